@@ -32,6 +32,7 @@
  * @author Joakim Nohlgård <joakim.nohlgard@eistec.se>
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "irq.h"
 
@@ -92,4 +93,44 @@ TEMPLATE_ATOMIC_FETCH_OP_N(nand, &, 2, ~) /* __atomic_fetch_nand_2 */
 TEMPLATE_ATOMIC_FETCH_OP_N(nand, &, 4, ~) /* __atomic_fetch_nand_4 */
 TEMPLATE_ATOMIC_FETCH_OP_N(nand, &, 8, ~) /* __atomic_fetch_nand_8 */
 
+/**
+ * @brief This is a macro that defines a function named __atomic_compare_exchange_<em>n</em>
+ *
+ * Unlike the builtin of the same name, the library call takes no weak
+ * argument. The function is therefore defined under another C name and only
+ * carries the symbol name of the library call, so it does not clash with the
+ * declaration of the builtin.
+ *
+ * \param n         width of the data, in bytes
+ */
+#define TEMPLATE_ATOMIC_COMPARE_EXCHANGE_N(n) \
+    bool _atomic_compare_exchange_##n (volatile void *ptr, void *expected, \
+                                       I##n desired, \
+                                       int success_memorder, \
+                                       int failure_memorder) \
+        __asm__("__atomic_compare_exchange_" #n); \
+    bool _atomic_compare_exchange_##n (volatile void *ptr, void *expected, \
+                                       I##n desired, \
+                                       int success_memorder, \
+                                       int failure_memorder) \
+    { \
+        unsigned int mask = irq_disable();    \
+        (void)success_memorder;               \
+        (void)failure_memorder;               \
+        I##n cur = *((I##n*)ptr);             \
+        if (cur == *((I##n*)expected)) {      \
+            *((I##n*)ptr) = desired;          \
+            irq_restore(mask);                \
+            return true;                      \
+        }                                     \
+        *((I##n*)expected) = cur;             \
+        irq_restore(mask);                    \
+        return false;                         \
+    }
+
+TEMPLATE_ATOMIC_COMPARE_EXCHANGE_N(1) /* __atomic_compare_exchange_1 */
+TEMPLATE_ATOMIC_COMPARE_EXCHANGE_N(2) /* __atomic_compare_exchange_2 */
+TEMPLATE_ATOMIC_COMPARE_EXCHANGE_N(4) /* __atomic_compare_exchange_4 */
+TEMPLATE_ATOMIC_COMPARE_EXCHANGE_N(8) /* __atomic_compare_exchange_8 */
+
 /** @} */
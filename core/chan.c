@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     core_chan
+ * @{
+ *
+ * @file
+ * @brief       Channel implementation
+ *
+ * @}
+ */
+
+#include <assert.h>
+
+#include "chan.h"
+#include "irq.h"
+#include "sched.h"
+#include "thread.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+#ifdef MODULE_CORE_CHAN
+
+/**
+ * @brief   Record header marking the rest of the buffer as unused, the next
+ *          record starts at the beginning of the buffer
+ */
+#define CHAN_WRAP       (0xffffU)
+
+static inline unsigned _align(size_t len)
+{
+    return (len + CHAN_ALIGN - 1) & ~(CHAN_ALIGN - 1);
+}
+
+static inline uint16_t *_hdr(chan_t *chan, unsigned pos)
+{
+    return (uint16_t *)&chan->buf[pos & (chan->size - 1)];
+}
+
+static inline void *_data(chan_t *chan, unsigned pos)
+{
+    return &chan->buf[(pos & (chan->size - 1)) + CHAN_HDR_SIZE];
+}
+
+static void _signal(kernel_pid_t pid, thread_flags_t flag)
+{
+    thread_t *thread = (thread_t *)thread_get(pid);
+
+    if (thread != NULL) {
+        thread_flags_set(thread, flag);
+    }
+}
+
+static void _set_tail(chan_t *chan, unsigned tail)
+{
+    __atomic_store_n(&chan->tail, tail, __ATOMIC_RELEASE);
+    if (chan->writer != KERNEL_PID_UNDEF) {
+        _signal(chan->writer, THREAD_FLAG_CHAN_SPACE);
+    }
+}
+
+void chan_init(chan_t *chan, void *buf, unsigned size, kernel_pid_t reader,
+               thread_flags_t flag)
+{
+    assert((size != 0) && ((size & (size - 1)) == 0));
+    chan->buf = buf;
+    chan->size = size;
+    chan->head = 0;
+    chan->tail = 0;
+    chan->reserved = 0;
+    chan->reader = reader;
+    chan->writer = KERNEL_PID_UNDEF;
+    chan->flag = flag;
+}
+
+void *_chan_reserve(chan_t *chan, size_t len, int blocking)
+{
+    unsigned need = CHAN_HDR_SIZE + _align(len);
+    unsigned head = chan->head;
+
+    if ((len >= CHAN_WRAP) || (need > chan->size)) {
+        DEBUG("chan: record of size %u does not fit\n", (unsigned)len);
+        return NULL;
+    }
+
+    while (1) {
+        unsigned tail = __atomic_load_n(&chan->tail, __ATOMIC_ACQUIRE);
+        unsigned used = head - tail;
+        unsigned contiguous = chan->size - (head & (chan->size - 1));
+
+        if (contiguous < need) {
+            if ((used + contiguous) <= chan->size) {
+                /* skip the end of the buffer, so the record is contiguous */
+                *_hdr(chan, head) = CHAN_WRAP;
+                head += contiguous;
+                __atomic_store_n(&chan->head, head, __ATOMIC_RELEASE);
+                continue;
+            }
+        }
+        else if ((used + need) <= chan->size) {
+            chan->writer = KERNEL_PID_UNDEF;
+            chan->reserved = head;
+            return _data(chan, head);
+        }
+
+        if (!blocking || irq_is_in()) {
+            return NULL;
+        }
+
+        DEBUG("chan: %" PRIkernel_pid " waits for space\n", sched_active_pid);
+        chan->writer = sched_active_pid;
+        /* the consumer may have made space before it saw chan->writer */
+        if (__atomic_load_n(&chan->tail, __ATOMIC_ACQUIRE) == tail) {
+            thread_flags_wait_any(THREAD_FLAG_CHAN_SPACE);
+        }
+    }
+}
+
+void chan_commit(chan_t *chan, size_t len)
+{
+    unsigned pos = chan->reserved;
+
+    *_hdr(chan, pos) = (uint16_t)len;
+    __atomic_store_n(&chan->head, pos + CHAN_HDR_SIZE + _align(len),
+                     __ATOMIC_RELEASE);
+    _signal(chan->reader, chan->flag);
+}
+
+void *_chan_peek(chan_t *chan, size_t *len, int blocking)
+{
+    while (1) {
+        unsigned tail = chan->tail;
+
+        if (__atomic_load_n(&chan->head, __ATOMIC_ACQUIRE) != tail) {
+            uint16_t hdr = *_hdr(chan, tail);
+
+            if (hdr == CHAN_WRAP) {
+                _set_tail(chan, tail + (chan->size - (tail & (chan->size - 1))));
+                continue;
+            }
+            *len = hdr;
+            return _data(chan, tail);
+        }
+
+        if (!blocking || irq_is_in()) {
+            return NULL;
+        }
+
+        DEBUG("chan: %" PRIkernel_pid " waits for a record\n", sched_active_pid);
+        thread_flags_wait_any(chan->flag);
+    }
+}
+
+void chan_release(chan_t *chan)
+{
+    unsigned tail = chan->tail;
+
+    _set_tail(chan, tail + CHAN_HDR_SIZE + _align(*_hdr(chan, tail)));
+}
+
+#endif /* MODULE_CORE_CHAN */
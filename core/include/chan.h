@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    core_chan Channels
+ * @ingroup     core
+ * @brief       Zero-copy single-producer/single-consumer channels
+ *
+ * A channel is a ring buffer of variable-size records between exactly one
+ * producer and one consumer. Records are written and read in place:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~ {.c}
+ * phydat_t *sample = chan_reserve(&chan, sizeof(phydat_t));
+ * saul_reg_read(dev, sample);
+ * chan_commit(&chan, sizeof(phydat_t));
+ * ~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~ {.c}
+ * size_t len;
+ * phydat_t *sample = chan_peek(&chan, &len);
+ * process(sample);
+ * chan_release(&chan);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * Unlike @ref core_msg, neither side has to wait for the other one: a commit
+ * only sets a @ref core_thread_flags "thread flag" of the consumer. The
+ * consumer can thus wait for several channels and for messages (see
+ * @ref THREAD_FLAG_MSG_WAITING) with a single thread_flags_wait_any().
+ *
+ * The `chan_try_*()` variants never block and can be used in interrupt
+ * context, e.g. to produce records from an ISR.
+ *
+ * This module requires `core_thread_flags`.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Channel API
+ */
+
+#ifndef CHAN_H
+#define CHAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "kernel_types.h"
+#include "thread_flags.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Alignment of the records in a channel
+ */
+#define CHAN_ALIGN      (4U)
+
+/**
+ * @brief   Size of the header in front of each record
+ */
+#define CHAN_HDR_SIZE   (CHAN_ALIGN)
+
+/**
+ * @brief   Channel structure. Must never be modified by the user.
+ */
+typedef struct {
+    uint8_t *buf;               /**< the ring buffer */
+    unsigned size;              /**< size of chan_t::buf, a power of two */
+    volatile unsigned head;     /**< write position, only moved by the producer */
+    volatile unsigned tail;     /**< read position, only moved by the consumer */
+    unsigned reserved;          /**< offset of the record currently reserved */
+    kernel_pid_t reader;        /**< the consumer */
+    volatile kernel_pid_t writer;   /**< a producer waiting for space */
+    thread_flags_t flag;        /**< flag set on chan_t::reader on commit */
+} chan_t;
+
+/**
+ * @brief   Initializes a channel
+ *
+ * @param[out] chan     The channel to initialize. Must not be NULL.
+ * @param[in] buf       Buffer for the records, aligned to @ref CHAN_ALIGN.
+ * @param[in] size      Size of @p buf. Must be a power of two.
+ * @param[in] reader    The consumer thread.
+ * @param[in] flag      Thread flag set on @p reader when a record is
+ *                      committed. Must not be a reserved flag.
+ */
+void chan_init(chan_t *chan, void *buf, unsigned size, kernel_pid_t reader,
+               thread_flags_t flag);
+
+/**
+ * @brief   Reserves space for a record, blocking or non-blocking.
+ *
+ * @details For commit purposes you should probably use chan_reserve() and
+ *          chan_try_reserve() instead.
+ *
+ * @param[in] chan      The channel. Must not be NULL.
+ * @param[in] len       Maximum size of the record.
+ * @param[in] blocking  if true, block until enough space is available.
+ *
+ * @return  Pointer to @p len bytes, aligned to @ref CHAN_ALIGN.
+ * @return  NULL, if not enough space is available and @p blocking is false.
+ * @return  NULL, if @p len never fits into the channel.
+ */
+void *_chan_reserve(chan_t *chan, size_t len, int blocking);
+
+/**
+ * @brief   Reserves space for a record, blocking.
+ *
+ * @param[in] chan      The channel. Must not be NULL.
+ * @param[in] len       Maximum size of the record.
+ *
+ * @return  Pointer to @p len bytes, NULL if @p len never fits into @p chan.
+ */
+static inline void *chan_reserve(chan_t *chan, size_t len)
+{
+    return _chan_reserve(chan, len, 1);
+}
+
+/**
+ * @brief   Reserves space for a record, non-blocking.
+ *
+ * @note    Can be used in interrupt context.
+ *
+ * @param[in] chan      The channel. Must not be NULL.
+ * @param[in] len       Maximum size of the record.
+ *
+ * @return  Pointer to @p len bytes, NULL if the channel is full.
+ */
+static inline void *chan_try_reserve(chan_t *chan, size_t len)
+{
+    return _chan_reserve(chan, len, 0);
+}
+
+/**
+ * @brief   Hands the reserved record over to the consumer.
+ *
+ * @note    Can be used in interrupt context.
+ *
+ * @param[in] chan      The channel. Must not be NULL.
+ * @param[in] len       Actual size of the record. Must not be greater than
+ *                      the size reserved.
+ */
+void chan_commit(chan_t *chan, size_t len);
+
+/**
+ * @brief   Gets the oldest record of a channel, blocking or non-blocking.
+ *
+ * @details For commit purposes you should probably use chan_peek() and
+ *          chan_try_peek() instead.
+ *
+ * @param[in] chan      The channel. Must not be NULL.
+ * @param[out] len      Size of the record. Must not be NULL.
+ * @param[in] blocking  if true, block until a record is available. Only
+ *                      the consumer thread may block.
+ *
+ * @return  The record. It stays valid until chan_release().
+ * @return  NULL, if the channel is empty and @p blocking is false.
+ */
+void *_chan_peek(chan_t *chan, size_t *len, int blocking);
+
+/**
+ * @brief   Gets the oldest record of a channel, blocking.
+ *
+ * @param[in] chan      The channel. Must not be NULL.
+ * @param[out] len      Size of the record. Must not be NULL.
+ *
+ * @return  The record. It stays valid until chan_release().
+ */
+static inline void *chan_peek(chan_t *chan, size_t *len)
+{
+    return _chan_peek(chan, len, 1);
+}
+
+/**
+ * @brief   Gets the oldest record of a channel, non-blocking.
+ *
+ * @note    Can be used in interrupt context.
+ *
+ * @param[in] chan      The channel. Must not be NULL.
+ * @param[out] len      Size of the record. Must not be NULL.
+ *
+ * @return  The record, NULL if the channel is empty.
+ */
+static inline void *chan_try_peek(chan_t *chan, size_t *len)
+{
+    return _chan_peek(chan, len, 0);
+}
+
+/**
+ * @brief   Frees the record returned by the last chan_peek().
+ *
+ * @note    Can be used in interrupt context.
+ *
+ * @param[in] chan      The channel. Must not be NULL.
+ */
+void chan_release(chan_t *chan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CHAN_H */
+/** @} */
@@ -69,6 +69,26 @@ static inline list_node_t* list_remove_head(list_node_t *list) {
     return head;
 }
 
+/**
+ * @brief Removes the node from the list
+ *
+ * @param[in] list  Pointer to the list itself, where list->next points
+ *                  to the root node
+ * @param[in] node  List node to remove from the list
+ *
+ * @return  removed node, or NULL if it is not in the list
+ */
+static inline list_node_t* list_remove(list_node_t *list, list_node_t *node) {
+    while (list->next) {
+        if (list->next == node) {
+            list->next = node->next;
+            return node;
+        }
+        list = list->next;
+    }
+    return NULL;
+}
+
 #ifdef __cplusplus
 }
 #endif
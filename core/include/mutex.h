@@ -26,6 +26,7 @@
 
 #include "list.h"
 #include "atomic.h"
+#include "kernel_types.h"
 
 #ifdef __cplusplus
  extern "C" {
@@ -33,6 +34,16 @@
 
 /**
  * @brief Mutex structure. Must never be modified by the user.
+ *
+ * @details An uncontended mutex is locked and unlocked with a single atomic
+ *          compare-and-swap on mutex_t::queue, interrupts are only disabled
+ *          when a thread has to wait for the mutex.
+ *
+ *          With module `core_mutex_pi` the mutex implements priority
+ *          inheritance: while a thread waits for the mutex, its owner runs
+ *          with at least the priority of the waiter. Inheritance is not
+ *          transitive, i.e. if the owner itself waits for another mutex the
+ *          owner of that mutex is not boosted.
  */
 typedef struct {
     /**
@@ -41,13 +52,30 @@ typedef struct {
      * @internal
      */
     list_node_t queue;
+#if defined(MODULE_CORE_MUTEX_PI) || defined(DOXYGEN)
+    /**
+     * @brief   The owner of the mutex, only valid if threads are waiting.
+     * @internal
+     */
+    kernel_pid_t owner;
+    /**
+     * @brief   Entry in the owner's list of held mutexes threads wait for,
+     *          only valid if threads are waiting.
+     * @internal
+     */
+    list_node_t owner_node;
+#endif
 } mutex_t;
 
 /**
  * @brief Static initializer for mutex_t.
  * @details This initializer is preferable to mutex_init().
  */
+#ifdef MODULE_CORE_MUTEX_PI
+#define MUTEX_INIT { { NULL }, KERNEL_PID_UNDEF, { NULL } }
+#else
 #define MUTEX_INIT { { NULL } }
+#endif
 
 /**
  * @brief Initializes a mutex object.
@@ -58,6 +86,10 @@ typedef struct {
 static inline void mutex_init(mutex_t *mutex)
 {
     mutex->queue.next = NULL;
+#ifdef MODULE_CORE_MUTEX_PI
+    mutex->owner = KERNEL_PID_UNDEF;
+    mutex->owner_node.next = NULL;
+#endif
 }
 
 /**
@@ -99,6 +131,38 @@ static inline void mutex_lock(mutex_t *mutex)
     _mutex_lock(mutex, 1);
 }
 
+#if defined(MODULE_CORE_MUTEX_PI) || defined(DOXYGEN)
+struct _thread;
+
+/**
+ * @brief   Gets the priority a thread runs with: its base priority or the
+ *          highest priority of the threads waiting for the mutexes it holds.
+ *
+ * @pre     Interrupts are disabled.
+ *
+ * @param[in] thread    The thread.
+ *
+ * @return  The priority.
+ *
+ * @internal
+ */
+uint8_t mutex_pi_priority(struct _thread *thread);
+
+/**
+ * @brief   Disowns the mutexes an exiting thread holds.
+ *
+ * @details The mutexes stay locked, but threads waiting for them no longer
+ *          boost the exited thread or a new thread with its PID.
+ *
+ * @pre     Interrupts are disabled.
+ *
+ * @param[in] thread    The exiting thread.
+ *
+ * @internal
+ */
+void mutex_pi_exit(struct _thread *thread);
+#endif
+
 /**
  * @brief Unlocks the mutex.
  *
@@ -119,6 +119,42 @@ int sched_run(void);
  */
 void sched_set_status(thread_t *process, unsigned int status);
 
+/**
+ * @brief   Change the priority of a thread
+ *
+ * @details If the thread is on a runqueue it is moved to the runqueue of
+ *          its new priority. The running thread stays at the head of its
+ *          runqueue. Does not yield.
+ *
+ *          With module `core_mutex_pi` this changes the base priority of the
+ *          thread: while it holds a mutex a thread of higher priority waits
+ *          for, it keeps running with the priority it inherited.
+ *
+ * @note    Must be called with interrupts disabled.
+ *
+ * @param[in]   process     Pointer to the thread control block of the
+ *                          targeted process
+ * @param[in]   priority    The new priority of this thread
+ */
+void sched_change_priority(thread_t *process, uint8_t priority);
+
+/**
+ * @brief   Sets the priority a thread is scheduled with, leaving its base
+ *          priority alone
+ *
+ * @details Like sched_change_priority(), but for the priority inheritance
+ *          of @ref mutex_t.
+ *
+ * @note    Must be called with interrupts disabled.
+ *
+ * @param[in]   process     Pointer to the thread control block of the
+ *                          targeted process
+ * @param[in]   priority    The priority to schedule this thread with
+ *
+ * @internal
+ */
+void sched_set_priority(thread_t *process, uint8_t priority);
+
 /**
  * @brief       Yield if approriate.
  *
@@ -175,6 +211,11 @@ extern clist_node_t sched_runqueues[SCHED_PRIO_LEVELS];
 NORETURN void sched_task_exit(void);
 
 #ifdef MODULE_SCHEDSTATISTICS
+/**
+ *  Number of thread states (`STATUS_*` in thread.h)
+ */
+#define SCHED_STAT_STATUS_NUMOF     (10U)
+
 /**
  *  Scheduler statistics
  */
@@ -182,7 +223,18 @@ typedef struct {
     unsigned int laststart;         /**< Time stamp of the last time this thread was
                                          scheduled to run */
     unsigned int schedules;         /**< How often the thread was scheduled to run */
-    unsigned long runtime_ticks;    /**< The total runtime of this thread in ticks */
+    uint64_t runtime_ticks;         /**< The total runtime of this thread in ticks */
+    unsigned int voluntary;         /**< How often the thread gave up the CPU
+                                         because it blocked */
+    unsigned int yields;            /**< How often the thread gave up the CPU
+                                         by calling thread_yield() */
+    unsigned int involuntary;       /**< How often the thread was preempted
+                                         while still runnable */
+    uint32_t status_since;          /**< Time stamp of the last status change */
+    uint64_t status_ticks[SCHED_STAT_STATUS_NUMOF]; /**< The total time spent
+                                                         in each `STATUS_*`
+                                                         in ticks */
+    uint16_t msg_queue_max;         /**< High-water mark of the message queue */
 } schedstat;
 
 /**
@@ -190,12 +242,50 @@ typedef struct {
  */
 extern schedstat sched_pidlist[KERNEL_PID_LAST + 1];
 
+/**
+ *  @brief  Set by thread_yield() so the next sched_run() counts the switch in
+ *          schedstat::yields instead of schedstat::involuntary
+ *
+ *  @internal
+ */
+extern volatile unsigned int sched_yield_request;
+
 /**
  *  @brief  Register a callback that will be called on every scheduler run
  *
  *  @param[in] callback The callback functions the will be called
  */
 void sched_register_cb(void (*callback)(uint32_t, uint32_t));
+
+/**
+ *  @brief  Get a consistent copy of the statistics of a thread
+ *
+ *  @details    Unlike @ref sched_pidlist, the copy includes the time the thread
+ *              spent in its current status and time slice.
+ *
+ *  @param[in] pid      The thread
+ *  @param[out] stat    The statistics of @p pid
+ *
+ *  @return 0 on success
+ *  @return -1 if @p pid is not a running thread
+ */
+int sched_stat_get(kernel_pid_t pid, schedstat *stat);
+
+/**
+ *  @brief  Reset the statistics of all threads
+ *
+ *  @details    Also (re)starts the timer that keeps the 64-bit counters
+ *              correct across the wrap of xtimer_now(). It is called once
+ *              xtimer is initialized, before main() runs.
+ */
+void sched_stat_reset(void);
+
+/**
+ *  @brief  Get the time covered by the statistics
+ *
+ *  @return Ticks since the last sched_stat_reset()
+ */
+uint64_t sched_stat_elapsed(void);
 #endif /* MODULE_SCHEDSTATISTICS */
 
 #ifdef __cplusplus
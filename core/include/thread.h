@@ -93,6 +93,11 @@ struct _thread {
     msg_t *msg_array;               /**< memory holding messages        */
 #endif
 
+#ifdef MODULE_CORE_MUTEX_PI
+    list_node_t mutexes_held;       /**< held mutexes threads wait for  */
+    uint8_t base_priority;          /**< priority without inheritance   */
+#endif
+
 #if defined DEVELHELP || defined(SCHED_TEST_STACK)
     char *stack_start;              /**< thread's stack start address   */
 #endif
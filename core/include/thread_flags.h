@@ -42,7 +42,7 @@
  * Usually, if it is only of interest that an event occurred, but not how many
  * of them, thread flags should be considered.
  *
- * Note that some flags (currently the three most significant bits) are used by
+ * Note that some flags (currently the four most significant bits) are used by
  * core functions and should not be set by the user. They can be waited for.
  *
  * @author      Kaspar Schleiser <kaspar@schleiser.de>
@@ -64,6 +64,7 @@
 #define THREAD_FLAG_MSG_WAITING      (0x1<<15)
 #define THREAD_FLAG_MUTEX_UNLOCKED   (0x1<<14)
 #define THREAD_FLAG_TIMEOUT          (0x1<<13)
+#define THREAD_FLAG_CHAN_SPACE       (0x1<<12)
 /** @} */
 
 /**
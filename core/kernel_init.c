@@ -51,8 +51,8 @@ static void *main_trampoline(void *arg)
 #endif
 
 #ifdef MODULE_SCHEDSTATISTICS
-    schedstat *stat = &sched_pidlist[thread_getpid()];
-    stat->laststart = 0;
+    /* time stamps taken before xtimer was initialized are meaningless */
+    sched_stat_reset();
 #endif
 
     LOG_INFO("main(): This is RIOT! (Version: " RIOT_VERSION ")\n");
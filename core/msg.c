@@ -29,6 +29,9 @@
 #include "thread.h"
 #include "irq.h"
 #include "cib.h"
+#ifdef MODULE_CORE_THREAD_FLAGS
+#include "thread_flags.h"
+#endif
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
@@ -50,9 +53,49 @@ static int queue_msg(thread_t *target, const msg_t *m)
     DEBUG("queue_msg(): queuing message\n");
     msg_t *dest = &target->msg_array[n];
     *dest = *m;
+#ifdef MODULE_SCHEDSTATISTICS
+    uint16_t queued = cib_avail(&target->msg_queue);
+    if (queued > sched_pidlist[target->pid].msg_queue_max) {
+        sched_pidlist[target->pid].msg_queue_max = queued;
+    }
+#endif
     return 1;
 }
 
+/**
+ * @brief   Sets THREAD_FLAG_MSG_WAITING on @p target after a message was
+ *          queued, so it can wait for messages and other events together.
+ *
+ * @return  1 if @p target was woken up, 0 otherwise.
+ */
+static inline int _msg_waiting(thread_t *target)
+{
+#ifdef MODULE_CORE_THREAD_FLAGS
+    target->flags |= THREAD_FLAG_MSG_WAITING;
+    return thread_flags_wake(target);
+#else
+    (void)target;
+    return 0;
+#endif
+}
+
+/**
+ * @brief   Clears THREAD_FLAG_MSG_WAITING on @p me once neither queued nor
+ *          blocked senders' messages are left.
+ *
+ * @pre Interrupts are disabled
+ */
+static inline void _msg_drained(thread_t *me)
+{
+#ifdef MODULE_CORE_THREAD_FLAGS
+    if ((cib_avail(&me->msg_queue) == 0) && (me->msg_waiters.next == NULL)) {
+        me->flags &= ~THREAD_FLAG_MSG_WAITING;
+    }
+#else
+    (void)me;
+#endif
+}
+
 int msg_send(msg_t *m, kernel_pid_t target_pid)
 {
     if (irq_is_in()) {
@@ -108,8 +151,9 @@ static int _msg_send(msg_t *m, kernel_pid_t target_pid, bool block, unsigned sta
             DEBUG("msg_send() %s:%i: Target %" PRIkernel_pid
                   " has a msg_queue. Queueing message.\n", RIOT_FILE_RELATIVE,
                   __LINE__, target_pid);
+            int woken = _msg_waiting(target);
             irq_restore(state);
-            if (me->status == STATUS_REPLY_BLOCKED) {
+            if ((me->status == STATUS_REPLY_BLOCKED) || woken) {
                 thread_yield_higher();
             }
             return 1;
@@ -139,6 +183,7 @@ static int _msg_send(msg_t *m, kernel_pid_t target_pid, bool block, unsigned sta
         sched_set_status((thread_t*) me, newstatus);
 
         thread_add_to_list(&(target->msg_waiters), me);
+        _msg_waiting(target);
 
         irq_restore(state);
         thread_yield_higher();
@@ -169,6 +214,9 @@ int msg_send_to_self(msg_t *m)
     m->sender_pid = sched_active_pid;
     int res = queue_msg((thread_t *) sched_active_thread, m);
 
+    if (res) {
+        _msg_waiting((thread_t *) sched_active_thread);
+    }
     irq_restore(state);
     return res;
 }
@@ -204,7 +252,13 @@ int msg_send_int(msg_t *m, kernel_pid_t target_pid)
     }
     else {
         DEBUG("msg_send_int: Receiver not waiting.\n");
-        return (queue_msg(target, m));
+        if (!queue_msg(target, m)) {
+            return 0;
+        }
+        if (_msg_waiting(target)) {
+            sched_context_switch_request = 1;
+        }
+        return 1;
     }
 }
 
@@ -313,6 +367,7 @@ static int _msg_receive(msg_t *m, int block)
             DEBUG("_msg_receive(): %" PRIkernel_pid ": No msg in queue. Going blocked.\n",
                   sched_active_thread->pid);
             sched_set_status(me, STATUS_RECEIVE_BLOCKED);
+            _msg_drained(me);
 
             irq_restore(state);
             thread_yield_higher();
@@ -320,6 +375,7 @@ static int _msg_receive(msg_t *m, int block)
             /* sender copied message */
         }
         else {
+            _msg_drained(me);
             irq_restore(state);
         }
 
@@ -350,6 +406,7 @@ static int _msg_receive(msg_t *m, int block)
             sender_prio = sender->priority;
         }
 
+        _msg_drained(me);
         irq_restore(state);
         if (sender_prio < THREAD_PRIORITY_IDLE) {
             sched_switch(sender_prio);
@@ -37,64 +37,199 @@
 
 #define MUTEX_LOCKED ((void*)-1)
 
+/**
+ * @brief   Low bit of mutex_t::queue.next: set if the mutex is locked but no
+ *          thread waits for it
+ *
+ * @details Thread control blocks are word-aligned, so with `core_mutex_pi`
+ *          the remaining bits store the owner. MUTEX_LOCKED (owner unknown,
+ *          e.g. when locked from an ISR) has it set as well.
+ */
+#define MUTEX_TAG    ((uintptr_t)1)
+
+static inline int _is_tagged(list_node_t *val)
+{
+    return ((uintptr_t)val & MUTEX_TAG);
+}
+
+static inline list_node_t *_locked_by_me(void)
+{
+#ifdef MODULE_CORE_MUTEX_PI
+    if (!irq_is_in()) {
+        return (list_node_t*)((uintptr_t)sched_active_thread | MUTEX_TAG);
+    }
+#endif
+    return MUTEX_LOCKED;
+}
+
+#ifdef MODULE_CORE_MUTEX_PI
+static inline thread_t *_owner(mutex_t *mutex, list_node_t *val)
+{
+    thread_t *owner;
+
+    if (_is_tagged(val)) {
+        if (val == MUTEX_LOCKED) {
+            return NULL;
+        }
+        owner = (thread_t*)((uintptr_t)val & ~MUTEX_TAG);
+        /* the thread might have exited without unlocking the mutex */
+        if (!pid_is_valid(owner->pid) || (sched_threads[owner->pid] != owner)) {
+            return NULL;
+        }
+        return owner;
+    }
+    return (thread_t*)sched_threads[mutex->owner];
+}
+
+uint8_t mutex_pi_priority(thread_t *thread)
+{
+    uint8_t priority = thread->base_priority;
+
+    for (list_node_t *node = thread->mutexes_held.next; node != NULL;
+         node = node->next) {
+        mutex_t *mutex = container_of(node, mutex_t, owner_node);
+        /* waiters are sorted by priority */
+        thread_t *waiter = container_of((clist_node_t*)mutex->queue.next,
+                                        thread_t, rq_entry);
+
+        if (waiter->priority < priority) {
+            priority = waiter->priority;
+        }
+    }
+    return priority;
+}
+
+void mutex_pi_exit(thread_t *thread)
+{
+    for (list_node_t *node = thread->mutexes_held.next; node != NULL;
+         node = node->next) {
+        container_of(node, mutex_t, owner_node)->owner = KERNEL_PID_UNDEF;
+    }
+    thread->mutexes_held.next = NULL;
+}
+
+/**
+ * @brief   Sets the priority of @p owner to the highest priority of the
+ *          threads waiting for the mutexes it holds or to its base priority.
+ *
+ * @details Recomputing from all held mutexes keeps the priority right no
+ *          matter in which order they are unlocked.
+ */
+static void _update_owner(thread_t *owner)
+{
+    uint8_t priority = mutex_pi_priority(owner);
+
+    if (priority != owner->priority) {
+        DEBUG("mutex: changing prio of %" PRIkernel_pid " to %" PRIu32 "\n",
+              owner->pid, (uint32_t)priority);
+        sched_set_priority(owner, priority);
+    }
+}
+
+/**
+ * @brief   Makes @p owner the owner of @p mutex, which threads wait for.
+ */
+static void _hold(mutex_t *mutex, thread_t *owner)
+{
+    mutex->owner = owner->pid;
+    list_add(&owner->mutexes_held, &mutex->owner_node);
+}
+
+/**
+ * @brief   Takes @p mutex from its owner and drops what the owner inherited
+ *          through it.
+ */
+static void _release(mutex_t *mutex)
+{
+    thread_t *owner = (thread_t*)sched_threads[mutex->owner];
+
+    mutex->owner = KERNEL_PID_UNDEF;
+    if ((owner != NULL) &&
+        (list_remove(&owner->mutexes_held, &mutex->owner_node) != NULL)) {
+        _update_owner(owner);
+    }
+}
+#endif
+
 int _mutex_lock(mutex_t *mutex, int blocking)
 {
+    list_node_t *unlocked = NULL;
+
+    /* fast path: take an unlocked mutex without disabling interrupts */
+    if (__atomic_compare_exchange_n(&mutex->queue.next, &unlocked,
+                                    _locked_by_me(), 0, __ATOMIC_ACQUIRE,
+                                    __ATOMIC_RELAXED)) {
+        DEBUG("PID[%" PRIkernel_pid "]: mutex_wait early out.\n",
+              sched_active_pid);
+        return 1;
+    }
+    else if (!blocking) {
+        return 0;
+    }
+
     unsigned irqstate = irq_disable();
 
     DEBUG("PID[%" PRIkernel_pid "]: Mutex in use.\n", sched_active_pid);
 
     if (mutex->queue.next == NULL) {
-        /* mutex is unlocked. */
-        mutex->queue.next = MUTEX_LOCKED;
-        DEBUG("PID[%" PRIkernel_pid "]: mutex_wait early out.\n",
-              sched_active_pid);
+        /* mutex was unlocked in the meantime. */
+        mutex->queue.next = _locked_by_me();
         irq_restore(irqstate);
         return 1;
     }
-    else if (blocking) {
+    else {
         thread_t *me = (thread_t*)sched_active_thread;
+#ifdef MODULE_CORE_MUTEX_PI
+        thread_t *owner = _owner(mutex, mutex->queue.next);
+#endif
         DEBUG("PID[%" PRIkernel_pid "]: Adding node to mutex queue: prio: %"
               PRIu32 "\n", sched_active_pid, (uint32_t)me->priority);
         sched_set_status(me, STATUS_MUTEX_BLOCKED);
-        if (mutex->queue.next == MUTEX_LOCKED) {
+        if (_is_tagged(mutex->queue.next)) {
             mutex->queue.next = (list_node_t*)&me->rq_entry;
             mutex->queue.next->next = NULL;
+#ifdef MODULE_CORE_MUTEX_PI
+            mutex->owner = KERNEL_PID_UNDEF;
+            if (owner != NULL) {
+                _hold(mutex, owner);
+            }
+#endif
         }
         else {
             thread_add_to_list(&mutex->queue, me);
         }
+#ifdef MODULE_CORE_MUTEX_PI
+        if (owner != NULL) {
+            _update_owner(owner);
+        }
+#endif
         irq_restore(irqstate);
         thread_yield_higher();
         /* We were woken up by scheduler. Waker removed us from queue.
          * We have the mutex now. */
         return 1;
     }
-    else {
-        irq_restore(irqstate);
-        return 0;
-    }
 }
 
-void mutex_unlock(mutex_t *mutex)
+/**
+ * @brief   Hands the mutex over to the first waiting thread or unlocks it.
+ *
+ * @pre     Interrupts are disabled.
+ *
+ * @return  The woken up thread, NULL if no thread was waiting.
+ */
+static thread_t *_unlock(mutex_t *mutex)
 {
-    unsigned irqstate = irq_disable();
-
-    DEBUG("mutex_unlock(): queue.next: 0x%08x pid: %" PRIkernel_pid "\n",
-          (unsigned)mutex->queue.next, sched_active_pid);
-
-    if (mutex->queue.next == NULL) {
-        /* the mutex was not locked */
-        irq_restore(irqstate);
-        return;
-    }
-
-    if (mutex->queue.next == MUTEX_LOCKED) {
+    if ((mutex->queue.next == NULL) || _is_tagged(mutex->queue.next)) {
+        /* the mutex was not locked or no thread was waiting for it */
         mutex->queue.next = NULL;
-        /* the mutex was locked and no thread was waiting for it */
-        irq_restore(irqstate);
-        return;
+        return NULL;
     }
 
+#ifdef MODULE_CORE_MUTEX_PI
+    _release(mutex);
+#endif
+
     list_node_t *next = list_remove_head(&mutex->queue);
 
     thread_t *process = container_of((clist_node_t*)next, thread_t, rq_entry);
@@ -104,7 +239,43 @@ void mutex_unlock(mutex_t *mutex)
     sched_set_status(process, STATUS_PENDING);
 
     if (!mutex->queue.next) {
+#ifdef MODULE_CORE_MUTEX_PI
+        mutex->queue.next = (list_node_t*)((uintptr_t)process | MUTEX_TAG);
+#else
         mutex->queue.next = MUTEX_LOCKED;
+#endif
+    }
+#ifdef MODULE_CORE_MUTEX_PI
+    else {
+        /* waiters are sorted by priority, so the new owner needs no boost */
+        _hold(mutex, process);
+    }
+#endif
+
+    return process;
+}
+
+void mutex_unlock(mutex_t *mutex)
+{
+    list_node_t *locked = __atomic_load_n(&mutex->queue.next, __ATOMIC_RELAXED);
+
+    DEBUG("mutex_unlock(): queue.next: %p pid: %" PRIkernel_pid "\n",
+          (void *)locked, sched_active_pid);
+
+    /* fast path: no thread is waiting for the mutex */
+    if ((locked == NULL) ||
+        (_is_tagged(locked) &&
+         __atomic_compare_exchange_n(&mutex->queue.next, &locked, NULL, 0,
+                                     __ATOMIC_RELEASE, __ATOMIC_RELAXED))) {
+        return;
+    }
+
+    unsigned irqstate = irq_disable();
+    thread_t *process = _unlock(mutex);
+
+    if (process == NULL) {
+        irq_restore(irqstate);
+        return;
     }
 
     uint16_t process_priority = process->priority;
@@ -114,25 +285,11 @@ void mutex_unlock(mutex_t *mutex)
 
 void mutex_unlock_and_sleep(mutex_t *mutex)
 {
-    DEBUG("PID[%" PRIkernel_pid "]: unlocking mutex. queue.next: 0x%08x, and "
-          "taking a nap\n", sched_active_pid, (unsigned)mutex->queue.next);
+    DEBUG("PID[%" PRIkernel_pid "]: unlocking mutex. queue.next: %p, and "
+          "taking a nap\n", sched_active_pid, (void *)mutex->queue.next);
     unsigned irqstate = irq_disable();
 
-    if (mutex->queue.next) {
-        if (mutex->queue.next == MUTEX_LOCKED) {
-            mutex->queue.next = NULL;
-        }
-        else {
-            list_node_t *next = list_remove_head(&mutex->queue);
-            thread_t *process = container_of((clist_node_t*)next, thread_t,
-                                             rq_entry);
-            DEBUG("PID[%" PRIkernel_pid "]: waking up waiter.\n", process->pid);
-            sched_set_status(process, STATUS_PENDING);
-            if (!mutex->queue.next) {
-                mutex->queue.next = MUTEX_LOCKED;
-            }
-        }
-    }
+    _unlock(mutex);
 
     DEBUG("PID[%" PRIkernel_pid "]: going to sleep.\n", sched_active_pid);
     sched_set_status((thread_t*)sched_active_thread, STATUS_SLEEPING);
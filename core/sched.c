@@ -28,8 +28,11 @@
 #include "thread.h"
 #include "irq.h"
 #include "log.h"
+#include "mutex.h"
 
 #ifdef MODULE_SCHEDSTATISTICS
+#include <string.h>
+
 #include "xtimer.h"
 #endif
 
@@ -56,11 +59,83 @@ static uint32_t runqueue_bitcache = 0;
 #ifdef MODULE_SCHEDSTATISTICS
 static void (*sched_cb) (uint32_t timestamp, uint32_t value) = NULL;
 schedstat sched_pidlist[KERNEL_PID_LAST + 1];
+volatile unsigned int sched_yield_request;
+static uint32_t _stat_last;
+static uint64_t _stat_elapsed;
+static xtimer_t _stat_timer;
+
+/**
+ * @brief   Interval at which open time spans are folded into the 64-bit
+ *          counters
+ *
+ * Time stamps are 32-bit xtimer_now() values, which wrap after ~71 minutes.
+ * Folding every ~35 minutes keeps every difference of two stamps unambiguous.
+ */
+#define SCHED_STAT_FOLD_INTERVAL    (1UL << 31)
+
+#if SCHED_STAT_STATUS_NUMOF != (STATUS_PENDING + 1)
+#error "SCHED_STAT_STATUS_NUMOF does not match the thread states"
+#endif
+
+/**
+ * @brief   Accounts the time since the last status change of @p thread to its
+ *          current status
+ *
+ * @details A thread leaving STATUS_STOPPED was just created, so its PID's
+ *          statistics are cleared.
+ */
+static inline void _stat_status(thread_t *thread, uint32_t now)
+{
+    schedstat *stat = &sched_pidlist[thread->pid];
+
+    if (thread->status == STATUS_STOPPED) {
+        memset(stat, 0, sizeof(schedstat));
+    }
+    else {
+        stat->status_ticks[thread->status] += now - stat->status_since;
+    }
+    stat->status_since = now;
+}
+
+/**
+ * @brief   Accounts the open time spans of all threads up to now
+ *
+ * @pre     Interrupts are disabled
+ */
+static void _stat_fold(uint32_t now)
+{
+    for (kernel_pid_t pid = KERNEL_PID_FIRST; pid <= KERNEL_PID_LAST; pid++) {
+        thread_t *thread = (thread_t *)sched_threads[pid];
+
+        if ((thread != NULL) && (thread->status != STATUS_STOPPED)) {
+            _stat_status(thread, now);
+        }
+    }
+    if (sched_active_thread != NULL) {
+        schedstat *stat = &sched_pidlist[sched_active_pid];
+
+        stat->runtime_ticks += now - stat->laststart;
+        stat->laststart = now;
+    }
+    _stat_elapsed += now - _stat_last;
+    _stat_last = now;
+}
+
+static void _stat_fold_cb(void *arg)
+{
+    (void)arg;
+    _stat_fold(xtimer_now());
+    xtimer_set(&_stat_timer, SCHED_STAT_FOLD_INTERVAL);
+}
 #endif
 
 int sched_run(void)
 {
     sched_context_switch_request = 0;
+#ifdef MODULE_SCHEDSTATISTICS
+    unsigned int yielded = sched_yield_request;
+    sched_yield_request = 0;
+#endif
 
     thread_t *active_thread = (thread_t *)sched_active_thread;
 
@@ -80,13 +155,27 @@ int sched_run(void)
     }
 
 #ifdef MODULE_SCHEDSTATISTICS
-    unsigned long time = xtimer_now();
+    uint32_t time = xtimer_now();
 #endif
 
     if (active_thread) {
         if (active_thread->status == STATUS_RUNNING) {
+#ifdef MODULE_SCHEDSTATISTICS
+            if (yielded) {
+                sched_pidlist[active_thread->pid].yields++;
+            }
+            else {
+                sched_pidlist[active_thread->pid].involuntary++;
+            }
+            _stat_status(active_thread, time);
+#endif
             active_thread->status = STATUS_PENDING;
         }
+#ifdef MODULE_SCHEDSTATISTICS
+        else {
+            sched_pidlist[active_thread->pid].voluntary++;
+        }
+#endif
 
 #ifdef SCHED_TEST_STACK
         if (*((uintptr_t *) active_thread->stack_start) != (uintptr_t) active_thread->stack_start) {
@@ -109,6 +198,7 @@ int sched_run(void)
     if (sched_cb) {
         sched_cb(time, next_thread->pid);
     }
+    _stat_status(next_thread, time);
 #endif
 
     next_thread->status = STATUS_RUNNING;
@@ -125,10 +215,72 @@ void sched_register_cb(void (*callback)(uint32_t, uint32_t))
 {
     sched_cb = callback;
 }
+
+int sched_stat_get(kernel_pid_t pid, schedstat *stat)
+{
+    if ((pid < KERNEL_PID_FIRST) || (pid > KERNEL_PID_LAST)) {
+        return -1;
+    }
+
+    unsigned state = irq_disable();
+    thread_t *thread = (thread_t *)sched_threads[pid];
+
+    if (thread == NULL) {
+        irq_restore(state);
+        return -1;
+    }
+
+    uint32_t now = xtimer_now();
+
+    *stat = sched_pidlist[pid];
+    /* account the time of the current status and time slice */
+    stat->status_ticks[thread->status] += now - stat->status_since;
+    stat->status_since = now;
+    if (thread == sched_active_thread) {
+        stat->runtime_ticks += now - stat->laststart;
+        stat->laststart = now;
+    }
+    irq_restore(state);
+
+    return 0;
+}
+
+void sched_stat_reset(void)
+{
+    unsigned state = irq_disable();
+    uint32_t now = xtimer_now();
+
+    for (kernel_pid_t pid = KERNEL_PID_FIRST; pid <= KERNEL_PID_LAST; pid++) {
+        schedstat *stat = &sched_pidlist[pid];
+
+        memset(stat, 0, sizeof(schedstat));
+        stat->laststart = now;
+        stat->status_since = now;
+    }
+    _stat_last = now;
+    _stat_elapsed = 0;
+    _stat_timer.callback = _stat_fold_cb;
+    xtimer_set(&_stat_timer, SCHED_STAT_FOLD_INTERVAL);
+    irq_restore(state);
+}
+
+uint64_t sched_stat_elapsed(void)
+{
+    unsigned state = irq_disable();
+    uint64_t elapsed = _stat_elapsed + (xtimer_now() - _stat_last);
+
+    irq_restore(state);
+    return elapsed;
+}
 #endif
 
 void sched_set_status(thread_t *process, unsigned int status)
 {
+#ifdef MODULE_SCHEDSTATISTICS
+    if (process->status != status) {
+        _stat_status(process, xtimer_now());
+    }
+#endif
     if (status >= STATUS_ON_RUNQUEUE) {
         if (!(process->status >= STATUS_ON_RUNQUEUE)) {
             DEBUG("sched_set_status: adding thread %" PRIkernel_pid " to runqueue %" PRIu16 ".\n",
@@ -152,6 +304,61 @@ void sched_set_status(thread_t *process, unsigned int status)
     process->status = status;
 }
 
+void sched_change_priority(thread_t *process, uint8_t priority)
+{
+#ifdef MODULE_CORE_MUTEX_PI
+    process->base_priority = priority;
+    priority = mutex_pi_priority(process);
+#endif
+    sched_set_priority(process, priority);
+}
+
+void sched_set_priority(thread_t *process, uint8_t priority)
+{
+    uint8_t old_prio = process->priority;
+
+    if (old_prio == priority) {
+        return;
+    }
+
+    if (process->status >= STATUS_ON_RUNQUEUE) {
+        clist_node_t *rq = &sched_runqueues[old_prio];
+        clist_node_t *node = &process->rq_entry;
+        clist_node_t *prev = rq->next;
+
+        DEBUG("sched_set_priority: moving thread %" PRIkernel_pid " from runqueue %"
+              PRIu16 " to %" PRIu16 ".\n", process->pid, old_prio, priority);
+
+        /* the runqueue is circular, so the predecessor is always found */
+        while (prev->next != node) {
+            prev = prev->next;
+        }
+        if (prev == node) {
+            rq->next = NULL;
+            runqueue_bitcache &= ~(1 << old_prio);
+        }
+        else {
+            prev->next = node->next;
+            if (rq->next == node) {
+                rq->next = prev;
+            }
+        }
+
+        rq = &sched_runqueues[priority];
+        if ((process->status == STATUS_RUNNING) && rq->next) {
+            /* the running thread must stay the head of its runqueue */
+            node->next = rq->next->next;
+            rq->next->next = node;
+        }
+        else {
+            clist_insert(rq, node);
+        }
+        runqueue_bitcache |= 1 << priority;
+    }
+
+    process->priority = priority;
+}
+
 void sched_switch(uint16_t other_prio)
 {
     thread_t *active_thread = (thread_t *) sched_active_thread;
@@ -182,6 +389,9 @@ NORETURN void sched_task_exit(void)
     DEBUG("sched_task_exit: ending thread %" PRIkernel_pid "...\n", sched_active_thread->pid);
 
     (void) irq_disable();
+#ifdef MODULE_CORE_MUTEX_PI
+    mutex_pi_exit((thread_t *)sched_active_thread);
+#endif
     sched_threads[sched_active_pid] = NULL;
     sched_num_threads--;
 
@@ -78,7 +78,7 @@ int thread_wakeup(kernel_pid_t pid)
     else if (other_thread->status == STATUS_SLEEPING) {
         DEBUG("thread_wakeup: Thread is sleeping.\n");
 
-        sched_set_status(other_thread, STATUS_RUNNING);
+        sched_set_status(other_thread, STATUS_PENDING);
 
         irq_restore(old_state);
         sched_switch(other_thread->priority);
@@ -100,6 +100,9 @@ void thread_yield(void)
     if (me->status >= STATUS_ON_RUNQUEUE) {
         clist_advance(&sched_runqueues[me->priority]);
     }
+#ifdef MODULE_SCHEDSTATISTICS
+    sched_yield_request = 1;
+#endif
     irq_restore(old_state);
 
     thread_yield_higher();
@@ -225,6 +228,11 @@ kernel_pid_t thread_create(char *stack, int stacksize, char priority, int flags,
 
     cb->rq_entry.next = NULL;
 
+#ifdef MODULE_CORE_MUTEX_PI
+    cb->mutexes_held.next = NULL;
+    cb->base_priority = priority;
+#endif
+
 #ifdef MODULE_CORE_MSG
     cb->wait_data = NULL;
     cb->msg_waiters.next = NULL;
@@ -41,7 +41,7 @@ static void _thread_flags_wait(thread_flags_t mask, thread_t *thread, unsigned t
     DEBUG("_thread_flags_wait: me->flags=0x%08x me->mask=0x%08x. going blocked.\n",
             (unsigned)thread->flags, (unsigned)mask);
 
-    thread->wait_data = (void *)(unsigned)mask;
+    thread->wait_data = (void *)(uintptr_t)mask;
     sched_set_status(thread, threadstate);
     irq_restore(irqstate);
     thread_yield_higher();
@@ -102,7 +102,7 @@ thread_flags_t thread_flags_wait_all(thread_flags_t mask)
 inline int __attribute__((always_inline)) thread_flags_wake(thread_t *thread)
 {
     unsigned wakeup = 0;
-    thread_flags_t mask = (uint16_t)(unsigned)thread->wait_data;
+    thread_flags_t mask = (uint16_t)(uintptr_t)thread->wait_data;
     switch(thread->status) {
         case STATUS_FLAG_BLOCKED_ANY:
             wakeup = (thread->flags & mask);
@@ -114,7 +114,7 @@ inline int __attribute__((always_inline)) thread_flags_wake(thread_t *thread)
 
     if (wakeup) {
         DEBUG("_thread_flags_wake(): wakeing up pid %"PRIkernel_pid"\n", thread->pid);
-        sched_set_status(thread, STATUS_RUNNING);
+        sched_set_status(thread, STATUS_PENDING);
     }
 
     return wakeup;
@@ -127,7 +127,9 @@ void thread_flags_set(thread_t *thread, thread_flags_t mask)
     thread->flags |= mask;
     if (thread_flags_wake(thread)) {
         irq_restore(state);
-        thread_yield_higher();
+        /* only requests the switch when called from an ISR, e.g. a timer
+         * callback, that must run to its end first */
+        sched_switch(thread->priority);
     }
     else {
         irq_restore(state);
@@ -8,6 +8,8 @@
 
 #include "net/af.h"
 #include "net/conn/udp.h"
+#include "net/gnrc/conn.h"
+#include "net/gnrc/pktbuf.h"
 
 #ifdef MICROCOAP_DEBUG
 #define ENABLE_DEBUG (1)
@@ -18,7 +20,7 @@
 
 #include "coap.h"
 
-static uint8_t _udp_buf[512];   /* udp read buffer (max udp payload size) */
+static uint8_t _udp_buf[512];   /* udp reply buffer (max udp payload size) */
 uint8_t scratch_raw[1024];      /* microcoap scratch buffer */
 
 coap_rw_buffer_t scratch_buf = { scratch_raw, sizeof(scratch_raw) };
@@ -28,7 +30,7 @@ coap_rw_buffer_t scratch_buf = { scratch_raw, sizeof(scratch_raw) };
 /*
  * Starts a blocking and never-returning loop dispatching CoAP requests.
  *
- * When using gnrc, make sure the calling thread has an initialized msg queue.
+ * Requests are parsed in place in the network stack's packet buffer.
  */
 void microcoap_server_loop(void)
 {
@@ -44,21 +46,24 @@ void microcoap_server_loop(void)
 
     while (1) {
         DEBUG("Waiting for incoming UDP packet...\n");
-        rc = conn_udp_recvfrom(&conn, (char *)_udp_buf, sizeof(_udp_buf), raddr, &raddr_len, &rport);
+        gnrc_pktsnip_t *req_pkt;
+        rc = gnrc_conn_udp_recv_buf(&conn, &req_pkt, raddr, &raddr_len, &rport);
         if (rc < 0) {
-            DEBUG("Error in conn_udp_recvfrom(). rc=%u\n", rc);
+            DEBUG("Error in gnrc_conn_udp_recv_buf(). rc=%u\n", rc);
             continue;
         }
 
+        const uint8_t *req = req_pkt->data;
+
         size_t n = rc;
 
         coap_packet_t pkt;
         DEBUG("Received packet: ");
-        coap_dump(_udp_buf, n, true);
+        coap_dump(req, n, true);
         DEBUG("\n");
 
         /* parse UDP packet to CoAP */
-        if (0 != (rc = coap_parse(&pkt, _udp_buf, n))) {
+        if (0 != (rc = coap_parse(&pkt, req, n))) {
             DEBUG("Bad packet rc=%d\n", rc);
         }
         else {
@@ -88,5 +93,7 @@ void microcoap_server_loop(void)
                 }
             }
         }
+        /* the request is referenced by pkt until the reply is sent */
+        gnrc_pktbuf_release(req_pkt);
     }
 }
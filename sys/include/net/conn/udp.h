@@ -49,6 +49,20 @@ struct conn_udp;
  */
 typedef struct conn_udp conn_udp_t;
 
+/**
+ * @brief   A datagram for conn_udp_recv_many() and conn_udp_send_many()
+ */
+typedef struct {
+    void *data;         /**< the payload */
+    size_t len;         /**< length of conn_udp_dgram_t::data. On receive: space
+                         *   available, set to the number of bytes received */
+    void *addr;         /**< the remote network layer address. On receive: NULL
+                         *   pointer or space for any address of the
+                         *   connection's family */
+    size_t addr_len;    /**< length of conn_udp_dgram_t::addr */
+    uint16_t port;      /**< the remote UDP port */
+} conn_udp_dgram_t;
+
 /**
  * @brief   Creates a new UDP connection object
  *
@@ -59,10 +73,6 @@ typedef struct conn_udp conn_udp_t;
  * @param[in] family    The family of @p addr (see @ref net_af).
  * @param[in] port      The local UDP port for @p conn.
  *
- * @todo    With @ref net_gnrc @ref conn_udp_recvfrom needs to be called from the
- *          same thread as for this function. This is undesired behavior and
- *          will be fixed in upcoming versions of RIOT.
- *
  * @return  0 on success.
  * @return  any other negative number in case of an error. For portability implementations should
  *          draw inspiration of the errno values from the POSIX' bind() function specification.
@@ -105,10 +115,6 @@ int conn_udp_getlocaladdr(conn_udp_t *conn, void *addr, uint16_t *port);
  *
  * @note    Function may block.
  *
- * @todo    With @ref net_gnrc this function needs to be called from the same
- *          thread as @ref conn_udp_create. This is undesired behavior and will
- *          be fixed in upcoming versions of RIOT.
- *
  * @return  The number of bytes received on success.
  * @return  0, if no received data is available, but everything is in order.
  * @return  any other negative number in case of an error. For portability, implementations should
@@ -142,6 +148,91 @@ int conn_udp_sendto(const void *data, size_t len, const void *src, size_t src_le
                     const void *dst, size_t dst_len, int family, uint16_t sport,
                     uint16_t dport);
 
+/**
+ * @brief   Sets the receiver of the UDP messages sent with conn_udp_send()
+ *
+ * @details The connection keeps the next hop to @p addr, so messages sent with
+ *          conn_udp_send() skip the route, neighbor and source address lookups
+ *          as long as none of them changes.
+ *
+ *          Like a connected POSIX datagram socket, the connection only
+ *          receives messages from @p addr and @p port afterwards. Messages
+ *          from other senders are dropped.
+ *
+ * @param[in] conn      A UDP connection object.
+ * @param[in] addr      The receiver's network address.
+ * @param[in] addr_len  Length of @p addr.
+ * @param[in] port      The receiver's UDP port.
+ *
+ * @note    Only available with @ref net_gnrc so far.
+ *
+ * @return  0 on success.
+ * @return  any other negative number in case of an error. For portability, implementations should
+ *          draw inspiration of the errno values from the POSIX' connect() function specification.
+ */
+int conn_udp_connect(conn_udp_t *conn, const void *addr, size_t addr_len, uint16_t port);
+
+/**
+ * @brief   Sends a UDP message to the receiver set with conn_udp_connect()
+ *
+ * @param[in] conn      A UDP connection object.
+ * @param[in] data      Pointer to the data to send.
+ * @param[in] len       Length of the @p data to send.
+ *
+ * @note    Function may block.
+ * @note    Only available with @ref net_gnrc so far.
+ *
+ * @return  The number of bytes sent on success.
+ * @return  -ENOTCONN, if no receiver was set with conn_udp_connect().
+ * @return  any other negative number in case of an error. For portability, implementations should
+ *          draw inspiration of the errno values from the POSIX' send() function specification.
+ */
+int conn_udp_send(conn_udp_t *conn, const void *data, size_t len);
+
+/**
+ * @brief   Receives up to @p numof UDP messages
+ *
+ * @details Blocks until at least one message is available, then takes the
+ *          messages already received by the stack without blocking again.
+ *          It stops at the first of these that does not fit into its entry
+ *          of @p dgrams and leaves it for the next call.
+ *
+ * @param[in] conn          A UDP connection object.
+ * @param[in,out] dgrams    The datagrams to fill.
+ * @param[in] numof         Number of entries in @p dgrams.
+ *
+ * @return  The number of datagrams received on success.
+ * @return  any other negative number in case of an error, if no datagram was received. For
+ *          portability, implementations should draw inspiration of the errno values from the
+ *          Linux' recvmmsg() function specification.
+ */
+int conn_udp_recv_many(conn_udp_t *conn, conn_udp_dgram_t *dgrams, unsigned numof);
+
+/**
+ * @brief   Sends up to @p numof UDP messages from the same source
+ *
+ * @details Where the stack supports it, the messages are passed to it at
+ *          once.
+ *
+ * @param[in] dgrams    The datagrams to send.
+ * @param[in] numof     Number of entries in @p dgrams.
+ * @param[in] src       The source address. May be NULL for any interface address.
+ * @param[in] src_len   Length of @p src. May be 0 if @p src is NULL
+ * @param[in] family    The family of @p src and of the destinations in @p dgrams
+ *                      (see @ref net_af).
+ * @param[in] sport     The source UDP port.
+ *
+ * @note    Function may block.
+ *
+ * @return  The number of datagrams sent on success. Datagrams the stack
+ *          dropped on the way are not counted.
+ * @return  any other negative number in case of an error, if no datagram was sent. For
+ *          portability, implementations should draw inspiration of the errno values from the
+ *          Linux' sendmmsg() function specification.
+ */
+int conn_udp_send_many(const conn_udp_dgram_t *dgrams, unsigned numof, const void *src,
+                       size_t src_len, int family, uint16_t sport);
+
 #ifdef __cplusplus
 }
 #endif
@@ -465,6 +465,19 @@ int fib_sr_get_route(fib_table_t *table, uint8_t *dst, size_t dst_size, kernel_p
  */
 int fib_get_num_used_entries(fib_table_t *table);
 
+/**
+ * @brief returns the generation of a FIB table
+ *
+ * The generation changes whenever a single hop entry is added, updated,
+ * removed or expires, so a caller can keep the result of a lookup as long as
+ * the generation stays the same.
+ *
+ * @param[in] table         the fib instance to check
+ *
+ * @return the current generation of the table
+ */
+uint32_t fib_get_gen(fib_table_t *table);
+
 /**
  * @brief Prints the kernel_pid_t for all registered RRPs
  */
@@ -35,10 +35,22 @@ extern "C" {
  */
 #define FIB_MAX_REGISTERED_RP (5)
 
+/**
+ * @brief Node of the prefix trie indexing the entries of a FIB table
+ */
+typedef struct fib_trie_node {
+    /** sub-tries for keys with a 0 and a 1 at bit fib_trie_node_t::bits */
+    struct fib_trie_node *child[2];
+    /** length of the key of this node in bits */
+    uint8_t bits;
+    /** 1 if the node only branches and holds no entry */
+    uint8_t glue;
+} fib_trie_node_t;
+
 /**
  * @brief Container descriptor for a FIB entry
  */
-typedef struct {
+typedef struct fib_entry {
     /** interface ID */
     kernel_pid_t iface_id;
     /** Lifetime of this entry (an absolute time-point is stored by the FIB) */
@@ -51,6 +63,16 @@ typedef struct {
     uint32_t next_hop_flags;
     /** Pointer to the shared generic address */
     universal_address_container_t *next_hop;
+    /** Node of this entry in the prefix trie of the table */
+    fib_trie_node_t trie;
+    /** Branching node this entry provides to the prefix trie of the table */
+    fib_trie_node_t trie_glue;
+    /** Next entry with the same key in the prefix trie */
+    struct fib_entry *trie_dup;
+    /** Position of this entry in the lifetime heap of the table */
+    uint16_t heap_pos;
+    /** Index of the entry at the heap position equal to this entry's index */
+    uint16_t heap_slot;
 } fib_entry_t;
 
 /**
@@ -117,7 +139,9 @@ typedef struct {
     *   This value indicates what is stored in `data` of this table
     */
     uint8_t table_type;
-    /** the maximim number of entries in this FIB table */
+    /** the maximim number of entries in this FIB table,
+    *   at most UINT16_MAX for single hop tables
+    */
     size_t size;
     /** table access mutex to grant exclusive operations on calls */
     mutex_t mtx_access;
@@ -133,6 +157,18 @@ typedef struct {
     *   e.g. when the unreachable destination is covered by the prefix
     */
     universal_address_container_t* prefix_rp[FIB_MAX_REGISTERED_RP];
+    /** root of the prefix trie indexing the single hop entries */
+    fib_trie_node_t *trie_root;
+    /** list of unused branching nodes for the prefix trie */
+    fib_trie_node_t *trie_free;
+    /** number of single hop entries with a finite lifetime, kept in a
+    *   min-heap to expire them without scanning the table
+    */
+    size_t heap_len;
+    /** incremented on every change of the single hop entries,
+    *   see fib_get_gen()
+    */
+    uint32_t gen;
 } fib_table_t;
 
 #ifdef __cplusplus
@@ -26,12 +26,38 @@
 #include <stdint.h>
 #include "net/ipv6/addr.h"
 #include "net/gnrc.h"
+#include "net/gnrc/ipv6/dst_cache.h"
+#ifdef MODULE_GNRC_TCP
+#include "net/gnrc/tcp.h"
+#endif
 #include "sched.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief   Number of received packets a connection can queue
+ *
+ * @details Packets arriving while the mailbox of a connection is full are
+ *          dropped and counted in gnrc_netapi_mbox_t::drops. Must be a power
+ *          of 2.
+ */
+#ifndef GNRC_CONN_MBOX_SIZE
+#define GNRC_CONN_MBOX_SIZE         (8)
+#endif
+
+/**
+ * @brief   Thread flag set on the receiving thread when a packet for one of
+ *          its connections arrives
+ *
+ * @details Threads using connections must not use this flag for other
+ *          purposes.
+ */
+#ifndef GNRC_CONN_FLAG_RCV
+#define GNRC_CONN_FLAG_RCV          (0x1 << 11)
+#endif
+
 /**
  * @brief   Connection base class
  * @internal
@@ -40,6 +66,8 @@ typedef struct {
     gnrc_nettype_t l3_type;                     /**< Network layer type of the connection */
     gnrc_nettype_t l4_type;                     /**< Transport layer type of the connection */
     gnrc_netreg_entry_t netreg_entry;           /**< @p net_ng_netreg entry for the connection */
+    gnrc_netapi_mbox_t mbox;                    /**< mailbox for received packets */
+    gnrc_pktsnip_t *mbox_queue[GNRC_CONN_MBOX_SIZE];    /**< packets queued in the mailbox */
 } conn_t;
 
 /**
@@ -52,6 +80,8 @@ struct conn_ip {
     gnrc_nettype_t l4_type;                     /**< Transport layer type of the connection.
                                                  *   Always GNRC_NETTYPE_UNDEF */
     gnrc_netreg_entry_t netreg_entry;           /**< @p net_ng_netreg entry for the connection */
+    gnrc_netapi_mbox_t mbox;                    /**< mailbox for received packets */
+    gnrc_pktsnip_t *mbox_queue[GNRC_CONN_MBOX_SIZE];    /**< packets queued in the mailbox */
     uint8_t local_addr[sizeof(ipv6_addr_t)];    /**< local IP address */
     size_t local_addr_len;                      /**< length of struct conn_ip::local_addr */
 };
@@ -67,25 +97,80 @@ struct conn_udp {
     gnrc_nettype_t l4_type;                     /**< Transport layer type of the connection.
                                                  *   Always GNRC_NETTYPE_UDP */
     gnrc_netreg_entry_t netreg_entry;           /**< @p net_ng_netreg entry for the connection */
+    gnrc_netapi_mbox_t mbox;                    /**< mailbox for received packets */
+    gnrc_pktsnip_t *mbox_queue[GNRC_CONN_MBOX_SIZE];    /**< packets queued in the mailbox */
     uint8_t local_addr[sizeof(ipv6_addr_t)];    /**< local IP address */
     size_t local_addr_len;                      /**< length of struct conn_ip::local_addr */
+    uint8_t remote_addr[sizeof(ipv6_addr_t)];   /**< IP address set by conn_udp_connect() */
+    size_t remote_addr_len;                     /**< length of struct conn_udp::remote_addr.
+                                                 *   0 if not connected */
+    uint16_t remote_port;                       /**< UDP port set by conn_udp_connect() */
+#ifdef MODULE_GNRC_IPV6
+    gnrc_ipv6_dst_cache_t dst_cache;            /**< next hop to struct conn_udp::remote_addr */
+#endif
+};
+
+#ifdef MODULE_GNRC_TCP
+/**
+ * @brief   TCP connection type
+ * @internal
+ * @extends conn_t
+ *
+ * @details The TCP thread puts received data and state changes into the
+ *          mailbox, struct conn_tcp::netreg_entry is not used.
+ */
+struct conn_tcp {
+    gnrc_nettype_t l3_type;                     /**< Network layer type of the connection.
+                                                 *   Always GNRC_NETTYPE_IPV6 */
+    gnrc_nettype_t l4_type;                     /**< Transport layer type of the connection.
+                                                 *   Always GNRC_NETTYPE_TCP */
+    gnrc_netreg_entry_t netreg_entry;           /**< @p net_ng_netreg entry for the connection */
+    gnrc_netapi_mbox_t mbox;                    /**< mailbox for received data */
+    gnrc_pktsnip_t *mbox_queue[GNRC_CONN_MBOX_SIZE];    /**< packets queued in the mailbox */
+    gnrc_tcp_tcb_t tcb;                         /**< transmission control block */
 };
+#endif
 
 /**
  * @brief  Bind connection to demux context
  *
  * @internal
  *
- * @param[out] entry    @ref net_ng_netreg entry.
+ * @details Received packets are put into the mailbox of @p conn, the calling
+ *          thread does not need a message queue.
+ *
+ * @param[out] conn     Connection object.
  * @param[in] type      @ref net_ng_nettype.
  * @param[in] demux_ctx demux context (port or proto) for the connection.
  */
-static inline void gnrc_conn_reg(gnrc_netreg_entry_t *entry, gnrc_nettype_t type,
-                                 uint32_t demux_ctx)
+static inline void gnrc_conn_reg(conn_t *conn, gnrc_nettype_t type, uint32_t demux_ctx)
 {
-    entry->pid = sched_active_pid;
-    entry->demux_ctx = demux_ctx;
-    gnrc_netreg_register(type, entry);
+    gnrc_netapi_mbox_init(&conn->mbox, conn->mbox_queue, GNRC_CONN_MBOX_SIZE,
+                          GNRC_CONN_FLAG_RCV);
+    conn->netreg_entry.pid = sched_active_pid;
+    conn->netreg_entry.demux_ctx = demux_ctx;
+    gnrc_netreg_register_mbox(type, &conn->netreg_entry, &conn->mbox);
+}
+
+/**
+ * @brief  Unbind connection from its demux context
+ *
+ * @internal
+ *
+ * @details Packets still queued in the mailbox of @p conn are released and
+ *          the mailbox is removed from its gnrc_netapi_mbox_set_t.
+ *
+ * @param[in,out] conn  Connection object.
+ * @param[in] type      @ref net_ng_nettype given to gnrc_conn_reg().
+ */
+static inline void gnrc_conn_unreg(conn_t *conn, gnrc_nettype_t type)
+{
+    if (conn->netreg_entry.pid != KERNEL_PID_UNDEF) {
+        gnrc_netreg_unregister(type, &conn->netreg_entry);
+        gnrc_netapi_mbox_set_remove(&conn->mbox);
+        gnrc_netapi_mbox_flush(&conn->mbox);
+        conn->netreg_entry.pid = KERNEL_PID_UNDEF;
+    }
 }
 
 /**
@@ -103,11 +188,12 @@ static inline void gnrc_conn_reg(gnrc_netreg_entry_t *entry, gnrc_nettype_t type
 bool gnrc_conn6_set_local_addr(uint8_t *conn_addr, const ipv6_addr_t *addr);
 
 /**
- * @brief   Generic recvfrom
+ * @brief   Copies a received packet of a connection and releases it
  *
  * @internal
  *
  * @param[in] conn      Connection object.
+ * @param[in] pkt       A packet taken from the mailbox of @p conn.
  * @param[out] data     Pointer where the received data should be stored.
  * @param[in] max_len   Maximum space available at @p data.
  * @param[out] addr     NULL pointer or the sender's IP address. Must fit address of connection's
@@ -116,14 +202,79 @@ bool gnrc_conn6_set_local_addr(uint8_t *conn_addr, const ipv6_addr_t *addr);
  * @param[out] port     NULL pointer or the sender's port.
  *
  * @return  The number of bytes received on success.
- * @return  0, if no received data is available, but everything is in order.
+ * @return  -EBADMSG, if @p pkt lacks the headers of @p conn.
  * @return  -ENOMEM, if received data was more than max_len.
- * @returne -ETIMEDOUT, if more than 3 IPC messages were not @ref net_ng_netapi receive commands
- *          with the required headers in the packet
+ */
+int gnrc_conn_recv_pkt(conn_t *conn, gnrc_pktsnip_t *pkt, void *data, size_t max_len,
+                       void *addr, size_t *addr_len, uint16_t *port);
+
+/**
+ * @brief   Generic recvfrom
+ *
+ * @internal
+ *
+ * @details Blocks until a packet is in the mailbox of @p conn. The calling
+ *          thread becomes the one woken up by new packets for @p conn.
+ *
+ * @param[in] conn      Connection object.
+ * @param[out] data     Pointer where the received data should be stored.
+ * @param[in] max_len   Maximum space available at @p data.
+ * @param[out] addr     NULL pointer or the sender's IP address. Must fit address of connection's
+ *                      family if not NULL.
+ * @param[out] addr_len Length of @p addr. May be NULL if @p addr is NULL.
+ * @param[out] port     NULL pointer or the sender's port.
+ *
+ * @return  The number of bytes received on success.
+ * @return  -ENOMEM, if received data was more than max_len. The packet is
+ *          dropped.
  */
 int gnrc_conn_recvfrom(conn_t *conn, void *data, size_t max_len, void *addr, size_t *addr_len,
                        uint16_t *port);
 
+/**
+ * @brief   Generic receive without copying
+ *
+ * @internal
+ *
+ * @details Blocks until a packet is in the mailbox of @p conn. The calling
+ *          thread becomes the one woken up by new packets for @p conn.
+ *
+ * @param[in] conn      Connection object.
+ * @param[out] addr     NULL pointer or the sender's IP address. Must fit address of connection's
+ *                      family if not NULL.
+ * @param[out] addr_len Length of @p addr. May be NULL if @p addr is NULL.
+ * @param[out] port     NULL pointer or the sender's port.
+ *
+ * @return  The received packet, starting with the payload. Must be released
+ *          with gnrc_pktbuf_release().
+ */
+gnrc_pktsnip_t *gnrc_conn_recv_buf(conn_t *conn, void *addr, size_t *addr_len, uint16_t *port);
+
+/**
+ * @brief   Receives a UDP message without copying it
+ *
+ * @details The payload stays in the packet buffer and can be parsed in place.
+ *          It must be released with gnrc_pktbuf_release() as soon as
+ *          possible, since it occupies the packet buffer until then. Since
+ *          the payload is not copied, a datagram never has to be dropped or
+ *          truncated for lack of space in a user buffer.
+ *
+ * @param[in] conn      A UDP connection object.
+ * @param[out] pkt      The received packet, starting with the payload.
+ *                      Read-only.
+ * @param[out] addr     NULL pointer or the sender's IP address. Must fit address of connection's
+ *                      family if not NULL.
+ * @param[out] addr_len Length of @p addr. May be NULL if @p addr is NULL.
+ * @param[out] port     NULL pointer or the sender's UDP port.
+ *
+ * @note    Function may block.
+ *
+ * @return  The size of the payload on success.
+ * @return  -EBADF, if @p conn was not created.
+ */
+int gnrc_conn_udp_recv_buf(struct conn_udp *conn, gnrc_pktsnip_t **pkt, void *addr,
+                           size_t *addr_len, uint16_t *port);
+
 #ifdef __cplusplus
 }
 #endif
@@ -38,6 +38,7 @@
 #include "net/gnrc/ipv6/hdr.h"
 #include "net/gnrc/ipv6/nc.h"
 #include "net/gnrc/ipv6/netif.h"
+#include "net/gnrc/ipv6/dst_cache.h"
 
 #ifdef MODULE_FIB
 #include "net/fib.h"
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License v2.1. See the file LICENSE in the top level directory for
+ * more details.
+ */
+
+/**
+ * @defgroup    net_gnrc_ipv6_dst_cache  IPv6 destination cache
+ * @ingroup     net_gnrc_ipv6
+ * @brief       Keeps the next hop of a connection to skip the lookups of the
+ *              IPv6 thread on every send.
+ *
+ * A destination cache entry holds the source address, the interface and the
+ * link-layer address of the next hop that the IPv6 thread chose for one
+ * destination. It is owned by the user, e.g. a connected UDP connection, and
+ * stays valid as long as the forwarding table, the neighbor cache and the
+ * address sets of the interfaces do not change.
+ * @{
+ *
+ * @file
+ * @brief       IPv6 destination cache definitions.
+ */
+
+#ifndef GNRC_IPV6_DST_CACHE_H_
+#define GNRC_IPV6_DST_CACHE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "kernel_types.h"
+#include "net/ipv6/addr.h"
+#include "net/gnrc/pkt.h"
+#include "net/gnrc/ipv6/nc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Message type to fill a destination cache entry in the IPv6 thread
+ */
+#define GNRC_IPV6_MSG_DST_CACHE_FILL    (0x0230)
+
+/**
+ * @brief   Destination cache entry
+ */
+typedef struct {
+    ipv6_addr_t dst;                            /**< destination of the entry */
+    ipv6_addr_t src;                            /**< source address for
+                                                 *   gnrc_ipv6_dst_cache_t::dst */
+    kernel_pid_t iface;                         /**< interface to the next hop.
+                                                 *   KERNEL_PID_UNDEF if the entry
+                                                 *   is unused */
+    uint8_t l2addr[GNRC_IPV6_NC_L2_ADDR_MAX];   /**< link-layer address of the next hop */
+    uint8_t l2addr_len;                         /**< length of
+                                                 *   gnrc_ipv6_dst_cache_t::l2addr */
+    uint32_t nc_gen;                            /**< neighbor cache generation */
+    uint32_t netif_gen;                         /**< address set generation */
+#ifdef MODULE_FIB
+    uint32_t fib_gen;                           /**< forwarding table generation */
+#endif
+} gnrc_ipv6_dst_cache_t;
+
+/**
+ * @brief   Marks a destination cache entry as unused.
+ *
+ * @param[out] cache    A destination cache entry.
+ */
+static inline void gnrc_ipv6_dst_cache_init(gnrc_ipv6_dst_cache_t *cache)
+{
+    cache->iface = KERNEL_PID_UNDEF;
+}
+
+/**
+ * @brief   Checks if a destination cache entry can be used for @p dst.
+ *
+ * @param[in] cache     A destination cache entry.
+ * @param[in] dst       The destination of the packet to send.
+ *
+ * @return  true, if @p cache was filled for @p dst and nothing it was derived
+ *          from changed since.
+ * @return  false otherwise.
+ */
+bool gnrc_ipv6_dst_cache_valid(const gnrc_ipv6_dst_cache_t *cache, const ipv6_addr_t *dst);
+
+/**
+ * @brief   Fills a destination cache entry for @p dst.
+ *
+ * @details The IPv6 thread determines the next hop as for a packet to @p dst,
+ *          but without sending a packet. Multicast and local destinations
+ *          are not cached. If the neighbor is not resolved yet, the entry
+ *          stays unused until a packet sent the usual way resolved it.
+ *
+ * @param[out] cache    A destination cache entry.
+ * @param[in] dst       The destination to fill @p cache for.
+ *
+ * @return  0, on success.
+ * @return  -ENOTSUP, if @p dst is a multicast or a local address.
+ * @return  -EHOSTUNREACH, if the next hop is not resolved (yet).
+ * @return  -EADDRNOTAVAIL, if there is no source address for @p dst.
+ */
+int gnrc_ipv6_dst_cache_fill(gnrc_ipv6_dst_cache_t *cache, const ipv6_addr_t *dst);
+
+/**
+ * @brief   Builds the IPv6 and interface header of a packet to the
+ *          destination of a valid destination cache entry.
+ *
+ * @details The IPv6 thread sends the packet to the cached next hop without
+ *          any lookup.
+ *
+ * @pre The last gnrc_ipv6_dst_cache_fill() for @p cache succeeded.
+ *
+ * @param[in] cache     A filled destination cache entry.
+ * @param[in] payload   Payload of the IPv6 packet.
+ * @param[in] src       Source address of the packet. The one of @p cache is
+ *                      used if NULL or unspecified.
+ *
+ * @return  The interface header in front of the IPv6 header and @p payload.
+ * @return  NULL, if the packet buffer is full.
+ */
+gnrc_pktsnip_t *gnrc_ipv6_dst_cache_hdr_build(const gnrc_ipv6_dst_cache_t *cache,
+                                              gnrc_pktsnip_t *payload,
+                                              const ipv6_addr_t *src);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GNRC_IPV6_DST_CACHE_H_ */
+/** @} */
@@ -44,6 +44,16 @@ extern "C" {
 #define GNRC_IPV6_NC_SIZE           (GNRC_NETIF_NUMOF * 8)
 #endif
 
+#ifndef GNRC_IPV6_NC_HASH_SIZE
+/**
+ * @brief   Number of hash buckets used to index the neighbor cache
+ *
+ * @note    Must be a power of two. About half of @ref GNRC_IPV6_NC_SIZE
+ *          keeps the hash chains short.
+ */
+#define GNRC_IPV6_NC_HASH_SIZE      (8U)
+#endif
+
 #ifndef GNRC_IPV6_NC_L2_ADDR_MAX
 /**
  * @brief   The maximum size of a link layer address
@@ -168,6 +178,16 @@ typedef struct {
      */
 } gnrc_ipv6_nc_t;
 
+/**
+ * @brief   Neighbor cache statistics
+ */
+typedef struct {
+    uint32_t lookups;       /**< number of calls to gnrc_ipv6_nc_get() */
+    uint32_t hits;          /**< number of lookups that found an entry */
+    uint32_t evictions;     /**< number of entries replaced to make room */
+    uint32_t add_fails;     /**< number of additions failed due to a full cache */
+} gnrc_ipv6_nc_stats_t;
+
 /**
  * @brief   Initializes neighbor cache
  */
@@ -176,6 +196,13 @@ void gnrc_ipv6_nc_init(void);
 /**
  * @brief   Adds a neighbor to the neighbor cache
  *
+ * @details If the neighbor cache is full, the least recently used entry
+ *          managed by NDP is replaced, preferring entries that are marked
+ *          for garbage collection or unreachable over stale entries over
+ *          all others. Unmanaged, registered, tentative, and router entries
+ *          as well as entries still performing address resolution are never
+ *          replaced.
+ *
  * @param[in] iface         PID to the interface where the neighbor is.
  * @param[in] ipv6_addr     IPv6 address of the neighbor. Must not be NULL.
  * @param[in] l2_addr       Link layer address of the neighbor. NULL if unknown.
@@ -230,6 +257,31 @@ gnrc_ipv6_nc_t *gnrc_ipv6_nc_get_next(gnrc_ipv6_nc_t *prev);
  */
 gnrc_ipv6_nc_t *gnrc_ipv6_nc_get_next_router(gnrc_ipv6_nc_t *prev);
 
+/**
+ * @brief   Gets the statistics of the neighbor cache.
+ *
+ * @param[out] stats    Is filled with the current statistics. Must not be NULL.
+ */
+void gnrc_ipv6_nc_get_stats(gnrc_ipv6_nc_stats_t *stats);
+
+/**
+ * @brief   Gets the generation of the neighbor cache.
+ *
+ * @details The generation changes whenever an entry is added or removed or
+ *          the state, link-layer address or router flag of an entry changes.
+ *
+ * @return  The current generation of the neighbor cache.
+ */
+uint32_t gnrc_ipv6_nc_get_gen(void);
+
+/**
+ * @brief   Changes the generation of the neighbor cache.
+ *
+ * @details Must be called after changing an entry in place, i.e. without
+ *          the functions of this module or gnrc_ndp_internal_set_state().
+ */
+void gnrc_ipv6_nc_update_gen(void);
+
 /**
  * @brief   Returns the state of a neighbor cache entry.
  *
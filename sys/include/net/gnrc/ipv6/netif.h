@@ -591,6 +591,16 @@ static inline bool gnrc_ipv6_netif_addr_is_non_unicast(const ipv6_addr_t *addr)
  */
 void gnrc_ipv6_netif_init_by_dev(void);
 
+/**
+ * @brief   Gets the generation of the interfaces' address sets.
+ *
+ * @details The generation changes whenever an address is added to or removed
+ *          from any interface.
+ *
+ * @return  The current generation of the address sets.
+ */
+uint32_t gnrc_ipv6_netif_get_gen(void);
+
 /**
  * @brief   Get sent and received statistics about IPv6 traffic on this interface.
  *
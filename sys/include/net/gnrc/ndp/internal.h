@@ -32,6 +32,18 @@
 extern "C" {
 #endif
 
+/**
+ * @brief   Slack of retransmission timers as right shift of their delay.
+ *
+ * The retransmission timers may fire this fraction of their delay late (1/16
+ * by default), so they can share a wake-up with other timers.
+ *
+ * @see xtimer_set_msg_slack()
+ */
+#ifndef GNRC_NDP_INTERNAL_SLACK_SHIFT
+#define GNRC_NDP_INTERNAL_SLACK_SHIFT   (4U)
+#endif
+
 /**
  * @brief   Get best match from default router list.
  *
@@ -204,7 +216,9 @@ static inline void gnrc_ndp_internal_reset_nbr_sol_timer(gnrc_ipv6_nc_t *nc_entr
 {
     xtimer_remove(&nc_entry->nbr_sol_timer);
     nc_entry->nbr_sol_msg.type = type;
-    xtimer_set_msg(&nc_entry->nbr_sol_timer, delay, &nc_entry->nbr_sol_msg, pid);
+    xtimer_set_msg_slack(&nc_entry->nbr_sol_timer, delay,
+                         delay >> GNRC_NDP_INTERNAL_SLACK_SHIFT,
+                         &nc_entry->nbr_sol_msg, pid);
 }
 
 #ifdef __cplusplus
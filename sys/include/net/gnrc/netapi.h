@@ -28,7 +28,12 @@
 #ifndef GNRC_NETAPI_H_
 #define GNRC_NETAPI_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cib.h"
 #include "thread.h"
+#include "thread_flags.h"
 #include "net/netopt.h"
 #include "net/gnrc/nettype.h"
 #include "net/gnrc/pkt.h"
@@ -62,6 +67,29 @@ extern "C" {
  */
 #define GNRC_NETAPI_MSG_TYPE_ACK        (0x0205)
 
+/**
+ * @brief   @ref core_msg type for passing a batch of @ref net_gnrc_pkt up the
+ *          network stack
+ *
+ * @see gnrc_netapi_batch_handle()
+ */
+#define GNRC_NETAPI_MSG_TYPE_RCV_BATCH  (0x0206)
+
+/**
+ * @brief   @ref core_msg type for passing a batch of @ref net_gnrc_pkt down the
+ *          network stack
+ *
+ * @see gnrc_netapi_batch_handle()
+ */
+#define GNRC_NETAPI_MSG_TYPE_SND_BATCH  (0x0207)
+
+/**
+ * @brief   Maximum number of packets passed in one batch message
+ */
+#ifndef GNRC_NETAPI_BATCH_SIZE
+#define GNRC_NETAPI_BATCH_SIZE          (8)
+#endif
+
 /**
  * @brief   Data structure to be send for setting (@ref GNRC_NETAPI_MSG_TYPE_SET)
  *          and getting (@ref GNRC_NETAPI_MSG_TYPE_GET) options
@@ -73,6 +101,94 @@ typedef struct {
     uint16_t data_len;          /**< size of the data / the buffer */
 } gnrc_netapi_opt_t;
 
+/**
+ * @brief   Collects packets a thread passes on to another thread while it
+ *          handles one wake-up (see gnrc_netapi_batch_begin())
+ */
+typedef struct {
+    gnrc_pktsnip_t *pkts[GNRC_NETAPI_BATCH_SIZE];   /**< collected packets */
+    kernel_pid_t pid;   /**< PID of the thread the packets are for */
+    uint16_t type;      /**< @ref GNRC_NETAPI_MSG_TYPE_RCV or
+                         *   @ref GNRC_NETAPI_MSG_TYPE_SND */
+    uint8_t numof;      /**< number of collected packets */
+    unsigned dropped;   /**< number of collected packets that could not be
+                         *   passed on since collecting started */
+} gnrc_netapi_batch_t;
+
+/**
+ * @brief   Bounded queue of received packets for one @ref net_gnrc_netreg
+ *          entry (see gnrc_netreg_register_mbox())
+ *
+ * @details Packets dispatched to an entry with a mailbox are put into the
+ *          mailbox instead of the message queue of a thread. Putting a packet
+ *          sets gnrc_netapi_mbox_t::flag on gnrc_netapi_mbox_t::reader, so
+ *          one thread can wait for any number of mailboxes at once.
+ *          Packets are dropped when the mailbox is full. To wait for several
+ *          mailboxes efficiently, put them into a gnrc_netapi_mbox_set_t.
+ *
+ *          All members but gnrc_netapi_mbox_t::drops must never be changed
+ *          by the user.
+ */
+typedef struct gnrc_netapi_mbox {
+    gnrc_pktsnip_t **queue;             /**< ring of queued packets */
+    cib_t cib;                          /**< index of gnrc_netapi_mbox_t::queue */
+    volatile kernel_pid_t reader;       /**< thread woken up by new packets */
+    thread_flags_t flag;                /**< flag set on gnrc_netapi_mbox_t::reader */
+    volatile unsigned drops;            /**< number of packets dropped because
+                                         *   the mailbox was full */
+    struct gnrc_netapi_mbox_set *set;   /**< set the mailbox was added to */
+    struct gnrc_netapi_mbox *ready_next;    /**< next mailbox in
+                                             *   gnrc_netapi_mbox_set_t::ready */
+    void *ctx;                          /**< context given to
+                                         *   gnrc_netapi_mbox_set_add() */
+    uint8_t in_ready;                   /**< mailbox is in
+                                         *   gnrc_netapi_mbox_set_t::ready */
+    uint8_t notified;                   /**< gnrc_netapi_mbox_notify() was
+                                         *   called since the last wait */
+} gnrc_netapi_mbox_t;
+
+/**
+ * @brief   Set of packet mailboxes a thread waits for
+ *
+ * @details Similar to Linux' epoll: mailboxes are added once, a packet put
+ *          into a member appends it to gnrc_netapi_mbox_set_t::ready and
+ *          wakes up the gnrc_netapi_mbox_set_t::owner, so
+ *          gnrc_netapi_mbox_set_wait() only looks at mailboxes that have
+ *          packets.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~ {.c}
+ * gnrc_netapi_mbox_set_init(&set, GNRC_CONN_FLAG_RCV);
+ * gnrc_netapi_mbox_set_add(&set, &coap_conn.mbox, &coap_conn);
+ * gnrc_netapi_mbox_set_add(&set, &dns_conn.mbox, &dns_conn);
+ * while (1) {
+ *     gnrc_netapi_mbox_t *ready[2];
+ *     int n = gnrc_netapi_mbox_set_wait(&set, ready, 2,
+ *                                       GNRC_NETAPI_MBOX_WAIT_FOREVER);
+ *     for (int i = 0; i < n; i++) {
+ *         conn_udp_t *conn = ready[i]->ctx;
+ *         res = conn_udp_recvfrom(conn, buf, sizeof(buf), &addr, &addr_len,
+ *                                 &port);
+ *         ...
+ *     }
+ * }
+ * ~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ *          All members must never be changed by the user.
+ */
+typedef struct gnrc_netapi_mbox_set {
+    gnrc_netapi_mbox_t *ready;          /**< members with packets */
+    gnrc_netapi_mbox_t *ready_tail;     /**< last mailbox in
+                                         *   gnrc_netapi_mbox_set_t::ready */
+    volatile kernel_pid_t owner;        /**< thread waiting for the set */
+    thread_flags_t flag;                /**< flag set on
+                                         *   gnrc_netapi_mbox_set_t::owner */
+} gnrc_netapi_mbox_set_t;
+
+/**
+ * @brief   Timeout of gnrc_netapi_mbox_set_wait() to wait without timeout
+ */
+#define GNRC_NETAPI_MBOX_WAIT_FOREVER   (UINT32_MAX)
+
 /**
  * @brief   Shortcut function for sending @ref GNRC_NETAPI_MSG_TYPE_SND messages
  *
@@ -176,6 +292,248 @@ int gnrc_netapi_get(kernel_pid_t pid, netopt_t opt, uint16_t context,
 int gnrc_netapi_set(kernel_pid_t pid, netopt_t opt, uint16_t context,
                     void *data, size_t data_len);
 
+/**
+ * @brief   Starts collecting the packets the calling thread sends with
+ *          @ref net_gnrc_netapi into @p batch.
+ *
+ * @details Until gnrc_netapi_batch_end() is called, packets for threads that
+ *          use batches themselves are not sent right away but collected and
+ *          passed in a single @ref GNRC_NETAPI_MSG_TYPE_RCV_BATCH or
+ *          @ref GNRC_NETAPI_MSG_TYPE_SND_BATCH message. A batch is passed on
+ *          early when it is full or packets for another thread or in another
+ *          direction arrive. Threads that call this function must handle
+ *          batch messages with gnrc_netapi_batch_handle(). The calling
+ *          thread is passed batches until it exits or
+ *          gnrc_netapi_batch_disable() is called for it, which
+ *          gnrc_netreg_unregister() does when the thread's last
+ *          registration is removed.
+ *
+ *          Without the `gnrc_netapi_batch` module this function does nothing
+ *          and every packet is passed on in its own message.
+ *
+ * @param[in] batch     Storage for the batch. Must stay valid until
+ *                      gnrc_netapi_batch_end() is called.
+ */
+void gnrc_netapi_batch_begin(gnrc_netapi_batch_t *batch);
+
+/**
+ * @brief   Like gnrc_netapi_batch_begin(), but for threads that do not handle
+ *          batch messages themselves.
+ *
+ * @details Used by applications that send many packets at once, e.g.
+ *          conn_udp_send_many(). Packets for other threads are still batched.
+ *
+ * @param[in] batch     Storage for the batch. Must stay valid until
+ *                      gnrc_netapi_batch_end() is called.
+ */
+void gnrc_netapi_batch_collect(gnrc_netapi_batch_t *batch);
+
+/**
+ * @brief   Passes on the packets collected since gnrc_netapi_batch_begin()
+ *          or gnrc_netapi_batch_collect() and stops collecting.
+ *
+ * @return  Number of collected packets that could not be delivered and were
+ *          released, including the ones of batches passed on early.
+ */
+int gnrc_netapi_batch_end(void);
+
+/**
+ * @brief   Checks if packets the calling thread sends to a thread are
+ *          collected into a batch instead of being sent right away.
+ *
+ * @details A thread that sends many packets to @p pid in one go can only rely
+ *          on them not overflowing the message queue of @p pid if they are
+ *          collected. Always false without the `gnrc_netapi_batch` module.
+ *
+ * @param[in] pid   PID of the receiving thread.
+ *
+ * @return  true, if packets for @p pid are collected.
+ * @return  false, if they are passed on one by one.
+ */
+bool gnrc_netapi_batch_collects(kernel_pid_t pid);
+
+/**
+ * @brief   Stops passing batch messages to a thread
+ *
+ * @details Must be called before a thread that called
+ *          gnrc_netapi_batch_begin() exits, so a thread that is created
+ *          with the same stack and gets the same PID is passed single
+ *          messages again. Nothing happens for threads that do not handle
+ *          batches.
+ *
+ * @param[in] pid   PID of the thread.
+ */
+void gnrc_netapi_batch_disable(kernel_pid_t pid);
+
+/**
+ * @brief   Handles a @ref GNRC_NETAPI_MSG_TYPE_RCV_BATCH or
+ *          @ref GNRC_NETAPI_MSG_TYPE_SND_BATCH message.
+ *
+ * @details Calls @p cb for every packet in the batch in order and releases
+ *          the batch container afterwards. @p cb takes ownership of the
+ *          packet, just as if it was received in a
+ *          @ref GNRC_NETAPI_MSG_TYPE_RCV or @ref GNRC_NETAPI_MSG_TYPE_SND
+ *          message.
+ *
+ * @param[in] msg   The batch message.
+ * @param[in] cb    Handler for the single packets.
+ * @param[in] arg   Argument passed to @p cb.
+ */
+void gnrc_netapi_batch_handle(msg_t *msg,
+                              void (*cb)(gnrc_pktsnip_t *pkt, void *arg),
+                              void *arg);
+
+/**
+ * @brief   Initializes a packet mailbox
+ *
+ * @details The calling thread becomes the gnrc_netapi_mbox_t::reader.
+ *
+ * @param[out] mbox     The mailbox. Must not be NULL.
+ * @param[in] queue     Storage for @p size packet pointers.
+ * @param[in] size      Maximum number of queued packets. Must be a power
+ *                      of two.
+ * @param[in] flag      Thread flag set on the reader when a packet was put.
+ *                      Must not be a reserved flag.
+ */
+void gnrc_netapi_mbox_init(gnrc_netapi_mbox_t *mbox, gnrc_pktsnip_t **queue,
+                           unsigned size, thread_flags_t flag);
+
+/**
+ * @brief   Puts a packet into a mailbox and wakes up its reader
+ *
+ * @note    Can be used in interrupt context.
+ *
+ * @param[in] mbox  The mailbox. Must not be NULL.
+ * @param[in] pkt   The packet. The mailbox takes ownership on success.
+ *
+ * @return  1, if @p pkt was queued.
+ * @return  -1, if the mailbox was full. gnrc_netapi_mbox_t::drops is
+ *          increased, @p pkt stays with the caller.
+ */
+int gnrc_netapi_mbox_put(gnrc_netapi_mbox_t *mbox, gnrc_pktsnip_t *pkt);
+
+/**
+ * @brief   Takes the oldest packet out of a mailbox, non-blocking
+ *
+ * @param[in] mbox  The mailbox. Must not be NULL.
+ *
+ * @return  The packet, the caller takes ownership.
+ * @return  NULL, if the mailbox is empty.
+ */
+gnrc_pktsnip_t *gnrc_netapi_mbox_try_get(gnrc_netapi_mbox_t *mbox);
+
+/**
+ * @brief   Returns the oldest packet of a mailbox without taking it out
+ *
+ * @details Must only be called by the gnrc_netapi_mbox_t::reader, so the
+ *          packet stays in the mailbox until the reader takes it.
+ *
+ * @param[in] mbox  The mailbox. Must not be NULL.
+ *
+ * @return  The packet, the mailbox keeps ownership.
+ * @return  NULL, if the mailbox is empty.
+ */
+gnrc_pktsnip_t *gnrc_netapi_mbox_peek(gnrc_netapi_mbox_t *mbox);
+
+/**
+ * @brief   Takes the oldest packet out of a mailbox, blocking
+ *
+ * @details The calling thread becomes the gnrc_netapi_mbox_t::reader and
+ *          waits for gnrc_netapi_mbox_t::flag until a packet is available.
+ *
+ * @param[in] mbox  The mailbox. Must not be NULL.
+ *
+ * @return  The packet, the caller takes ownership.
+ */
+gnrc_pktsnip_t *gnrc_netapi_mbox_get(gnrc_netapi_mbox_t *mbox);
+
+/**
+ * @brief   Wakes up the reader of a mailbox and the owner of its set without
+ *          putting a packet
+ *
+ * @details Used to signal events of the owner of the mailbox, e.g. a state
+ *          change of a connection. A set reports the mailbox ready once per
+ *          notification.
+ *
+ * @note    Can be used in interrupt context.
+ *
+ * @param[in] mbox  The mailbox. Must not be NULL.
+ */
+void gnrc_netapi_mbox_notify(gnrc_netapi_mbox_t *mbox);
+
+/**
+ * @brief   Gets the number of packets in a mailbox
+ *
+ * @param[in] mbox  The mailbox. Must not be NULL.
+ *
+ * @return  Number of queued packets.
+ */
+static inline unsigned gnrc_netapi_mbox_avail(gnrc_netapi_mbox_t *mbox)
+{
+    return cib_avail(&mbox->cib);
+}
+
+/**
+ * @brief   Releases all packets queued in a mailbox
+ *
+ * @param[in] mbox  The mailbox. Must not be NULL.
+ */
+void gnrc_netapi_mbox_flush(gnrc_netapi_mbox_t *mbox);
+
+/**
+ * @brief   Initializes a mailbox set
+ *
+ * @details The calling thread becomes the gnrc_netapi_mbox_set_t::owner.
+ *
+ * @param[out] set      The set. Must not be NULL.
+ * @param[in] flag      Thread flag set on the owner when a packet was put into
+ *                      a member. Must not be a reserved flag.
+ */
+void gnrc_netapi_mbox_set_init(gnrc_netapi_mbox_set_t *set, thread_flags_t flag);
+
+/**
+ * @brief   Adds a mailbox to a set
+ *
+ * @pre A mailbox is a member of at most one set at a time.
+ *
+ * @param[in] set       The set. Must not be NULL.
+ * @param[in] mbox      The mailbox. Must not be NULL.
+ * @param[in] ctx       Context stored in gnrc_netapi_mbox_t::ctx, e.g. the
+ *                      connection the mailbox belongs to.
+ */
+void gnrc_netapi_mbox_set_add(gnrc_netapi_mbox_set_t *set,
+                              gnrc_netapi_mbox_t *mbox, void *ctx);
+
+/**
+ * @brief   Removes a mailbox from its set
+ *
+ * @param[in] mbox      The mailbox. Must not be NULL. Nothing happens if it
+ *                      is not in a set.
+ */
+void gnrc_netapi_mbox_set_remove(gnrc_netapi_mbox_t *mbox);
+
+/**
+ * @brief   Waits until members of a set have packets
+ *
+ * @details The calling thread becomes the gnrc_netapi_mbox_set_t::owner.
+ *          A mailbox is reported as long as it has packets (level
+ *          triggered). If more than @p max mailboxes have packets, the ones
+ *          reported are reported last in the next call, so no mailbox
+ *          starves.
+ *
+ * @param[in] set       The set. Must not be NULL.
+ * @param[out] ready    Mailboxes that have packets.
+ * @param[in] max       Maximum number of mailboxes written to @p ready.
+ * @param[in] timeout   Maximum time to wait in microseconds, 0 to not block,
+ *                      @ref GNRC_NETAPI_MBOX_WAIT_FOREVER to wait without
+ *                      timeout.
+ *
+ * @return  Number of mailboxes written to @p ready, 0 on timeout.
+ */
+int gnrc_netapi_mbox_set_wait(gnrc_netapi_mbox_set_t *set,
+                              gnrc_netapi_mbox_t **ready, unsigned max,
+                              uint32_t timeout);
+
 #ifdef __cplusplus
 }
 #endif
@@ -94,6 +94,54 @@ typedef struct gnrc_netdev2 {
 kernel_pid_t gnrc_netdev2_init(char *stack, int stacksize, char priority,
                                const char *name, gnrc_netdev2_t *gnrc_netdev2);
 
+/**
+ * @brief   Reads a received frame from a device directly into the packet
+ *          buffer
+ *
+ * The frame is read @p headroom bytes behind the start of the returned snip,
+ * with @p headroom chosen so that a link-layer header of @p hdr_len bytes can
+ * be split off with `gnrc_pktbuf_mark(pkt, *headroom + hdr_len, type)`
+ * without moving the payload (see gnrc_pktbuf_mark_headroom()). If the header
+ * turns out to be of another length, marking still works but might copy.
+ *
+ * @param[in] dev       The device to read from.
+ * @param[in] hdr_len   Expected length of the link-layer header.
+ * @param[out] info     Status information for the frame, passed to
+ *                      netdev2_driver_t::recv(). May be NULL.
+ * @param[out] headroom Number of bytes in front of the frame.
+ *
+ * @return  Snip of type @ref GNRC_NETTYPE_UNDEF holding headroom and frame.
+ * @return  NULL, if no frame was received or no space was left in the packet
+ *          buffer. The frame is dropped in the latter case.
+ */
+gnrc_pktsnip_t *gnrc_netdev2_recv_pkt(netdev2_t *dev, size_t hdr_len,
+                                      void *info, size_t *headroom);
+
+/**
+ * @brief   Builds the I/O vector to hand a packet with a link-layer header
+ *          to netdev2_driver_t::send()
+ *
+ * If the payload of @p pkt has enough headroom left (see
+ * gnrc_pktbuf_add_headroom()), the header is written right in front of it so
+ * the header and all contiguous payload snips end up in one vector element.
+ * Otherwise the header gets an element of its own, pointing to @p hdr.
+ *
+ * @param[in] pkt       Packet to send, starting with the
+ *                      @ref GNRC_NETTYPE_NETIF header.
+ * @param[in] hdr       The link-layer header. Must stay valid until the
+ *                      packet was sent.
+ * @param[in] hdr_len   Length of @p hdr.
+ * @param[out] vector   The I/O vector to send.
+ * @param[out] n        Number of elements in @p vector.
+ *
+ * @return  The packet, to be released after sending instead of @p pkt.
+ * @return  NULL, if no space was left in the packet buffer. @p pkt is not
+ *          released in that case.
+ */
+gnrc_pktsnip_t *gnrc_netdev2_get_iovec(gnrc_pktsnip_t *pkt, void *hdr,
+                                       size_t hdr_len, struct iovec **vector,
+                                       size_t *n);
+
 #ifdef __cplusplus
 }
 #endif
@@ -27,7 +27,9 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "kernel_types.h"
+#include "net/netopt.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -102,6 +104,43 @@ size_t gnrc_netif_get(kernel_pid_t *netifs);
  */
 bool gnrc_netif_exist(kernel_pid_t pid);
 
+/**
+ * @brief   Gets the generation of the interfaces' link-layer addresses.
+ *
+ * @details The generation changes whenever the link-layer address or the
+ *          source address length of any interface is set.
+ *
+ * @return  The current generation of the link-layer addresses.
+ */
+uint32_t gnrc_netif_get_l2addr_gen(void);
+
+/**
+ * @brief   Changes the generation of the interfaces' link-layer addresses.
+ *
+ * @details Must be called if an interface changes its link-layer address
+ *          by itself. Addresses set through @ref net_gnrc_netapi are covered
+ *          by gnrc_netif_opt_applied().
+ */
+void gnrc_netif_update_l2addr_gen(void);
+
+/**
+ * @brief   Notes that an interface applied an option set through
+ *          @ref net_gnrc_netapi
+ *
+ * @details Interface threads call this once the device accepted the option.
+ *          Changes the generation of the link-layer addresses if @p opt
+ *          sets the link-layer address or the source address length.
+ *
+ * @param[in] opt   The option that was set.
+ */
+static inline void gnrc_netif_opt_applied(netopt_t opt)
+{
+    if ((opt == NETOPT_ADDRESS) || (opt == NETOPT_ADDRESS_LONG) ||
+        (opt == NETOPT_SRC_LEN)) {
+        gnrc_netif_update_l2addr_gen();
+    }
+}
+
 /**
  * @brief   Converts a hardware address to a human readable string.
  *
@@ -65,6 +65,17 @@ extern "C" {
  *          this flag the same way it does @ref GNRC_NETIF_HDR_FLAGS_BROADCAST.
  */
 #define GNRC_NETIF_HDR_FLAGS_MULTICAST  (0x40)
+
+/**
+ * @brief   Next hop resolved by the sender.
+ *
+ * @details Packets with this flag set are sent by the network layer to
+ *          gnrc_netif_hdr_t::if_pid and the destination address without
+ *          determining the next hop (see @ref net_gnrc_ipv6_dst_cache).
+ *          The network layer clears this flag before the packet reaches the
+ *          link layer.
+ */
+#define GNRC_NETIF_HDR_FLAGS_RESOLVED   (0x20)
 /**
  * @}
  */
@@ -38,6 +38,23 @@ extern "C" {
  */
 #define GNRC_NETREG_DEMUX_CTX_ALL   (0xffff0000)
 
+/**
+ * @brief   Number of hash buckets per protocol type in the registry
+ *
+ * @details Entries are distributed over the buckets by their
+ *          gnrc_netreg_entry_t::demux_ctx, so lookups only need to walk the
+ *          entries of one bucket. Entries with equal
+ *          gnrc_netreg_entry_t::demux_ctx are kept next to each other, so
+ *          gnrc_netreg_getnext() is O(1). Must be a power of 2.
+ *
+ *          The default keeps the chains short with a few dozen registered
+ *          ports per protocol and costs one pointer per bucket and protocol
+ *          type. Lower it on nodes with only a handful of registrations.
+ */
+#ifndef GNRC_NETREG_BUCKETS
+#define GNRC_NETREG_BUCKETS         (16)
+#endif
+
 /**
  * @brief   Entry to the @ref net_gnrc_netreg
  */
@@ -58,8 +75,30 @@ typedef struct gnrc_netreg_entry {
      */
     uint32_t demux_ctx;
     kernel_pid_t pid;       /**< The PID of the registering thread */
+#ifdef MODULE_GNRC_NETAPI_MBOX
+    /**
+     * @brief   Mailbox packets are put into instead of sending them to
+     *          gnrc_netreg_entry_t::pid, NULL for none.
+     *
+     * @see gnrc_netreg_register_mbox()
+     */
+    struct gnrc_netapi_mbox *mbox;
+#endif
 } gnrc_netreg_entry_t;
 
+/**
+ * @brief   Static initializer for a gnrc_netreg_entry_t that delivers packets
+ *          to a thread.
+ *
+ * @param[in] demux_ctx The demultiplexing context of the entry.
+ * @param[in] pid       The PID of the registering thread.
+ */
+#ifdef MODULE_GNRC_NETAPI_MBOX
+#define GNRC_NETREG_ENTRY_INIT_PID(demux_ctx, pid)  { NULL, (demux_ctx), (pid), NULL }
+#else
+#define GNRC_NETREG_ENTRY_INIT_PID(demux_ctx, pid)  { NULL, (demux_ctx), (pid) }
+#endif
+
 /**
  * @brief   Initializes module.
  */
@@ -86,9 +125,38 @@ void gnrc_netreg_init(void);
  */
 int gnrc_netreg_register(gnrc_nettype_t type, gnrc_netreg_entry_t *entry);
 
+#if defined(MODULE_GNRC_NETAPI_MBOX) || defined(DOXYGEN)
+/**
+ * @brief   Registers a packet mailbox to the registry.
+ *
+ * @details Packets of protocol @p type with context
+ *          gnrc_netreg_entry_t::demux_ctx are put into @p mbox instead of
+ *          being sent to a thread. gnrc_netreg_entry_t::pid is only kept to
+ *          mark the entry as used, the registering thread does not need a
+ *          message queue.
+ *
+ *          Only available with the `gnrc_netapi_mbox` module.
+ *
+ * @param[in] type      Type of the protocol. Must not be < GNRC_NETTYPE_UNDEF or
+ *                      >= GNRC_NETTYPE_NUMOF.
+ * @param[in] entry     An entry you want to add to the registry with
+ *                      gnrc_netreg_entry_t::demux_ctx set.
+ * @param[in] mbox      An initialized mailbox. Must not be NULL.
+ *
+ * @return  0 on success
+ * @return  -EINVAL if @p type was < GNRC_NETTYPE_UNDEF or >= GNRC_NETTYPE_NUMOF
+ */
+int gnrc_netreg_register_mbox(gnrc_nettype_t type, gnrc_netreg_entry_t *entry,
+                              struct gnrc_netapi_mbox *mbox);
+#endif
+
 /**
  * @brief   Removes a thread from the registry.
  *
+ * @details Once a thread has no registrations left, it is not passed
+ *          @ref net_gnrc_netapi batches anymore (see
+ *          gnrc_netapi_batch_disable()).
+ *
  * @param[in] type      Type of the protocol.
  * @param[in] entry     An entry you want to remove from the registry.
  */
@@ -128,6 +196,10 @@ int gnrc_netreg_num(gnrc_nettype_t type, uint32_t demux_ctx);
  * @param[in] entry     A registry entry retrieved by gnrc_netreg_lookup() or
  *                      gnrc_netreg_getnext(). Must not be NULL.
  *
+ * @details Since entries with equal gnrc_netreg_entry_t::demux_ctx are
+ *          stored next to each other this does not need to search the
+ *          registry.
+ *
  * @return  The next entry after @p entry fitting the given parameters on success
  * @return  NULL if no entry new entry can be found.
  */
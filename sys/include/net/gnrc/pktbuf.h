@@ -59,6 +59,88 @@ extern "C" {
 #define GNRC_PKTBUF_SIZE    (6144)
 #endif  /* GNRC_PKTBUF_SIZE */
 
+/**
+ * @def     GNRC_PKTBUF_STATIC_CACHE_SIZE
+ * @brief   Number of free packet snips every thread keeps in its snip cache
+ *          with `gnrc_pktbuf_static_cache`
+ *
+ * @details With `gnrc_pktbuf_static_cache` a thread that releases a snip keeps
+ *          it in a per-thread cache so its next allocation of a snip does not
+ *          need to lock the packet buffer. Snips in the caches still occupy
+ *          space in the packet buffer. The module also makes releasing a
+ *          packet lock-free: the last user queues it, and the next
+ *          operation that locks the packet buffer frees it.
+ */
+#ifndef GNRC_PKTBUF_STATIC_CACHE_SIZE
+#define GNRC_PKTBUF_STATIC_CACHE_SIZE   (4)
+#endif
+
+/**
+ * @def     GNRC_PKTBUF_TX_HEADROOM
+ * @brief   Headroom to reserve in front of outgoing payload
+ *
+ * @details Fits a UDP header, an IPv6 header and the largest IEEE 802.15.4
+ *          MAC header (8 + 40 + 23 B, which also covers Ethernet), so that
+ *          all of them can be put in front of the payload without
+ *          allocating further data (see gnrc_pktbuf_add_headroom()).
+ */
+#ifndef GNRC_PKTBUF_TX_HEADROOM
+#define GNRC_PKTBUF_TX_HEADROOM         (72)
+#endif
+
+/**
+ * @def     GNRC_PKTBUF_HEADROOM_NUMOF
+ * @brief   Maximum number of packets with reserved headroom at the same time
+ *
+ * @details When all of them are in use, gnrc_pktbuf_add_headroom() allocates
+ *          the payload without headroom.
+ */
+#ifndef GNRC_PKTBUF_HEADROOM_NUMOF
+#define GNRC_PKTBUF_HEADROOM_NUMOF      (4)
+#endif
+
+/**
+ * @name    Size classes of the slab packet buffer
+ * @brief   Slot sizes and slot numbers of the size classes used by
+ *          `gnrc_pktbuf_slab`
+ *
+ * @details `gnrc_pktbuf_slab` serves packet snips from a dedicated class and
+ *          data from the smallest data class that fits the requested size
+ *          (falling back to the next larger class if that one is exhausted).
+ *          The data classes must be given in ascending slot size. Requests
+ *          larger than @ref GNRC_PKTBUF_SLAB_LARGE_SIZE fail, so set it to
+ *          e.g. 1514 when the packet buffer backs an Ethernet interface.
+ * @{
+ */
+#ifndef GNRC_PKTBUF_SLAB_SNIP_NUMOF
+#define GNRC_PKTBUF_SLAB_SNIP_NUMOF     (32)    /**< number of packet snip slots */
+#endif
+#ifndef GNRC_PKTBUF_SLAB_TINY_SIZE
+#define GNRC_PKTBUF_SLAB_TINY_SIZE      (8)     /**< fits e.g. a UDP header */
+#endif
+#ifndef GNRC_PKTBUF_SLAB_TINY_NUMOF
+#define GNRC_PKTBUF_SLAB_TINY_NUMOF     (16)    /**< number of tiny slots */
+#endif
+#ifndef GNRC_PKTBUF_SLAB_SMALL_SIZE
+#define GNRC_PKTBUF_SLAB_SMALL_SIZE     (40)    /**< fits e.g. an IPv6 header */
+#endif
+#ifndef GNRC_PKTBUF_SLAB_SMALL_NUMOF
+#define GNRC_PKTBUF_SLAB_SMALL_NUMOF    (16)    /**< number of small slots */
+#endif
+#ifndef GNRC_PKTBUF_SLAB_MEDIUM_SIZE
+#define GNRC_PKTBUF_SLAB_MEDIUM_SIZE    (127)   /**< fits an IEEE 802.15.4 frame */
+#endif
+#ifndef GNRC_PKTBUF_SLAB_MEDIUM_NUMOF
+#define GNRC_PKTBUF_SLAB_MEDIUM_NUMOF   (8)     /**< number of medium slots */
+#endif
+#ifndef GNRC_PKTBUF_SLAB_LARGE_SIZE
+#define GNRC_PKTBUF_SLAB_LARGE_SIZE     (1280)  /**< fits a full-MTU IPv6 packet */
+#endif
+#ifndef GNRC_PKTBUF_SLAB_LARGE_NUMOF
+#define GNRC_PKTBUF_SLAB_LARGE_NUMOF    (4)     /**< number of large slots */
+#endif
+/** @} */
+
 /**
  * @brief   Initializes packet buffer module.
  */
@@ -85,6 +167,47 @@ void gnrc_pktbuf_init(void);
 gnrc_pktsnip_t *gnrc_pktbuf_add(gnrc_pktsnip_t *next, void *data, size_t size,
                                 gnrc_nettype_t type);
 
+/**
+ * @brief   Adds a new gnrc_pktsnip_t with free space in front of its data to
+ *          the packet buffer.
+ *
+ * @details Headers later added in front of the new snip with
+ *          gnrc_pktbuf_add() are placed into this headroom, directly in front
+ *          of the data of their gnrc_pktsnip_t::next, instead of being
+ *          allocated separately. A packet built like this lies in one
+ *          contiguous buffer, so gnrc_pktbuf_get_iovec() describes it with a
+ *          single entry.
+ *
+ *          If no headroom can be reserved, this function behaves like
+ *          gnrc_pktbuf_add().
+ *
+ * @param[in] next      Next gnrc_pktsnip_t in the packet. Leave NULL if you
+ *                      want to create a new packet.
+ * @param[in] data      Data of the new gnrc_pktsnip_t. If @p data is NULL no data
+ *                      will be inserted into `result`.
+ * @param[in] size      Length of @p data. May not be 0.
+ * @param[in] headroom  Number of bytes to reserve in front of the data, e.g.
+ *                      @ref GNRC_PKTBUF_TX_HEADROOM.
+ * @param[in] type      Protocol type of the gnrc_pktsnip_t.
+ *
+ * @return  Pointer to the packet part that represents the new gnrc_pktsnip_t.
+ * @return  NULL, if no space is left in the packet buffer.
+ * @return  NULL, if @p size == 0.
+ */
+gnrc_pktsnip_t *gnrc_pktbuf_add_headroom(gnrc_pktsnip_t *next, void *data,
+                                         size_t size, size_t headroom,
+                                         gnrc_nettype_t type);
+
+/**
+ * @brief   Gets the number of bytes gnrc_pktbuf_add() can place directly in
+ *          front of the data of @p pkt.
+ *
+ * @param[in] pkt   A packet snip.
+ *
+ * @return  The free headroom in front of gnrc_pktsnip_t::data of @p pkt.
+ */
+size_t gnrc_pktbuf_headroom(gnrc_pktsnip_t *pkt);
+
 /**
  * @brief   Marks the first @p size bytes in a received packet with a new
  *          packet snip that is appended to the packet.
@@ -113,6 +236,23 @@ gnrc_pktsnip_t *gnrc_pktbuf_add(gnrc_pktsnip_t *next, void *data, size_t size,
  */
 gnrc_pktsnip_t *gnrc_pktbuf_mark(gnrc_pktsnip_t *pkt, size_t size, gnrc_nettype_t type);
 
+/**
+ * @brief   Gets the number of bytes to reserve in front of a header, so that
+ *          gnrc_pktbuf_mark() can split it off without moving any data.
+ *
+ * @details Receive paths that read a frame into a freshly allocated snip can
+ *          place it `headroom` bytes behind gnrc_pktsnip_t::data and then
+ *          mark `headroom + hdr_len` bytes. The header then starts at offset
+ *          `headroom` of the marked snip and the payload stays where it was
+ *          written to.
+ *
+ * @param[in] hdr_len   Length of the header that will be marked.
+ *
+ * @return  The number of bytes to reserve in front of the header.
+ * @return  0, if @p hdr_len is 0.
+ */
+size_t gnrc_pktbuf_mark_headroom(size_t hdr_len);
+
 /**
  * @brief   Reallocates gnrc_pktsnip_t::data of @p pkt in the packet buffer, without
  *          changing the content.
@@ -186,6 +326,10 @@ gnrc_pktsnip_t *gnrc_pktbuf_start_write(gnrc_pktsnip_t *pkt);
  *          which points to the given *pkt* and contains a IOVEC representation
  *          of the referenced packet in its data section.
  *
+ *          The first element always describes the first snip of *pkt*.
+ *          Following snips that are adjacent in memory (see
+ *          gnrc_pktbuf_add_headroom()) share one element.
+ *
  * @param[in]  pkt  Packet to export as IOVEC
  * @param[out] len  Number of elements in the IOVEC
  *
@@ -271,7 +415,8 @@ gnrc_pktsnip_t *gnrc_pktbuf_duplicate_upto(gnrc_pktsnip_t *pkt, gnrc_nettype_t t
  *
  * @note    Only available with DEVELHELP defined.
  *
- * @details Statistics include maximum number of reserved bytes.
+ * @details Statistics include maximum number of reserved bytes or, with
+ *          `gnrc_pktbuf_slab`, the high-water mark of every size class.
  */
 void gnrc_pktbuf_stats(void);
 #endif
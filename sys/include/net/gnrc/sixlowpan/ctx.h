@@ -113,17 +113,24 @@ gnrc_sixlowpan_ctx_t *gnrc_sixlowpan_ctx_update(uint8_t id, const ipv6_addr_t *p
                                                 uint8_t prefix_len, uint16_t ltime,
                                                 bool comp);
 
-#ifdef MODULE_GNRC_SIXLOWPAN_CTX
 /**
  * @brief   Removes context.
  *
  * @param[in] id    A context ID.
  */
-static inline void gnrc_sixlowpan_ctx_remove(uint8_t id)
-{
-    gnrc_sixlowpan_ctx_lookup_id(id)->prefix_len = 0;
-}
-#endif
+void gnrc_sixlowpan_ctx_remove(uint8_t id);
+
+/**
+ * @brief   Gets the generation of the context buffer.
+ *
+ * @details The generation changes whenever a context is added, removed or
+ *          changed, including when it is no longer used for compression.
+ *          Users caching anything derived from the contexts can compare it
+ *          to find out if their cache is still valid.
+ *
+ * @return  The current generation of the context buffer.
+ */
+uint32_t gnrc_sixlowpan_ctx_gen(void);
 
 #ifdef TEST_SUITES
 /**
@@ -42,6 +42,12 @@ extern "C" {
  */
 #define GNRC_SIXLOWPAN_MSG_FRAG_SND    (0x0225)
 
+/**
+ * @brief   Message type for triggering garbage collection of the reassembly
+ *          buffer
+ */
+#define GNRC_SIXLOWPAN_MSG_FRAG_GC_RBUF (0x0226)
+
 /**
  * @brief   Definition of 6LoWPAN fragmentation type.
  */
@@ -51,11 +57,29 @@ typedef struct {
     size_t datagram_size;   /**< Length of just the IPv6 packet to be fragmented */
     uint16_t offset;        /**< Offset of the Nth fragment from the beginning of the
                              *   payload datagram */
+    uint16_t tag;           /**< Datagram tag of the fragments */
 } gnrc_sixlowpan_msg_frag_t;
 
+/**
+ * @brief   Gets a new datagram tag for a datagram this node fragments
+ *
+ * @return  The datagram tag.
+ */
+uint16_t gnrc_sixlowpan_frag_next_tag(void);
+
 /**
  * @brief   Sends a packet fragmented.
  *
+ * The fragments reference the payload of the packet instead of copying it,
+ * and only get their own fragment header and interface header. If the calling
+ * thread collects the fragments into a netapi batch (see
+ * gnrc_netapi_batch_collects()) all of them are sent in one go and
+ * @p fragment_msg is free again on return. Otherwise one fragment is sent and
+ * a @ref GNRC_SIXLOWPAN_MSG_FRAG_SND message with @p fragment_msg is sent to
+ * the calling thread for the next one, which needs to call this function
+ * again. gnrc_sixlowpan_msg_frag_t::pkt is NULL once the last fragment is
+ * sent.
+ *
  * @param[in] fragment_msg    Message containing status of the 6LoWPAN
  *                            fragmentation progress
  */
@@ -68,6 +92,14 @@ void gnrc_sixlowpan_frag_send(gnrc_sixlowpan_msg_frag_t *fragment_msg);
  */
 void gnrc_sixlowpan_frag_handle_pkt(gnrc_pktsnip_t *pkt);
 
+/**
+ * @brief   Garbage collects timed out entries of the reassembly buffer.
+ *
+ * Called on @ref GNRC_SIXLOWPAN_MSG_FRAG_GC_RBUF, which the reassembly buffer
+ * schedules to the thread that handles the fragments while it holds entries.
+ */
+void gnrc_sixlowpan_frag_gc_rbuf(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,11 +24,42 @@
 
 #include "net/gnrc/pkt.h"
 #include "net/sixlowpan.h"
+#include "timex.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief   Number of flows whose compressed header is cached by the encoder
+ *
+ * @details Everything but the traffic class, the flow label and the next
+ *          header compression only depends on the IPv6 source and destination
+ *          address, the next header, the hop limit, the link-layer addresses
+ *          and the 6LoWPAN contexts. The encoder remembers the result for the
+ *          most recent flows, so packets of these flows skip the context
+ *          lookups and address comparisons.
+ *
+ *          Set to 0 to disable the cache.
+ */
+#ifndef GNRC_SIXLOWPAN_IPHC_CACHE_SIZE
+#define GNRC_SIXLOWPAN_IPHC_CACHE_SIZE  (4U)
+#endif
+
+/**
+ * @brief   Time in microseconds a cached flow is used before it is encoded
+ *          anew
+ *
+ * @details Changes to the contexts and to the link-layer addresses of the
+ *          interfaces take effect immediately (see gnrc_sixlowpan_ctx_gen()
+ *          and gnrc_netif_get_l2addr_gen()). This bounds the use of changes
+ *          the cache can not detect, like a context lifetime running out
+ *          unnoticed.
+ */
+#ifndef GNRC_SIXLOWPAN_IPHC_CACHE_LTIME
+#define GNRC_SIXLOWPAN_IPHC_CACHE_LTIME (10U * SEC_IN_USEC)
+#endif
+
 /**
  * @brief   Decompresses a received 6LoWPAN IPHC frame.
  *
@@ -0,0 +1,457 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    net_gnrc_tcp TCP
+ * @ingroup     net_gnrc
+ * @brief       GNRC's implementation of the TCP protocol
+ *
+ * The TCP thread demultiplexes received segments to their transmission
+ * control block (TCB) and runs the retransmission and delayed ACK timers.
+ * The functions below are called by the application threads, usually
+ * through @ref net_conn_tcp. All TCBs are protected by one lock.
+ *
+ * Sent data is copied once into the packet buffer, where it stays until it
+ * is acknowledged. Retransmissions put a new header in front of the same
+ * payload. Received in-order payload is handed to the
+ * @ref gnrc_netapi_mbox_t "mailbox" of the connection as it came from the
+ * network stack.
+ *
+ * Supported are window scaling (RFC 7323), selective acknowledgments
+ * (RFC 2018), delayed ACKs (RFC 1122), the retransmission timer of RFC 6298
+ * and the congestion control of RFC 5681, including fast retransmit and fast
+ * recovery.
+ *
+ * Limitations:
+ * - IPv6 only.
+ * - A connection request of a listening TCB is only answered when
+ *   gnrc_tcp_accept() takes it from the backlog.
+ * - gnrc_tcp_close() returns when the own FIN is acknowledged. The
+ *   connection then waits for the FIN of the peer (FIN-WAIT-2) and in
+ *   TIME-WAIT without the TCB, see @ref GNRC_TCP_TIME_WAIT_NUMOF. Data the
+ *   peer sends in FIN-WAIT-2 is acknowledged and discarded.
+ * - No Nagle algorithm, urgent data or timestamps.
+ *
+ * @{
+ *
+ * @file
+ * @brief       TCP GNRC definition
+ */
+
+#ifndef GNRC_TCP_H_
+#define GNRC_TCP_H_
+
+#include <stdint.h>
+
+#include "net/gnrc.h"
+#include "net/ipv6/addr.h"
+#include "net/tcp.h"
+#include "xtimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Default message queue size for the TCP thread
+ */
+#ifndef GNRC_TCP_MSG_QUEUE_SIZE
+#define GNRC_TCP_MSG_QUEUE_SIZE     (8U)
+#endif
+
+/**
+ * @brief   Priority of the TCP thread
+ */
+#ifndef GNRC_TCP_PRIO
+#define GNRC_TCP_PRIO               (THREAD_PRIORITY_MAIN - 2)
+#endif
+
+/**
+ * @brief   Default stack size to use for the TCP thread
+ */
+#ifndef GNRC_TCP_STACK_SIZE
+#define GNRC_TCP_STACK_SIZE         (THREAD_STACKSIZE_DEFAULT)
+#endif
+
+/**
+ * @brief   Maximum segment size announced to the peer
+ *
+ * @details Defaults to what fits into the minimum IPv6 MTU.
+ */
+#ifndef GNRC_TCP_MSS
+#define GNRC_TCP_MSS                (1220U)
+#endif
+
+/**
+ * @brief   Receive window in bytes
+ *
+ * @details Windows beyond 65535 bytes are announced with window scaling.
+ *          All data within the window may end up in the packet buffer, so
+ *          the packet buffer must be large enough.
+ */
+#ifndef GNRC_TCP_RCV_WND
+#define GNRC_TCP_RCV_WND            (2 * GNRC_TCP_MSS)
+#endif
+
+/**
+ * @brief   Maximum number of segments in the send queue of a TCB, sent or
+ *          not yet acknowledged. Must be a power of 2.
+ */
+#ifndef GNRC_TCP_SND_QUEUE_SIZE
+#define GNRC_TCP_SND_QUEUE_SIZE     (4U)
+#endif
+
+/**
+ * @brief   Maximum number of out-of-order segments a TCB keeps
+ */
+#ifndef GNRC_TCP_OOO_SIZE
+#define GNRC_TCP_OOO_SIZE           (2U)
+#endif
+
+/**
+ * @brief   Maximum number of connection requests a listening TCB queues
+ */
+#ifndef GNRC_TCP_BACKLOG_SIZE
+#define GNRC_TCP_BACKLOG_SIZE       (2U)
+#endif
+
+/**
+ * @brief   Time in microseconds after which a connection request that was not
+ *          accepted is dropped from the backlog
+ *
+ * @details Every retransmission of the SYN restarts the time. Defaults to the
+ *          connection establishment timer of BSD.
+ */
+#ifndef GNRC_TCP_BACKLOG_TIMEOUT
+#define GNRC_TCP_BACKLOG_TIMEOUT    (75U * 1000U * 1000U)
+#endif
+
+/**
+ * @brief   Maximum number of closed connections kept in FIN-WAIT-2 or
+ *          TIME-WAIT
+ *
+ * @details If all are in use, the one that would end first is dropped.
+ */
+#ifndef GNRC_TCP_TIME_WAIT_NUMOF
+#define GNRC_TCP_TIME_WAIT_NUMOF    (2U)
+#endif
+
+/**
+ * @brief   Maximum segment lifetime in microseconds, TIME-WAIT lasts twice as
+ *          long
+ */
+#ifndef GNRC_TCP_MSL
+#define GNRC_TCP_MSL                (30U * 1000U * 1000U)
+#endif
+
+/**
+ * @brief   Time in microseconds a closed connection waits for the FIN of the
+ *          peer
+ */
+#ifndef GNRC_TCP_FIN_WAIT_2_TIMEOUT
+#define GNRC_TCP_FIN_WAIT_2_TIMEOUT (60U * 1000U * 1000U)
+#endif
+
+/**
+ * @brief   Delay of an acknowledgment in microseconds, 0 to acknowledge
+ *          every segment right away
+ *
+ * @details Every second full segment is acknowledged right away regardless.
+ */
+#ifndef GNRC_TCP_ACK_DELAY
+#define GNRC_TCP_ACK_DELAY          (40U * 1000U)
+#endif
+
+/**
+ * @brief   Initial retransmission timeout in microseconds
+ */
+#ifndef GNRC_TCP_RTO_INIT
+#define GNRC_TCP_RTO_INIT           (1000U * 1000U)
+#endif
+
+/**
+ * @brief   Minimum retransmission timeout in microseconds
+ */
+#ifndef GNRC_TCP_RTO_MIN
+#define GNRC_TCP_RTO_MIN            (1000U * 1000U)
+#endif
+
+/**
+ * @brief   Maximum retransmission timeout in microseconds
+ */
+#ifndef GNRC_TCP_RTO_MAX
+#define GNRC_TCP_RTO_MAX            (60U * 1000U * 1000U)
+#endif
+
+/**
+ * @brief   Number of retransmissions of a segment before the connection is
+ *          aborted
+ */
+#ifndef GNRC_TCP_RTX_MAX
+#define GNRC_TCP_RTX_MAX            (8U)
+#endif
+
+/**
+ * @name    Message types of the TCP thread
+ * @{
+ */
+#define GNRC_TCP_MSG_TYPE_RTX       (0x0240)    /**< retransmission timeout */
+#define GNRC_TCP_MSG_TYPE_ACK       (0x0241)    /**< delayed ACK timeout */
+/** @} */
+
+/**
+ * @name    Events reported by gnrc_tcp_events()
+ * @{
+ */
+#define GNRC_TCP_EVENT_IN           (0x1)   /**< data, end of stream or a
+                                             *   connection request can be
+                                             *   received */
+#define GNRC_TCP_EVENT_OUT          (0x2)   /**< data can be sent */
+#define GNRC_TCP_EVENT_ERR          (0x4)   /**< the connection failed */
+/** @} */
+
+/**
+ * @brief   TCP connection states (RFC 793, section 3.2)
+ */
+typedef enum {
+    GNRC_TCP_STATE_CLOSED = 0,
+    GNRC_TCP_STATE_LISTEN,
+    GNRC_TCP_STATE_SYN_SENT,
+    GNRC_TCP_STATE_SYN_RCVD,
+    GNRC_TCP_STATE_ESTABLISHED,
+    GNRC_TCP_STATE_FIN_WAIT_1,
+    GNRC_TCP_STATE_FIN_WAIT_2,
+    GNRC_TCP_STATE_CLOSE_WAIT,
+    GNRC_TCP_STATE_CLOSING,
+    GNRC_TCP_STATE_LAST_ACK,
+    GNRC_TCP_STATE_TIME_WAIT,
+} gnrc_tcp_state_t;
+
+/**
+ * @brief   A segment in the send or out-of-order queue of a TCB
+ */
+typedef struct {
+    gnrc_pktsnip_t *pkt;    /**< the payload */
+    uint32_t seq;           /**< sequence number of the first payload byte */
+    uint8_t sacked;         /**< the peer selectively acknowledged it */
+} gnrc_tcp_seg_t;
+
+/**
+ * @brief   A connection request queued by a listening TCB
+ */
+typedef struct {
+    ipv6_addr_t local_addr;     /**< address the request was sent to */
+    ipv6_addr_t peer_addr;      /**< address of the peer */
+    uint16_t peer_port;         /**< port of the peer */
+    uint16_t mss;               /**< maximum segment size of the peer */
+    uint32_t irs;               /**< initial sequence number of the peer */
+    uint8_t wscale;             /**< window scale of the peer, 0xff for none */
+    uint8_t sack_perm;          /**< the peer supports SACK */
+    uint32_t time;              /**< time the last SYN was received */
+} gnrc_tcp_syn_t;
+
+/**
+ * @brief   Transmission control block. Must never be modified by the user.
+ */
+typedef struct gnrc_tcp_tcb {
+    struct gnrc_tcp_tcb *next;      /**< next active TCB */
+    gnrc_netapi_mbox_t *mbox;       /**< received data is put here, state
+                                     *   changes are notified through it */
+    ipv6_addr_t local_addr;         /**< local address, may be unspecified */
+    ipv6_addr_t peer_addr;          /**< address of the peer */
+    uint16_t local_port;            /**< local port */
+    uint16_t peer_port;             /**< port of the peer */
+    uint16_t mss;                   /**< maximum segment size to send */
+    uint8_t state;                  /**< @ref gnrc_tcp_state_t */
+    uint8_t flags;                  /**< internal flags */
+    uint8_t snd_wscale;             /**< window scale of the peer */
+    uint8_t rcv_wscale;             /**< own window scale */
+    uint8_t dupacks;                /**< number of duplicate ACKs */
+    uint8_t rtx_count;              /**< retransmissions of the oldest segment */
+    int error;                      /**< negative errno the connection failed
+                                     *   with, 0 if it did not fail */
+    uint32_t iss;                   /**< initial send sequence number */
+    uint32_t snd_una;               /**< oldest unacknowledged sequence number */
+    uint32_t snd_nxt;               /**< next sequence number to send */
+    uint32_t snd_max;               /**< highest sequence number sent */
+    uint32_t snd_end;               /**< sequence number after the queued data */
+    uint32_t snd_wnd;               /**< send window */
+    uint32_t snd_wl1;               /**< segment sequence number of the last
+                                     *   window update */
+    uint32_t snd_wl2;               /**< segment acknowledgment number of the
+                                     *   last window update */
+    uint32_t cwnd;                  /**< congestion window */
+    uint32_t ssthresh;              /**< slow start threshold */
+    uint32_t irs;                   /**< initial receive sequence number */
+    uint32_t rcv_nxt;               /**< next sequence number expected */
+    uint32_t rcv_adv;               /**< right edge of the announced window */
+    uint32_t rcv_queued;            /**< received bytes not yet read */
+    gnrc_pktsnip_t *rcv_pkt;        /**< received packet partially read */
+    uint16_t rcv_off;               /**< bytes of gnrc_tcp_tcb_t::rcv_pkt read */
+    uint8_t snd_head;               /**< oldest segment in
+                                     *   gnrc_tcp_tcb_t::snd_queue */
+    uint8_t snd_numof;              /**< number of segments in
+                                     *   gnrc_tcp_tcb_t::snd_queue */
+    gnrc_tcp_seg_t snd_queue[GNRC_TCP_SND_QUEUE_SIZE];  /**< send queue */
+    gnrc_tcp_seg_t ooo[GNRC_TCP_OOO_SIZE];  /**< out-of-order segments */
+    uint32_t srtt;                  /**< smoothed round-trip time */
+    uint32_t rttvar;                /**< round-trip time variation */
+    uint32_t rto;                   /**< retransmission timeout */
+    uint32_t rtt_seq;               /**< sequence number timed */
+    uint32_t rtt_start;             /**< time gnrc_tcp_tcb_t::rtt_seq was sent */
+    xtimer_t rtx_timer;             /**< retransmission timer */
+    xtimer_t ack_timer;             /**< delayed ACK timer */
+    msg_t rtx_msg;                  /**< message of gnrc_tcp_tcb_t::rtx_timer */
+    msg_t ack_msg;                  /**< message of gnrc_tcp_tcb_t::ack_timer */
+    gnrc_tcp_syn_t backlog[GNRC_TCP_BACKLOG_SIZE];  /**< connection requests of
+                                                     *   a listening TCB */
+    uint8_t backlog_numof;          /**< number of queued connection requests */
+    uint8_t backlog_max;            /**< maximum number of queued connection
+                                     *   requests */
+} gnrc_tcp_tcb_t;
+
+/**
+ * @brief   Initializes and starts the TCP thread
+ *
+ * @return  PID of the TCP thread
+ * @return  negative value on error
+ */
+int gnrc_tcp_init(void);
+
+/**
+ * @brief   Initializes a TCB
+ *
+ * @param[out] tcb          The TCB. Must not be NULL.
+ * @param[in] mbox          Initialized mailbox the received data is put into.
+ *                          Threads waiting for the TCB must be its reader.
+ * @param[in] local_addr    Local address, may be unspecified.
+ * @param[in] local_port    Local port.
+ */
+void gnrc_tcp_tcb_init(gnrc_tcp_tcb_t *tcb, gnrc_netapi_mbox_t *mbox,
+                       const ipv6_addr_t *local_addr, uint16_t local_port);
+
+/**
+ * @brief   Opens a connection actively
+ *
+ * @details Blocks until the connection is established or failed.
+ *
+ * @param[in,out] tcb       A closed TCB.
+ * @param[in] peer_addr     Address of the peer.
+ * @param[in] peer_port     Port of the peer.
+ *
+ * @return  0 on success.
+ * @return  -EISCONN, if @p tcb is not closed.
+ * @return  -ECONNREFUSED, if the peer refused the connection.
+ * @return  -ETIMEDOUT, if the peer did not answer.
+ */
+int gnrc_tcp_connect(gnrc_tcp_tcb_t *tcb, const ipv6_addr_t *peer_addr,
+                     uint16_t peer_port);
+
+/**
+ * @brief   Makes a TCB listen for connection requests
+ *
+ * @param[in,out] tcb       A closed TCB.
+ * @param[in] backlog       Number of connection requests to queue. Adapted
+ *                          to 1 to @ref GNRC_TCP_BACKLOG_SIZE.
+ *
+ * @return  0 on success.
+ * @return  -EISCONN, if @p tcb is connected.
+ */
+int gnrc_tcp_listen(gnrc_tcp_tcb_t *tcb, int backlog);
+
+/**
+ * @brief   Accepts a connection request
+ *
+ * @details Blocks until a connection requested from a listening TCB is
+ *          established.
+ *
+ * @param[in] listener      A listening TCB.
+ * @param[out] tcb          The TCB for the new connection.
+ * @param[in] mbox          Initialized mailbox for @p tcb, see
+ *                          gnrc_tcp_tcb_init().
+ *
+ * @return  0 on success.
+ * @return  -EINVAL, if @p listener is not listening or was closed while
+ *          waiting.
+ */
+int gnrc_tcp_accept(gnrc_tcp_tcb_t *listener, gnrc_tcp_tcb_t *tcb,
+                    gnrc_netapi_mbox_t *mbox);
+
+/**
+ * @brief   Sends data
+ *
+ * @details Blocks until all data is queued for sending.
+ *
+ * @param[in,out] tcb   A connected TCB.
+ * @param[in] data      The data.
+ * @param[in] len       Length of @p data.
+ *
+ * @return  Number of bytes queued.
+ * @return  -ENOTCONN, if @p tcb is not connected.
+ * @return  -EPIPE, if @p tcb was closed for sending.
+ * @return  -ENOMEM, if the packet buffer is full.
+ * @return  the error the connection failed with.
+ */
+int gnrc_tcp_send(gnrc_tcp_tcb_t *tcb, const void *data, size_t len);
+
+/**
+ * @brief   Receives data
+ *
+ * @details Blocks until data is available.
+ *
+ * @param[in,out] tcb   A connected TCB.
+ * @param[out] data     Buffer for the data.
+ * @param[in] max_len   Size of @p data.
+ *
+ * @return  Number of bytes received.
+ * @return  0, if the peer closed the connection.
+ * @return  -ENOTCONN, if @p tcb is not connected.
+ * @return  the error the connection failed with.
+ */
+int gnrc_tcp_recv(gnrc_tcp_tcb_t *tcb, void *data, size_t max_len);
+
+/**
+ * @brief   Closes a connection
+ *
+ * @details Blocks until the queued data and the FIN are acknowledged or the
+ *          connection failed. @p tcb can be used again afterwards. Threads
+ *          waiting in gnrc_tcp_accept() for a listening @p tcb return.
+ *
+ * @param[in,out] tcb   A TCB.
+ */
+void gnrc_tcp_close(gnrc_tcp_tcb_t *tcb);
+
+/**
+ * @brief   Gets the pending events of a TCB
+ *
+ * @param[in] tcb   A TCB.
+ *
+ * @return  @ref GNRC_TCP_EVENT_IN, @ref GNRC_TCP_EVENT_OUT and
+ *          @ref GNRC_TCP_EVENT_ERR or-ed together.
+ */
+unsigned gnrc_tcp_events(gnrc_tcp_tcb_t *tcb);
+
+/**
+ * @brief   Calculate the checksum for the given packet
+ *
+ * @param[in] hdr           Pointer to the TCP header
+ * @param[in] pseudo_hdr    Pointer to the network layer header
+ *
+ * @return  0 on success
+ * @return  -EBADMSG if @p hdr is not of type GNRC_NETTYPE_TCP
+ * @return  -EFAULT if @p hdr or @p pseudo_hdr is NULL
+ * @return  -ENOENT if gnrc_pktsnip_t::type of @p pseudo_hdr is not known
+ */
+int gnrc_tcp_calc_csum(gnrc_pktsnip_t *hdr, gnrc_pktsnip_t *pseudo_hdr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GNRC_TCP_H_ */
+/** @} */
@@ -73,6 +73,51 @@ static inline uint16_t inet_csum(uint16_t sum, const uint8_t *buf, uint16_t len)
     return inet_csum_slice(sum, buf, len, 0);
 }
 
+/**
+ * @brief   Updates an Internet Checksum after a part of its domain changed.
+ *
+ * @see <a href="https://tools.ietf.org/html/rfc1624">
+ *          RFC 1624
+ *      </a>
+ *
+ * @details Unlike the other functions, this one works on the checksum as
+ *          stored in a header, i.e. its 1's complement was taken. Only the
+ *          changed part is summed, so e.g. a forwarder can adapt the checksum
+ *          to a rewritten header field without summing the whole packet.
+ *
+ * @param[in] csum      The checksum over the old domain, as in the header.
+ * @param[in] old_data  The old content of the changed part.
+ * @param[in] new_data  The new content of the changed part.
+ * @param[in] len       Length of @p old_data and @p new_data in byte.
+ * @param[in] offset    Offset of the changed part in the checksum domain.
+ *
+ * @return  The checksum over the new domain, as in the header.
+ */
+uint16_t inet_csum_replace(uint16_t csum, const uint8_t *old_data, const uint8_t *new_data,
+                           uint16_t len, size_t offset);
+
+/**
+ * @brief   Updates an Internet Checksum after a 16-bit word of its domain
+ *          changed.
+ *
+ * @see inet_csum_replace()
+ *
+ * @param[in] csum      The checksum over the old domain, as in the header.
+ * @param[in] old_word  The old word in host byte order.
+ * @param[in] new_word  The new word in host byte order.
+ *
+ * @return  The checksum over the new domain, as in the header.
+ */
+static inline uint16_t inet_csum_update16(uint16_t csum, uint16_t old_word, uint16_t new_word)
+{
+    /* RFC 1624, eqn. 3: HC' = ~(~HC + ~m + m') */
+    uint32_t sum = (uint16_t)~csum + (uint32_t)(uint16_t)~old_word + new_word;
+
+    sum = (sum & 0xffff) + (sum >> 16);
+    sum = (sum & 0xffff) + (sum >> 16);
+    return (uint16_t)~sum;
+}
+
 #ifdef __cplusplus
 }
 #endif
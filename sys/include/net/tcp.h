@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    net_tcp TCP
+ * @ingroup     net
+ * @brief       Provides TCP header and helper functions
+ * @see         <a href="https://tools.ietf.org/html/rfc793">
+ *                  RFC 793
+ *              </a>
+ * @{
+ *
+ * @file
+ * @brief       TCP header and helper functions definitions
+ */
+#ifndef TCP_H_
+#define TCP_H_
+
+#include "byteorder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name    TCP header flags
+ * @{
+ */
+#define TCP_FLAG_FIN        (0x01)  /**< no more data from sender */
+#define TCP_FLAG_SYN        (0x02)  /**< synchronize sequence numbers */
+#define TCP_FLAG_RST        (0x04)  /**< reset the connection */
+#define TCP_FLAG_PSH        (0x08)  /**< push function */
+#define TCP_FLAG_ACK        (0x10)  /**< acknowledgment field significant */
+#define TCP_FLAG_URG        (0x20)  /**< urgent pointer field significant */
+/** @} */
+
+/**
+ * @name    TCP option kinds
+ * @see     <a href="https://www.iana.org/assignments/tcp-parameters">
+ *              IANA, TCP Parameters
+ *          </a>
+ * @{
+ */
+#define TCP_OPTION_KIND_EOL         (0) /**< end of option list */
+#define TCP_OPTION_KIND_NOP         (1) /**< no operation */
+#define TCP_OPTION_KIND_MSS         (2) /**< maximum segment size */
+#define TCP_OPTION_KIND_WS          (3) /**< window scale (RFC 7323) */
+#define TCP_OPTION_KIND_SACK_PERM   (4) /**< SACK permitted (RFC 2018) */
+#define TCP_OPTION_KIND_SACK        (5) /**< SACK (RFC 2018) */
+/** @} */
+
+/**
+ * @name    TCP option lengths
+ * @{
+ */
+#define TCP_OPTION_LENGTH_MSS       (4) /**< length of MSS option */
+#define TCP_OPTION_LENGTH_WS        (3) /**< length of window scale option */
+#define TCP_OPTION_LENGTH_SACK_PERM (2) /**< length of SACK permitted option */
+/** @} */
+
+/**
+ * @brief   Maximum length of a TCP header including options
+ */
+#define TCP_HDR_LEN_MAX     (60)
+
+/**
+ * @brief   Maximum window scale shift (RFC 7323, section 2.3)
+ */
+#define TCP_WS_MAX          (14)
+
+/**
+ * @brief   TCP header
+ */
+typedef struct __attribute__((packed)) {
+    network_uint16_t src_port;      /**< source port */
+    network_uint16_t dst_port;      /**< destination port */
+    network_uint32_t seq_num;       /**< sequence number */
+    network_uint32_t ack_num;       /**< acknowledgment number */
+    uint8_t off_reserved;           /**< data offset in 4 byte words (upper
+                                     *   nibble) */
+    uint8_t flags;                  /**< flags, see @ref TCP_FLAG_FIN etc. */
+    network_uint16_t window;        /**< receive window */
+    network_uint16_t checksum;      /**< checksum */
+    network_uint16_t urgent_ptr;    /**< urgent pointer */
+} tcp_hdr_t;
+
+/**
+ * @brief   Gets the length of a TCP header including options
+ *
+ * @param[in] hdr   A TCP header.
+ *
+ * @return  Length of @p hdr in bytes.
+ */
+static inline unsigned tcp_hdr_len(const tcp_hdr_t *hdr)
+{
+    return (hdr->off_reserved >> 4) * 4;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TCP_H_ */
+/** @} */
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_thread_periodic Periodic threads
+ * @ingroup     sys
+ * @brief       Rate-monotonic periodic threads with budget enforcement
+ *
+ * A periodic thread runs a job once per period. The job of each period
+ * (release) must finish before the next release, otherwise a deadline miss
+ * is counted.
+ *
+ * Periodic threads are scheduled rate-monotonic: they get the priorities
+ * @ref THREAD_PERIODIC_PRIO_FIRST to
+ * `THREAD_PERIODIC_PRIO_FIRST + THREAD_PERIODIC_PRIO_NUMOF - 1`, the shorter
+ * the period the higher the priority. They thus coexist with all other
+ * threads by plain fixed-priority scheduling. Periodic threads beyond
+ * @ref THREAD_PERIODIC_PRIO_NUMOF share the lowest priority of the band.
+ *
+ * If a job is still running @ref thread_periodic_t::budget microseconds
+ * after it started, it is demoted to @ref THREAD_PERIODIC_PRIO_BACKGROUND
+ * until its next release, so an overrunning job can not starve lower
+ * priority threads. A job still running at its next release gets its
+ * rate-monotonic priority back and continues on the budget of that release.
+ * Priorities are changed with sched_change_priority(), so a periodic thread
+ * holding a mutex keeps a priority it inherited (module `core_mutex_pi`).
+ *
+ * @note    The budget is measured in wall-clock time, including the time the
+ *          job was preempted by higher priority threads and interrupts.
+ *
+ * @{
+ *
+ * @file
+ * @brief   Periodic thread definitions
+ */
+#ifndef THREAD_PERIODIC_H
+#define THREAD_PERIODIC_H
+
+#include <stdint.h>
+
+#include "kernel_types.h"
+#include "thread.h"
+#include "xtimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef THREAD_PERIODIC_PRIO_FIRST
+/**
+ * @brief   Priority of the periodic thread with the shortest period
+ */
+#define THREAD_PERIODIC_PRIO_FIRST      (1)
+#endif
+
+#ifndef THREAD_PERIODIC_PRIO_NUMOF
+/**
+ * @brief   Number of priorities used by periodic threads
+ */
+#define THREAD_PERIODIC_PRIO_NUMOF      (3)
+#endif
+
+#ifndef THREAD_PERIODIC_PRIO_BACKGROUND
+/**
+ * @brief   Priority of a job that exceeded its budget
+ */
+#define THREAD_PERIODIC_PRIO_BACKGROUND (THREAD_PRIORITY_IDLE - 1)
+#endif
+
+/**
+ * @brief   Job of a periodic thread
+ *
+ * @param[in] arg   Argument given to thread_create_periodic()
+ */
+typedef void (*thread_periodic_job_t)(void *arg);
+
+/**
+ * @brief   A periodic thread.
+ *
+ * @details The statistics (thread_periodic_t::jobs,
+ *          thread_periodic_t::deadline_misses and
+ *          thread_periodic_t::budget_overruns) may be read and reset by
+ *          the user, all other members must never be changed by the user.
+ */
+typedef struct thread_periodic {
+    struct thread_periodic *next;   /**< next periodic thread, sorted by period */
+    thread_periodic_job_t job;      /**< the job */
+    void *arg;                      /**< argument of the job */
+    uint32_t period;                /**< period in microseconds */
+    uint32_t budget;                /**< budget of a job in microseconds,
+                                     *   0 for unlimited */
+    uint32_t release;               /**< time of the current release */
+    xtimer_t release_timer;         /**< timer for the next release */
+    xtimer_t budget_timer;          /**< timer enforcing the budget */
+    volatile unsigned jobs;         /**< number of jobs completed */
+    volatile unsigned deadline_misses;  /**< number of jobs not completed
+                                         *   before the next release */
+    volatile unsigned budget_overruns;  /**< number of jobs that exceeded the
+                                         *   budget */
+    kernel_pid_t pid;               /**< the thread */
+    uint8_t priority;               /**< rate-monotonic priority */
+    volatile uint8_t waiting;       /**< thread waits for the next release */
+    volatile uint8_t pending;       /**< a release was missed while the
+                                     *   previous job ran */
+    volatile uint8_t demoted;       /**< job exceeded its budget */
+} thread_periodic_t;
+
+/**
+ * @brief   Creates a periodic thread
+ *
+ * @details The first job is released immediately.
+ *
+ * @param[out] pt           Periodic thread structure. Must not be NULL.
+ * @param[out] stack        Start address of the preallocated stack memory
+ * @param[in] stacksize     Size of the stack in bytes
+ * @param[in] period        Period in microseconds. Must not be 0.
+ * @param[in] budget        Maximum time in microseconds a job may run at its
+ *                          rate-monotonic priority, 0 for unlimited.
+ * @param[in] job           Job run once per period
+ * @param[in] arg           Argument of @p job
+ * @param[in] name          Human readable descriptor for the thread
+ *
+ * @return  PID of the newly created thread on success
+ * @return  value as returned by thread_create() on error
+ */
+kernel_pid_t thread_create_periodic(thread_periodic_t *pt, char *stack,
+                                    int stacksize, uint32_t period,
+                                    uint32_t budget, thread_periodic_job_t job,
+                                    void *arg, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* THREAD_PERIODIC_H */
+/** @} */
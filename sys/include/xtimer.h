@@ -20,6 +20,12 @@
  * number of active timers.  The reason for this is that multiplexing is
  * realized by next-first singly linked lists.
  *
+ * With the `xtimer_wheel` module, timers are kept in a hierarchical timer
+ * wheel instead. Insertion and removal are O(1) then, at the cost of
+ * XTIMER_WHEEL_LEVELS * 32 list heads of RAM and two more words per timer.
+ * Timers are sorted only once they are due within the current wheel tick
+ * (see XTIMER_WHEEL_TICK_SHIFT), so they still fire with the usual precision.
+ *
  * @{
  * @file
  * @brief   xtimer interface definitions
@@ -62,6 +68,12 @@ typedef struct xtimer {
     timer_callback_t callback;  /**< callback function to call when timer
                                      expires */
     void *arg;                  /**< argument to pass to callback function */
+#if defined(MODULE_XTIMER_WHEEL) || defined(DOXYGEN)
+    struct xtimer **pprev;      /**< reference to the pointer to this timer,
+                                     for O(1) removal */
+    uintptr_t tag;              /**< marks xtimer_t::pprev as valid, as timer
+                                     structs do not need to be initialized */
+#endif
 } xtimer_t;
 
 /**
@@ -207,6 +219,45 @@ void xtimer_set_msg(xtimer_t *timer, uint32_t offset, msg_t *msg, kernel_pid_t t
  */
 void xtimer_set_msg64(xtimer_t *timer, uint64_t offset, msg_t *msg, kernel_pid_t target_pid);
 
+/**
+ * @brief Set a timer that sends a message, with a tolerance
+ *
+ * Like xtimer_set_msg(), but the message may be sent up to @p slack
+ * microseconds late. Within that window, the timer is placed on the time with
+ * the most trailing zero bits, so timers with overlapping windows tend to
+ * share the same target and expire in one pass of the timer interrupt
+ * instead of waking the system separately.
+ *
+ * Use this for protocol timeouts and retransmissions that have no need to be
+ * exact.
+ *
+ * @param[in] timer         timer struct to work with.
+ *                          Its xtimer_t::target and xtimer_t::long_target
+ *                          fields need to be initialized with 0 on first use.
+ * @param[in] offset        minimum microseconds from now
+ * @param[in] slack         microseconds the message may be sent late
+ * @param[in] msg           ptr to msg that will be sent
+ * @param[in] target_pid    pid the message will be sent to
+ */
+void xtimer_set_msg_slack(xtimer_t *timer, uint32_t offset, uint32_t slack,
+                          msg_t *msg, kernel_pid_t target_pid);
+
+/**
+ * @brief Set a timer that sends a message, with a tolerance, 64bit version
+ *
+ * @see xtimer_set_msg_slack()
+ *
+ * @param[in] timer         timer struct to work with.
+ *                          Its xtimer_t::target and xtimer_t::long_target
+ *                          fields need to be initialized with 0 on first use.
+ * @param[in] offset        minimum microseconds from now
+ * @param[in] slack         microseconds the message may be sent late
+ * @param[in] msg           ptr to msg that will be sent
+ * @param[in] target_pid    pid the message will be sent to
+ */
+void xtimer_set_msg64_slack(xtimer_t *timer, uint64_t offset, uint64_t slack,
+                            msg_t *msg, kernel_pid_t target_pid);
+
 /**
  * @brief Set a timer that wakes up a thread
  *
@@ -255,10 +306,27 @@ void xtimer_set_wakeup64(xtimer_t *timer, uint64_t offset, kernel_pid_t pid);
  */
 void xtimer_set(xtimer_t *timer, uint32_t offset);
 
+/**
+ * @brief Set a timer to execute a callback, with a tolerance
+ *
+ * Like xtimer_set(), but the callback may be executed up to @p slack
+ * microseconds late, so it can share a timer interrupt with other timers.
+ * See xtimer_set_msg_slack() for how the target is chosen.
+ *
+ * @param[in] timer     the timer structure to use.
+ *                      Its xtimer_t::target and xtimer_t::long_target
+ *                      fields need to be initialized with 0 on first use
+ * @param[in] offset    minimum time in microseconds from now
+ * @param[in] slack     time in microseconds the callback may be late.
+ *                      @p offset + @p slack is capped at UINT32_MAX.
+ */
+void xtimer_set_slack(xtimer_t *timer, uint32_t offset, uint32_t slack);
+
 /**
  * @brief remove a timer
  *
- * @note this function runs in O(n) with n being the number of active timers
+ * @note this function runs in O(n) with n being the number of active timers,
+ *       in O(1) with the `xtimer_wheel` module
  *
  * @param[in] timer ptr to timer structure that will be removed
  */
@@ -286,6 +354,28 @@ int xtimer_msg_receive_timeout(msg_t *msg, uint32_t us);
  */
 int xtimer_msg_receive_timeout64(msg_t *msg, uint64_t us);
 
+#ifndef XTIMER_WHEEL_TICK_SHIFT
+/**
+ * @brief Tick of the timer wheel as power of two microseconds
+ *
+ * Only used by the `xtimer_wheel` module. Timers due in the same tick are
+ * kept in a sorted list, so the tick should be short against the typical
+ * timeout, but long against the time to handle one wheel tick.
+ */
+#define XTIMER_WHEEL_TICK_SHIFT (10)
+#endif
+
+#ifndef XTIMER_WHEEL_LEVELS
+/**
+ * @brief Number of levels of the timer wheel
+ *
+ * Only used by the `xtimer_wheel` module. Every level covers 32 times the
+ * range of the level below, timers beyond the last level are kept in an
+ * unsorted list. With the default values, the wheel covers about 12.7 days.
+ */
+#define XTIMER_WHEEL_LEVELS (6)
+#endif
+
 /**
  * @brief xtimer backoff value
  *
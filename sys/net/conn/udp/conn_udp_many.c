@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ * @brief       conn_udp_recv_many() and conn_udp_send_many() for stacks that
+ *              can only take one datagram at a time
+ *
+ * @details     Built on conn_udp_recvfrom() and conn_udp_sendto() of the
+ *              stack.
+ */
+
+#include "net/conn/udp.h"
+
+int conn_udp_recv_many(conn_udp_t *conn, conn_udp_dgram_t *dgrams, unsigned numof)
+{
+    int res;
+
+    if (numof == 0) {
+        return 0;
+    }
+    /* without a non-blocking receive only one datagram can be taken */
+    res = conn_udp_recvfrom(conn, dgrams->data, dgrams->len, dgrams->addr,
+                            &dgrams->addr_len, &dgrams->port);
+    if (res < 0) {
+        return res;
+    }
+    dgrams->len = (size_t)res;
+    return 1;
+}
+
+int conn_udp_send_many(const conn_udp_dgram_t *dgrams, unsigned numof, const void *src,
+                       size_t src_len, int family, uint16_t sport)
+{
+    unsigned sent;
+    int res = 0;
+
+    for (sent = 0; sent < numof; sent++) {
+        res = conn_udp_sendto(dgrams[sent].data, dgrams[sent].len, src, src_len,
+                              dgrams[sent].addr, dgrams[sent].addr_len, family, sport,
+                              dgrams[sent].port);
+        if (res < 0) {
+            break;
+        }
+    }
+    return (sent > 0) ? (int)sent : res;
+}
+
+/** @} */
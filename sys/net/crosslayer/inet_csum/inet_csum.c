@@ -14,12 +14,96 @@
 
 #include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 #include "od.h"
 #include "net/inet_csum.h"
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
 
+/* word types the buffer may be accessed through */
+typedef uint16_t __attribute__((may_alias)) _u16_t;
+typedef uint32_t __attribute__((may_alias)) _u32_t;
+
+static inline uint32_t _fold(uint64_t sum)
+{
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return (uint32_t)sum;
+}
+
+static inline uint16_t _swap(uint32_t sum)
+{
+    return (uint16_t)((sum >> 8) | (sum << 8));
+}
+
+/**
+ * @brief   Sums @p buf in host byte order
+ *
+ * @details The 1's complement sum does not depend on the byte order, so the
+ *          buffer is summed in native words and the result is swapped into
+ *          network byte order afterwards (see RFC 1071, section 2 (B)). A
+ *          buffer starting at an odd address is summed as if it was preceded
+ *          by a zero byte, which swaps the bytes of the sum once more.
+ *
+ * @return  The 1's complement sum of @p buf as big-endian 16-bit words, a
+ *          trailing odd byte is padded with zero.
+ */
+static uint16_t _sum(const uint8_t *buf, size_t len)
+{
+    uint64_t sum = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    int swap = 1;
+#else
+    int swap = 0;
+#endif
+    uint16_t word;
+
+    if (((uintptr_t)buf & 1) && (len > 0)) {
+        uint8_t tmp[2] = { 0, *buf };
+
+        memcpy(&word, tmp, sizeof(word));
+        sum += word;
+        buf++;
+        len--;
+        swap = !swap;
+    }
+    if (((uintptr_t)buf & 2) && (len >= 2)) {
+        sum += *((const _u16_t *)buf);
+        buf += 2;
+        len -= 2;
+    }
+    /* the sum of 32-bit words carries into the upper half of sum */
+    while (len >= 32) {
+        const _u32_t *w = (const _u32_t *)buf;
+
+        sum += (uint64_t)w[0] + w[1] + w[2] + w[3];
+        sum += (uint64_t)w[4] + w[5] + w[6] + w[7];
+        buf += 32;
+        len -= 32;
+    }
+    while (len >= 4) {
+        sum += *((const _u32_t *)buf);
+        buf += 4;
+        len -= 4;
+    }
+    if (len >= 2) {
+        sum += *((const _u16_t *)buf);
+        buf += 2;
+        len -= 2;
+    }
+    if (len) {
+        uint8_t tmp[2] = { *buf, 0 };
+
+        memcpy(&word, tmp, sizeof(word));
+        sum += word;
+    }
+
+    sum = _fold(sum);
+    return (swap) ? _swap(sum) : sum;
+}
+
 uint16_t inet_csum_slice(uint16_t sum, const uint8_t *buf, uint16_t len, size_t accum_len)
 {
     uint32_t csum = sum;
@@ -41,25 +125,25 @@ uint16_t inet_csum_slice(uint16_t sum, const uint8_t *buf, uint16_t len, size_t
         csum += *buf;         /* add first byte as bottom half of 16-byte word */
         buf++;
         len--;
-        accum_len++;
     }
 
-    for (int i = 0; i < (len >> 1); buf += 2, i++) {
-        csum += (uint16_t)(*buf << 8) + *(buf + 1); /* group bytes by 16-byte words */
-                                                    /* and add them */
-    }
-
-    if ((accum_len + len) & 1)          /* if accumulated length is odd */
-        csum += (uint16_t)(*buf << 8);  /* add last byte as top half of 16-byte word */
-
-    while (csum >> 16) {
-        uint16_t carry = csum >> 16;
-        csum = (csum & 0xffff) + carry;
-    }
+    csum = _fold(csum + _sum(buf, len));
 
     DEBUG("inet_sum: new sum = 0x%04" PRIx32 "\n", csum);
 
     return csum;
 }
 
+uint16_t inet_csum_replace(uint16_t csum, const uint8_t *old_data, const uint8_t *new_data,
+                           uint16_t len, size_t offset)
+{
+    /* RFC 1624, eqn. 3: HC' = ~(~HC + ~m + m') */
+    uint32_t sum = (uint16_t)~csum;
+
+    sum += (uint16_t)~inet_csum_slice(0, old_data, len, offset);
+    sum += inet_csum_slice(0, new_data, len, offset);
+
+    return (uint16_t)~_fold(sum);
+}
+
 /** @} */
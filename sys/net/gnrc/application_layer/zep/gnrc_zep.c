@@ -557,9 +557,8 @@ void *_event_loop(void *args)
     msg_t msg, ack, msg_q[GNRC_ZEP_MSG_QUEUE_SIZE];
     gnrc_netdev_t *dev = (gnrc_netdev_t *)args;
     gnrc_netapi_opt_t *opt;
-    gnrc_netreg_entry_t my_reg = { NULL, ((gnrc_zep_t *)args)->src_port,
-                                   KERNEL_PID_UNDEF
-                                 };
+    gnrc_netreg_entry_t my_reg = GNRC_NETREG_ENTRY_INIT_PID(((gnrc_zep_t *)args)->src_port,
+                                                            KERNEL_PID_UNDEF);
 
     msg_init_queue(msg_q, GNRC_ZEP_MSG_QUEUE_SIZE);
 
@@ -598,6 +597,11 @@ void *_event_loop(void *args)
                 opt = (gnrc_netapi_opt_t *)msg.content.ptr;
                 ack.type = GNRC_NETAPI_MSG_TYPE_ACK;
                 ack.content.value = _set(dev, opt->opt, opt->data, opt->data_len);
+#ifdef MODULE_GNRC_NETIF
+                if ((int)ack.content.value >= 0) {
+                    gnrc_netif_opt_applied(opt->opt);
+                }
+#endif
                 msg_reply(&msg, &ack);
                 break;
 
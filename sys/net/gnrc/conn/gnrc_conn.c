@@ -21,52 +21,98 @@
 #include "net/gnrc/ipv6/netif.h"
 #include "net/udp.h"
 
-int gnrc_conn_recvfrom(conn_t *conn, void *data, size_t max_len, void *addr, size_t *addr_len,
-                       uint16_t *port)
+#ifdef MODULE_CONN_UDP
+/* checks if pkt comes from the peer a UDP connection is connected to */
+static bool _from_peer(struct conn_udp *conn, gnrc_pktsnip_t *l3hdr, gnrc_pktsnip_t *pkt)
+{
+    gnrc_pktsnip_t *l4hdr = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_UDP);
+
+    return (l4hdr != NULL) &&
+           (byteorder_ntohs(((udp_hdr_t *)l4hdr->data)->src_port) == conn->remote_port) &&
+           (memcmp(&((ipv6_hdr_t *)l3hdr->data)->src, conn->remote_addr,
+                   conn->remote_addr_len) == 0);
+}
+#endif
+
+static int _parse(conn_t *conn, gnrc_pktsnip_t *pkt, void *addr, size_t *addr_len,
+                  uint16_t *port)
 {
-    msg_t msg;
-    int timeout = 3;
-    while ((timeout--) > 0) {
-        gnrc_pktsnip_t *pkt, *l3hdr;
-        size_t size = 0;
-        msg_receive(&msg);
-        switch (msg.type) {
-            case GNRC_NETAPI_MSG_TYPE_RCV:
-                pkt = (gnrc_pktsnip_t *)msg.content.ptr;
-                if (pkt->size > max_len) {
-                    return -ENOMEM;
-                }
-                l3hdr = gnrc_pktsnip_search_type(pkt, conn->l3_type);
-                if (l3hdr == NULL) {
-                    msg_send_to_self(&msg); /* requeue invalid messages */
-                    continue;
-                }
+    gnrc_pktsnip_t *l3hdr;
+
+    l3hdr = gnrc_pktsnip_search_type(pkt, conn->l3_type);
+    if (l3hdr == NULL) {
+        return -EBADMSG;
+    }
+#ifdef MODULE_CONN_UDP
+    /* a connected UDP connection only receives from its peer, like a
+     * connected POSIX datagram socket */
+    if ((conn->l4_type == GNRC_NETTYPE_UDP) &&
+        (((struct conn_udp *)conn)->remote_addr_len > 0) &&
+        !_from_peer((struct conn_udp *)conn, l3hdr, pkt)) {
+        return -EBADMSG;
+    }
+#endif
 #if defined(MODULE_CONN_UDP) || defined(MODULE_CONN_TCP)
-                if ((conn->l4_type != GNRC_NETTYPE_UNDEF) && (port != NULL)) {
-                    gnrc_pktsnip_t *l4hdr;
-                    l4hdr = gnrc_pktsnip_search_type(pkt, conn->l4_type);
-                    if (l4hdr == NULL) {
-                        msg_send_to_self(&msg); /* requeue invalid messages */
-                        continue;
-                    }
-                    *port = byteorder_ntohs(((udp_hdr_t *)l4hdr->data)->src_port);
-                }
+    if ((conn->l4_type != GNRC_NETTYPE_UNDEF) && (port != NULL)) {
+        gnrc_pktsnip_t *l4hdr;
+        l4hdr = gnrc_pktsnip_search_type(pkt, conn->l4_type);
+        if (l4hdr == NULL) {
+            return -EBADMSG;
+        }
+        *port = byteorder_ntohs(((udp_hdr_t *)l4hdr->data)->src_port);
+    }
+#else
+    (void)port;
 #endif  /* defined(MODULE_CONN_UDP) */
-                if (addr != NULL) {
-                    memcpy(addr, &((ipv6_hdr_t *)l3hdr->data)->src, sizeof(ipv6_addr_t));
-                    *addr_len = sizeof(ipv6_addr_t);
-                }
-                memcpy(data, pkt->data, pkt->size);
-                size = pkt->size;
-                gnrc_pktbuf_release(pkt);
-                return (int)size;
-            default:
-                (void)port;
-                msg_send_to_self(&msg); /* requeue invalid messages */
-                break;
+    if (addr != NULL) {
+        memcpy(addr, &((ipv6_hdr_t *)l3hdr->data)->src, sizeof(ipv6_addr_t));
+        *addr_len = sizeof(ipv6_addr_t);
+    }
+    return 0;
+}
+
+int gnrc_conn_recv_pkt(conn_t *conn, gnrc_pktsnip_t *pkt, void *data, size_t max_len,
+                       void *addr, size_t *addr_len, uint16_t *port)
+{
+    size_t size;
+    int res;
+
+    if (pkt->size > max_len) {
+        gnrc_pktbuf_release(pkt);
+        return -ENOMEM;
+    }
+    if ((res = _parse(conn, pkt, addr, addr_len, port)) < 0) {
+        gnrc_pktbuf_release(pkt);
+        return res;
+    }
+    memcpy(data, pkt->data, pkt->size);
+    size = pkt->size;
+    gnrc_pktbuf_release(pkt);
+    return (int)size;
+}
+
+int gnrc_conn_recvfrom(conn_t *conn, void *data, size_t max_len, void *addr, size_t *addr_len,
+                       uint16_t *port)
+{
+    int res;
+
+    do {
+        res = gnrc_conn_recv_pkt(conn, gnrc_netapi_mbox_get(&conn->mbox), data, max_len,
+                                 addr, addr_len, port);
+    } while (res == -EBADMSG);  /* drop invalid packets */
+    return res;
+}
+
+gnrc_pktsnip_t *gnrc_conn_recv_buf(conn_t *conn, void *addr, size_t *addr_len, uint16_t *port)
+{
+    while (1) {
+        gnrc_pktsnip_t *pkt = gnrc_netapi_mbox_get(&conn->mbox);
+
+        if (_parse(conn, pkt, addr, addr_len, port) == 0) {
+            return pkt;
         }
+        gnrc_pktbuf_release(pkt);   /* drop invalid packets */
     }
-    return -ETIMEDOUT;
 }
 
 #ifdef MODULE_GNRC_IPV6
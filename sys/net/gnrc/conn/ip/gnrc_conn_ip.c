@@ -32,7 +32,7 @@ int conn_ip_create(conn_ip_t *conn, const void *addr, size_t addr_len, int famil
                 conn->l3_type = GNRC_NETTYPE_IPV6;
                 conn->local_addr_len = addr_len;
                 conn_ip_close(conn);       /* unregister possibly registered netreg entry */
-                gnrc_conn_reg(&conn->netreg_entry, conn->l3_type, (uint32_t)proto);
+                gnrc_conn_reg((conn_t *)conn, conn->l3_type, (uint32_t)proto);
             }
             else {
                 return -EADDRNOTAVAIL;
@@ -52,9 +52,7 @@ int conn_ip_create(conn_ip_t *conn, const void *addr, size_t addr_len, int famil
 void conn_ip_close(conn_ip_t *conn)
 {
     assert(conn->l4_type == GNRC_NETTYPE_UNDEF);
-    if (conn->netreg_entry.pid != KERNEL_PID_UNDEF) {
-        gnrc_netreg_unregister(conn->l3_type, &conn->netreg_entry);
-    }
+    gnrc_conn_unreg((conn_t *)conn, conn->l3_type);
 }
 
 int conn_ip_getlocaladdr(conn_ip_t *conn, void *addr)
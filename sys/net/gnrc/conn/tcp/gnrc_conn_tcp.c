@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ * @brief       GNRC implementation of the tcp interface defined by net/conn/tcp.h
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "net/af.h"
+#include "net/gnrc/conn.h"
+#include "net/gnrc/tcp.h"
+
+#include "net/conn/tcp.h"
+
+static void _init(conn_tcp_t *conn)
+{
+    conn->l3_type = GNRC_NETTYPE_IPV6;
+    conn->l4_type = GNRC_NETTYPE_TCP;
+    /* the TCP thread demultiplexes, the netreg entry is not used */
+    conn->netreg_entry.pid = KERNEL_PID_UNDEF;
+    gnrc_netapi_mbox_init(&conn->mbox, conn->mbox_queue, GNRC_CONN_MBOX_SIZE,
+                          GNRC_CONN_FLAG_RCV);
+}
+
+int conn_tcp_create(conn_tcp_t *conn, const void *addr, size_t addr_len, int family,
+                    uint16_t port)
+{
+    ipv6_addr_t local_addr;
+
+    switch (family) {
+        case AF_INET6:
+            if (addr_len != sizeof(ipv6_addr_t)) {
+                return -EINVAL;
+            }
+            if (!gnrc_conn6_set_local_addr((uint8_t *)&local_addr, addr)) {
+                return -EADDRNOTAVAIL;
+            }
+            _init(conn);
+            gnrc_tcp_tcb_init(&conn->tcb, &conn->mbox, &local_addr, port);
+            break;
+        default:
+            (void)addr;
+            (void)addr_len;
+            (void)port;
+            return -EAFNOSUPPORT;
+    }
+    return 0;
+}
+
+void conn_tcp_close(conn_tcp_t *conn)
+{
+    assert(conn->l4_type == GNRC_NETTYPE_TCP);
+    gnrc_tcp_close(&conn->tcb);
+    gnrc_netapi_mbox_set_remove(&conn->mbox);
+    gnrc_netapi_mbox_flush(&conn->mbox);
+}
+
+int conn_tcp_getlocaladdr(conn_tcp_t *conn, void *addr, uint16_t *port)
+{
+    assert(conn->l4_type == GNRC_NETTYPE_TCP);
+    memcpy(addr, &conn->tcb.local_addr, sizeof(ipv6_addr_t));
+    *port = conn->tcb.local_port;
+    return sizeof(ipv6_addr_t);
+}
+
+int conn_tcp_getpeeraddr(conn_tcp_t *conn, void *addr, uint16_t *port)
+{
+    assert(conn->l4_type == GNRC_NETTYPE_TCP);
+    if ((conn->tcb.state == GNRC_TCP_STATE_CLOSED) ||
+        (conn->tcb.state == GNRC_TCP_STATE_LISTEN)) {
+        return -ENOTCONN;
+    }
+    memcpy(addr, &conn->tcb.peer_addr, sizeof(ipv6_addr_t));
+    *port = conn->tcb.peer_port;
+    return sizeof(ipv6_addr_t);
+}
+
+int conn_tcp_connect(conn_tcp_t *conn, const void *addr, size_t addr_len, uint16_t port)
+{
+    assert(conn->l4_type == GNRC_NETTYPE_TCP);
+    if (addr_len != sizeof(ipv6_addr_t)) {
+        return -EINVAL;
+    }
+    return gnrc_tcp_connect(&conn->tcb, addr, port);
+}
+
+int conn_tcp_listen(conn_tcp_t *conn, int queue_len)
+{
+    assert(conn->l4_type == GNRC_NETTYPE_TCP);
+    return gnrc_tcp_listen(&conn->tcb, queue_len);
+}
+
+int conn_tcp_accept(conn_tcp_t *conn, conn_tcp_t *out_conn)
+{
+    assert(conn->l4_type == GNRC_NETTYPE_TCP);
+    _init(out_conn);
+    return gnrc_tcp_accept(&conn->tcb, &out_conn->tcb, &out_conn->mbox);
+}
+
+int conn_tcp_recv(conn_tcp_t *conn, void *data, size_t max_len)
+{
+    assert(conn->l4_type == GNRC_NETTYPE_TCP);
+    return gnrc_tcp_recv(&conn->tcb, data, max_len);
+}
+
+int conn_tcp_send(conn_tcp_t *conn, const void *data, size_t len)
+{
+    assert(conn->l4_type == GNRC_NETTYPE_TCP);
+    return gnrc_tcp_send(&conn->tcb, data, len);
+}
+
+/** @} */
@@ -23,6 +23,20 @@
 
 #include "net/conn/udp.h"
 
+/**
+ * @brief   Checks if the connection was created for a network layer that is
+ *          compiled in
+ */
+static inline bool _l3_supported(const conn_udp_t *conn)
+{
+#ifdef MODULE_GNRC_IPV6
+    return (conn->l3_type == GNRC_NETTYPE_IPV6);
+#else
+    (void)conn;
+    return false;
+#endif
+}
+
 int conn_udp_create(conn_udp_t *conn, const void *addr, size_t addr_len,
                     int family, uint16_t port)
 {
@@ -37,7 +51,7 @@ int conn_udp_create(conn_udp_t *conn, const void *addr, size_t addr_len,
                 conn->l3_type = GNRC_NETTYPE_IPV6;
                 conn->local_addr_len = addr_len;
                 conn_udp_close(conn);       /* unregister possibly registered netreg entry */
-                gnrc_conn_reg(&conn->netreg_entry, conn->l4_type, (uint32_t)port);
+                gnrc_conn_reg((conn_t *)conn, conn->l4_type, (uint32_t)port);
             }
             else {
                 return -EADDRNOTAVAIL;
@@ -56,10 +70,11 @@ int conn_udp_create(conn_udp_t *conn, const void *addr, size_t addr_len,
 void conn_udp_close(conn_udp_t *conn)
 {
     assert(conn->l4_type == GNRC_NETTYPE_UDP);
-    if (conn->netreg_entry.pid != KERNEL_PID_UNDEF) {
-        gnrc_netreg_unregister(GNRC_NETTYPE_UDP, &conn->netreg_entry);
-        conn->netreg_entry.pid = KERNEL_PID_UNDEF;
-    }
+    gnrc_conn_unreg((conn_t *)conn, GNRC_NETTYPE_UDP);
+    conn->remote_addr_len = 0;
+#ifdef MODULE_GNRC_IPV6
+    gnrc_ipv6_dst_cache_init(&conn->dst_cache);
+#endif
 }
 
 int conn_udp_getlocaladdr(conn_udp_t *conn, void *addr, uint16_t *port)
@@ -95,7 +110,9 @@ int conn_udp_sendto(const void *data, size_t len, const void *src, size_t src_le
 {
     gnrc_pktsnip_t *pkt, *hdr = NULL;
 
-    pkt = gnrc_pktbuf_add(NULL, (void *)data, len, GNRC_NETTYPE_UNDEF); /* data will only be copied */
+    /* data will only be copied, headers of the lower layers go in front of it */
+    pkt = gnrc_pktbuf_add_headroom(NULL, (void *)data, len, GNRC_PKTBUF_TX_HEADROOM,
+                                   GNRC_NETTYPE_UNDEF);
     hdr = gnrc_udp_hdr_build(pkt, sport, dport);
     if (hdr == NULL) {
         gnrc_pktbuf_release(pkt);
@@ -134,4 +151,152 @@ int conn_udp_sendto(const void *data, size_t len, const void *src, size_t src_le
     return len;
 }
 
+int conn_udp_connect(conn_udp_t *conn, const void *addr, size_t addr_len, uint16_t port)
+{
+    assert(conn->l4_type == GNRC_NETTYPE_UDP);
+    switch (conn->l3_type) {
+#ifdef MODULE_GNRC_IPV6
+        case GNRC_NETTYPE_IPV6:
+            if (addr_len != sizeof(ipv6_addr_t)) {
+                return -EINVAL;
+            }
+            memcpy(conn->remote_addr, addr, addr_len);
+            conn->remote_addr_len = addr_len;
+            conn->remote_port = port;
+            /* the next hop is looked up with the first message */
+            gnrc_ipv6_dst_cache_init(&conn->dst_cache);
+            return 0;
+#endif
+        default:
+            (void)addr;
+            (void)addr_len;
+            (void)port;
+            return -EBADF;
+    }
+}
+
+int conn_udp_send(conn_udp_t *conn, const void *data, size_t len)
+{
+#ifdef MODULE_GNRC_IPV6
+    ipv6_addr_t *dst = (ipv6_addr_t *)conn->remote_addr;
+    gnrc_pktsnip_t *pkt, *hdr;
+#endif
+
+    assert(conn->l4_type == GNRC_NETTYPE_UDP);
+    if (conn->remote_addr_len == 0) {
+        return -ENOTCONN;
+    }
+    switch (conn->l3_type) {
+#ifdef MODULE_GNRC_IPV6
+        case GNRC_NETTYPE_IPV6:
+            if (!gnrc_ipv6_dst_cache_valid(&conn->dst_cache, dst) &&
+                (ipv6_addr_is_multicast(dst) ||
+                 (gnrc_ipv6_dst_cache_fill(&conn->dst_cache, dst) < 0))) {
+                /* next hop can not be cached (yet): let IPv6 look it up */
+                return conn_udp_sendto(data, len, conn->local_addr, conn->local_addr_len,
+                                       conn->remote_addr, conn->remote_addr_len, AF_INET6,
+                                       (uint16_t)conn->netreg_entry.demux_ctx,
+                                       conn->remote_port);
+            }
+            /* data will only be copied, headers of the lower layers go in front of it */
+            pkt = gnrc_pktbuf_add_headroom(NULL, (void *)data, len, GNRC_PKTBUF_TX_HEADROOM,
+                                           GNRC_NETTYPE_UNDEF);
+            hdr = gnrc_udp_hdr_build(pkt, (uint16_t)conn->netreg_entry.demux_ctx,
+                                     conn->remote_port);
+            if (hdr == NULL) {
+                gnrc_pktbuf_release(pkt);
+                return -ENOMEM;
+            }
+            pkt = hdr;
+            hdr = gnrc_ipv6_dst_cache_hdr_build(&conn->dst_cache, pkt,
+                                                (ipv6_addr_t *)conn->local_addr);
+            if (hdr == NULL) {
+                gnrc_pktbuf_release(pkt);
+                return -ENOMEM;
+            }
+            gnrc_netapi_dispatch_send(GNRC_NETTYPE_UDP, GNRC_NETREG_DEMUX_CTX_ALL, hdr);
+            return len;
+#endif
+        default:
+            (void)data;
+            (void)len;
+            return -EBADF;
+    }
+}
+
+int gnrc_conn_udp_recv_buf(conn_udp_t *conn, gnrc_pktsnip_t **pkt, void *addr,
+                           size_t *addr_len, uint16_t *port)
+{
+    assert(conn->l4_type == GNRC_NETTYPE_UDP);
+    if (!_l3_supported(conn)) {
+        return -EBADF;
+    }
+    *pkt = gnrc_conn_recv_buf((conn_t *)conn, addr, addr_len, port);
+    return (int)(*pkt)->size;
+}
+
+int conn_udp_recv_many(conn_udp_t *conn, conn_udp_dgram_t *dgrams, unsigned numof)
+{
+    unsigned received = 0;
+
+    assert(conn->l4_type == GNRC_NETTYPE_UDP);
+    if (!_l3_supported(conn)) {
+        return -EBADF;
+    }
+    while (received < numof) {
+        conn_udp_dgram_t *dgram = &dgrams[received];
+        gnrc_pktsnip_t *pkt;
+        int res;
+
+        if (received == 0) {
+            pkt = gnrc_netapi_mbox_get(&conn->mbox);
+        }
+        else {
+            pkt = gnrc_netapi_mbox_peek(&conn->mbox);
+            if ((pkt == NULL) || (pkt->size > dgram->len)) {
+                /* leave a datagram that does not fit for the next call */
+                break;
+            }
+            gnrc_netapi_mbox_try_get(&conn->mbox);
+        }
+        res = gnrc_conn_recv_pkt((conn_t *)conn, pkt, dgram->data, dgram->len,
+                                 dgram->addr, &dgram->addr_len, &dgram->port);
+        if (res == -EBADMSG) {
+            continue;   /* drop invalid packets */
+        }
+        if (res < 0) {
+            return (received > 0) ? (int)received : res;
+        }
+        dgram->len = (size_t)res;
+        received++;
+    }
+    return (int)received;
+}
+
+int conn_udp_send_many(const conn_udp_dgram_t *dgrams, unsigned numof, const void *src,
+                       size_t src_len, int family, uint16_t sport)
+{
+    gnrc_netapi_batch_t batch;
+    unsigned sent;
+    int res = 0, dropped;
+
+    /* hand the datagrams to the UDP thread in one message */
+    gnrc_netapi_batch_collect(&batch);
+    for (sent = 0; sent < numof; sent++) {
+        const conn_udp_dgram_t *dgram = &dgrams[sent];
+
+        res = conn_udp_sendto(dgram->data, dgram->len, src, src_len, dgram->addr,
+                              dgram->addr_len, family, sport, dgram->port);
+        if (res < 0) {
+            break;
+        }
+    }
+    /* datagrams the UDP thread had no room for are lost */
+    dropped = gnrc_netapi_batch_end();
+    if ((unsigned)dropped >= sent) {
+        return (sent > 0) ? -ENOBUFS : res;
+    }
+    return (int)sent - dropped;
+}
+
 /** @} */
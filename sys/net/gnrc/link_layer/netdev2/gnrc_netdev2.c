@@ -99,6 +99,13 @@ static void _pass_on_packet(gnrc_pktsnip_t *pkt)
     }
 }
 
+static void _send_batched(gnrc_pktsnip_t *pkt, void *arg)
+{
+    gnrc_netdev2_t *gnrc_netdev2 = (gnrc_netdev2_t *)arg;
+
+    gnrc_netdev2->send(gnrc_netdev2, pkt);
+}
+
 /**
  * @brief   Startup code and event loop of the gnrc_netdev2 layer
  *
@@ -118,6 +125,9 @@ static void *_gnrc_netdev2_thread(void *args)
     gnrc_netapi_opt_t *opt;
     int res;
     msg_t msg, reply, msg_queue[NETDEV2_NETAPI_MSG_QUEUE_SIZE];
+    gnrc_netapi_batch_t batch;
+    int dropped;
+    unsigned handled = GNRC_NETAPI_BATCH_SIZE;
 
     /* setup the MAC layers message queue */
     msg_init_queue(msg_queue, NETDEV2_NETAPI_MSG_QUEUE_SIZE);
@@ -134,8 +144,18 @@ static void *_gnrc_netdev2_thread(void *args)
 
     /* start the event loop */
     while (1) {
-        DEBUG("gnrc_netdev2: waiting for incoming messages\n");
-        msg_receive(&msg);
+        /* handle already queued messages in one go, so the packets passed
+         * up meanwhile reach the upper layer in a single batch */
+        if ((handled >= GNRC_NETAPI_BATCH_SIZE) || (msg_try_receive(&msg) != 1)) {
+            if ((dropped = gnrc_netapi_batch_end()) > 0) {
+                DEBUG("gnrc_netdev2: %d packets passed on were dropped\n", dropped);
+            }
+            DEBUG("gnrc_netdev2: waiting for incoming messages\n");
+            msg_receive(&msg);
+            gnrc_netapi_batch_begin(&batch);
+            handled = 0;
+        }
+        handled++;
         /* dispatch NETDEV and NETAPI messages */
         switch (msg.type) {
             case NETDEV2_MSG_TYPE_EVENT:
@@ -147,6 +167,10 @@ static void *_gnrc_netdev2_thread(void *args)
                 gnrc_pktsnip_t *pkt = (gnrc_pktsnip_t *)msg.content.ptr;
                 gnrc_netdev2->send(gnrc_netdev2, pkt);
                 break;
+            case GNRC_NETAPI_MSG_TYPE_SND_BATCH:
+                DEBUG("gnrc_netdev2: GNRC_NETAPI_MSG_TYPE_SND_BATCH received\n");
+                gnrc_netapi_batch_handle(&msg, _send_batched, gnrc_netdev2);
+                break;
             case GNRC_NETAPI_MSG_TYPE_SET:
                 /* read incoming options */
                 opt = (gnrc_netapi_opt_t *)msg.content.ptr;
@@ -155,6 +179,11 @@ static void *_gnrc_netdev2_thread(void *args)
                 /* set option for device driver */
                 res = dev->driver->set(dev, opt->opt, opt->data, opt->data_len);
                 DEBUG("gnrc_netdev2: response of netdev->set: %i\n", res);
+#ifdef MODULE_GNRC_NETIF
+                if (res >= 0) {
+                    gnrc_netif_opt_applied(opt->opt);
+                }
+#endif
                 /* send reply to calling thread */
                 reply.type = GNRC_NETAPI_MSG_TYPE_ACK;
                 reply.content.value = (uint32_t)res;
@@ -182,6 +211,76 @@ static void *_gnrc_netdev2_thread(void *args)
     return NULL;
 }
 
+gnrc_pktsnip_t *gnrc_netdev2_recv_pkt(netdev2_t *dev, size_t hdr_len,
+                                      void *info, size_t *headroom)
+{
+    int bytes_expected = dev->driver->recv(dev, NULL, 0, NULL);
+    size_t offset = gnrc_pktbuf_mark_headroom(hdr_len);
+    gnrc_pktsnip_t *pkt;
+    int nread;
+
+    if (bytes_expected <= 0) {
+        return NULL;
+    }
+    pkt = gnrc_pktbuf_add(NULL, NULL, offset + bytes_expected,
+                          GNRC_NETTYPE_UNDEF);
+    if (pkt == NULL) {
+        DEBUG("gnrc_netdev2: cannot allocate pktsnip.\n");
+        /* drop the frame */
+        dev->driver->recv(dev, NULL, bytes_expected, NULL);
+        return NULL;
+    }
+    /* let the driver write the frame right to its final position */
+    nread = dev->driver->recv(dev, (char *)pkt->data + offset, bytes_expected,
+                              info);
+    if (nread <= 0) {
+        DEBUG("gnrc_netdev2: read error.\n");
+        gnrc_pktbuf_release(pkt);
+        return NULL;
+    }
+    if (nread < bytes_expected) {
+        /* shrinking does not move the data */
+        gnrc_pktbuf_realloc_data(pkt, offset + nread);
+    }
+    *headroom = offset;
+    return pkt;
+}
+
+gnrc_pktsnip_t *gnrc_netdev2_get_iovec(gnrc_pktsnip_t *pkt, void *hdr,
+                                       size_t hdr_len, struct iovec **vector,
+                                       size_t *n)
+{
+    gnrc_pktsnip_t *vec_snip, *l2_hdr = NULL;
+
+    /* the netif header is not sent, so the chain behind it can be changed
+     * if it is not shared */
+    if ((pkt->users == 1) && (pkt->next != NULL) &&
+        (gnrc_pktbuf_headroom(pkt->next) >= hdr_len)) {
+        l2_hdr = gnrc_pktbuf_add(pkt->next, hdr, hdr_len, GNRC_NETTYPE_UNDEF);
+        if (l2_hdr != NULL) {
+            pkt->next = l2_hdr;
+        }
+    }
+    vec_snip = gnrc_pktbuf_get_iovec(pkt, n);
+    if (vec_snip == NULL) {
+        if (l2_hdr != NULL) {
+            pkt->next = gnrc_pktbuf_remove_snip(l2_hdr, l2_hdr);
+        }
+        return NULL;
+    }
+    *vector = (struct iovec *)vec_snip->data;
+    if (l2_hdr != NULL) {
+        /* header is in front of the payload, skip element of netif header */
+        (*vector)++;
+        (*n)--;
+    }
+    else {
+        (*vector)[0].iov_base = hdr;
+        (*vector)[0].iov_len = hdr_len;
+    }
+    return vec_snip;
+}
+
 kernel_pid_t gnrc_netdev2_init(char *stack, int stacksize, char priority,
                         const char *name, gnrc_netdev2_t *gnrc_netdev2)
 {
@@ -32,45 +32,27 @@
 static gnrc_pktsnip_t *_recv(gnrc_netdev2_t *gnrc_netdev2)
 {
     netdev2_t *dev = gnrc_netdev2->dev;
-    int bytes_expected = dev->driver->recv(dev, NULL, 0, NULL);
-    gnrc_pktsnip_t *pkt = NULL;
+    size_t headroom;
+    gnrc_pktsnip_t *pkt = gnrc_netdev2_recv_pkt(dev, sizeof(ethernet_hdr_t),
+                                                NULL, &headroom);
 
-    if (bytes_expected) {
-        pkt = gnrc_pktbuf_add(NULL, NULL,
-                bytes_expected,
-                GNRC_NETTYPE_UNDEF);
+    if (pkt) {
+        int nread = pkt->size - headroom;
 
-        if(!pkt) {
-            DEBUG("_recv_ethernet_packet: cannot allocate pktsnip.\n");
-
-            /* drop the packet */
-            dev->driver->recv(dev, NULL, bytes_expected, NULL);
-
-            goto out;
-        }
-
-        int nread = dev->driver->recv(dev, pkt->data, bytes_expected, NULL);
-        if(nread <= 0) {
-            DEBUG("_recv_ethernet_packet: read error.\n");
+        if (nread <= (int)sizeof(ethernet_hdr_t)) {
+            DEBUG("_recv_ethernet_packet: frame without payload.\n");
             goto safe_out;
         }
 
-        if (nread < bytes_expected) {
-            /* we've got less then the expected packet size,
-             * so free the unused space.*/
-
-            DEBUG("_recv_ethernet_packet: reallocating.\n");
-            gnrc_pktbuf_realloc_data(pkt, nread);
-        }
-
-        /* mark ethernet header */
-        gnrc_pktsnip_t *eth_hdr = gnrc_pktbuf_mark(pkt, sizeof(ethernet_hdr_t), GNRC_NETTYPE_UNDEF);
+        /* mark ethernet header (and the headroom in front of it) */
+        gnrc_pktsnip_t *eth_hdr = gnrc_pktbuf_mark(pkt, headroom + sizeof(ethernet_hdr_t),
+                                                   GNRC_NETTYPE_UNDEF);
         if (!eth_hdr) {
             DEBUG("gnrc_netdev2_eth: no space left in packet buffer\n");
             goto safe_out;
         }
 
-        ethernet_hdr_t *hdr = (ethernet_hdr_t *)eth_hdr->data;
+        ethernet_hdr_t *hdr = (ethernet_hdr_t *)((uint8_t *)eth_hdr->data + headroom);
 
         /* set payload type from ethertype */
         pkt->type = gnrc_nettype_from_ethertype(byteorder_ntohs(hdr->type));
@@ -104,7 +86,6 @@ static gnrc_pktsnip_t *_recv(gnrc_netdev2_t *gnrc_netdev2)
         LL_APPEND(pkt, netif_hdr);
     }
 
-out:
     return pkt;
 
 safe_out:
@@ -199,14 +180,13 @@ static int _send(gnrc_netdev2_t *gnrc_netdev2, gnrc_pktsnip_t *pkt)
           hdr.dst[3], hdr.dst[4], hdr.dst[5]);
 
     size_t n;
-    payload = gnrc_pktbuf_get_iovec(pkt, &n);   /* use payload as temporary
-                                                 * variable */
+    struct iovec *vector;
+    payload = gnrc_netdev2_get_iovec(pkt, &hdr, sizeof(ethernet_hdr_t),
+                                     &vector, &n);  /* use payload as temporary
+                                                     * variable */
     res = -ENOBUFS;
     if (payload != NULL) {
         pkt = payload;      /* reassign for later release; vec_snip is prepended to pkt */
-        struct iovec *vector = (struct iovec *)pkt->data;
-        vector[0].iov_base = (char*)&hdr;
-        vector[0].iov_len = sizeof(ethernet_hdr_t);
 #ifdef MODULE_NETSTATS_L2
         if ((netif_hdr->flags & GNRC_NETIF_HDR_FLAGS_BROADCAST) ||
             (netif_hdr->flags & GNRC_NETIF_HDR_FLAGS_MULTICAST)) {
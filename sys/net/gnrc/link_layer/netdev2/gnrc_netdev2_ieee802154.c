@@ -64,75 +64,86 @@ static gnrc_pktsnip_t *_make_netif_hdr(uint8_t *mhr)
     return snip;
 }
 
+/**
+ * @brief   Guesses the MAC header length of incoming frames from the
+ *          addressing the device uses itself
+ */
+static size_t _expected_mhr_len(netdev2_ieee802154_t *state)
+{
+    size_t addr_len = (state->flags & NETDEV2_IEEE802154_SRC_MODE_LONG) ?
+                      IEEE802154_LONG_ADDRESS_LEN : IEEE802154_SHORT_ADDRESS_LEN;
+    /* FCF, sequence number, destination PAN, addresses */
+    size_t len = 3U + 2U + (2 * addr_len);
+
+    if (!(state->flags & NETDEV2_IEEE802154_PAN_COMP)) {
+        len += 2U;  /* source PAN */
+    }
+    return len;
+}
+
 static gnrc_pktsnip_t *_recv(gnrc_netdev2_t *gnrc_netdev2)
 {
     netdev2_t *netdev = gnrc_netdev2->dev;
     netdev2_ieee802154_rx_info_t rx_info;
     netdev2_ieee802154_t *state = (netdev2_ieee802154_t *)gnrc_netdev2->dev;
+    size_t headroom = 0;
     gnrc_pktsnip_t *pkt = NULL;
-    int bytes_expected = netdev->driver->recv(netdev, NULL, 0, NULL);
 
-    if (bytes_expected > 0) {
-        int nread;
+    if (state->flags & NETDEV2_IEEE802154_RAW) {
+        /* no header to mark: without headroom the frame is passed up as is */
+        return gnrc_netdev2_recv_pkt(netdev, 0, &rx_info, &headroom);
+    }
+    pkt = gnrc_netdev2_recv_pkt(netdev, _expected_mhr_len(state), &rx_info,
+                                &headroom);
+    if (pkt != NULL) {
+        gnrc_pktsnip_t *ieee802154_hdr, *netif_hdr;
+        gnrc_netif_hdr_t *hdr;
+        uint8_t *mhr = (uint8_t *)pkt->data + headroom;
+#if ENABLE_DEBUG
+        char src_str[GNRC_NETIF_HDR_L2ADDR_PRINT_LEN];
+#endif
+        size_t mhr_len = ieee802154_get_frame_hdr_len(mhr);
+        int nread = pkt->size - headroom;
 
-        pkt = gnrc_pktbuf_add(NULL, NULL, bytes_expected, GNRC_NETTYPE_UNDEF);
-        if (pkt == NULL) {
-            DEBUG("_recv_ieee802154: cannot allocate pktsnip.\n");
+        if ((mhr_len == 0) || (mhr_len >= (size_t)nread)) {
+            DEBUG("_recv_ieee802154: illegally formatted frame received\n");
+            gnrc_pktbuf_release(pkt);
             return NULL;
         }
-        nread = netdev->driver->recv(netdev, pkt->data, bytes_expected, &rx_info);
-        if (nread <= 0) {
+        nread -= mhr_len;
+        /* mark IEEE 802.15.4 header (and the headroom in front of it); if
+         * the guessed header length was right, this does not move the
+         * payload */
+        ieee802154_hdr = gnrc_pktbuf_mark(pkt, headroom + mhr_len,
+                                          GNRC_NETTYPE_UNDEF);
+        if (ieee802154_hdr == NULL) {
+            DEBUG("_recv_ieee802154: no space left in packet buffer\n");
             gnrc_pktbuf_release(pkt);
             return NULL;
         }
-        if (!(state->flags & NETDEV2_IEEE802154_RAW)) {
-            gnrc_pktsnip_t *ieee802154_hdr, *netif_hdr;
-            gnrc_netif_hdr_t *hdr;
-#if ENABLE_DEBUG
-            char src_str[GNRC_NETIF_HDR_L2ADDR_PRINT_LEN];
-#endif
-            size_t mhr_len = ieee802154_get_frame_hdr_len(pkt->data);
-
-            if (mhr_len == 0) {
-                DEBUG("_recv_ieee802154: illegally formatted frame received\n");
-                gnrc_pktbuf_release(pkt);
-                return NULL;
-            }
-            nread -= mhr_len;
-            /* mark IEEE 802.15.4 header */
-            ieee802154_hdr = gnrc_pktbuf_mark(pkt, mhr_len, GNRC_NETTYPE_UNDEF);
-            if (ieee802154_hdr == NULL) {
-                DEBUG("_recv_ieee802154: no space left in packet buffer\n");
-                gnrc_pktbuf_release(pkt);
-                return NULL;
-            }
-            netif_hdr = _make_netif_hdr(ieee802154_hdr->data);
-            if (netif_hdr == NULL) {
-                DEBUG("_recv_ieee802154: no space left in packet buffer\n");
-                gnrc_pktbuf_release(pkt);
-                return NULL;
-            }
-            hdr = netif_hdr->data;
-            hdr->lqi = rx_info.lqi;
-            hdr->rssi = rx_info.rssi;
-            hdr->if_pid = thread_getpid();
-            pkt->type = state->proto;
+        netif_hdr = _make_netif_hdr((uint8_t *)ieee802154_hdr->data + headroom);
+        if (netif_hdr == NULL) {
+            DEBUG("_recv_ieee802154: no space left in packet buffer\n");
+            gnrc_pktbuf_release(pkt);
+            return NULL;
+        }
+        hdr = netif_hdr->data;
+        hdr->lqi = rx_info.lqi;
+        hdr->rssi = rx_info.rssi;
+        hdr->if_pid = thread_getpid();
+        pkt->type = state->proto;
 #if ENABLE_DEBUG
-            DEBUG("_recv_ieee802154: received packet from %s of length %u\n",
-                  gnrc_netif_addr_to_str(src_str, sizeof(src_str),
-                                         gnrc_netif_hdr_get_src_addr(hdr),
-                                         hdr->src_l2addr_len),
-                  nread);
+        DEBUG("_recv_ieee802154: received packet from %s of length %u\n",
+              gnrc_netif_addr_to_str(src_str, sizeof(src_str),
+                                     gnrc_netif_hdr_get_src_addr(hdr),
+                                     hdr->src_l2addr_len),
+              nread);
 #if defined(MODULE_OD)
-            od_hex_dump(pkt->data, nread, OD_WIDTH_DEFAULT);
+        od_hex_dump(pkt->data, nread, OD_WIDTH_DEFAULT);
 #endif
 #endif
-            gnrc_pktbuf_remove_snip(pkt, ieee802154_hdr);
-            LL_APPEND(pkt, netif_hdr);
-        }
-
-        DEBUG("_recv_ieee802154: reallocating.\n");
-        gnrc_pktbuf_realloc_data(pkt, nread);
+        gnrc_pktbuf_remove_snip(pkt, ieee802154_hdr);
+        LL_APPEND(pkt, netif_hdr);
     }
 
     return pkt;
@@ -144,6 +155,7 @@ static int _send(gnrc_netdev2_t *gnrc_netdev2, gnrc_pktsnip_t *pkt)
     netdev2_ieee802154_t *state = (netdev2_ieee802154_t *)gnrc_netdev2->dev;
     gnrc_netif_hdr_t *netif_hdr;
     gnrc_pktsnip_t *vec_snip;
+    struct iovec *vector;
     uint8_t *src, *dst = NULL;
     int res = 0;
     size_t n, src_len;
@@ -190,14 +202,9 @@ static int _send(gnrc_netdev2_t *gnrc_netdev2, gnrc_pktsnip_t *pkt)
         return -EINVAL;
     }
     /* prepare packet for sending */
-    vec_snip = gnrc_pktbuf_get_iovec(pkt, &n);
+    vec_snip = gnrc_netdev2_get_iovec(pkt, mhr, (size_t)res, &vector, &n);
     if (vec_snip != NULL) {
-        struct iovec *vector;
-
         pkt = vec_snip;     /* reassign for later release; vec_snip is prepended to pkt */
-        vector = (struct iovec *)pkt->data;
-        vector[0].iov_base = mhr;
-        vector[0].iov_len = (size_t)res;
 #ifdef MODULE_NETSTATS_L2
         if (flags & IEEE802154_BCAST) {
             gnrc_netdev2->dev->stats.tx_mcast_count++;
@@ -99,6 +99,11 @@ static void *_nomac_thread(void *args)
                 /* set option for device driver */
                 res = dev->driver->set(dev, opt->opt, opt->data, opt->data_len);
                 DEBUG("nomac: response of netdev->set: %i\n", res);
+#ifdef MODULE_GNRC_NETIF
+                if (res >= 0) {
+                    gnrc_netif_opt_applied(opt->opt);
+                }
+#endif
                 /* send reply to calling thread */
                 reply.type = GNRC_NETAPI_MSG_TYPE_ACK;
                 reply.content.value = (uint32_t)res;
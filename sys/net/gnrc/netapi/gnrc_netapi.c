@@ -18,14 +18,51 @@
  * @}
  */
 
+#include "assert.h"
 #include "msg.h"
+#include "irq.h"
 #include "net/gnrc/netreg.h"
 #include "net/gnrc/pktbuf.h"
 #include "net/gnrc/netapi.h"
 
+#ifdef MODULE_GNRC_NETAPI_MBOX
+#include "xtimer.h"
+#endif
+
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
 
+#ifdef MODULE_GNRC_NETAPI_BATCH
+/**
+ * @brief   Batch currently collected by each thread, NULL if none
+ */
+static gnrc_netapi_batch_t *_batches[MAXTHREADS];
+
+/**
+ * @brief   Threads that handle batch messages
+ *
+ * @details The thread is stored instead of a mark per PID, so a thread that
+ *          gets the PID of an exited batch handler with another stack is
+ *          not passed batches either.
+ */
+static thread_t *_batch_capable[MAXTHREADS];
+
+static inline bool _is_batch_capable(kernel_pid_t pid)
+{
+    thread_t *thread = _batch_capable[pid - KERNEL_PID_FIRST];
+
+    return (thread != NULL) && (thread == thread_get(pid));
+}
+
+static inline gnrc_netapi_batch_t *_batch(void)
+{
+    if (irq_is_in()) {
+        return NULL;
+    }
+    return _batches[sched_active_pid - KERNEL_PID_FIRST];
+}
+#endif
+
 /**
  * @brief   Unified function for getting and setting netapi options
  *
@@ -59,7 +96,7 @@ static inline int _get_set(kernel_pid_t pid, uint16_t type,
     return (int)ack.content.value;
 }
 
-static inline int _snd_rcv(kernel_pid_t pid, uint16_t type, gnrc_pktsnip_t *pkt)
+static inline int _send_msg(kernel_pid_t pid, uint16_t type, gnrc_pktsnip_t *pkt)
 {
     msg_t msg;
     /* set the outgoing message's fields */
@@ -74,23 +111,101 @@ static inline int _snd_rcv(kernel_pid_t pid, uint16_t type, gnrc_pktsnip_t *pkt)
     return ret;
 }
 
+#ifdef MODULE_GNRC_NETAPI_BATCH
+static void _batch_flush(gnrc_netapi_batch_t *batch)
+{
+    gnrc_pktsnip_t *container;
+
+    if (batch->numof == 0) {
+        return;
+    }
+    if (batch->numof == 1) {
+        if (_send_msg(batch->pid, batch->type, batch->pkts[0]) < 1) {
+            gnrc_pktbuf_release(batch->pkts[0]);
+            batch->dropped++;
+        }
+        batch->numof = 0;
+        return;
+    }
+    container = gnrc_pktbuf_add(NULL, batch->pkts,
+                                batch->numof * sizeof(gnrc_pktsnip_t *),
+                                GNRC_NETTYPE_UNDEF);
+    if (container == NULL) {
+        /* no space for the container: pass the packets on one by one */
+        DEBUG("gnrc_netapi: no space for batch container, sending singly\n");
+        for (unsigned i = 0; i < batch->numof; i++) {
+            if (_send_msg(batch->pid, batch->type, batch->pkts[i]) < 1) {
+                gnrc_pktbuf_release(batch->pkts[i]);
+                batch->dropped++;
+            }
+        }
+    }
+    else if (_send_msg(batch->pid, (batch->type == GNRC_NETAPI_MSG_TYPE_RCV) ?
+                       GNRC_NETAPI_MSG_TYPE_RCV_BATCH :
+                       GNRC_NETAPI_MSG_TYPE_SND_BATCH, container) < 1) {
+        DEBUG("gnrc_netapi: dropped batch of %u packets\n",
+              (unsigned)batch->numof);
+        for (unsigned i = 0; i < batch->numof; i++) {
+            gnrc_pktbuf_release(batch->pkts[i]);
+        }
+        gnrc_pktbuf_release(container);
+        batch->dropped += batch->numof;
+    }
+    batch->numof = 0;
+}
+#endif
+
+static int _snd_rcv(kernel_pid_t pid, uint16_t type, gnrc_pktsnip_t *pkt)
+{
+#ifdef MODULE_GNRC_NETAPI_BATCH
+    gnrc_netapi_batch_t *batch = _batch();
+
+    if ((batch != NULL) && pid_is_valid(pid) && _is_batch_capable(pid)) {
+        if ((batch->numof > 0) && ((batch->pid != pid) ||
+                                   (batch->type != type) ||
+                                   (batch->numof == GNRC_NETAPI_BATCH_SIZE))) {
+            _batch_flush(batch);
+        }
+        batch->pid = pid;
+        batch->type = type;
+        batch->pkts[batch->numof++] = pkt;
+        return 1;
+    }
+#endif
+    return _send_msg(pid, type, pkt);
+}
+
+static inline int _deliver(gnrc_netreg_entry_t *entry, uint16_t cmd,
+                           gnrc_pktsnip_t *pkt)
+{
+#ifdef MODULE_GNRC_NETAPI_MBOX
+    if (entry->mbox != NULL) {
+        return gnrc_netapi_mbox_put(entry->mbox, pkt);
+    }
+#endif
+    return _snd_rcv(entry->pid, cmd, pkt);
+}
+
 int gnrc_netapi_dispatch(gnrc_nettype_t type, uint32_t demux_ctx,
                          uint16_t cmd, gnrc_pktsnip_t *pkt)
 {
-    int numof = gnrc_netreg_num(type, demux_ctx);
-
-    if (numof != 0) {
-        gnrc_netreg_entry_t *sendto = gnrc_netreg_lookup(type, demux_ctx);
+    int numof = 0;
+    gnrc_netreg_entry_t *sendto = gnrc_netreg_lookup(type, demux_ctx);
 
-        gnrc_pktbuf_hold(pkt, numof - 1);
+    while (sendto) {
+        gnrc_netreg_entry_t *next = gnrc_netreg_getnext(sendto);
 
-        while (sendto) {
-            if (_snd_rcv(sendto->pid, cmd, pkt) < 1) {
-                /* unable to dispatch packet */
-                gnrc_pktbuf_release(pkt);
-            }
-            sendto = gnrc_netreg_getnext(sendto);
+        /* hold for the next subscriber before handing the packet to the
+         * current one, which might release it right away */
+        if (next != NULL) {
+            gnrc_pktbuf_hold(pkt, 1);
+        }
+        if (_deliver(sendto, cmd, pkt) < 1) {
+            /* unable to dispatch packet */
+            gnrc_pktbuf_release(pkt);
         }
+        numof++;
+        sendto = next;
     }
 
     return numof;
@@ -119,3 +234,324 @@ int gnrc_netapi_set(kernel_pid_t pid, netopt_t opt, uint16_t context,
     return _get_set(pid, GNRC_NETAPI_MSG_TYPE_SET, opt, context,
                     data, data_len);
 }
+
+void gnrc_netapi_batch_collect(gnrc_netapi_batch_t *batch)
+{
+#ifdef MODULE_GNRC_NETAPI_BATCH
+    batch->numof = 0;
+    batch->dropped = 0;
+    _batches[sched_active_pid - KERNEL_PID_FIRST] = batch;
+#else
+    (void)batch;
+#endif
+}
+
+void gnrc_netapi_batch_begin(gnrc_netapi_batch_t *batch)
+{
+#ifdef MODULE_GNRC_NETAPI_BATCH
+    _batch_capable[sched_active_pid - KERNEL_PID_FIRST] =
+        (thread_t *)sched_active_thread;
+#endif
+    gnrc_netapi_batch_collect(batch);
+}
+
+int gnrc_netapi_batch_end(void)
+{
+#ifdef MODULE_GNRC_NETAPI_BATCH
+    gnrc_netapi_batch_t *batch = _batches[sched_active_pid - KERNEL_PID_FIRST];
+
+    _batches[sched_active_pid - KERNEL_PID_FIRST] = NULL;
+    if (batch != NULL) {
+        _batch_flush(batch);
+        return (int)batch->dropped;
+    }
+#endif
+    return 0;
+}
+
+bool gnrc_netapi_batch_collects(kernel_pid_t pid)
+{
+#ifdef MODULE_GNRC_NETAPI_BATCH
+    return (_batch() != NULL) && pid_is_valid(pid) && _is_batch_capable(pid);
+#else
+    (void)pid;
+    return false;
+#endif
+}
+
+void gnrc_netapi_batch_disable(kernel_pid_t pid)
+{
+#ifdef MODULE_GNRC_NETAPI_BATCH
+    if (pid_is_valid(pid)) {
+        _batch_capable[pid - KERNEL_PID_FIRST] = NULL;
+    }
+#else
+    (void)pid;
+#endif
+}
+
+void gnrc_netapi_batch_handle(msg_t *msg,
+                              void (*cb)(gnrc_pktsnip_t *pkt, void *arg),
+                              void *arg)
+{
+    gnrc_pktsnip_t *container = (gnrc_pktsnip_t *)msg->content.ptr;
+    gnrc_pktsnip_t **pkts = container->data;
+
+    for (size_t i = 0; i < (container->size / sizeof(gnrc_pktsnip_t *)); i++) {
+        cb(pkts[i], arg);
+    }
+    gnrc_pktbuf_release(container);
+}
+
+#ifdef MODULE_GNRC_NETAPI_MBOX
+void gnrc_netapi_mbox_init(gnrc_netapi_mbox_t *mbox, gnrc_pktsnip_t **queue,
+                           unsigned size, thread_flags_t flag)
+{
+    mbox->queue = queue;
+    cib_init(&mbox->cib, size);
+    mbox->reader = sched_active_pid;
+    mbox->flag = flag;
+    mbox->drops = 0;
+    mbox->set = NULL;
+    mbox->in_ready = 0;
+    mbox->notified = 0;
+}
+
+static void _signal(kernel_pid_t pid, thread_flags_t flag)
+{
+    thread_t *thread = (thread_t *)thread_get(pid);
+
+    if (thread != NULL) {
+        thread_flags_set(thread, flag);
+    }
+}
+
+/**
+ * @pre Interrupts are disabled
+ */
+static void _ready_append(gnrc_netapi_mbox_set_t *set, gnrc_netapi_mbox_t *mbox)
+{
+    mbox->ready_next = NULL;
+    if (set->ready == NULL) {
+        set->ready = mbox;
+    }
+    else {
+        set->ready_tail->ready_next = mbox;
+    }
+    set->ready_tail = mbox;
+    mbox->in_ready = 1;
+}
+
+int gnrc_netapi_mbox_put(gnrc_netapi_mbox_t *mbox, gnrc_pktsnip_t *pkt)
+{
+    unsigned state = irq_disable();
+    int idx = cib_put(&mbox->cib);
+    gnrc_netapi_mbox_set_t *set;
+    kernel_pid_t owner = KERNEL_PID_UNDEF;
+    thread_flags_t owner_flag = 0;
+
+    if (idx < 0) {
+        mbox->drops++;
+        irq_restore(state);
+        DEBUG("gnrc_netapi: mailbox %p full, dropping packet\n", (void *)mbox);
+        return -1;
+    }
+    mbox->queue[idx] = pkt;
+    if ((set = mbox->set) != NULL) {
+        if (!mbox->in_ready) {
+            _ready_append(set, mbox);
+        }
+        owner = set->owner;
+        owner_flag = set->flag;
+    }
+    irq_restore(state);
+    /* signalling may switch threads, so not with interrupts disabled */
+    _signal(owner, owner_flag);
+    _signal(mbox->reader, mbox->flag);
+    return 1;
+}
+
+void gnrc_netapi_mbox_notify(gnrc_netapi_mbox_t *mbox)
+{
+    unsigned state = irq_disable();
+    gnrc_netapi_mbox_set_t *set;
+    kernel_pid_t owner = KERNEL_PID_UNDEF;
+    thread_flags_t owner_flag = 0;
+
+    if ((set = mbox->set) != NULL) {
+        mbox->notified = 1;
+        if (!mbox->in_ready) {
+            _ready_append(set, mbox);
+        }
+        owner = set->owner;
+        owner_flag = set->flag;
+    }
+    irq_restore(state);
+    _signal(owner, owner_flag);
+    _signal(mbox->reader, mbox->flag);
+}
+
+gnrc_pktsnip_t *gnrc_netapi_mbox_try_get(gnrc_netapi_mbox_t *mbox)
+{
+    gnrc_pktsnip_t *pkt = NULL;
+    unsigned state = irq_disable();
+    int idx = cib_get(&mbox->cib);
+
+    if (idx >= 0) {
+        pkt = mbox->queue[idx];
+    }
+    irq_restore(state);
+    return pkt;
+}
+
+gnrc_pktsnip_t *gnrc_netapi_mbox_peek(gnrc_netapi_mbox_t *mbox)
+{
+    gnrc_pktsnip_t *pkt = NULL;
+    unsigned state = irq_disable();
+
+    if (cib_avail(&mbox->cib) > 0) {
+        pkt = mbox->queue[mbox->cib.read_count & mbox->cib.mask];
+    }
+    irq_restore(state);
+    return pkt;
+}
+
+gnrc_pktsnip_t *gnrc_netapi_mbox_get(gnrc_netapi_mbox_t *mbox)
+{
+    gnrc_pktsnip_t *pkt;
+
+    /* become the reader before looking into the mailbox, so a packet put in
+     * between sets the flag and thread_flags_wait_any() returns right away */
+    mbox->reader = sched_active_pid;
+    while ((pkt = gnrc_netapi_mbox_try_get(mbox)) == NULL) {
+        thread_flags_wait_any(mbox->flag);
+    }
+    return pkt;
+}
+
+void gnrc_netapi_mbox_flush(gnrc_netapi_mbox_t *mbox)
+{
+    gnrc_pktsnip_t *pkt;
+
+    while ((pkt = gnrc_netapi_mbox_try_get(mbox)) != NULL) {
+        gnrc_pktbuf_release(pkt);
+    }
+}
+
+void gnrc_netapi_mbox_set_init(gnrc_netapi_mbox_set_t *set, thread_flags_t flag)
+{
+    set->ready = NULL;
+    set->ready_tail = NULL;
+    set->owner = sched_active_pid;
+    set->flag = flag;
+}
+
+void gnrc_netapi_mbox_set_add(gnrc_netapi_mbox_set_t *set,
+                              gnrc_netapi_mbox_t *mbox, void *ctx)
+{
+    unsigned state = irq_disable();
+
+    assert(mbox->set == NULL);
+    mbox->ctx = ctx;
+    mbox->set = set;
+    mbox->notified = 0;
+    if (cib_avail(&mbox->cib) > 0) {
+        _ready_append(set, mbox);
+    }
+    irq_restore(state);
+}
+
+void gnrc_netapi_mbox_set_remove(gnrc_netapi_mbox_t *mbox)
+{
+    unsigned state = irq_disable();
+    gnrc_netapi_mbox_set_t *set = mbox->set;
+
+    if ((set != NULL) && mbox->in_ready) {
+        gnrc_netapi_mbox_t *prev = NULL;
+
+        for (gnrc_netapi_mbox_t *cur = set->ready; cur != mbox;
+             cur = cur->ready_next) {
+            prev = cur;
+        }
+        if (prev == NULL) {
+            set->ready = mbox->ready_next;
+        }
+        else {
+            prev->ready_next = mbox->ready_next;
+        }
+        if (set->ready_tail == mbox) {
+            set->ready_tail = prev;
+        }
+        mbox->in_ready = 0;
+    }
+    mbox->set = NULL;
+    irq_restore(state);
+}
+
+/**
+ * @brief   Takes up to @p max mailboxes with packets from the front of
+ *          gnrc_netapi_mbox_set_t::ready and appends them again to its end
+ */
+static unsigned _set_collect(gnrc_netapi_mbox_set_t *set,
+                             gnrc_netapi_mbox_t **ready, unsigned max)
+{
+    unsigned state = irq_disable();
+    unsigned n = 0;
+
+    while ((n < max) && (set->ready != NULL)) {
+        gnrc_netapi_mbox_t *mbox = set->ready;
+
+        set->ready = mbox->ready_next;
+        mbox->in_ready = 0;
+        /* mailboxes emptied by their reader are dropped from the list */
+        if ((cib_avail(&mbox->cib) > 0) || mbox->notified) {
+            mbox->notified = 0;
+            ready[n++] = mbox;
+        }
+    }
+    for (unsigned i = 0; i < n; i++) {
+        _ready_append(set, ready[i]);
+    }
+    irq_restore(state);
+    return n;
+}
+
+static void _set_timeout(void *arg)
+{
+    _signal((kernel_pid_t)(intptr_t)arg, THREAD_FLAG_TIMEOUT);
+}
+
+int gnrc_netapi_mbox_set_wait(gnrc_netapi_mbox_set_t *set,
+                              gnrc_netapi_mbox_t **ready, unsigned max,
+                              uint32_t timeout)
+{
+    xtimer_t timer = { .callback = _set_timeout,
+                       .arg = (void *)(intptr_t)sched_active_pid };
+    unsigned n;
+
+    /* become the owner before looking at the set, so a packet put in between
+     * sets the flag and thread_flags_wait_any() returns right away */
+    set->owner = sched_active_pid;
+    if (((n = _set_collect(set, ready, max)) > 0) || (timeout == 0)) {
+        return n;
+    }
+    /* a timeout flag left over from an earlier wait must not end this one */
+    thread_flags_clear(THREAD_FLAG_TIMEOUT);
+    if (timeout != GNRC_NETAPI_MBOX_WAIT_FOREVER) {
+        xtimer_set(&timer, timeout);
+    }
+    while ((n = _set_collect(set, ready, max)) == 0) {
+        if (thread_flags_wait_any(set->flag | THREAD_FLAG_TIMEOUT) &
+            THREAD_FLAG_TIMEOUT) {
+            if (timeout != GNRC_NETAPI_MBOX_WAIT_FOREVER) {
+                break;
+            }
+        }
+    }
+    if (timeout != GNRC_NETAPI_MBOX_WAIT_FOREVER) {
+        xtimer_remove(&timer);
+        thread_flags_clear(THREAD_FLAG_TIMEOUT);
+    }
+    return n;
+}
+#endif
@@ -33,6 +33,7 @@ static gnrc_netif_handler_t if_handler[] = {
 };
 
 static kernel_pid_t ifs[GNRC_NETIF_NUMOF];
+static uint32_t _l2addr_gen;
 
 void gnrc_netif_init(void)
 {
@@ -107,4 +108,14 @@ bool gnrc_netif_exist(kernel_pid_t pid)
     return false;
 }
 
+uint32_t gnrc_netif_get_l2addr_gen(void)
+{
+    return _l2addr_gen;
+}
+
+void gnrc_netif_update_l2addr_gen(void)
+{
+    _l2addr_gen++;
+}
+
 /** @} */
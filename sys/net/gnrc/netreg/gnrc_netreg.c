@@ -13,50 +13,128 @@
  */
 
 #include <errno.h>
+#include <stdbool.h>
 #include <string.h>
 
 #include "assert.h"
 #include "clist.h"
 #include "utlist.h"
+#include "net/gnrc/netapi.h"
 #include "net/gnrc/netreg.h"
 #include "net/gnrc/nettype.h"
 #include "net/gnrc/pkt.h"
 #include "net/gnrc/icmpv6.h"
 #include "net/gnrc/ipv6.h"
+#include "net/gnrc/tcp.h"
 #include "net/gnrc/udp.h"
 
 #define _INVALID_TYPE(type) (((type) < GNRC_NETTYPE_UNDEF) || ((type) >= GNRC_NETTYPE_NUMOF))
 
-/* The registry as lookup table by gnrc_nettype_t */
-static gnrc_netreg_entry_t *netreg[GNRC_NETTYPE_NUMOF];
+#if (GNRC_NETREG_BUCKETS & (GNRC_NETREG_BUCKETS - 1)) != 0
+#error "GNRC_NETREG_BUCKETS must be a power of 2"
+#endif
+
+/* The registry as lookup table by gnrc_nettype_t and hash of demux_ctx */
+static gnrc_netreg_entry_t *netreg[GNRC_NETTYPE_NUMOF][GNRC_NETREG_BUCKETS];
+
+static inline gnrc_netreg_entry_t **_bucket(gnrc_nettype_t type, uint32_t demux_ctx)
+{
+    /* fold upper half in, so GNRC_NETREG_DEMUX_CTX_ALL does not collide with
+     * demux context 0 */
+    return &netreg[type][(demux_ctx ^ (demux_ctx >> 16)) & (GNRC_NETREG_BUCKETS - 1)];
+}
 
 void gnrc_netreg_init(void)
 {
     /* set all pointers in registry to NULL */
-    memset(netreg, 0, GNRC_NETTYPE_NUMOF * sizeof(gnrc_netreg_entry_t *));
+    memset(netreg, 0, sizeof(netreg));
 }
 
-int gnrc_netreg_register(gnrc_nettype_t type, gnrc_netreg_entry_t *entry)
+static int _register(gnrc_nettype_t type, gnrc_netreg_entry_t *entry)
 {
-    /* only threads with a message queue are allowed to register at gnrc */
-    assert(sched_threads[entry->pid]->msg_array);
+    gnrc_netreg_entry_t **bucket, *first;
 
     if (_INVALID_TYPE(type)) {
         return -EINVAL;
     }
 
-    LL_PREPEND(netreg[type], entry);
+    bucket = _bucket(type, entry->demux_ctx);
+    LL_SEARCH_SCALAR(*bucket, first, demux_ctx, entry->demux_ctx);
+
+    if (first == NULL) {
+        LL_PREPEND(*bucket, entry);
+    }
+    else {
+        /* keep entries with same demux context next to each other */
+        LL_PREPEND_ELEM(*bucket, first, entry);
+    }
 
     return 0;
 }
 
+int gnrc_netreg_register(gnrc_nettype_t type, gnrc_netreg_entry_t *entry)
+{
+    /* only threads with a message queue are allowed to register at gnrc */
+    assert(sched_threads[entry->pid]->msg_array);
+
+#ifdef MODULE_GNRC_NETAPI_MBOX
+    entry->mbox = NULL;
+#endif
+    return _register(type, entry);
+}
+
+#ifdef MODULE_GNRC_NETAPI_MBOX
+int gnrc_netreg_register_mbox(gnrc_nettype_t type, gnrc_netreg_entry_t *entry,
+                              struct gnrc_netapi_mbox *mbox)
+{
+    entry->mbox = mbox;
+    return _register(type, entry);
+}
+#endif
+
+#ifdef MODULE_GNRC_NETAPI_BATCH
+/* checks if a thread is still registered for packets to its message queue */
+static bool _is_registered(kernel_pid_t pid)
+{
+    for (unsigned type = 0; type < GNRC_NETTYPE_NUMOF; type++) {
+        for (unsigned i = 0; i < GNRC_NETREG_BUCKETS; i++) {
+            gnrc_netreg_entry_t *entry;
+
+            LL_FOREACH(netreg[type][i], entry) {
+#ifdef MODULE_GNRC_NETAPI_MBOX
+                if (entry->mbox != NULL) {
+                    continue;
+                }
+#endif
+                if (entry->pid == pid) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+#endif
+
 void gnrc_netreg_unregister(gnrc_nettype_t type, gnrc_netreg_entry_t *entry)
 {
     if (_INVALID_TYPE(type)) {
         return;
     }
 
-    LL_DELETE(netreg[type], entry);
+    LL_DELETE(*_bucket(type, entry->demux_ctx), entry);
+#ifdef MODULE_GNRC_NETAPI_BATCH
+    /* the thread might exit after its last registration and its PID be
+     * reused by a thread that does not handle batches */
+#ifdef MODULE_GNRC_NETAPI_MBOX
+    if (entry->mbox != NULL) {
+        return;
+    }
+#endif
+    if (!_is_registered(entry->pid)) {
+        gnrc_netapi_batch_disable(entry->pid);
+    }
+#endif
 }
 
 gnrc_netreg_entry_t *gnrc_netreg_lookup(gnrc_nettype_t type, uint32_t demux_ctx)
@@ -67,7 +145,7 @@ gnrc_netreg_entry_t *gnrc_netreg_lookup(gnrc_nettype_t type, uint32_t demux_ctx)
         return NULL;
     }
 
-    LL_SEARCH_SCALAR(netreg[type], res, demux_ctx, demux_ctx);
+    LL_SEARCH_SCALAR(*_bucket(type, demux_ctx), res, demux_ctx, demux_ctx);
 
     return res;
 }
@@ -75,20 +153,11 @@ gnrc_netreg_entry_t *gnrc_netreg_lookup(gnrc_nettype_t type, uint32_t demux_ctx)
 int gnrc_netreg_num(gnrc_nettype_t type, uint32_t demux_ctx)
 {
     int num = 0;
-    gnrc_netreg_entry_t *entry;
-
-    if (_INVALID_TYPE(type)) {
-        return 0;
-    }
-
-    entry = netreg[type];
+    gnrc_netreg_entry_t *entry = gnrc_netreg_lookup(type, demux_ctx);
 
     while (entry != NULL) {
-        if (entry->demux_ctx == demux_ctx) {
-            num++;
-        }
-
-        entry = entry->next;
+        num++;
+        entry = gnrc_netreg_getnext(entry);
     }
 
     return num;
@@ -96,17 +165,12 @@ int gnrc_netreg_num(gnrc_nettype_t type, uint32_t demux_ctx)
 
 gnrc_netreg_entry_t *gnrc_netreg_getnext(gnrc_netreg_entry_t *entry)
 {
-    uint32_t demux_ctx;
-
-    if (entry == NULL) {
+    if ((entry == NULL) || (entry->next == NULL) ||
+        (entry->next->demux_ctx != entry->demux_ctx)) {
         return NULL;
     }
 
-    demux_ctx = entry->demux_ctx;
-
-    LL_SEARCH_SCALAR(entry->next, entry, demux_ctx, demux_ctx);
-
-    return entry;
+    return entry->next;
 }
 
 int gnrc_netreg_calc_csum(gnrc_pktsnip_t *hdr, gnrc_pktsnip_t *pseudo_hdr)
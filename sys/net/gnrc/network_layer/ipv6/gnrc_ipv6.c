@@ -73,6 +73,9 @@ static void _receive(gnrc_pktsnip_t *pkt);
  * prep_hdr: prepare header for sending (call to _fill_ipv6_hdr()), otherwise
  * assume it is already prepared */
 static void _send(gnrc_pktsnip_t *pkt, bool prep_hdr);
+
+/* Fills a destination cache entry, called by the IPv6 thread */
+static int _dst_cache_fill(gnrc_ipv6_dst_cache_t *cache);
 /* Main event loop for IPv6 */
 static void *_event_loop(void *args);
 
@@ -238,9 +241,23 @@ static void _dispatch_next_header(gnrc_pktsnip_t *current, gnrc_pktsnip_t *pkt,
     }
 }
 
+static void _receive_batched(gnrc_pktsnip_t *pkt, void *arg)
+{
+    (void)arg;
+    _receive(pkt);
+}
+
+static void _send_batched(gnrc_pktsnip_t *pkt, void *arg)
+{
+    (void)arg;
+    _send(pkt, true);
+}
+
 static void *_event_loop(void *args)
 {
     msg_t msg, reply, msg_q[GNRC_IPV6_MSG_QUEUE_SIZE];
+    gnrc_netapi_batch_t batch;
+    int dropped;
     gnrc_netreg_entry_t me_reg;
 
     (void)args;
@@ -259,6 +276,7 @@ static void *_event_loop(void *args)
     while (1) {
         DEBUG("ipv6: waiting for incoming message.\n");
         msg_receive(&msg);
+        gnrc_netapi_batch_begin(&batch);
 
         switch (msg.type) {
             case GNRC_NETAPI_MSG_TYPE_RCV:
@@ -271,6 +289,16 @@ static void *_event_loop(void *args)
                 _send((gnrc_pktsnip_t *)msg.content.ptr, true);
                 break;
 
+            case GNRC_NETAPI_MSG_TYPE_RCV_BATCH:
+                DEBUG("ipv6: GNRC_NETAPI_MSG_TYPE_RCV_BATCH received\n");
+                gnrc_netapi_batch_handle(&msg, _receive_batched, NULL);
+                break;
+
+            case GNRC_NETAPI_MSG_TYPE_SND_BATCH:
+                DEBUG("ipv6: GNRC_NETAPI_MSG_TYPE_SND_BATCH received\n");
+                gnrc_netapi_batch_handle(&msg, _send_batched, NULL);
+                break;
+
             case GNRC_NETAPI_MSG_TYPE_GET:
             case GNRC_NETAPI_MSG_TYPE_SET:
                 DEBUG("ipv6: reply to unsupported get/set\n");
@@ -278,10 +306,18 @@ static void *_event_loop(void *args)
                 msg_reply(&msg, &reply);
                 break;
 
+            case GNRC_IPV6_MSG_DST_CACHE_FILL:
+                DEBUG("ipv6: fill destination cache entry\n");
+                reply.content.value =
+                    (uint32_t)_dst_cache_fill((gnrc_ipv6_dst_cache_t *)msg.content.ptr);
+                msg_reply(&msg, &reply);
+                break;
+
 #ifdef MODULE_GNRC_NDP
             case GNRC_NDP_MSG_RTR_TIMEOUT:
                 DEBUG("ipv6: Router timeout received\n");
                 ((gnrc_ipv6_nc_t *)msg.content.ptr)->flags &= ~GNRC_IPV6_NC_IS_ROUTER;
+                gnrc_ipv6_nc_update_gen();
                 break;
 
             /* XXX reactivate when https://github.com/RIOT-OS/RIOT/issues/5122 is
@@ -357,6 +393,9 @@ static void *_event_loop(void *args)
             default:
                 break;
         }
+        if ((dropped = gnrc_netapi_batch_end()) > 0) {
+            DEBUG("ipv6: %d packets passed on were dropped\n", dropped);
+        }
     }
 
     return NULL;
@@ -698,7 +737,26 @@ static void _send(gnrc_pktsnip_t *pkt, bool prep_hdr)
     hdr = ipv6->data;
     payload = ipv6->next;
 
-    if (ipv6_addr_is_multicast(&hdr->dst)) {
+    if ((pkt != ipv6) &&
+        (((gnrc_netif_hdr_t *)pkt->data)->flags & GNRC_NETIF_HDR_FLAGS_RESOLVED)) {
+        /* next hop was taken from a destination cache entry */
+        ((gnrc_netif_hdr_t *)pkt->data)->flags &= ~GNRC_NETIF_HDR_FLAGS_RESOLVED;
+
+        if (prep_hdr) {
+            if (_fill_ipv6_hdr(iface, ipv6, payload) < 0) {
+                /* error on filling up header */
+                gnrc_pktbuf_release(pkt);
+                return;
+            }
+        }
+
+        DEBUG("ipv6: send unicast over interface %" PRIkernel_pid " (cached)\n", iface);
+#ifdef MODULE_NETSTATS_IPV6
+        gnrc_ipv6_netif_get_stats(iface)->tx_unicast_count++;
+#endif
+        _send_to_iface(iface, pkt);
+    }
+    else if (ipv6_addr_is_multicast(&hdr->dst)) {
         _send_multicast(iface, pkt, ipv6, payload, prep_hdr);
     }
     else if ((ipv6_addr_is_loopback(&hdr->dst)) ||      /* dst is loopback address */
@@ -767,6 +825,111 @@ static void _send(gnrc_pktsnip_t *pkt, bool prep_hdr)
     }
 }
 
+/* destination cache */
+static int _dst_cache_fill(gnrc_ipv6_dst_cache_t *cache)
+{
+    uint8_t l2addr_len = GNRC_IPV6_NC_L2_ADDR_MAX;
+    ipv6_addr_t *src;
+    kernel_pid_t iface;
+
+    if (ipv6_addr_is_multicast(&cache->dst) || ipv6_addr_is_loopback(&cache->dst) ||
+        (gnrc_ipv6_netif_find_by_addr(&src, &cache->dst) != KERNEL_PID_UNDEF)) {
+        return -ENOTSUP;
+    }
+
+    /* take the generations before the lookup: if it changes anything itself
+     * (e.g. a STALE neighbor becomes DELAY) the entry is filled again on next
+     * use */
+    cache->nc_gen = gnrc_ipv6_nc_get_gen();
+    cache->netif_gen = gnrc_ipv6_netif_get_gen();
+#ifdef MODULE_FIB
+    cache->fib_gen = fib_get_gen(&gnrc_ipv6_fib_table);
+#endif
+
+    iface = _next_hop_l2addr(cache->l2addr, &l2addr_len, KERNEL_PID_UNDEF, &cache->dst,
+                             NULL);
+    if (iface <= KERNEL_PID_UNDEF) {
+        DEBUG("ipv6: next hop of %s not resolved, not caching\n",
+              ipv6_addr_to_str(addr_str, &cache->dst, sizeof(addr_str)));
+        return -EHOSTUNREACH;
+    }
+
+    if ((src = gnrc_ipv6_netif_find_best_src_addr(iface, &cache->dst, false)) == NULL) {
+        DEBUG("ipv6: no source address for %s, not caching\n",
+              ipv6_addr_to_str(addr_str, &cache->dst, sizeof(addr_str)));
+        return -EADDRNOTAVAIL;
+    }
+
+    memcpy(&cache->src, src, sizeof(ipv6_addr_t));
+    cache->l2addr_len = l2addr_len;
+    cache->iface = iface;
+
+    return 0;
+}
+
+bool gnrc_ipv6_dst_cache_valid(const gnrc_ipv6_dst_cache_t *cache, const ipv6_addr_t *dst)
+{
+    if ((cache->iface == KERNEL_PID_UNDEF) || !ipv6_addr_equal(&cache->dst, dst)) {
+        return false;
+    }
+
+#ifdef MODULE_FIB
+    if (cache->fib_gen != fib_get_gen(&gnrc_ipv6_fib_table)) {
+        return false;
+    }
+#endif
+
+    return (cache->nc_gen == gnrc_ipv6_nc_get_gen()) &&
+           (cache->netif_gen == gnrc_ipv6_netif_get_gen());
+}
+
+int gnrc_ipv6_dst_cache_fill(gnrc_ipv6_dst_cache_t *cache, const ipv6_addr_t *dst)
+{
+    msg_t msg, reply;
+
+    assert(thread_getpid() != gnrc_ipv6_pid);
+
+    gnrc_ipv6_dst_cache_init(cache);
+    if (gnrc_ipv6_pid == KERNEL_PID_UNDEF) {
+        return -ENOTSUP;
+    }
+
+    memcpy(&cache->dst, dst, sizeof(ipv6_addr_t));
+    msg.type = GNRC_IPV6_MSG_DST_CACHE_FILL;
+    msg.content.ptr = (char *)cache;
+    msg_send_receive(&msg, &reply, gnrc_ipv6_pid);
+
+    return (int)reply.content.value;
+}
+
+gnrc_pktsnip_t *gnrc_ipv6_dst_cache_hdr_build(const gnrc_ipv6_dst_cache_t *cache,
+                                              gnrc_pktsnip_t *payload,
+                                              const ipv6_addr_t *src)
+{
+    gnrc_pktsnip_t *ipv6, *netif;
+
+    if ((src == NULL) || ipv6_addr_is_unspecified(src)) {
+        src = &cache->src;
+    }
+
+    if ((ipv6 = gnrc_ipv6_hdr_build(payload, src, &cache->dst)) == NULL) {
+        return NULL;
+    }
+
+    netif = gnrc_netif_hdr_build(NULL, 0, (uint8_t *)cache->l2addr, cache->l2addr_len);
+    if (netif == NULL) {
+        /* only remove the IPv6 header, the payload stays with the caller */
+        gnrc_pktbuf_remove_snip(ipv6, ipv6);
+        return NULL;
+    }
+
+    ((gnrc_netif_hdr_t *)netif->data)->if_pid = cache->iface;
+    ((gnrc_netif_hdr_t *)netif->data)->flags = GNRC_NETIF_HDR_FLAGS_RESOLVED;
+    LL_PREPEND(ipv6, netif);
+
+    return netif;
+}
+
 /* functions for receiving */
 static inline bool _pkt_not_for_me(kernel_pid_t *iface, ipv6_hdr_t *hdr)
 {
@@ -13,6 +13,7 @@
  */
 
 #include <errno.h>
+#include <limits.h>
 #include <string.h>
 
 #include "net/gnrc/ipv6.h"
@@ -35,8 +36,113 @@
 static char addr_str[IPV6_ADDR_MAX_STR_LEN];
 #endif
 
+#define NC_NIL  (0U)    /**< end of a hash chain */
+
 static gnrc_ipv6_nc_t ncache[GNRC_IPV6_NC_SIZE];
 
+/* hash index: head of each bucket's chain and next pointers per entry. They
+ * hold the entry's index + 1, so the zero-initialized index is empty even
+ * without gnrc_ipv6_nc_init() */
+static uint16_t _nc_buckets[GNRC_IPV6_NC_HASH_SIZE];
+static uint16_t _nc_chain[GNRC_IPV6_NC_SIZE];
+/* last use of each entry for LRU replacement */
+static uint32_t _nc_last_used[GNRC_IPV6_NC_SIZE];
+static uint32_t _nc_clock;
+static gnrc_ipv6_nc_stats_t _nc_stats;
+static uint32_t _nc_gen;
+
+static inline unsigned _nc_hash(const ipv6_addr_t *ipv6_addr)
+{
+    uint32_t hash = ipv6_addr->u32[0].u32 ^ ipv6_addr->u32[1].u32 ^
+                    ipv6_addr->u32[2].u32 ^ ipv6_addr->u32[3].u32;
+
+    hash ^= (hash >> 16);
+    hash ^= (hash >> 8);
+    return hash & (GNRC_IPV6_NC_HASH_SIZE - 1);
+}
+
+static inline void _nc_touch(const gnrc_ipv6_nc_t *entry)
+{
+    _nc_last_used[entry - ncache] = ++_nc_clock;
+}
+
+static gnrc_ipv6_nc_t *_nc_find(const ipv6_addr_t *ipv6_addr)
+{
+    for (uint16_t i = _nc_buckets[_nc_hash(ipv6_addr)]; i != NC_NIL; i = _nc_chain[i - 1]) {
+        if (ipv6_addr_equal(&(ncache[i - 1].ipv6_addr), ipv6_addr)) {
+            return ncache + i - 1;
+        }
+    }
+
+    return NULL;
+}
+
+static void _nc_link(gnrc_ipv6_nc_t *entry)
+{
+    uint16_t *bucket = &_nc_buckets[_nc_hash(&entry->ipv6_addr)];
+
+    _nc_chain[entry - ncache] = *bucket;
+    *bucket = (uint16_t)(entry - ncache + 1);
+}
+
+static void _nc_unlink(gnrc_ipv6_nc_t *entry)
+{
+    uint16_t *i = &_nc_buckets[_nc_hash(&entry->ipv6_addr)];
+
+    while (*i != NC_NIL) {
+        if (*i == (entry - ncache + 1)) {
+            *i = _nc_chain[*i - 1];
+            return;
+        }
+        i = &_nc_chain[*i - 1];
+    }
+}
+
+/* replacement class of an entry; lower classes are replaced first */
+static unsigned _nc_evict_class(const gnrc_ipv6_nc_t *entry)
+{
+    if ((entry->flags & GNRC_IPV6_NC_IS_ROUTER) ||
+        (gnrc_ipv6_nc_get_type(entry) == GNRC_IPV6_NC_TYPE_REGISTERED) ||
+        (gnrc_ipv6_nc_get_type(entry) == GNRC_IPV6_NC_TYPE_TENTATIVE)) {
+        return UINT_MAX;
+    }
+    if (gnrc_ipv6_nc_get_type(entry) == GNRC_IPV6_NC_TYPE_GC) {
+        return 0;
+    }
+
+    switch (gnrc_ipv6_nc_get_state(entry)) {
+        case GNRC_IPV6_NC_STATE_UNMANAGED:
+        case GNRC_IPV6_NC_STATE_INCOMPLETE:
+            /* static or still resolving (might have packets queued) */
+            return UINT_MAX;
+        case GNRC_IPV6_NC_STATE_UNREACHABLE:
+            return 0;
+        case GNRC_IPV6_NC_STATE_STALE:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+static gnrc_ipv6_nc_t *_nc_find_victim(void)
+{
+    gnrc_ipv6_nc_t *victim = NULL;
+    unsigned victim_class = UINT_MAX;
+
+    for (int i = 0; i < GNRC_IPV6_NC_SIZE; i++) {
+        unsigned class = _nc_evict_class(&ncache[i]);
+
+        if ((class < victim_class) ||
+            ((class == victim_class) && (victim != NULL) &&
+             ((int32_t)(_nc_last_used[i] - _nc_last_used[victim - ncache]) < 0))) {
+            victim = &ncache[i];
+            victim_class = class;
+        }
+    }
+
+    return victim;
+}
+
 static void _nc_remove(kernel_pid_t iface, gnrc_ipv6_nc_t *entry)
 {
     (void) iface;
@@ -44,6 +150,10 @@ static void _nc_remove(kernel_pid_t iface, gnrc_ipv6_nc_t *entry)
         return;
     }
 
+    if (!ipv6_addr_is_unspecified(&(entry->ipv6_addr))) {
+        _nc_unlink(entry);
+    }
+
     DEBUG("ipv6_nc: Remove %s for interface %" PRIkernel_pid "\n",
           ipv6_addr_to_str(addr_str, &(entry->ipv6_addr), sizeof(addr_str)),
           iface);
@@ -75,7 +185,9 @@ static void _nc_remove(kernel_pid_t iface, gnrc_ipv6_nc_t *entry)
 
     ipv6_addr_set_unspecified(&(entry->ipv6_addr));
     entry->iface = KERNEL_PID_UNDEF;
+    entry->l2_addr_len = 0;
     entry->flags = 0;
+    _nc_gen++;
 }
 
 void gnrc_ipv6_nc_init(void)
@@ -86,17 +198,31 @@ void gnrc_ipv6_nc_init(void)
         _nc_remove(entry->iface, entry);
     }
     memset(ncache, 0, sizeof(ncache));
+    memset(_nc_buckets, 0, sizeof(_nc_buckets));
+    memset(_nc_last_used, 0, sizeof(_nc_last_used));
+    memset(&_nc_stats, 0, sizeof(_nc_stats));
+    _nc_clock = 0;
 }
 
-gnrc_ipv6_nc_t *_find_free_entry(void)
+static gnrc_ipv6_nc_t *_find_free_entry(void)
 {
+    gnrc_ipv6_nc_t *entry;
+
     for (int i = 0; i < GNRC_IPV6_NC_SIZE; i++) {
         if (ipv6_addr_is_unspecified(&(ncache[i].ipv6_addr))) {
             return ncache + i;
         }
     }
 
-    return NULL;
+    if ((entry = _nc_find_victim()) == NULL) {
+        return NULL;
+    }
+
+    DEBUG("ipv6_nc: neighbor cache full, replacing %s\n",
+          ipv6_addr_to_str(addr_str, &(entry->ipv6_addr), sizeof(addr_str)));
+    _nc_stats.evictions++;
+    _nc_remove(entry->iface, entry);
+    return entry;
 }
 
 gnrc_ipv6_nc_t *gnrc_ipv6_nc_add(kernel_pid_t iface, const ipv6_addr_t *ipv6_addr,
@@ -114,34 +240,29 @@ gnrc_ipv6_nc_t *gnrc_ipv6_nc_add(kernel_pid_t iface, const ipv6_addr_t *ipv6_add
         return NULL;
     }
 
-    for (int i = 0; i < GNRC_IPV6_NC_SIZE; i++) {
-        if (ipv6_addr_equal(&(ncache[i].ipv6_addr), ipv6_addr)) {
-            DEBUG("ipv6_nc: Address %s already registered.\n",
-                  ipv6_addr_to_str(addr_str, ipv6_addr, sizeof(addr_str)));
-
-            if ((l2_addr != NULL) && (l2_addr_len > 0)) {
-                DEBUG("ipv6_nc: Update to L2 address %s",
-                      gnrc_netif_addr_to_str(addr_str, sizeof(addr_str),
-                                             l2_addr, l2_addr_len));
-
-                memcpy(&(ncache[i].l2_addr), l2_addr, l2_addr_len);
-                ncache[i].l2_addr_len = l2_addr_len;
-                ncache[i].flags = flags;
-                DEBUG(" with flags = 0x%0x\n", flags);
-
-            }
-            return &ncache[i];
-        }
+    if ((free_entry = _nc_find(ipv6_addr)) != NULL) {
+        DEBUG("ipv6_nc: Address %s already registered.\n",
+              ipv6_addr_to_str(addr_str, ipv6_addr, sizeof(addr_str)));
 
-        if (ipv6_addr_is_unspecified(&(ncache[i].ipv6_addr)) && !free_entry) {
-            /* found the first free entry */
-            free_entry = &ncache[i];
+        if ((l2_addr != NULL) && (l2_addr_len > 0)) {
+            DEBUG("ipv6_nc: Update to L2 address %s",
+                  gnrc_netif_addr_to_str(addr_str, sizeof(addr_str),
+                                         l2_addr, l2_addr_len));
+
+            memcpy(&(free_entry->l2_addr), l2_addr, l2_addr_len);
+            free_entry->l2_addr_len = l2_addr_len;
+            free_entry->flags = flags;
+            DEBUG(" with flags = 0x%0x\n", flags);
+            _nc_gen++;
         }
+        _nc_touch(free_entry);
+        return free_entry;
     }
 
-    if (!free_entry) {
-        /* reached end of NC without finding updateable or free entry */
+    if ((free_entry = _find_free_entry()) == NULL) {
+        /* no free entry and nothing that may be replaced */
         DEBUG("ipv6_nc: neighbor cache full.\n");
+        _nc_stats.add_fails++;
         return NULL;
     }
 
@@ -152,6 +273,8 @@ gnrc_ipv6_nc_t *gnrc_ipv6_nc_add(kernel_pid_t iface, const ipv6_addr_t *ipv6_add
     free_entry->pkts = NULL;
 #endif
     memcpy(&(free_entry->ipv6_addr), ipv6_addr, sizeof(ipv6_addr_t));
+    _nc_link(free_entry);
+    _nc_touch(free_entry);
     DEBUG("ipv6_nc: Register %s for interface %" PRIkernel_pid,
           ipv6_addr_to_str(addr_str, ipv6_addr, sizeof(addr_str)),
           iface);
@@ -165,6 +288,7 @@ gnrc_ipv6_nc_t *gnrc_ipv6_nc_add(kernel_pid_t iface, const ipv6_addr_t *ipv6_add
     }
 
     free_entry->flags = flags;
+    _nc_gen++;
 
     DEBUG(" with flags = 0x%0x\n", flags);
 
@@ -204,17 +328,19 @@ gnrc_ipv6_nc_t *gnrc_ipv6_nc_get(kernel_pid_t iface, const ipv6_addr_t *ipv6_add
         return NULL;
     }
 
-    for (int i = 0; i < GNRC_IPV6_NC_SIZE; i++) {
-        if (((ncache[i].iface == KERNEL_PID_UNDEF) || (iface == KERNEL_PID_UNDEF) ||
-             (iface == ncache[i].iface)) &&
-            ipv6_addr_equal(&(ncache[i].ipv6_addr), ipv6_addr)) {
-            DEBUG("ipv6_nc: Found entry for %s on interface %" PRIkernel_pid
-                  " (0 = all interfaces) [%p]\n",
-                  ipv6_addr_to_str(addr_str, ipv6_addr, sizeof(addr_str)),
-                  iface, (void *)(ncache + i));
+    gnrc_ipv6_nc_t *entry = _nc_find(ipv6_addr);
 
-            return ncache + i;
-        }
+    _nc_stats.lookups++;
+    if ((entry != NULL) && ((entry->iface == KERNEL_PID_UNDEF) ||
+                            (iface == KERNEL_PID_UNDEF) || (iface == entry->iface))) {
+        DEBUG("ipv6_nc: Found entry for %s on interface %" PRIkernel_pid
+              " (0 = all interfaces) [%p]\n",
+              ipv6_addr_to_str(addr_str, ipv6_addr, sizeof(addr_str)),
+              iface, (void *)entry);
+
+        _nc_stats.hits++;
+        _nc_touch(entry);
+        return entry;
     }
 
     return NULL;
@@ -275,11 +401,28 @@ gnrc_ipv6_nc_t *gnrc_ipv6_nc_still_reachable(const ipv6_addr_t *ipv6_addr)
               ipv6_addr_to_str(addr_str, ipv6_addr, sizeof(addr_str)));
         entry->flags &= ~(GNRC_IPV6_NC_STATE_MASK >> GNRC_IPV6_NC_STATE_POS);
         entry->flags |= (GNRC_IPV6_NC_STATE_REACHABLE >> GNRC_IPV6_NC_STATE_POS);
+        _nc_gen++;
     }
 
     return entry;
 }
 
+void gnrc_ipv6_nc_get_stats(gnrc_ipv6_nc_stats_t *stats)
+{
+    assert(stats != NULL);
+    memcpy(stats, &_nc_stats, sizeof(_nc_stats));
+}
+
+uint32_t gnrc_ipv6_nc_get_gen(void)
+{
+    return _nc_gen;
+}
+
+void gnrc_ipv6_nc_update_gen(void)
+{
+    _nc_gen++;
+}
+
 kernel_pid_t gnrc_ipv6_nc_get_l2_addr(uint8_t *l2_addr, uint8_t *l2_addr_len,
                                       const gnrc_ipv6_nc_t *entry)
 {
@@ -52,6 +52,7 @@
 #define RULE_3_PTS          (1)
 
 static gnrc_ipv6_netif_t ipv6_ifs[GNRC_NETIF_NUMOF];
+static uint32_t _gen;
 
 #if ENABLE_DEBUG
 static char addr_str[IPV6_ADDR_MAX_STR_LEN];
@@ -86,6 +87,7 @@ static ipv6_addr_t *_add_addr_to_entry(gnrc_ipv6_netif_t *entry, const ipv6_addr
 
     tmp_addr->prefix_len = prefix_len;
     tmp_addr->flags = flags;
+    _gen++;
 
 #ifdef MODULE_GNRC_SIXLOWPAN_ND
     if (!ipv6_addr_is_multicast(&(tmp_addr->addr)) &&
@@ -165,6 +167,7 @@ static void _reset_addr_from_entry(gnrc_ipv6_netif_t *entry)
 {
     DEBUG("ipv6 netif: Reset IPv6 addresses on interface %" PRIkernel_pid "\n", entry->pid);
     memset(entry->addrs, 0, sizeof(entry->addrs));
+    _gen++;
 }
 
 static void _ipv6_netif_remove(gnrc_ipv6_netif_t *entry)
@@ -322,6 +325,7 @@ static void _remove_addr_from_entry(gnrc_ipv6_netif_t *entry, ipv6_addr_t *addr)
                   ipv6_addr_to_str(addr_str, addr, sizeof(addr_str)), entry->pid);
             ipv6_addr_set_unspecified(&(entry->addrs[i].addr));
             entry->addrs[i].flags = 0;
+            _gen++;
 #ifdef MODULE_GNRC_NDP_ROUTER
             /* Removal of prefixes MAY allow the router to retransmit up to
              * GNRC_NDP_MAX_INIT_RTR_ADV_NUMOF unsolicited RA
@@ -897,6 +901,11 @@ void gnrc_ipv6_netif_init_by_dev(void)
     }
 }
 
+uint32_t gnrc_ipv6_netif_get_gen(void)
+{
+    return _gen;
+}
+
 #ifdef MODULE_NETSTATS_IPV6
 netstats_t *gnrc_ipv6_netif_get_stats(kernel_pid_t pid)
 {
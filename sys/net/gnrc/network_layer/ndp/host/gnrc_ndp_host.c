@@ -29,7 +29,8 @@ static inline void _reschedule_rtr_sol(gnrc_ipv6_netif_t *iface, uint32_t delay)
     xtimer_remove(&iface->rtr_sol_timer);
     iface->rtr_sol_msg.type = GNRC_NDP_MSG_RTR_SOL_RETRANS;
     iface->rtr_sol_msg.content.ptr = (char *) iface;
-    xtimer_set_msg(&iface->rtr_sol_timer, delay, &iface->rtr_sol_msg, gnrc_ipv6_pid);
+    xtimer_set_msg_slack(&iface->rtr_sol_timer, delay, delay >> GNRC_NDP_INTERNAL_SLACK_SHIFT,
+                         &iface->rtr_sol_msg, gnrc_ipv6_pid);
 }
 
 void gnrc_ndp_host_init(gnrc_ipv6_netif_t *iface)
@@ -128,6 +128,11 @@ kernel_pid_t gnrc_ndp_node_next_hop_l2addr(uint8_t *l2addr, uint8_t *l2addr_len,
         gnrc_pktqueue_t *pkt_node;
         ipv6_addr_t dst_sol;
 
+        if (pkt == NULL) {
+            /* only the addresses were asked for */
+            return KERNEL_PID_UNDEF;
+        }
+
         nc_entry = gnrc_ipv6_nc_add(iface, next_hop_ip, NULL, 0,
                                     GNRC_IPV6_NC_STATE_INCOMPLETE << GNRC_IPV6_NC_STATE_POS);
 
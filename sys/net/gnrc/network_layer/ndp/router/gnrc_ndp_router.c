@@ -107,8 +107,10 @@ static void _send_rtr_adv(gnrc_ipv6_netif_t *iface, ipv6_addr_t *dst)
         xtimer_remove(&iface->rtr_adv_timer);
         iface->rtr_adv_msg.type = GNRC_NDP_MSG_RTR_ADV_RETRANS;
         iface->rtr_adv_msg.content.ptr = (char *) iface;
-        xtimer_set_msg(&iface->rtr_adv_timer, interval * SEC_IN_USEC, &iface->rtr_adv_msg,
-                       gnrc_ipv6_pid);
+        interval *= SEC_IN_USEC;
+        xtimer_set_msg_slack(&iface->rtr_adv_timer, interval,
+                             interval >> GNRC_NDP_INTERNAL_SLACK_SHIFT,
+                             &iface->rtr_adv_msg, gnrc_ipv6_pid);
     }
     mutex_unlock(&iface->mutex);
     for (int i = 0; i < GNRC_IPV6_NETIF_ADDR_NUMOF; i++) {
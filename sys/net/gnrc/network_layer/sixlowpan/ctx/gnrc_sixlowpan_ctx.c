@@ -25,6 +25,7 @@
 static gnrc_sixlowpan_ctx_t _ctxs[GNRC_SIXLOWPAN_CTX_SIZE];
 static uint32_t _ctx_inval_times[GNRC_SIXLOWPAN_CTX_SIZE];
 static mutex_t _ctx_mutex = MUTEX_INIT;
+static uint32_t _ctx_gen;
 
 static uint32_t _current_minute(void);
 static void _update_lifetime(uint8_t id);
@@ -103,6 +104,9 @@ gnrc_sixlowpan_ctx_t *gnrc_sixlowpan_ctx_update(uint8_t id, const ipv6_addr_t *p
 
     mutex_lock(&_ctx_mutex);
 
+    uint8_t old_prefix_len = _ctxs[id].prefix_len;
+    uint8_t old_flags_id = _ctxs[id].flags_id;
+
     _ctxs[id].ltime = ltime;
 
     if (ltime == 0) {
@@ -121,6 +125,11 @@ gnrc_sixlowpan_ctx_t *gnrc_sixlowpan_ctx_update(uint8_t id, const ipv6_addr_t *p
     if (!ipv6_addr_equal(&(_ctxs[id].prefix), prefix)) {
         ipv6_addr_set_unspecified(&(_ctxs[id].prefix));
         ipv6_addr_init_prefix(&(_ctxs[id].prefix), prefix, _ctxs[id].prefix_len);
+        _ctx_gen++;
+    }
+    else if ((old_prefix_len != _ctxs[id].prefix_len) ||
+             (old_flags_id != _ctxs[id].flags_id)) {
+        _ctx_gen++;
     }
     DEBUG("6lo ctx: update context (%u, %s/%" PRIu8 "), lifetime: %" PRIu16 " min\n",
           id, ipv6_addr_to_str(ipv6str, &_ctxs[id].prefix, sizeof(ipv6str)),
@@ -131,6 +140,23 @@ gnrc_sixlowpan_ctx_t *gnrc_sixlowpan_ctx_update(uint8_t id, const ipv6_addr_t *p
     return &(_ctxs[id]);
 }
 
+void gnrc_sixlowpan_ctx_remove(uint8_t id)
+{
+    if (id >= GNRC_SIXLOWPAN_CTX_SIZE) {
+        return;
+    }
+
+    mutex_lock(&_ctx_mutex);
+    _ctxs[id].prefix_len = 0;
+    _ctx_gen++;
+    mutex_unlock(&_ctx_mutex);
+}
+
+uint32_t gnrc_sixlowpan_ctx_gen(void)
+{
+    return _ctx_gen;
+}
+
 static uint32_t _current_minute(void)
 {
     return xtimer_now() / (SEC_IN_USEC * 60);
@@ -141,7 +167,10 @@ static void _update_lifetime(uint8_t id)
     uint32_t now;
 
     if (_ctxs[id].ltime == 0) {
-        _ctxs[id].flags_id &= ~GNRC_SIXLOWPAN_CTX_FLAGS_COMP;
+        if (_ctxs[id].flags_id & GNRC_SIXLOWPAN_CTX_FLAGS_COMP) {
+            _ctxs[id].flags_id &= ~GNRC_SIXLOWPAN_CTX_FLAGS_COMP;
+            _ctx_gen++;
+        }
         return;
     }
 
@@ -151,6 +180,7 @@ static void _update_lifetime(uint8_t id)
         DEBUG("6lo ctx: context %u was invalidated for compression\n", id);
         _ctxs[id].ltime = 0;
         _ctxs[id].flags_id &= ~GNRC_SIXLOWPAN_CTX_FLAGS_COMP;
+        _ctx_gen++;
     }
     else {
         _ctxs[id].ltime = (uint16_t)(_ctx_inval_times[id] - now);
@@ -163,6 +193,7 @@ static void _update_lifetime(uint8_t id)
 void gnrc_sixlowpan_ctx_reset(void)
 {
     memset(_ctxs, 0, sizeof(_ctxs));
+    _ctx_gen++;
 }
 #endif
 
@@ -17,6 +17,8 @@
  */
 
 #include "kernel_types.h"
+#include "msg.h"
+#include "thread.h"
 #include "net/gnrc/pktbuf.h"
 #include "net/gnrc/netapi.h"
 #include "net/gnrc/netif/hdr.h"
@@ -26,6 +28,9 @@
 #include "utlist.h"
 
 #include "rbuf.h"
+#ifdef MODULE_GNRC_SIXLOWPAN_FRAG_VRB
+#include "vrb.h"
+#endif
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
@@ -47,8 +52,7 @@ static inline size_t _min(size_t a, size_t b)
     return (a < b) ? a : b;
 }
 
-static gnrc_pktsnip_t *_build_frag_pkt(gnrc_pktsnip_t *pkt, size_t payload_len,
-                                       size_t size)
+static gnrc_pktsnip_t *_build_frag_pkt(gnrc_pktsnip_t *pkt, size_t hdr_size)
 {
     gnrc_netif_hdr_t *hdr = pkt->data, *new_hdr;
     gnrc_pktsnip_t *netif, *frag;
@@ -67,11 +71,10 @@ static gnrc_pktsnip_t *_build_frag_pkt(gnrc_pktsnip_t *pkt, size_t payload_len,
     new_hdr->rssi = hdr->rssi;
     new_hdr->lqi = hdr->lqi;
 
-    frag = gnrc_pktbuf_add(NULL, NULL, _min(size, payload_len),
-                           GNRC_NETTYPE_SIXLOWPAN);
+    frag = gnrc_pktbuf_add(NULL, NULL, hdr_size, GNRC_NETTYPE_SIXLOWPAN);
 
     if (frag == NULL) {
-        DEBUG("6lo frag: error allocating first fragment\n");
+        DEBUG("6lo frag: error allocating fragment header\n");
         gnrc_pktbuf_release(netif);
         return NULL;
     }
@@ -81,149 +84,148 @@ static gnrc_pktsnip_t *_build_frag_pkt(gnrc_pktsnip_t *pkt, size_t payload_len,
     return frag;
 }
 
-static uint16_t _send_1st_fragment(gnrc_sixlowpan_netif_t *iface, gnrc_pktsnip_t *pkt,
-                                   size_t payload_len, size_t datagram_size)
+/**
+ * @brief   Makes every snip in the payload of @p pkt writable, so it can be
+ *          sliced up into fragments.
+ *
+ * @details Only snips shared with another user (e.g. a multicast packet sent
+ *          over several interfaces) are copied.
+ */
+static bool _start_write_payload(gnrc_pktsnip_t *pkt)
 {
-    gnrc_pktsnip_t *frag;
-    uint16_t local_offset = 0;
-    /* payload_len: actual size of the packet vs
-     * datagram_size: size of the uncompressed IPv6 packet */
-    int payload_diff = (datagram_size - payload_len);
-    /* virtually add payload_diff to flooring to account for offset (must be divisable by 8)
-     * in uncompressed datagram */
-    uint16_t max_frag_size = _floor8(iface->max_frag_size + payload_diff -
-                                     sizeof(sixlowpan_frag_t)) - payload_diff;
-    sixlowpan_frag_t *hdr;
-    uint8_t *data;
-
-    DEBUG("6lo frag: determined max_frag_size = %" PRIu16 "\n", max_frag_size);
+    while (pkt->next != NULL) {
+        gnrc_pktsnip_t *tmp = gnrc_pktbuf_start_write(pkt->next);
 
-    frag = _build_frag_pkt(pkt, payload_len,
-                           max_frag_size + sizeof(sixlowpan_frag_t));
-
-    if (frag == NULL) {
-        return 0;
+        if (tmp == NULL) {
+            return false;
+        }
+        pkt->next = tmp;
+        pkt = tmp;
     }
+    return true;
+}
 
-    hdr = frag->next->data;
-    data = (uint8_t *)(hdr + 1);
-
-    hdr->disp_size = byteorder_htons((uint16_t)datagram_size);
-    hdr->disp_size.u8[0] |= SIXLOWPAN_FRAG_1_DISP;
-    hdr->tag = byteorder_htons(_tag);
-
-    pkt = pkt->next;    /* don't copy netif header */
+/**
+ * @brief   Detaches the first @p size bytes of @p payload.
+ *
+ * @details A snip crossing the fragment boundary is split with
+ *          gnrc_pktbuf_mark(), so the payload is not copied.
+ *
+ * @param[in,out] payload   The writable payload to slice. Points to the rest
+ *                          of the payload on return.
+ * @param[in] size          Maximum size of the slice.
+ *
+ * @return  The slice, @p payload is unchanged if NULL is returned.
+ */
+static gnrc_pktsnip_t *_slice(gnrc_pktsnip_t **payload, size_t size)
+{
+    gnrc_pktsnip_t *slice = *payload, *last = NULL, *snip = *payload;
+    size_t len = 0;
 
-    while (pkt != NULL) {
-        size_t clen = _min(max_frag_size - local_offset, pkt->size);
+    while ((snip != NULL) && ((len + snip->size) <= size)) {
+        len += snip->size;
+        last = snip;
+        snip = snip->next;
+    }
 
-        memcpy(data + local_offset, pkt->data, clen);
-        local_offset += clen;
+    if ((snip != NULL) && (len < size)) {
+        /* gnrc_pktbuf_mark() appends the first bytes of snip behind snip */
+        gnrc_pktsnip_t *head = gnrc_pktbuf_mark(snip, size - len, snip->type);
 
-        if (local_offset >= max_frag_size) {
-            break;
+        if (head == NULL) {
+            DEBUG("6lo frag: error slicing payload\n");
+            return NULL;
+        }
+        snip->next = head->next;
+        head->next = NULL;
+        if (last == NULL) {
+            slice = head;
+        }
+        else {
+            last->next = head;
         }
-
-        pkt = pkt->next;
     }
-
-    DEBUG("6lo frag: send first fragment (datagram size: %u, "
-          "datagram tag: %" PRIu16 ", fragment size: %" PRIu16 ")\n",
-          (unsigned int)datagram_size, _tag, local_offset);
-    if (gnrc_netapi_send(iface->pid, frag) < 1) {
-        DEBUG("6lo frag: unable to send first fragment\n");
-        gnrc_pktbuf_release(frag);
+    else if (last != NULL) {
+        last->next = NULL;
     }
 
-    return local_offset;
+    *payload = snip;
+
+    return slice;
 }
 
-static uint16_t _send_nth_fragment(gnrc_sixlowpan_netif_t *iface, gnrc_pktsnip_t *pkt,
-                                   size_t payload_len, size_t datagram_size,
-                                   uint16_t offset)
+static bool _send_fragment(gnrc_sixlowpan_netif_t *iface, gnrc_pktsnip_t *netif,
+                           gnrc_pktsnip_t **payload, size_t datagram_size,
+                           uint16_t *offset, size_t max_frag_size, uint16_t tag)
 {
-    gnrc_pktsnip_t *frag;
-    /* since dispatches aren't supposed to go into subsequent fragments, we need not account
-     * for payload difference as for the first fragment */
-    uint16_t max_frag_size = _floor8(iface->max_frag_size - sizeof(sixlowpan_frag_n_t));
-    uint16_t local_offset = 0, offset_count = 0;
+    gnrc_pktsnip_t *frag, *slice;
     sixlowpan_frag_n_t *hdr;
-    uint8_t *data;
-
-    DEBUG("6lo frag: determined max_frag_size = %" PRIu16 "\n", max_frag_size);
+    size_t hdr_size = (*offset == 0) ? sizeof(sixlowpan_frag_t) :
+                                       sizeof(sixlowpan_frag_n_t);
+    /* payload_len: actual size of the packet vs
+     * datagram_size: size of the uncompressed IPv6 packet */
+    size_t payload_len = *offset + gnrc_pkt_len(*payload);
 
-    frag = _build_frag_pkt(pkt,
-                           payload_len - offset + sizeof(sixlowpan_frag_n_t),
-                           max_frag_size + sizeof(sixlowpan_frag_n_t));
+    frag = _build_frag_pkt(netif, hdr_size);
 
     if (frag == NULL) {
-        return 0;
+        return false;
+    }
+
+    slice = _slice(payload, max_frag_size);
+
+    if (slice == NULL) {
+        gnrc_pktbuf_release(frag);
+        return false;
     }
 
     hdr = frag->next->data;
-    data = (uint8_t *)(hdr + 1);
+    frag->next->next = slice;
 
     /* XXX: truncation of datagram_size > 4095 may happen here */
     hdr->disp_size = byteorder_htons((uint16_t)datagram_size);
-    hdr->disp_size.u8[0] |= SIXLOWPAN_FRAG_N_DISP;
-    hdr->tag = byteorder_htons(_tag);
-    /* don't mention payload diff in offset */
-    hdr->offset = (uint8_t)((offset + (datagram_size - payload_len)) >> 3);
-    pkt = pkt->next;    /* don't copy netif header */
-
-    while ((pkt != NULL) && (offset_count != offset)) {   /* go to offset */
-        offset_count += (uint16_t)pkt->size;
-
-        if (offset_count > offset) {    /* we overshot */
-            /* => copy rest of partly send packet snip */
-            uint16_t pkt_offset = offset - (offset_count - ((uint16_t)pkt->size));
-            size_t clen = _min(max_frag_size, pkt->size - pkt_offset);
-
-            memcpy(data, ((uint8_t *)pkt->data) + pkt_offset, clen);
-            local_offset = clen;
-            pkt = pkt->next;
-            break;
-        }
-
-        pkt = pkt->next;
+    hdr->tag = byteorder_htons(tag);
+    if (*offset == 0) {
+        hdr->disp_size.u8[0] |= SIXLOWPAN_FRAG_1_DISP;
+    }
+    else {
+        hdr->disp_size.u8[0] |= SIXLOWPAN_FRAG_N_DISP;
+        /* don't mention payload diff in offset */
+        hdr->offset = (uint8_t)((*offset + (datagram_size - payload_len)) >> 3);
     }
 
-    if (local_offset < max_frag_size) { /* copy other packet snips */
-        while (pkt != NULL) {
-            size_t clen = _min(max_frag_size - local_offset, pkt->size);
-
-            memcpy(data + local_offset, pkt->data, clen);
-            local_offset += clen;
+    DEBUG("6lo frag: send fragment (datagram size: %u, "
+          "datagram tag: %" PRIu16 ", offset: %" PRIu16 ", "
+          "fragment size: %u)\n", (unsigned int)datagram_size, tag, *offset,
+          (unsigned int)gnrc_pkt_len(slice));
 
-            if (local_offset == max_frag_size) {
-                break;
-            }
+    *offset += gnrc_pkt_len(slice);
 
-            pkt = pkt->next;
-        }
-    }
-
-    DEBUG("6lo frag: send subsequent fragment (datagram size: %u, "
-          "datagram tag: %" PRIu16 ", offset: %" PRIu8 " (%u bytes), "
-          "fragment size: %" PRIu16 ")\n",
-          (unsigned int)datagram_size, _tag, hdr->offset, hdr->offset << 3,
-          local_offset);
     if (gnrc_netapi_send(iface->pid, frag) < 1) {
-        DEBUG("6lo frag: unable to send subsequent fragment\n");
+        DEBUG("6lo frag: unable to send fragment\n");
         gnrc_pktbuf_release(frag);
     }
 
-    return local_offset;
+    return true;
+}
+
+uint16_t gnrc_sixlowpan_frag_next_tag(void)
+{
+    return ++_tag;
 }
 
 void gnrc_sixlowpan_frag_send(gnrc_sixlowpan_msg_frag_t *fragment_msg)
 {
     gnrc_sixlowpan_netif_t *iface = gnrc_sixlowpan_netif_get(fragment_msg->pid);
-    uint16_t res;
+    gnrc_pktsnip_t *payload;
     /* payload_len: actual size of the packet vs
      * datagram_size: size of the uncompressed IPv6 packet */
     size_t payload_len = gnrc_pkt_len(fragment_msg->pkt->next);
-    msg_t msg;
+    /* virtually add payload_diff to flooring to account for offset (must be divisable by 8)
+     * in uncompressed datagram */
+    int payload_diff = (fragment_msg->datagram_size - payload_len);
+    size_t max_frag_size;
+    bool batched;
 
 #if defined(DEVELHELP) && defined(ENABLE_DEBUG)
     if (iface == NULL) {
@@ -236,50 +238,69 @@ void gnrc_sixlowpan_frag_send(gnrc_sixlowpan_msg_frag_t *fragment_msg)
     }
 #endif
 
-    /* Check weater to send the first or an Nth fragment */
     if (fragment_msg->offset == 0) {
-        /* increment tag for successive, fragmented datagrams */
-        _tag++;
-        if ((res = _send_1st_fragment(iface, fragment_msg->pkt, payload_len, fragment_msg->datagram_size)) == 0) {
-            /* error sending first fragment */
-            DEBUG("6lo frag: error sending 1st fragment\n");
+        if (!_start_write_payload(fragment_msg->pkt)) {
+            DEBUG("6lo frag: no space left in packet buffer\n");
             gnrc_pktbuf_release(fragment_msg->pkt);
             fragment_msg->pkt = NULL;
             return;
         }
-        fragment_msg->offset += res;
-
-        /* send message to self*/
-        msg.type = GNRC_SIXLOWPAN_MSG_FRAG_SND;
-        msg.content.ptr = (void *)fragment_msg;
-        msg_send_to_self(&msg);
-        thread_yield();
+        /* increment tag for successive, fragmented datagrams */
+        fragment_msg->tag = gnrc_sixlowpan_frag_next_tag();
     }
-    else {
-        /* (offset + (datagram_size - payload_len) < datagram_size) simplified */
-        if (fragment_msg->offset < payload_len) {
-            if ((res = _send_nth_fragment(iface, fragment_msg->pkt, payload_len, fragment_msg->datagram_size,
-                                          fragment_msg->offset)) == 0) {
-                /* error sending subsequent fragment */
-                DEBUG("6lo frag: error sending subsequent fragment (offset = %" PRIu16
-                      ")\n", fragment_msg->offset);
-                gnrc_pktbuf_release(fragment_msg->pkt);
-                fragment_msg->pkt = NULL;
-                return;
-                }
-            fragment_msg->offset += res;
 
-            /* send message to self*/
-            msg.type = GNRC_SIXLOWPAN_MSG_FRAG_SND;
-            msg.content.ptr = (void *)fragment_msg;
-            msg_send_to_self(&msg);
-            thread_yield();
+    /* the fragments take the payload over, only the netif header remains */
+    payload = fragment_msg->pkt->next;
+    fragment_msg->pkt->next = NULL;
+
+    /* Fragments collected by the netapi batch (module gnrc_netapi_batch) reach
+     * the interface in one message, so all of them are sent back-to-back.
+     * Otherwise every fragment takes a slot in the message queue of the
+     * interface, so only one is sent per GNRC_SIXLOWPAN_MSG_FRAG_SND message
+     * to give the interface time to catch up */
+    batched = gnrc_netapi_batch_collects(iface->pid);
+    while (payload != NULL) {
+        if (fragment_msg->offset == 0) {
+            max_frag_size = _floor8(iface->max_frag_size + payload_diff -
+                                    sizeof(sixlowpan_frag_t)) - payload_diff;
         }
         else {
-            gnrc_pktbuf_release(fragment_msg->pkt);
-            fragment_msg->pkt = NULL;
+            /* since dispatches aren't supposed to go into subsequent fragments,
+             * we need not account for payload difference as for the first
+             * fragment */
+            max_frag_size = _floor8(iface->max_frag_size - sizeof(sixlowpan_frag_n_t));
+        }
+        DEBUG("6lo frag: determined max_frag_size = %u\n", (unsigned)max_frag_size);
+
+        if (!_send_fragment(iface, fragment_msg->pkt, &payload,
+                            fragment_msg->datagram_size, &fragment_msg->offset,
+                            max_frag_size, fragment_msg->tag)) {
+            DEBUG("6lo frag: error sending fragment (offset = %" PRIu16 ")\n",
+                  fragment_msg->offset);
+            gnrc_pktbuf_release(payload);
+            payload = NULL;
+            break;
+        }
+
+        if (!batched && (payload != NULL)) {
+            msg_t msg;
+
+            fragment_msg->pkt->next = payload;
+            /* send message to self */
+            msg.type = GNRC_SIXLOWPAN_MSG_FRAG_SND;
+            msg.content.ptr = (void *)fragment_msg;
+            if (msg_send_to_self(&msg) == 1) {
+                thread_yield();
+                return;
+            }
+            DEBUG("6lo frag: unable to schedule next fragment\n");
+            break;
         }
     }
+
+    gnrc_pktbuf_release(fragment_msg->pkt);
+    /* 6LoWPAN free for next fragmentation */
+    fragment_msg->pkt = NULL;
 }
 
 void gnrc_sixlowpan_frag_handle_pkt(gnrc_pktsnip_t *pkt)
@@ -306,9 +327,22 @@ void gnrc_sixlowpan_frag_handle_pkt(gnrc_pktsnip_t *pkt)
             return;
     }
 
+#ifdef MODULE_GNRC_SIXLOWPAN_FRAG_VRB
+    if (vrb_fwd(hdr, pkt, frag_size, offset)) {
+        /* fragment was forwarded without reassembly */
+        gnrc_pktbuf_release(pkt);
+        return;
+    }
+#endif
+
     rbuf_add(hdr, pkt, frag_size, offset);
 
     gnrc_pktbuf_release(pkt);
 }
 
+void gnrc_sixlowpan_frag_gc_rbuf(void)
+{
+    rbuf_gc();
+}
+
 /** @} */
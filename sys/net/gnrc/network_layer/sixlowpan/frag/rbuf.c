@@ -29,22 +29,19 @@
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
 
-/* estimated fragment payload size to determinate RBUF_INT_SIZE, default to
- * MAC payload size - fragment header. */
-#ifndef GNRC_SIXLOWPAN_FRAG_SIZE
-/* assuming 64-bit source/destination address, source PAN ID omitted */
-#define GNRC_SIXLOWPAN_FRAG_SIZE (104 - 5)
-#endif
-
-#ifndef RBUF_INT_SIZE
-/* same as ((int) ceil((double) N / D)) */
-#define DIV_CEIL(N, D) (((N) + (D) - 1) / (D))
-#define RBUF_INT_SIZE (DIV_CEIL(GNRC_IPV6_NETIF_DEFAULT_MTU, GNRC_SIXLOWPAN_FRAG_SIZE) * RBUF_SIZE)
-#endif
-
-static rbuf_int_t rbuf_int[RBUF_INT_SIZE];
-
+/* every datagram in reassembly, unused ones are chained in _free */
 static rbuf_t rbuf[RBUF_SIZE];
+static rbuf_t *_free;
+/* datagrams in reassembly indexed by (src, dst, tag) */
+static rbuf_t *_buckets[RBUF_HASH_SIZE];
+/* datagrams in reassembly, least recently updated first */
+static rbuf_t *_age;
+/* number of bytes the datagrams in reassembly occupy in the packet buffer */
+static size_t _used;
+
+static xtimer_t _gc_timer;
+static msg_t _gc_msg = { .type = GNRC_SIXLOWPAN_MSG_FRAG_GC_RBUF };
+static bool _gc_timer_set = false;
 
 #if ENABLE_DEBUG
 static char l2addr_str[3 * RBUF_L2ADDR_MAX_LEN];
@@ -53,16 +50,17 @@ static char l2addr_str[3 * RBUF_L2ADDR_MAX_LEN];
 /* ------------------------------------
  * internal function definitions
  * ------------------------------------*/
-/* checks whether start and end overlaps, but not identical to, given interval i */
-static inline bool _rbuf_int_overlap_partially(rbuf_int_t *i, uint16_t start, uint16_t end);
-/* gets a free entry from interval buffer */
-static rbuf_int_t *_rbuf_int_get_free(void);
+/* marks the units of a fragment as received. Returns 1 if the fragment is new,
+ * 0 if it is a duplicate and -1 if it overlaps received data partially */
+static int _rbuf_update_units(rbuf_t *entry, uint16_t offset, size_t frag_size);
 /* remove entry from reassembly buffer */
 static void _rbuf_rem(rbuf_t *entry);
-/* update interval buffer of entry */
-static bool _rbuf_update_ints(rbuf_t *entry, uint16_t offset, size_t frag_size);
-/* checks timeouts and removes entries if necessary (oldest if full) */
+/* removes the least recently updated entry, returns false if there is none */
+static bool _rbuf_rem_oldest(void);
+/* removes timed out entries */
 static void _rbuf_gc(void);
+/* sets the garbage collection timer, if not already set */
+static void _rbuf_gc_timer_set(uint32_t timeout);
 /* gets an entry identified by its tupel */
 static rbuf_t *_rbuf_get(const void *src, size_t src_len,
                          const void *dst, size_t dst_len,
@@ -77,10 +75,9 @@ void rbuf_add(gnrc_netif_hdr_t *netif_hdr, gnrc_pktsnip_t *pkt,
     unsigned int data_offset = 0;
     size_t original_size = frag_size;
     sixlowpan_frag_t *frag = pkt->data;
-    rbuf_int_t *ptr;
     uint8_t *data = ((uint8_t *)pkt->data) + sizeof(sixlowpan_frag_t);
+    int res;
 
-    _rbuf_gc();
     entry = _rbuf_get(gnrc_netif_hdr_get_src_addr(netif_hdr), netif_hdr->src_l2addr_len,
                       gnrc_netif_hdr_get_dst_addr(netif_hdr), netif_hdr->dst_l2addr_len,
                       byteorder_ntohs(frag->disp_size) & SIXLOWPAN_FRAG_SIZE_MASK,
@@ -91,8 +88,6 @@ void rbuf_add(gnrc_netif_hdr_t *netif_hdr, gnrc_pktsnip_t *pkt,
         return;
     }
 
-    ptr = entry->ints;
-
     /* dispatches in the first fragment are ignored */
     if (offset == 0) {
         if (data[0] == SIXLOWPAN_UNCOMP) {
@@ -102,7 +97,7 @@ void rbuf_add(gnrc_netif_hdr_t *netif_hdr, gnrc_pktsnip_t *pkt,
 #ifdef MODULE_GNRC_SIXLOWPAN_IPHC
         else if (sixlowpan_iphc_is(data)) {
             size_t iphc_len, nh_len = 0;
-            iphc_len = gnrc_sixlowpan_iphc_decode(&entry->pkt, pkt, entry->pkt->size,
+            iphc_len = gnrc_sixlowpan_iphc_decode(&entry->pkt, pkt, entry->size,
                                                   sizeof(sixlowpan_frag_t), &nh_len);
             if (iphc_len == 0) {
                 DEBUG("6lo rfrag: could not decode IPHC dispatch\n");
@@ -123,7 +118,7 @@ void rbuf_add(gnrc_netif_hdr_t *netif_hdr, gnrc_pktsnip_t *pkt,
         data++; /* FRAGN header is one byte longer (offset) */
     }
 
-    if ((offset + frag_size) > entry->pkt->size) {
+    if ((offset + frag_size) > entry->size) {
         DEBUG("6lo rfrag: fragment too big for resulting datagram, discarding datagram\n");
         gnrc_pktbuf_release(entry->pkt);
         _rbuf_rem(entry);
@@ -133,31 +128,28 @@ void rbuf_add(gnrc_netif_hdr_t *netif_hdr, gnrc_pktsnip_t *pkt,
     /* If the fragment overlaps another fragment and differs in either the size
      * or the offset of the overlapped fragment, discards the datagram
      * https://tools.ietf.org/html/rfc4944#section-5.3 */
-    while (ptr != NULL) {
-        if (_rbuf_int_overlap_partially(ptr, offset, offset + frag_size - 1)) {
-            DEBUG("6lo rfrag: overlapping intervals, discarding datagram\n");
-            gnrc_pktbuf_release(entry->pkt);
-            _rbuf_rem(entry);
-
-            /* "A fresh reassembly may be commenced with the most recently
-             * received link fragment"
-             * https://tools.ietf.org/html/rfc4944#section-5.3 */
-            rbuf_add(netif_hdr, pkt, original_size, offset);
+    res = _rbuf_update_units(entry, offset, frag_size);
+    if (res < 0) {
+        DEBUG("6lo rfrag: overlapping intervals, discarding datagram\n");
+        gnrc_pktbuf_release(entry->pkt);
+        _rbuf_rem(entry);
 
-            return;
-        }
+        /* "A fresh reassembly may be commenced with the most recently
+         * received link fragment"
+         * https://tools.ietf.org/html/rfc4944#section-5.3 */
+        rbuf_add(netif_hdr, pkt, original_size, offset);
 
-        ptr = ptr->next;
+        return;
     }
 
-    if (_rbuf_update_ints(entry, offset, frag_size)) {
+    if (res > 0) {
         DEBUG("6lo rbuf: add fragment data\n");
         entry->cur_size += (uint16_t)frag_size;
         memcpy(((uint8_t *)entry->pkt->data) + offset + data_offset, data,
                frag_size - data_offset);
     }
 
-    if (entry->cur_size == entry->pkt->size) {
+    if (entry->cur_size == entry->size) {
         gnrc_pktsnip_t *netif = gnrc_netif_hdr_build(entry->src, entry->src_len,
                                                      entry->dst, entry->dst_len);
 
@@ -189,141 +181,193 @@ void rbuf_add(gnrc_netif_hdr_t *netif_hdr, gnrc_pktsnip_t *pkt,
     }
 }
 
-static inline bool _rbuf_int_overlap_partially(rbuf_int_t *i, uint16_t start, uint16_t end)
+static inline unsigned _rbuf_hash(const uint8_t *src, size_t src_len,
+                                  const uint8_t *dst, size_t dst_len,
+                                  uint16_t tag)
+{
+    unsigned hash = tag ^ (tag >> 8);
+
+    for (unsigned i = 0; i < src_len; i++) {
+        hash = (hash * 31) + src[i];
+    }
+    for (unsigned i = 0; i < dst_len; i++) {
+        hash = (hash * 31) + dst[i];
+    }
+
+    return (hash ^ (hash >> 8)) & (RBUF_HASH_SIZE - 1);
+}
+
+static inline rbuf_t **_rbuf_bucket(const rbuf_t *entry)
 {
-    /* start and ends are both inclusive, so using <= for both */
-    return ((i->start <= end) && (start <= i->end)) && /* overlaps */
-        ((start != i->start) || (end != i->end)); /* not identical */
+    return &_buckets[_rbuf_hash(entry->src, entry->src_len, entry->dst,
+                                entry->dst_len, entry->tag)];
 }
 
-static rbuf_int_t *_rbuf_int_get_free(void)
+static int _rbuf_update_units(rbuf_t *entry, uint16_t offset, size_t frag_size)
 {
-    for (unsigned int i = 0; i < RBUF_INT_SIZE; i++) {
-        if (rbuf_int[i].end == 0) { /* start must be smaller than end anyways*/
-            return rbuf_int + i;
+    unsigned first = offset / RBUF_UNIT_SIZE;
+    unsigned last = (offset + frag_size - 1) / RBUF_UNIT_SIZE;
+    unsigned received = 0;
+
+    for (unsigned i = first; i <= last; i++) {
+        if (bf_isset(entry->received, i)) {
+            received++;
         }
     }
 
-    return NULL;
+    if (received == (last - first + 1)) {
+        DEBUG("6lo rfrag: fragment (%" PRIu16 ", %u) already received\n",
+              offset, (unsigned)frag_size);
+        return 0;
+    }
+    if (received > 0) {
+        return -1;
+    }
+
+    for (unsigned i = first; i <= last; i++) {
+        bf_set(entry->received, i);
+    }
+
+    DEBUG("6lo rfrag: add interval (%" PRIu16 ", %u) to entry (%s, ",
+          offset, (unsigned)(offset + frag_size - 1),
+          gnrc_netif_addr_to_str(l2addr_str, sizeof(l2addr_str), entry->src,
+                                 entry->src_len));
+    DEBUG("%s, %u, %u)\n", gnrc_netif_addr_to_str(l2addr_str,
+            sizeof(l2addr_str), entry->dst, entry->dst_len),
+          (unsigned)entry->size, entry->tag);
+
+    return 1;
 }
 
 static void _rbuf_rem(rbuf_t *entry)
 {
-    while (entry->ints != NULL) {
-        rbuf_int_t *next = entry->ints->next;
+    rbuf_t **bucket = _rbuf_bucket(entry);
 
-        entry->ints->start = 0;
-        entry->ints->end = 0;
-        entry->ints->next = NULL;
-        entry->ints = next;
-    }
+    LL_DELETE(*bucket, entry);
+    DL_DELETE2(_age, entry, age_prev, age_next);
+    _used -= entry->size;
 
     entry->pkt = NULL;
+    LL_PREPEND(_free, entry);
 }
 
-static bool _rbuf_update_ints(rbuf_t *entry, uint16_t offset, size_t frag_size)
+void rbuf_gc(void)
 {
-    rbuf_int_t *new;
-    uint16_t end = (uint16_t)(offset + frag_size - 1);
-
-    new = _rbuf_int_get_free();
+    _gc_timer_set = false;
+    _rbuf_gc();
+}
 
-    if (new == NULL) {
-        DEBUG("6lo rfrag: no space left in rbuf interval buffer.\n");
-        return false;
+static void _rbuf_gc_timer_set(uint32_t timeout)
+{
+    if (!_gc_timer_set) {
+        _gc_timer_set = true;
+        xtimer_set_msg_slack(&_gc_timer, timeout, RBUF_GC_SLACK, &_gc_msg,
+                             thread_getpid());
     }
+}
 
-    new->start = offset;
-    new->end = end;
+static void _rbuf_gc(void)
+{
+    uint32_t now_usec = xtimer_now();
 
-    DEBUG("6lo rfrag: add interval (%" PRIu16 ", %" PRIu16 ") to entry (%s, ",
-          new->start, new->end, gnrc_netif_addr_to_str(l2addr_str,
-                  sizeof(l2addr_str), entry->src, entry->src_len));
-    DEBUG("%s, %u, %u)\n", gnrc_netif_addr_to_str(l2addr_str,
-            sizeof(l2addr_str), entry->dst, entry->dst_len),
-          (unsigned)entry->pkt->size, entry->tag);
+    /* entries are ordered by arrival, so only the oldest ones need checking */
+    while (_age != NULL) {
+        rbuf_t *oldest = _age;
+        uint32_t age = now_usec - oldest->arrival;
 
-    LL_PREPEND(entry->ints, new);
+        if (age <= RBUF_TIMEOUT) {
+            /* + 1, as entries time out only after RBUF_TIMEOUT passed */
+            _rbuf_gc_timer_set(RBUF_TIMEOUT - age + 1);
+            return;
+        }
 
-    return true;
+        /* since pkt occupies pktbuf, aggressivly collect garbage */
+        DEBUG("6lo rfrag: entry (%s, ", gnrc_netif_addr_to_str(l2addr_str,
+                sizeof(l2addr_str), oldest->src, oldest->src_len));
+        DEBUG("%s, %u, %u) timed out\n",
+              gnrc_netif_addr_to_str(l2addr_str, sizeof(l2addr_str), oldest->dst,
+                                     oldest->dst_len),
+              (unsigned)oldest->size, oldest->tag);
+
+        gnrc_pktbuf_release(oldest->pkt);
+        _rbuf_rem(oldest);
+    }
 }
 
-static void _rbuf_gc(void)
+static bool _rbuf_rem_oldest(void)
 {
-    uint32_t now_usec = xtimer_now();
-    unsigned int i;
+    rbuf_t *oldest = _age;
 
-    for (i = 0; i < RBUF_SIZE; i++) {
-        /* since pkt occupies pktbuf, aggressivly collect garbage */
-        if ((rbuf[i].pkt != NULL) &&
-              ((now_usec - rbuf[i].arrival) > RBUF_TIMEOUT)) {
-            DEBUG("6lo rfrag: entry (%s, ", gnrc_netif_addr_to_str(l2addr_str,
-                    sizeof(l2addr_str), rbuf[i].src, rbuf[i].src_len));
-            DEBUG("%s, %u, %u) timed out\n",
-                  gnrc_netif_addr_to_str(l2addr_str, sizeof(l2addr_str), rbuf[i].dst,
-                                         rbuf[i].dst_len),
-                  (unsigned)rbuf[i].pkt->size, rbuf[i].tag);
-
-            gnrc_pktbuf_release(rbuf[i].pkt);
-            _rbuf_rem(&(rbuf[i]));
-        }
+    if (oldest == NULL) {
+        return false;
     }
+
+    DEBUG("6lo rfrag: reassembly buffer full, remove oldest entry\n");
+    gnrc_pktbuf_release(oldest->pkt);
+    _rbuf_rem(oldest);
+    return true;
 }
 
 static rbuf_t *_rbuf_get(const void *src, size_t src_len,
                          const void *dst, size_t dst_len,
                          size_t size, uint16_t tag)
 {
-    rbuf_t *res = NULL, *oldest = NULL;
+    rbuf_t *res, **bucket = &_buckets[_rbuf_hash(src, src_len, dst, dst_len, tag)];
     uint32_t now_usec = xtimer_now();
 
-    for (unsigned int i = 0; i < RBUF_SIZE; i++) {
+    if ((_free == NULL) && (_age == NULL)) {
+        /* every entry is either free or in use, so this is the first call */
+        for (unsigned int i = 0; i < RBUF_SIZE; i++) {
+            LL_PREPEND(_free, &rbuf[i]);
+        }
+    }
+
+    LL_FOREACH(*bucket, res) {
         /* check first if entry already available */
-        if ((rbuf[i].pkt != NULL) && (rbuf[i].pkt->size == size) &&
-            (rbuf[i].tag == tag) && (rbuf[i].src_len == src_len) &&
-            (rbuf[i].dst_len == dst_len) &&
-            (memcmp(rbuf[i].src, src, src_len) == 0) &&
-            (memcmp(rbuf[i].dst, dst, dst_len) == 0)) {
-            DEBUG("6lo rfrag: entry %p (%s, ", (void *)(&rbuf[i]),
+        if ((res->size == size) && (res->tag == tag) &&
+            (res->src_len == src_len) && (res->dst_len == dst_len) &&
+            (memcmp(res->src, src, src_len) == 0) &&
+            (memcmp(res->dst, dst, dst_len) == 0)) {
+            if ((now_usec - res->arrival) > RBUF_TIMEOUT) {
+                /* garbage collection did not get to it yet */
+                gnrc_pktbuf_release(res->pkt);
+                _rbuf_rem(res);
+                break;
+            }
+            DEBUG("6lo rfrag: entry %p (%s, ", (void *)res,
                   gnrc_netif_addr_to_str(l2addr_str, sizeof(l2addr_str),
-                                         rbuf[i].src, rbuf[i].src_len));
+                                         res->src, res->src_len));
             DEBUG("%s, %u, %u) found\n",
                   gnrc_netif_addr_to_str(l2addr_str, sizeof(l2addr_str),
-                                         rbuf[i].dst, rbuf[i].dst_len),
-                  (unsigned)rbuf[i].pkt->size, rbuf[i].tag);
-            rbuf[i].arrival = now_usec;
-            return &(rbuf[i]);
-        }
-
-        /* if there is a free spot: remember it */
-        if ((res == NULL) && (rbuf[i].pkt == NULL)) {
-            res = &(rbuf[i]);
-        }
-
-        /* remember oldest slot */
-        /* note that xtimer_now will overflow in ~1.2 hours */
-        if ((oldest == NULL) || (oldest->arrival - rbuf[i].arrival < UINT32_MAX / 2)) {
-            oldest = &(rbuf[i]);
+                                         res->dst, res->dst_len),
+                  (unsigned)res->size, res->tag);
+            res->arrival = now_usec;
+            /* move to the end of the arrival order */
+            DL_DELETE2(_age, res, age_prev, age_next);
+            DL_APPEND2(_age, res, age_prev, age_next);
+            return res;
         }
     }
 
-    /* entry not in buffer and no empty spot found */
-    if (res == NULL) {
-        assert(oldest != NULL);
-        assert(oldest->pkt != NULL); /* if oldest->pkt == NULL, res must not be NULL */
-        DEBUG("6lo rfrag: reassembly buffer full, remove oldest entry\n");
-        gnrc_pktbuf_release(oldest->pkt);
-        _rbuf_rem(oldest);
-        res = oldest;
+    if (size > RBUF_BUDGET) {
+        DEBUG("6lo rfrag: datagram exceeds reassembly budget.\n");
+        return NULL;
     }
 
-    /* now we have an empty spot */
+    /* make room if needed */
+    while ((_free == NULL) || ((_used + size) > RBUF_BUDGET)) {
+        _rbuf_rem_oldest();
+    }
 
-    res->pkt = gnrc_pktbuf_add(NULL, NULL, size, GNRC_NETTYPE_IPV6);
-    if (res->pkt == NULL) {
-        DEBUG("6lo rfrag: can not allocate reassembly buffer space.\n");
-        return NULL;
+    res = _free;
+    while ((res->pkt = gnrc_pktbuf_add(NULL, NULL, size, GNRC_NETTYPE_IPV6)) == NULL) {
+        /* packet buffer is full, try again with less datagrams in reassembly */
+        if (!_rbuf_rem_oldest()) {
+            DEBUG("6lo rfrag: can not allocate reassembly buffer space.\n");
+            return NULL;
+        }
     }
+    LL_DELETE(_free, res);
 
     *((uint64_t *)res->pkt->data) = 0;  /* clean first few bytes for later
                                          * look-ups */
@@ -333,17 +377,32 @@ static rbuf_t *_rbuf_get(const void *src, size_t src_len,
     res->src_len = src_len;
     res->dst_len = dst_len;
     res->tag = tag;
+    res->size = size;
     res->cur_size = 0;
+    memset(res->received, 0, sizeof(res->received));
+    LL_PREPEND(*bucket, res);
+    DL_APPEND2(_age, res, age_prev, age_next);
+    _used += size;
+    _rbuf_gc_timer_set(RBUF_TIMEOUT + 1);
 
     DEBUG("6lo rfrag: entry %p (%s, ", (void *)res,
           gnrc_netif_addr_to_str(l2addr_str, sizeof(l2addr_str), res->src,
                                  res->src_len));
     DEBUG("%s, %u, %u) created\n",
           gnrc_netif_addr_to_str(l2addr_str, sizeof(l2addr_str), res->dst,
-                                 res->dst_len), (unsigned)res->pkt->size,
+                                 res->dst_len), (unsigned)res->size,
           res->tag);
 
     return res;
 }
 
+#ifdef TEST_SUITES
+void rbuf_reset(void)
+{
+    while (_rbuf_rem_oldest()) {}
+    xtimer_remove(&_gc_timer);
+    _gc_timer_set = false;
+}
+#endif
+
 /** @} */
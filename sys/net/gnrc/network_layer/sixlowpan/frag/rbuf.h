@@ -21,8 +21,12 @@
 
 #include <inttypes.h>
 
+#include "bitfield.h"
 #include "net/gnrc/netif/hdr.h"
 #include "net/gnrc/pkt.h"
+#include "net/gnrc/pktbuf.h"
+#include "net/ipv6.h"
+#include "net/sixlowpan.h"
 
 #include "net/gnrc/sixlowpan/frag.h"
 #ifdef __cplusplus
@@ -31,26 +35,58 @@ extern "C" {
 #endif
 
 #define RBUF_L2ADDR_MAX_LEN (8U)               /**< maximum length for link-layer addresses */
-#define RBUF_SIZE           (4U)               /**< size of the reassembly buffer */
-#define RBUF_TIMEOUT        (3U * SEC_IN_USEC) /**< timeout for reassembly in microseconds */
 
+#ifndef RBUF_SIZE
+/**
+ * @brief   Maximum number of datagrams in reassembly at the same time
+ */
+#define RBUF_SIZE           (8U)
+#endif
+
+#ifndef RBUF_BUDGET
+/**
+ * @brief   Maximum number of bytes all datagrams in reassembly may occupy in
+ *          the packet buffer together
+ *
+ * @details If a new datagram does not fit, the datagrams that did not receive
+ *          a fragment for the longest time are discarded to make room.
+ */
+#if GNRC_PKTBUF_SIZE > 0
+#define RBUF_BUDGET         (GNRC_PKTBUF_SIZE / 2)
+#else
+#define RBUF_BUDGET         (4U * IPV6_MIN_MTU)
+#endif
+#endif
+
+#ifndef RBUF_HASH_SIZE
 /**
- * @brief   Fragment intervals to identify limits of fragments.
+ * @brief   Number of hash buckets to look up datagrams in reassembly
  *
- * @note    Fragments MUST NOT overlap and overlapping fragments are to be
- *          discarded
+ * @note    Must be a power of two.
+ */
+#define RBUF_HASH_SIZE      (8U)
+#endif
+
+#ifndef RBUF_TIMEOUT
+#define RBUF_TIMEOUT        (3U * SEC_IN_USEC) /**< timeout for reassembly in microseconds */
+#endif
+#define RBUF_GC_SLACK       (RBUF_TIMEOUT / 4) /**< time in microseconds the garbage
+                                                *   collection may be late */
+
+/**
+ * @brief   Granularity of fragment offsets in bytes
  *
  * @see <a href="https://tools.ietf.org/html/rfc4944#section-5.3">
  *          RFC 4944, section 5.3
  *      </a>
- *
- * @internal
  */
-typedef struct rbuf_int {
-    struct rbuf_int *next;  /**< next element in interval list */
-    uint16_t start;         /**< start byte of interval */
-    uint16_t end;           /**< end byte of interval */
-} rbuf_int_t;
+#define RBUF_UNIT_SIZE      (8U)
+
+/**
+ * @brief   Number of bits needed to track the reception of every
+ *          @ref RBUF_UNIT_SIZE unit of the largest possible datagram
+ */
+#define RBUF_UNITS          ((SIXLOWPAN_FRAG_SIZE_MASK + 1) / RBUF_UNIT_SIZE)
 
 /**
  * @brief   An entry in the 6LoWPAN reassembly buffer.
@@ -59,19 +95,25 @@ typedef struct rbuf_int {
  *
  * 1. the source address,
  * 2. the destination address,
- * 3. the datagram size (gnrc_pktsnip_t::size of rbuf_t::pkt), and
+ * 3. the datagram size (rbuf_t::size), and
  * 4. the datagram tag
  *
  * to identify all fragments that belong to the given datagram.
  *
+ * Fragments MUST NOT overlap and overlapping fragments are to be discarded,
+ * so the received parts of the datagram are tracked with a bitmap of
+ * @ref RBUF_UNIT_SIZE byte units, the granularity of fragment offsets.
+ *
  * @see <a href="https://tools.ietf.org/html/rfc4944#section-5.3">
  *          RFC 4944, section 5.3
  *      </a>
  *
  * @internal
  */
-typedef struct {
-    rbuf_int_t *ints;                   /**< intervals of the fragment */
+typedef struct rbuf {
+    struct rbuf *next;                  /**< next entry in hash bucket or free list */
+    struct rbuf *age_prev;              /**< previous entry in arrival order */
+    struct rbuf *age_next;              /**< next entry in arrival order */
     gnrc_pktsnip_t *pkt;                /**< the reassembled packet in packet buffer */
     uint32_t arrival;                   /**< time in microseconds of arrival of
                                          *   last received fragment */
@@ -80,7 +122,9 @@ typedef struct {
     uint8_t src_len;                    /**< length of source address */
     uint8_t dst_len;                    /**< length of destination address */
     uint16_t tag;                       /**< the datagram's tag */
+    uint16_t size;                      /**< the datagram's size */
     uint16_t cur_size;                  /**< the datagram's current size */
+    BITFIELD(received, RBUF_UNITS);     /**< received units of the datagram */
 } rbuf_t;
 
 /**
@@ -100,6 +144,27 @@ typedef struct {
 void rbuf_add(gnrc_netif_hdr_t *netif_hdr, gnrc_pktsnip_t *frag,
               size_t frag_size, size_t offset);
 
+/**
+ * @brief   Removes timed out entries from the reassembly buffer.
+ *
+ * Called when the garbage collection timer of the reassembly buffer fired.
+ * The timer is set with a slack of @ref RBUF_GC_SLACK while the buffer holds
+ * entries, so stale fragments are released even if no further fragments
+ * arrive.
+ *
+ * @internal
+ */
+void rbuf_gc(void);
+
+#ifdef TEST_SUITES
+/**
+ * @brief   Removes all entries from the reassembly buffer.
+ *
+ * @internal
+ */
+void rbuf_reset(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
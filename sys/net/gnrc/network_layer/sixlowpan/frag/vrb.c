@@ -0,0 +1,385 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "vrb.h"
+#include "net/ipv6/hdr.h"
+#include "net/gnrc.h"
+#include "net/gnrc/ipv6/netif.h"
+#include "net/gnrc/sixlowpan.h"
+#include "net/gnrc/sixlowpan/frag.h"
+#include "net/gnrc/sixlowpan/iphc.h"
+#include "net/gnrc/sixlowpan/nd.h"
+#include "net/gnrc/sixlowpan/netif.h"
+#include "net/sixlowpan.h"
+#include "net/udp.h"
+#include "xtimer.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+static vrb_t vrb[VRB_SIZE];
+
+#if ENABLE_DEBUG
+static char addr_str[IPV6_ADDR_MAX_STR_LEN];
+#endif
+
+/* ------------------------------------
+ * internal function definitions
+ * ------------------------------------*/
+/* gets an entry identified by its tupel or, if create is true, a free one */
+static vrb_t *_vrb_get(const void *src, size_t src_len, size_t size,
+                       uint16_t tag, bool create);
+/* decompresses the first fragment and determines its next hop */
+static gnrc_pktsnip_t *_vrb_fwd_frag1(vrb_t *entry, gnrc_pktsnip_t *pkt,
+                                      size_t frag_size, uint16_t *uncomp_size);
+/* creates a subsequent fragment to the next hop */
+static gnrc_pktsnip_t *_vrb_fwd_fragn(vrb_t *entry, gnrc_pktsnip_t *pkt);
+/* marks a part of the datagram forwarded, returns the number of its bytes
+ * not forwarded before */
+static uint16_t _vrb_update_units(vrb_t *entry, size_t offset, size_t size);
+
+bool vrb_fwd(gnrc_netif_hdr_t *netif_hdr, gnrc_pktsnip_t *pkt,
+             size_t frag_size, size_t offset)
+{
+    sixlowpan_frag_t *frag = pkt->data;
+    uint16_t size = byteorder_ntohs(frag->disp_size) & SIXLOWPAN_FRAG_SIZE_MASK;
+    uint16_t uncomp_size = frag_size;
+    gnrc_pktsnip_t *out;
+    vrb_t *entry;
+
+    entry = _vrb_get(gnrc_netif_hdr_get_src_addr(netif_hdr), netif_hdr->src_l2addr_len,
+                     size, byteorder_ntohs(frag->tag), (offset == 0));
+
+    if (entry == NULL) {
+        /* subsequent fragment of a datagram that is not forwarded or
+         * table full */
+        return false;
+    }
+
+    if ((entry->out_dst_len > 0) &&
+        bf_isset(entry->forwarded, offset / RBUF_UNIT_SIZE)) {
+        /* a fragment can not start within another one, it is a duplicate */
+        DEBUG("6lo vrb: fragment (offset: %u) already forwarded, dropping it\n",
+              (unsigned)offset);
+        return true;
+    }
+
+    if (offset == 0) {
+        out = _vrb_fwd_frag1(entry, pkt, frag_size, &uncomp_size);
+        if (out == NULL) {
+            /* not forwardable, reassemble instead */
+            return false;
+        }
+    }
+    else if ((out = _vrb_fwd_fragn(entry, pkt)) == NULL) {
+        DEBUG("6lo vrb: unable to forward fragment, dropping it\n");
+        return true;
+    }
+
+    DEBUG("6lo vrb: forward fragment (tag: %" PRIu16 " => %" PRIu16 ", offset: %u) "
+          "over interface %" PRIkernel_pid "\n", entry->tag, entry->out_tag,
+          (unsigned)offset, entry->out_iface);
+
+    entry->arrival = xtimer_now();
+    if (gnrc_netapi_send(entry->out_iface, out) < 1) {
+        DEBUG("6lo vrb: unable to forward fragment\n");
+        gnrc_pktbuf_release(out);
+    }
+
+    /* entry is not needed anymore, when all fragments were forwarded.
+     * Lost fragments will let it time out instead */
+    uncomp_size = _vrb_update_units(entry, offset, uncomp_size);
+    if (uncomp_size >= entry->remaining) {
+        entry->out_dst_len = 0;
+    }
+    else {
+        entry->remaining -= uncomp_size;
+    }
+
+    return true;
+}
+
+static uint16_t _vrb_update_units(vrb_t *entry, size_t offset, size_t size)
+{
+    size_t end = offset + size;
+    uint16_t res = 0;
+
+    if (end > entry->size) {
+        end = entry->size;
+    }
+    for (size_t i = offset / RBUF_UNIT_SIZE; (i * RBUF_UNIT_SIZE) < end; i++) {
+        if (!bf_isset(entry->forwarded, i)) {
+            size_t unit_end = (i + 1) * RBUF_UNIT_SIZE;
+
+            bf_set(entry->forwarded, i);
+            res += ((unit_end < end) ? unit_end : end) - (i * RBUF_UNIT_SIZE);
+        }
+    }
+
+    return res;
+}
+
+static vrb_t *_vrb_get(const void *src, size_t src_len, size_t size,
+                       uint16_t tag, bool create)
+{
+    vrb_t *res = NULL;
+    uint32_t now_usec = xtimer_now();
+
+    for (unsigned int i = 0; i < VRB_SIZE; i++) {
+        if ((vrb[i].out_dst_len > 0) && ((now_usec - vrb[i].arrival) > VRB_TIMEOUT)) {
+            DEBUG("6lo vrb: entry (tag: %" PRIu16 ") timed out\n", vrb[i].tag);
+            vrb[i].out_dst_len = 0;
+        }
+
+        if ((vrb[i].out_dst_len > 0) && (vrb[i].size == size) &&
+            (vrb[i].tag == tag) && (vrb[i].src_len == src_len) &&
+            (memcmp(vrb[i].src, src, src_len) == 0)) {
+            return &vrb[i];
+        }
+
+        /* if there is a free spot: remember it */
+        if ((res == NULL) && (vrb[i].out_dst_len == 0)) {
+            res = &vrb[i];
+        }
+    }
+
+    if (!create || (res == NULL)) {
+        return NULL;
+    }
+
+    memcpy(res->src, src, src_len);
+    res->src_len = src_len;
+    res->size = size;
+    res->tag = tag;
+    res->out_tag = gnrc_sixlowpan_frag_next_tag();
+    res->remaining = size;
+    memset(res->forwarded, 0, sizeof(res->forwarded));
+    /* res->out_dst_len is set when the first fragment was found to be
+     * forwardable */
+
+    return res;
+}
+
+static gnrc_pktsnip_t *_vrb_build(vrb_t *entry, gnrc_pktsnip_t *payload,
+                                  size_t hdr_size)
+{
+    gnrc_sixlowpan_netif_t *iface = gnrc_sixlowpan_netif_get(entry->out_iface);
+    gnrc_pktsnip_t *netif, *frag;
+    uint8_t *data;
+
+    if ((iface == NULL) || ((hdr_size + gnrc_pkt_len(payload)) > iface->max_frag_size)) {
+        DEBUG("6lo vrb: fragment does not fit next link\n");
+        return NULL;
+    }
+
+    netif = gnrc_netif_hdr_build(NULL, 0, entry->out_dst, entry->out_dst_len);
+
+    if (netif == NULL) {
+        DEBUG("6lo vrb: error allocating link-layer header\n");
+        return NULL;
+    }
+
+    ((gnrc_netif_hdr_t *)netif->data)->if_pid = entry->out_iface;
+    frag = gnrc_pktbuf_add(NULL, NULL, hdr_size + gnrc_pkt_len(payload),
+                           GNRC_NETTYPE_SIXLOWPAN);
+
+    if (frag == NULL) {
+        DEBUG("6lo vrb: error allocating fragment\n");
+        gnrc_pktbuf_release(netif);
+        return NULL;
+    }
+
+    data = ((uint8_t *)frag->data) + hdr_size;
+
+    while (payload != NULL) {
+        memcpy(data, payload->data, payload->size);
+        data += payload->size;
+        payload = payload->next;
+    }
+
+    netif->next = frag;
+
+    return netif;
+}
+
+static gnrc_pktsnip_t *_vrb_fwd_frag1(vrb_t *entry, gnrc_pktsnip_t *pkt,
+                                      size_t frag_size, uint16_t *uncomp_size)
+{
+    uint8_t *data = ((uint8_t *)pkt->data) + sizeof(sixlowpan_frag_t);
+    gnrc_pktsnip_t *ipv6, *payload, *out;
+    gnrc_sixlowpan_netif_t *out_if;
+    uint8_t l2addr_len = RBUF_L2ADDR_MAX_LEN;
+    size_t hdr_len, nh_len = 0;
+    kernel_pid_t out_iface;
+    ipv6_hdr_t *hdr;
+    sixlowpan_frag_t *frag;
+
+    /* room for IPv6 header and a decompressed UDP header */
+    ipv6 = gnrc_pktbuf_add(NULL, NULL, sizeof(ipv6_hdr_t) + sizeof(udp_hdr_t),
+                           GNRC_NETTYPE_IPV6);
+
+    if (ipv6 == NULL) {
+        DEBUG("6lo vrb: error allocating IPv6 header\n");
+        return NULL;
+    }
+
+    if ((data[0] == SIXLOWPAN_UNCOMP) && (frag_size > sizeof(ipv6_hdr_t))) {
+        memcpy(ipv6->data, data + 1, sizeof(ipv6_hdr_t));
+        hdr_len = 1 + sizeof(ipv6_hdr_t);
+    }
+#ifdef MODULE_GNRC_SIXLOWPAN_IPHC
+    else if (sixlowpan_iphc_is(data)) {
+        hdr_len = gnrc_sixlowpan_iphc_decode(&ipv6, pkt, entry->size,
+                                             sizeof(sixlowpan_frag_t), &nh_len);
+        if ((hdr_len == 0) || (hdr_len > frag_size)) {
+            DEBUG("6lo vrb: could not decode IPHC dispatch\n");
+            gnrc_pktbuf_release(ipv6);
+            return NULL;
+        }
+    }
+#endif
+    else {
+        gnrc_pktbuf_release(ipv6);
+        return NULL;
+    }
+
+    hdr = ipv6->data;
+
+    DEBUG("6lo vrb: first fragment to %s\n",
+          ipv6_addr_to_str(addr_str, &hdr->dst, sizeof(addr_str)));
+
+    /* RFC 4291, section 2.5.6: Routers must not forward any packets with
+     * link-local source or destination addresses to other links, and leave
+     * everything the IPv6 layer handles specially to it */
+    if (ipv6_addr_is_link_local(&hdr->src) || ipv6_addr_is_link_local(&hdr->dst) ||
+        ipv6_addr_is_multicast(&hdr->dst) || (hdr->hl <= 1) ||
+        (gnrc_ipv6_netif_find_by_addr(NULL, &hdr->dst) != KERNEL_PID_UNDEF)) {
+        DEBUG("6lo vrb: datagram needs to be handled by IPv6\n");
+        gnrc_pktbuf_release(ipv6);
+        return NULL;
+    }
+
+    out_iface = gnrc_sixlowpan_nd_next_hop_l2addr(entry->out_dst, &l2addr_len,
+                                                  KERNEL_PID_UNDEF, &hdr->dst);
+    if ((out_iface <= KERNEL_PID_UNDEF) || (l2addr_len == 0) ||
+        ((out_if = gnrc_sixlowpan_netif_get(out_iface)) == NULL)) {
+        DEBUG("6lo vrb: no 6LoWPAN next hop found\n");
+        gnrc_pktbuf_release(ipv6);
+        return NULL;
+    }
+
+    hdr->hl--;
+
+    /* everything after the (possibly compressed) headers stays as is, so the
+     * offsets of all subsequent fragments remain valid */
+    payload = gnrc_pktbuf_add(NULL, NULL, nh_len + frag_size - hdr_len,
+                              GNRC_NETTYPE_IPV6);
+    if (payload == NULL) {
+        DEBUG("6lo vrb: error allocating payload\n");
+        gnrc_pktbuf_release(ipv6);
+        return NULL;
+    }
+    memcpy(payload->data, hdr + 1, nh_len);
+    memcpy(((uint8_t *)payload->data) + nh_len, data + hdr_len, frag_size - hdr_len);
+    gnrc_pktbuf_realloc_data(ipv6, sizeof(ipv6_hdr_t));
+    ipv6->next = payload;
+    *uncomp_size = sizeof(ipv6_hdr_t) + payload->size;
+
+    /* (re-)compress the header for the next link, since IPHC might have
+     * derived addresses from the link-layer addresses of the last one */
+    entry->out_iface = out_iface;
+    entry->out_dst_len = l2addr_len;
+
+    if ((out = gnrc_netif_hdr_build(NULL, 0, entry->out_dst, l2addr_len)) == NULL) {
+        DEBUG("6lo vrb: error allocating link-layer header\n");
+        gnrc_pktbuf_release(ipv6);
+        entry->out_dst_len = 0;
+        return NULL;
+    }
+    ((gnrc_netif_hdr_t *)out->data)->if_pid = out_iface;
+    out->next = ipv6;
+
+#ifdef MODULE_GNRC_SIXLOWPAN_IPHC
+    if (out_if->iphc_enabled) {
+        if (!gnrc_sixlowpan_iphc_encode(out)) {
+            DEBUG("6lo vrb: error on IPHC encoding\n");
+            gnrc_pktbuf_release(out);
+            entry->out_dst_len = 0;
+            return NULL;
+        }
+    }
+    else
+#endif
+    {
+        uint8_t disp = SIXLOWPAN_UNCOMP;
+        gnrc_pktsnip_t *dispatch = gnrc_pktbuf_add(ipv6, &disp, sizeof(disp),
+                                                   GNRC_NETTYPE_SIXLOWPAN);
+
+        if (dispatch == NULL) {
+            DEBUG("6lo vrb: error allocating dispatch\n");
+            gnrc_pktbuf_release(out);
+            entry->out_dst_len = 0;
+            return NULL;
+        }
+        out->next = dispatch;
+    }
+
+    payload = out->next;
+    out->next = NULL;
+    gnrc_pktbuf_release(out);
+
+    if ((out = _vrb_build(entry, payload, sizeof(sixlowpan_frag_t))) == NULL) {
+        gnrc_pktbuf_release(payload);
+        entry->out_dst_len = 0;
+        return NULL;
+    }
+    gnrc_pktbuf_release(payload);
+
+    frag = out->next->data;
+    frag->disp_size = byteorder_htons(entry->size);
+    frag->disp_size.u8[0] |= SIXLOWPAN_FRAG_1_DISP;
+    frag->tag = byteorder_htons(entry->out_tag);
+
+    return out;
+}
+
+static gnrc_pktsnip_t *_vrb_fwd_fragn(vrb_t *entry, gnrc_pktsnip_t *pkt)
+{
+    gnrc_pktsnip_t *out;
+    sixlowpan_frag_n_t *frag;
+
+    /* the fragment is forwarded as is, only with a new tag */
+    if ((out = _vrb_build(entry, NULL, pkt->size)) == NULL) {
+        return NULL;
+    }
+
+    frag = out->next->data;
+    memcpy(frag, pkt->data, pkt->size);
+    frag->tag = byteorder_htons(entry->out_tag);
+
+    return out;
+}
+
+#ifdef TEST_SUITES
+void vrb_reset(void)
+{
+    memset(vrb, 0, sizeof(vrb));
+}
+#endif
+
+/** @} */
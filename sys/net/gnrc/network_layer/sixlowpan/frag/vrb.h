@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_gnrc_sixlowpan_frag
+ * @{
+ *
+ * @file
+ * @internal
+ * @brief   6LoWPAN virtual reassembly buffer
+ *
+ * With module `gnrc_sixlowpan_frag_vrb` a router forwards the fragments of a
+ * datagram that is not addressed to it without reassembling the datagram.
+ * Only the first fragment is decompressed to find the next hop, all following
+ * fragments are switched to that next hop by their datagram tag.
+ *
+ * A subsequent fragment that arrives before the first fragment of its
+ * datagram can not be switched, since its next hop is not known yet. It is
+ * handed to the reassembly buffer instead and never forwarded: the datagram
+ * reaches the next hop without it and times out there, just as if the
+ * fragment was lost on the link.
+ *
+ * @see <a href="https://tools.ietf.org/html/draft-ietf-6lo-minimal-fragment">
+ *          draft-ietf-6lo-minimal-fragment
+ *      </a>
+ */
+#ifndef GNRC_SIXLOWPAN_FRAG_VRB_H_
+#define GNRC_SIXLOWPAN_FRAG_VRB_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "kernel_types.h"
+#include "net/gnrc/netif/hdr.h"
+#include "net/gnrc/pkt.h"
+
+#include "rbuf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef VRB_SIZE
+/**
+ * @brief   Maximum number of datagrams forwarded at the same time
+ */
+#define VRB_SIZE            (8U)
+#endif
+
+#define VRB_TIMEOUT         (RBUF_TIMEOUT)  /**< timeout in microseconds after
+                                             *   the last fragment of a
+                                             *   datagram */
+
+/**
+ * @brief   An entry in the virtual reassembly buffer.
+ *
+ * @details Maps a datagram, identified by the link-layer source address,
+ *          the datagram size and the datagram tag of its fragments, to the
+ *          interface, next hop and datagram tag its fragments are forwarded
+ *          with.
+ *
+ *          The forwarded parts of the datagram are tracked in
+ *          @ref RBUF_UNIT_SIZE byte units like in the reassembly buffer, so
+ *          duplicate fragments are dropped and not mistaken for the rest of
+ *          the datagram.
+ *
+ * @internal
+ */
+typedef struct {
+    uint32_t arrival;                       /**< time in microseconds of arrival of
+                                             *   last received fragment */
+    uint8_t src[RBUF_L2ADDR_MAX_LEN];       /**< source address */
+    uint8_t out_dst[RBUF_L2ADDR_MAX_LEN];   /**< link-layer address of the next hop */
+    uint8_t src_len;                        /**< length of source address */
+    uint8_t out_dst_len;                    /**< length of next hop address,
+                                             *   0 if entry is unused */
+    kernel_pid_t out_iface;                 /**< interface to the next hop */
+    uint16_t tag;                           /**< the datagram's tag */
+    uint16_t out_tag;                       /**< the datagram's tag towards the next hop */
+    uint16_t size;                          /**< the datagram's size */
+    uint16_t remaining;                     /**< number of bytes of the datagram
+                                             *   not yet forwarded */
+    BITFIELD(forwarded, RBUF_UNITS);        /**< forwarded units of the datagram */
+} vrb_t;
+
+/**
+ * @brief   Forwards a fragment without reassembly, if possible.
+ *
+ * @param[in] netif_hdr     The interface header of the fragment.
+ * @param[in] frag          The fragment.
+ * @param[in] frag_size     The fragment's size (without fragment header).
+ * @param[in] offset        The fragment's offset.
+ *
+ * @return  true, if the fragment was forwarded (or dropped as part of a
+ *          forwarded datagram). @p frag is not released.
+ * @return  false, if the fragment needs to be reassembled.
+ *
+ * @internal
+ */
+bool vrb_fwd(gnrc_netif_hdr_t *netif_hdr, gnrc_pktsnip_t *frag,
+             size_t frag_size, size_t offset);
+
+#ifdef TEST_SUITES
+/**
+ * @brief   Removes all entries from the virtual reassembly buffer.
+ *
+ * @internal
+ */
+void vrb_reset(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GNRC_SIXLOWPAN_FRAG_VRB_H_ */
+/** @} */
@@ -35,7 +35,7 @@
 static kernel_pid_t _pid = KERNEL_PID_UNDEF;
 
 #ifdef MODULE_GNRC_SIXLOWPAN_FRAG
-static gnrc_sixlowpan_msg_frag_t fragment_msg = {KERNEL_PID_UNDEF, NULL, 0, 0};
+static gnrc_sixlowpan_msg_frag_t fragment_msg = {KERNEL_PID_UNDEF, NULL, 0, 0, 0};
 #endif
 
 #if ENABLE_DEBUG
@@ -280,7 +280,6 @@ static void _send(gnrc_pktsnip_t *pkt)
     else if (datagram_size <= SIXLOWPAN_FRAG_MAX_LEN) {
         DEBUG("6lo: Send fragmented (%u > %" PRIu16 ")\n",
               (unsigned int)datagram_size, iface->max_frag_size);
-        msg_t msg;
 
         fragment_msg.pid = hdr->if_pid;
         fragment_msg.pkt = pkt2;
@@ -288,11 +287,7 @@ static void _send(gnrc_pktsnip_t *pkt)
         /* Sending the first fragment has an offset==0 */
         fragment_msg.offset = 0;
 
-        /* set the outgoing message's fields */
-        msg.type = GNRC_SIXLOWPAN_MSG_FRAG_SND;
-        msg.content.ptr = (void *)&fragment_msg;
-        /* send message to self */
-        msg_send_to_self(&msg);
+        gnrc_sixlowpan_frag_send(&fragment_msg);
     }
     else {
         DEBUG("6lo: packet too big (%u > %" PRIu16 ")\n",
@@ -307,9 +302,23 @@ static void _send(gnrc_pktsnip_t *pkt)
 #endif
 }
 
+static void _receive_batched(gnrc_pktsnip_t *pkt, void *arg)
+{
+    (void)arg;
+    _receive(pkt);
+}
+
+static void _send_batched(gnrc_pktsnip_t *pkt, void *arg)
+{
+    (void)arg;
+    _send(pkt);
+}
+
 static void *_event_loop(void *args)
 {
     msg_t msg, reply, msg_q[GNRC_SIXLOWPAN_MSG_QUEUE_SIZE];
+    gnrc_netapi_batch_t batch;
+    int dropped;
     gnrc_netreg_entry_t me_reg;
 
     (void)args;
@@ -328,6 +337,7 @@ static void *_event_loop(void *args)
     while (1) {
         DEBUG("6lo: waiting for incoming message.\n");
         msg_receive(&msg);
+        gnrc_netapi_batch_begin(&batch);
 
         switch (msg.type) {
             case GNRC_NETAPI_MSG_TYPE_RCV:
@@ -340,6 +350,16 @@ static void *_event_loop(void *args)
                 _send((gnrc_pktsnip_t *)msg.content.ptr);
                 break;
 
+            case GNRC_NETAPI_MSG_TYPE_RCV_BATCH:
+                DEBUG("6lo: GNRC_NETAPI_MSG_TYPE_RCV_BATCH received\n");
+                gnrc_netapi_batch_handle(&msg, _receive_batched, NULL);
+                break;
+
+            case GNRC_NETAPI_MSG_TYPE_SND_BATCH:
+                DEBUG("6lo: GNRC_NETAPI_MSG_TYPE_SND_BATCH received\n");
+                gnrc_netapi_batch_handle(&msg, _send_batched, NULL);
+                break;
+
             case GNRC_NETAPI_MSG_TYPE_GET:
             case GNRC_NETAPI_MSG_TYPE_SET:
                 DEBUG("6lo: reply to unsupported get/set\n");
@@ -351,12 +371,20 @@ static void *_event_loop(void *args)
                 DEBUG("6lo: send fragmented event received\n");
                 gnrc_sixlowpan_frag_send((gnrc_sixlowpan_msg_frag_t *)msg.content.ptr);
                 break;
+
+            case GNRC_SIXLOWPAN_MSG_FRAG_GC_RBUF:
+                DEBUG("6lo: garbage collect reassembly buffer event received\n");
+                gnrc_sixlowpan_frag_gc_rbuf();
+                break;
 #endif
 
             default:
                 DEBUG("6lo: operation not supported\n");
                 break;
         }
+        if ((dropped = gnrc_netapi_batch_end()) > 0) {
+            DEBUG("6lo: %d packets passed on were dropped\n", dropped);
+        }
     }
 
     return NULL;
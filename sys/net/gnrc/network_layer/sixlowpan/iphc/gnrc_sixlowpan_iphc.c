@@ -27,6 +27,7 @@
 #include "utlist.h"
 #include "net/gnrc/nettype.h"
 #include "net/gnrc/udp.h"
+#include "xtimer.h"
 
 #include "net/gnrc/sixlowpan/iphc.h"
 
@@ -236,17 +237,19 @@ size_t gnrc_sixlowpan_iphc_decode(gnrc_pktsnip_t **dec_hdr, gnrc_pktsnip_t *pkt,
     switch (iphc_hdr[IPHC1_IDX] & SIXLOWPAN_IPHC1_TF) {
         case IPHC_TF_ECN_DSCP_FL:
             ipv6_hdr_set_tc(ipv6_hdr, iphc_hdr[payload_offset++]);
-            ipv6_hdr->v_tc_fl.u8[1] |= iphc_hdr[payload_offset++] & 0x0f;
-            ipv6_hdr->v_tc_fl.u8[2] |= iphc_hdr[payload_offset++];
-            ipv6_hdr->v_tc_fl.u8[3] |= iphc_hdr[payload_offset++];
+            ipv6_hdr_set_fl(ipv6_hdr, ((uint32_t)(iphc_hdr[payload_offset] & 0x0f) << 16) |
+                                      (iphc_hdr[payload_offset + 1] << 8) |
+                                      iphc_hdr[payload_offset + 2]);
+            payload_offset += 3;
             break;
 
         case IPHC_TF_ECN_FL:
             ipv6_hdr_set_tc_ecn(ipv6_hdr, iphc_hdr[payload_offset] >> 6);
             ipv6_hdr_set_tc_dscp(ipv6_hdr, 0);
-            ipv6_hdr->v_tc_fl.u8[1] |= iphc_hdr[payload_offset++] & 0x0f;
-            ipv6_hdr->v_tc_fl.u8[2] |= iphc_hdr[payload_offset++];
-            ipv6_hdr->v_tc_fl.u8[3] |= iphc_hdr[payload_offset++];
+            ipv6_hdr_set_fl(ipv6_hdr, ((uint32_t)(iphc_hdr[payload_offset] & 0x0f) << 16) |
+                                      (iphc_hdr[payload_offset + 1] << 8) |
+                                      iphc_hdr[payload_offset + 2]);
+            payload_offset += 3;
             break;
 
         case IPHC_TF_ECN_DSCP:
@@ -582,27 +585,138 @@ inline static size_t iphc_nhc_udp_encode(gnrc_pktsnip_t *udp, ipv6_hdr_t *ipv6_h
 }
 #endif
 
-bool gnrc_sixlowpan_iphc_encode(gnrc_pktsnip_t *pkt)
+/**
+ * @brief   Compressed header parts of a flow that do not change from packet
+ *          to packet
+ */
+typedef struct {
+    ipv6_addr_t src;                            /**< IPv6 source address */
+    ipv6_addr_t dst;                            /**< IPv6 destination address */
+    uint32_t created;                           /**< time the entry was encoded */
+    uint32_t ctx_gen;                           /**< generation of the contexts */
+    uint32_t l2addr_gen;                        /**< generation of the interfaces'
+                                                 *   link-layer addresses */
+    kernel_pid_t if_pid;                        /**< interface, KERNEL_PID_UNDEF
+                                                 *   if entry is unused */
+    uint8_t src_l2addr[GNRC_NETIF_HDR_L2ADDR_MAX_LEN];  /**< link-layer source */
+    uint8_t dst_l2addr[GNRC_NETIF_HDR_L2ADDR_MAX_LEN];  /**< link-layer destination */
+    uint8_t src_l2addr_len;                     /**< length of gnrc_sixlowpan_iphc_flow_t::src_l2addr */
+    uint8_t dst_l2addr_len;                     /**< length of gnrc_sixlowpan_iphc_flow_t::dst_l2addr */
+    uint8_t nh;                                 /**< next header */
+    uint8_t hl;                                 /**< hop limit */
+    /**
+     * @brief   IPHC dispatch without TF bits and context identifier extension
+     */
+    uint8_t iphc[SIXLOWPAN_IPHC_HDR_LEN + SIXLOWPAN_IPHC_CID_EXT_LEN];
+    uint8_t inline_len;                         /**< length of gnrc_sixlowpan_iphc_flow_t::inline_data */
+    /**
+     * @brief   Next header, hop limit, source and destination carried inline
+     */
+    uint8_t inline_data[2 + (2 * sizeof(ipv6_addr_t))];
+} gnrc_sixlowpan_iphc_flow_t;
+
+#if GNRC_SIXLOWPAN_IPHC_CACHE_SIZE
+static gnrc_sixlowpan_iphc_flow_t _flows[GNRC_SIXLOWPAN_IPHC_CACHE_SIZE];
+static unsigned _flow_last, _flow_next;
+
+static inline bool _flow_match(const gnrc_sixlowpan_iphc_flow_t *flow,
+                               gnrc_netif_hdr_t *netif_hdr,
+                               const ipv6_hdr_t *ipv6_hdr)
 {
-    gnrc_netif_hdr_t *netif_hdr = pkt->data;
-    ipv6_hdr_t *ipv6_hdr = pkt->next->data;
-    uint8_t *iphc_hdr;
-    uint16_t inline_pos = SIXLOWPAN_IPHC_HDR_LEN;
-    bool addr_comp = false, nhc_comp = false;
-    gnrc_sixlowpan_ctx_t *src_ctx = NULL, *dst_ctx = NULL;
-    gnrc_pktsnip_t *dispatch = gnrc_pktbuf_add(NULL, NULL, pkt->next->size,
-                                               GNRC_NETTYPE_SIXLOWPAN);
+    return (flow->if_pid == netif_hdr->if_pid) &&
+           (flow->nh == ipv6_hdr->nh) && (flow->hl == ipv6_hdr->hl) &&
+           (flow->src_l2addr_len == netif_hdr->src_l2addr_len) &&
+           (flow->dst_l2addr_len == netif_hdr->dst_l2addr_len) &&
+           ipv6_addr_equal(&flow->dst, &ipv6_hdr->dst) &&
+           ipv6_addr_equal(&flow->src, &ipv6_hdr->src) &&
+           (memcmp(flow->dst_l2addr, gnrc_netif_hdr_get_dst_addr(netif_hdr),
+                   flow->dst_l2addr_len) == 0) &&
+           (memcmp(flow->src_l2addr, gnrc_netif_hdr_get_src_addr(netif_hdr),
+                   flow->src_l2addr_len) == 0);
+}
 
-    if (dispatch == NULL) {
-        DEBUG("6lo iphc: error allocating dispatch space\n");
-        return false;
+static gnrc_sixlowpan_iphc_flow_t *_flow_lookup(gnrc_netif_hdr_t *netif_hdr,
+                                                const ipv6_hdr_t *ipv6_hdr)
+{
+    /* start with the flow of the last packet, they tend to come in bursts */
+    for (unsigned i = 0; i < GNRC_SIXLOWPAN_IPHC_CACHE_SIZE; i++) {
+        unsigned idx = (_flow_last + i) % GNRC_SIXLOWPAN_IPHC_CACHE_SIZE;
+        gnrc_sixlowpan_iphc_flow_t *flow = &_flows[idx];
+
+        if (_flow_match(flow, netif_hdr, ipv6_hdr)) {
+            if ((flow->ctx_gen != gnrc_sixlowpan_ctx_gen()) ||
+                (flow->l2addr_gen != gnrc_netif_get_l2addr_gen()) ||
+                ((xtimer_now() - flow->created) > GNRC_SIXLOWPAN_IPHC_CACHE_LTIME)) {
+                DEBUG("6lo iphc: cached flow is outdated\n");
+                flow->if_pid = KERNEL_PID_UNDEF;
+                return NULL;
+            }
+            _flow_last = idx;
+            return flow;
+        }
     }
+    return NULL;
+}
+
+static gnrc_sixlowpan_iphc_flow_t *_flow_alloc(gnrc_netif_hdr_t *netif_hdr,
+                                               const ipv6_hdr_t *ipv6_hdr)
+{
+    gnrc_sixlowpan_iphc_flow_t *flow = NULL;
+
+    if ((netif_hdr->src_l2addr_len > GNRC_NETIF_HDR_L2ADDR_MAX_LEN) ||
+        (netif_hdr->dst_l2addr_len > GNRC_NETIF_HDR_L2ADDR_MAX_LEN)) {
+        return NULL;
+    }
+    for (unsigned i = 0; i < GNRC_SIXLOWPAN_IPHC_CACHE_SIZE; i++) {
+        if (_flows[i].if_pid == KERNEL_PID_UNDEF) {
+            _flow_last = i;
+            flow = &_flows[i];
+            break;
+        }
+    }
+    if (flow == NULL) {
+        /* replace flows round-robin */
+        _flow_last = _flow_next;
+        flow = &_flows[_flow_next];
+        _flow_next = (_flow_next + 1) % GNRC_SIXLOWPAN_IPHC_CACHE_SIZE;
+    }
+    /* the generations must be taken before the contexts are looked up and
+     * the IID is taken from the interface */
+    flow->ctx_gen = gnrc_sixlowpan_ctx_gen();
+    flow->l2addr_gen = gnrc_netif_get_l2addr_gen();
+    flow->created = xtimer_now();
+    flow->if_pid = netif_hdr->if_pid;
+    flow->nh = ipv6_hdr->nh;
+    flow->hl = ipv6_hdr->hl;
+    flow->src = ipv6_hdr->src;
+    flow->dst = ipv6_hdr->dst;
+    flow->src_l2addr_len = netif_hdr->src_l2addr_len;
+    flow->dst_l2addr_len = netif_hdr->dst_l2addr_len;
+    memcpy(flow->src_l2addr, gnrc_netif_hdr_get_src_addr(netif_hdr),
+           netif_hdr->src_l2addr_len);
+    memcpy(flow->dst_l2addr, gnrc_netif_hdr_get_dst_addr(netif_hdr),
+           netif_hdr->dst_l2addr_len);
+    return flow;
+}
+#endif
 
-    iphc_hdr = dispatch->data;
+/**
+ * @brief   Encodes everything of the IPHC header except for the traffic class,
+ *          flow label and the next header compression into @p flow.
+ */
+static void _flow_encode(gnrc_sixlowpan_iphc_flow_t *flow, gnrc_netif_hdr_t *netif_hdr,
+                         ipv6_hdr_t *ipv6_hdr)
+{
+    uint8_t *iphc_hdr = flow->iphc;
+    uint8_t *inline_data = flow->inline_data;
+    uint16_t inline_pos = 0;
+    bool addr_comp = false;
+    gnrc_sixlowpan_ctx_t *src_ctx = NULL, *dst_ctx = NULL;
 
     /* set initial dispatch value*/
     iphc_hdr[IPHC1_IDX] = SIXLOWPAN_IPHC1_DISP;
     iphc_hdr[IPHC2_IDX] = 0;
+    iphc_hdr[CID_EXT_IDX] = 0;
 
     /* check for available contexts */
     if (!ipv6_addr_is_unspecified(&(ipv6_hdr->src))) {
@@ -613,65 +727,17 @@ bool gnrc_sixlowpan_iphc_encode(gnrc_pktsnip_t *pkt)
         dst_ctx = gnrc_sixlowpan_ctx_lookup_addr(&(ipv6_hdr->dst));
     }
 
-    /* if contexts available and both != 0 */
-    /* since this moves inline_pos we have to do this ahead*/
-    if (((src_ctx != NULL) &&
-         ((src_ctx->flags_id & GNRC_SIXLOWPAN_CTX_FLAGS_CID_MASK) != 0) &&
-         (src_ctx->flags_id & GNRC_SIXLOWPAN_CTX_FLAGS_COMP)) ||
-        ((dst_ctx != NULL) &&
-         ((dst_ctx->flags_id & GNRC_SIXLOWPAN_CTX_FLAGS_CID_MASK) != 0) &&
-         (dst_ctx->flags_id & GNRC_SIXLOWPAN_CTX_FLAGS_COMP))) {
-        /* add context identifier extension */
-        iphc_hdr[IPHC2_IDX] |= SIXLOWPAN_IPHC2_CID_EXT;
-        iphc_hdr[CID_EXT_IDX] = 0;
-
-        /* move position to behind CID extension */
-        inline_pos += SIXLOWPAN_IPHC_CID_EXT_LEN;
-    }
-
-    /* compress flow label and traffic class */
-    if (ipv6_hdr_get_fl(ipv6_hdr) == 0) {
-        if (ipv6_hdr_get_tc(ipv6_hdr) == 0) {
-            /* elide both traffic class and flow label */
-            iphc_hdr[IPHC1_IDX] |= IPHC_TF_ECN_ELIDE;
-        }
-        else {
-            /* elide flow label, traffic class (ECN + DSCP) inline (1 byte) */
-            iphc_hdr[IPHC1_IDX] |= IPHC_TF_ECN_DSCP;
-            iphc_hdr[inline_pos++] = ipv6_hdr_get_tc(ipv6_hdr);
-        }
-    }
-    else {
-        if (ipv6_hdr_get_tc_dscp(ipv6_hdr) == 0) {
-            /* elide DSCP, ECN + 2-bit pad + flow label inline (3 byte) */
-            iphc_hdr[IPHC1_IDX] |= IPHC_TF_ECN_FL;
-            iphc_hdr[inline_pos++] = (uint8_t)((ipv6_hdr_get_tc_ecn(ipv6_hdr) << 6) |
-                                               ((ipv6_hdr_get_fl(ipv6_hdr) & 0x000f0000) >> 16));
-        }
-        else {
-            /* ECN + DSCP + 4-bit pad + flow label (4 bytes) */
-            iphc_hdr[IPHC1_IDX] |= IPHC_TF_ECN_DSCP_FL;
-            iphc_hdr[inline_pos++] = ipv6_hdr_get_tc(ipv6_hdr);
-            iphc_hdr[inline_pos++] = (uint8_t)((ipv6_hdr_get_fl(ipv6_hdr) & 0x000f0000) >> 16);
-        }
-
-        /* copy remaining byteos of flow label */
-        iphc_hdr[inline_pos++] = (uint8_t)((ipv6_hdr_get_fl(ipv6_hdr) & 0x0000ff00) >> 8);
-        iphc_hdr[inline_pos++] = (uint8_t)((ipv6_hdr_get_fl(ipv6_hdr) & 0x000000ff) >> 8);
-    }
-
     /* compress next header */
     switch (ipv6_hdr->nh) {
 #ifdef MODULE_GNRC_SIXLOWPAN_IPHC_NHC
         case PROTNUM_UDP:
-            iphc_nhc_udp_encode(pkt->next->next, ipv6_hdr);
+            /* encoded per packet */
             iphc_hdr[IPHC1_IDX] |= SIXLOWPAN_IPHC1_NH;
-            nhc_comp = true;
             break;
 #endif
 
         default:
-            iphc_hdr[inline_pos++] = ipv6_hdr->nh;
+            inline_data[inline_pos++] = ipv6_hdr->nh;
             break;
     }
 
@@ -691,7 +757,7 @@ bool gnrc_sixlowpan_iphc_encode(gnrc_pktsnip_t *pkt)
 
         default:
             iphc_hdr[IPHC1_IDX] |= IPHC_HL_INLINE;
-            iphc_hdr[inline_pos++] = ipv6_hdr->hl;
+            inline_data[inline_pos++] = ipv6_hdr->hl;
             break;
     }
 
@@ -735,14 +801,14 @@ bool gnrc_sixlowpan_iphc_encode(gnrc_pktsnip_t *pkt)
                      (byteorder_ntohs(ipv6_hdr->src.u16[6]) == 0xfe00)) {
                 /* 16 bits. The address is derived using 16 bits carried inline */
                 iphc_hdr[IPHC2_IDX] |= IPHC_SAC_SAM_16;
-                memcpy(iphc_hdr + inline_pos, ipv6_hdr->src.u16 + 7, 2);
+                memcpy(inline_data + inline_pos, ipv6_hdr->src.u16 + 7, 2);
                 inline_pos += 2;
                 addr_comp = true;
             }
             else {
                 /* 64 bits. The address is derived using 64 bits carried inline */
                 iphc_hdr[IPHC2_IDX] |= IPHC_SAC_SAM_64;
-                memcpy(iphc_hdr + inline_pos, ipv6_hdr->src.u64 + 1, 8);
+                memcpy(inline_data + inline_pos, ipv6_hdr->src.u64 + 1, 8);
                 inline_pos += 8;
                 addr_comp = true;
             }
@@ -751,7 +817,7 @@ bool gnrc_sixlowpan_iphc_encode(gnrc_pktsnip_t *pkt)
         if (!addr_comp) {
             /* full address is carried inline */
             iphc_hdr[IPHC2_IDX] |= IPHC_SAC_SAM_FULL;
-            memcpy(iphc_hdr + inline_pos, &ipv6_hdr->src, 16);
+            memcpy(inline_data + inline_pos, &ipv6_hdr->src, 16);
             inline_pos += 16;
         }
     }
@@ -773,7 +839,7 @@ bool gnrc_sixlowpan_iphc_encode(gnrc_pktsnip_t *pkt)
                 (ipv6_hdr->dst.u8[14] == 0)) {
                 /* 8 bits. The address is derived using 8 bits carried inline */
                 iphc_hdr[IPHC2_IDX] |= IPHC_M_DAC_DAM_M_8;
-                iphc_hdr[inline_pos++] = ipv6_hdr->dst.u8[15];
+                inline_data[inline_pos++] = ipv6_hdr->dst.u8[15];
                 addr_comp = true;
             }
             /* if multicast address is of format ffXX::XX:XXXX */
@@ -781,8 +847,8 @@ bool gnrc_sixlowpan_iphc_encode(gnrc_pktsnip_t *pkt)
                      (ipv6_hdr->dst.u8[12] == 0)) {
                 /* 32 bits. The address is derived using 32 bits carried inline */
                 iphc_hdr[IPHC2_IDX] |= IPHC_M_DAC_DAM_M_32;
-                iphc_hdr[inline_pos++] = ipv6_hdr->dst.u8[1];
-                memcpy(iphc_hdr + inline_pos, ipv6_hdr->dst.u8 + 13, 3);
+                inline_data[inline_pos++] = ipv6_hdr->dst.u8[1];
+                memcpy(inline_data + inline_pos, ipv6_hdr->dst.u8 + 13, 3);
                 inline_pos += 3;
                 addr_comp = true;
             }
@@ -790,8 +856,8 @@ bool gnrc_sixlowpan_iphc_encode(gnrc_pktsnip_t *pkt)
             else if (ipv6_hdr->dst.u8[10] == 0) {
                 /* 48 bits. The address is derived using 48 bits carried inline */
                 iphc_hdr[IPHC2_IDX] |= IPHC_M_DAC_DAM_M_48;
-                iphc_hdr[inline_pos++] = ipv6_hdr->dst.u8[1];
-                memcpy(iphc_hdr + inline_pos, ipv6_hdr->dst.u8 + 11, 5);
+                inline_data[inline_pos++] = ipv6_hdr->dst.u8[1];
+                memcpy(inline_data + inline_pos, ipv6_hdr->dst.u8 + 11, 5);
                 inline_pos += 5;
                 addr_comp = true;
             }
@@ -816,9 +882,9 @@ bool gnrc_sixlowpan_iphc_encode(gnrc_pktsnip_t *pkt)
                 if ((ctx->flags_id & GNRC_SIXLOWPAN_CTX_FLAGS_CID_MASK) != 0) {
                     iphc_hdr[CID_EXT_IDX] |= (ctx->flags_id & GNRC_SIXLOWPAN_CTX_FLAGS_CID_MASK);
                 }
-                iphc_hdr[inline_pos++] = ipv6_hdr->dst.u8[1];
-                iphc_hdr[inline_pos++] = ipv6_hdr->dst.u8[2];
-                memcpy(iphc_hdr + inline_pos, ipv6_hdr->dst.u16 + 6, 4);
+                inline_data[inline_pos++] = ipv6_hdr->dst.u8[1];
+                inline_data[inline_pos++] = ipv6_hdr->dst.u8[2];
+                memcpy(inline_data + inline_pos, ipv6_hdr->dst.u16 + 6, 4);
                 inline_pos += 4;
                 addr_comp = true;
             }
@@ -850,14 +916,14 @@ bool gnrc_sixlowpan_iphc_encode(gnrc_pktsnip_t *pkt)
                  (byteorder_ntohs(ipv6_hdr->dst.u16[6]) == 0xfe00)) {
             /* 16 bits. The address is derived using 16 bits carried inline */
             iphc_hdr[IPHC2_IDX] |= IPHC_M_DAC_DAM_U_16;
-            memcpy(&(iphc_hdr[inline_pos]), &(ipv6_hdr->dst.u16[7]), 2);
+            memcpy(&(inline_data[inline_pos]), &(ipv6_hdr->dst.u16[7]), 2);
             inline_pos += 2;
             addr_comp = true;
         }
         else {
             /* 64 bits. The address is derived using 64 bits carried inline */
             iphc_hdr[IPHC2_IDX] |= IPHC_M_DAC_DAM_U_64;
-            memcpy(&(iphc_hdr[inline_pos]), &(ipv6_hdr->dst.u8[8]), 8);
+            memcpy(&(inline_data[inline_pos]), &(ipv6_hdr->dst.u8[8]), 8);
             inline_pos += 8;
             addr_comp = true;
         }
@@ -866,23 +932,103 @@ bool gnrc_sixlowpan_iphc_encode(gnrc_pktsnip_t *pkt)
     if (!addr_comp) {
         /* full destination address is carried inline */
         iphc_hdr[IPHC2_IDX] |= IPHC_SAC_SAM_FULL;
-        memcpy(iphc_hdr + inline_pos, &ipv6_hdr->dst, 16);
+        memcpy(inline_data + inline_pos, &ipv6_hdr->dst, 16);
         inline_pos += 16;
     }
 
-    if (nhc_comp) {
-        iphc_hdr[inline_pos++] = ipv6_hdr->nh;
+    /* add context identifier extension if any context != 0 is used */
+    if (iphc_hdr[CID_EXT_IDX] != 0) {
+        iphc_hdr[IPHC2_IDX] |= SIXLOWPAN_IPHC2_CID_EXT;
+    }
+
+    flow->inline_len = (uint8_t)inline_pos;
+}
+
+bool gnrc_sixlowpan_iphc_encode(gnrc_pktsnip_t *pkt)
+{
+    gnrc_netif_hdr_t *netif_hdr = pkt->data;
+    ipv6_hdr_t *ipv6_hdr = pkt->next->data;
+    /* encoded on the stack, so the dispatch can take the place of the IPv6
+     * header in the headroom of the payload */
+    uint8_t iphc_hdr[SIXLOWPAN_IPHC_HDR_LEN + SIXLOWPAN_IPHC_CID_EXT_LEN +
+                     sizeof(ipv6_hdr_t)];
+    uint16_t inline_pos = SIXLOWPAN_IPHC_HDR_LEN;
+    gnrc_sixlowpan_iphc_flow_t tmp, *flow = NULL;
+    gnrc_pktsnip_t *dispatch;
+
+#if GNRC_SIXLOWPAN_IPHC_CACHE_SIZE
+    if ((flow = _flow_lookup(netif_hdr, ipv6_hdr)) == NULL) {
+        if ((flow = _flow_alloc(netif_hdr, ipv6_hdr)) != NULL) {
+            _flow_encode(flow, netif_hdr, ipv6_hdr);
+        }
+    }
+#endif
+    if (flow == NULL) {
+        flow = &tmp;
+        _flow_encode(flow, netif_hdr, ipv6_hdr);
     }
 
-    /* shrink dispatch allocation to final size */
-    /* NOTE: Since this only shrinks the data nothing bad SHOULD happen ;-) */
-    gnrc_pktbuf_realloc_data(dispatch, (size_t)inline_pos);
+    iphc_hdr[IPHC1_IDX] = flow->iphc[IPHC1_IDX];
+    iphc_hdr[IPHC2_IDX] = flow->iphc[IPHC2_IDX];
+
+    if (flow->iphc[IPHC2_IDX] & SIXLOWPAN_IPHC2_CID_EXT) {
+        iphc_hdr[CID_EXT_IDX] = flow->iphc[CID_EXT_IDX];
+        /* move position to behind CID extension */
+        inline_pos += SIXLOWPAN_IPHC_CID_EXT_LEN;
+    }
+
+    /* compress flow label and traffic class */
+    if (ipv6_hdr_get_fl(ipv6_hdr) == 0) {
+        if (ipv6_hdr_get_tc(ipv6_hdr) == 0) {
+            /* elide both traffic class and flow label */
+            iphc_hdr[IPHC1_IDX] |= IPHC_TF_ECN_ELIDE;
+        }
+        else {
+            /* elide flow label, traffic class (ECN + DSCP) inline (1 byte) */
+            iphc_hdr[IPHC1_IDX] |= IPHC_TF_ECN_DSCP;
+            iphc_hdr[inline_pos++] = ipv6_hdr_get_tc(ipv6_hdr);
+        }
+    }
+    else {
+        if (ipv6_hdr_get_tc_dscp(ipv6_hdr) == 0) {
+            /* elide DSCP, ECN + 2-bit pad + flow label inline (3 byte) */
+            iphc_hdr[IPHC1_IDX] |= IPHC_TF_ECN_FL;
+            iphc_hdr[inline_pos++] = (uint8_t)((ipv6_hdr_get_tc_ecn(ipv6_hdr) << 6) |
+                                               ((ipv6_hdr_get_fl(ipv6_hdr) & 0x000f0000) >> 16));
+        }
+        else {
+            /* ECN + DSCP + 4-bit pad + flow label (4 bytes) */
+            iphc_hdr[IPHC1_IDX] |= IPHC_TF_ECN_DSCP_FL;
+            iphc_hdr[inline_pos++] = ipv6_hdr_get_tc(ipv6_hdr);
+            iphc_hdr[inline_pos++] = (uint8_t)((ipv6_hdr_get_fl(ipv6_hdr) & 0x000f0000) >> 16);
+        }
+
+        /* copy remaining byteos of flow label */
+        iphc_hdr[inline_pos++] = (uint8_t)((ipv6_hdr_get_fl(ipv6_hdr) & 0x0000ff00) >> 8);
+        iphc_hdr[inline_pos++] = (uint8_t)(ipv6_hdr_get_fl(ipv6_hdr) & 0x000000ff);
+    }
+
+    /* next header, hop limit and addresses */
+    memcpy(iphc_hdr + inline_pos, flow->inline_data, flow->inline_len);
+    inline_pos += flow->inline_len;
+
+#ifdef MODULE_GNRC_SIXLOWPAN_IPHC_NHC
+    if (flow->iphc[IPHC1_IDX] & SIXLOWPAN_IPHC1_NH) {
+        iphc_nhc_udp_encode(pkt->next->next, ipv6_hdr);
+        iphc_hdr[inline_pos++] = ipv6_hdr->nh;
+    }
+#endif
 
     /* remove IPv6 header */
     pkt = gnrc_pktbuf_remove_snip(pkt, pkt->next);
 
     /* insert dispatch into packet */
-    dispatch->next = pkt->next;
+    dispatch = gnrc_pktbuf_add(pkt->next, iphc_hdr, (size_t)inline_pos,
+                               GNRC_NETTYPE_SIXLOWPAN);
+    if (dispatch == NULL) {
+        DEBUG("6lo iphc: error allocating dispatch space\n");
+        return false;
+    }
     pkt->next = dispatch;
 
     return true;
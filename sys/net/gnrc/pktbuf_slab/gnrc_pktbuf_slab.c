@@ -0,0 +1,782 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup net_gnrc_pktbuf
+ * @{
+ *
+ * @file
+ * @brief   Packet buffer implementation based on fixed size classes
+ *
+ * Every size class is a static array of equally sized slots with an intrusive
+ * free list, so allocation and deallocation are O(1) and the buffer can not
+ * fragment. Every slot has a reference counter, which allows
+ * @ref gnrc_pktbuf_mark() to split a snip without copying: both the marked
+ * and the remaining snip point into the same slot.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include "mutex.h"
+#include "utlist.h"
+#include "net/gnrc/pktbuf.h"
+#include "net/gnrc/nettype.h"
+#include "net/gnrc/pkt.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+#define _ALIGNMENT_MASK    (sizeof(void *) - 1)
+
+/* fits size to byte alignment (usable in constant expressions) */
+#define _ALIGN(size)       (((size) + _ALIGNMENT_MASK) & ~(_ALIGNMENT_MASK))
+
+#define _SNIP_SLOT_SIZE    _ALIGN(sizeof(gnrc_pktsnip_t))
+#define _TINY_SLOT_SIZE    _ALIGN(GNRC_PKTBUF_SLAB_TINY_SIZE)
+#define _SMALL_SLOT_SIZE   _ALIGN(GNRC_PKTBUF_SLAB_SMALL_SIZE)
+#define _MEDIUM_SLOT_SIZE  _ALIGN(GNRC_PKTBUF_SLAB_MEDIUM_SIZE)
+#define _LARGE_SLOT_SIZE   _ALIGN(GNRC_PKTBUF_SLAB_LARGE_SIZE)
+
+/**
+ * @brief   Size class indices
+ *
+ * @note    Data classes must be in ascending slot size order
+ */
+enum {
+    _SLAB_SNIP = 0,
+    _SLAB_TINY,
+    _SLAB_SMALL,
+    _SLAB_MEDIUM,
+    _SLAB_LARGE,
+    _SLAB_NUMOF,
+};
+
+/* reference counter of a slot: a slot is referenced by at most all snips and
+ * its headroom, but gnrc_pktbuf_mark() still fails rather than wrapping it */
+typedef uint16_t _ref_t;
+#define _REF_MAX           (UINT16_MAX)
+
+/* free slots keep the free list in their first bytes */
+typedef struct _free_slot {
+    struct _free_slot *next;
+} _free_slot_t;
+
+typedef struct {
+    uint8_t *pool;              /**< first slot of the class */
+    _ref_t *refs;               /**< reference counter per slot */
+    _free_slot_t *first_free;   /**< head of the free list */
+    size_t slot_size;           /**< size of a single slot */
+    unsigned numof;             /**< number of slots in the class */
+#ifdef DEVELHELP
+    unsigned used;              /**< number of slots currently in use */
+    unsigned max_used;          /**< high-water mark of slots in use */
+#endif
+} _slab_t;
+
+/* pools are declared as pointer arrays to align their slots correctly */
+#define _POOL(name, slot_size, numof) \
+    static void *name[((slot_size) * (numof)) / sizeof(void *)]
+
+_POOL(_snip_pool, _SNIP_SLOT_SIZE, GNRC_PKTBUF_SLAB_SNIP_NUMOF);
+_POOL(_tiny_pool, _TINY_SLOT_SIZE, GNRC_PKTBUF_SLAB_TINY_NUMOF);
+_POOL(_small_pool, _SMALL_SLOT_SIZE, GNRC_PKTBUF_SLAB_SMALL_NUMOF);
+_POOL(_medium_pool, _MEDIUM_SLOT_SIZE, GNRC_PKTBUF_SLAB_MEDIUM_NUMOF);
+_POOL(_large_pool, _LARGE_SLOT_SIZE, GNRC_PKTBUF_SLAB_LARGE_NUMOF);
+
+static _ref_t _snip_refs[GNRC_PKTBUF_SLAB_SNIP_NUMOF];
+static _ref_t _tiny_refs[GNRC_PKTBUF_SLAB_TINY_NUMOF];
+static _ref_t _small_refs[GNRC_PKTBUF_SLAB_SMALL_NUMOF];
+static _ref_t _medium_refs[GNRC_PKTBUF_SLAB_MEDIUM_NUMOF];
+static _ref_t _large_refs[GNRC_PKTBUF_SLAB_LARGE_NUMOF];
+
+/**
+ * @brief   Slot holding a payload and the headroom in front of it
+ *
+ * Snips added in front of the payload get their data from the headroom and
+ * take a reference to the slot.
+ */
+typedef struct {
+    uint8_t *start;     /**< start of the slot, NULL if unused */
+    uint8_t *front;     /**< start of the part of the slot in use */
+    size_t size;        /**< number of bytes used for headroom and payload */
+} _headroom_t;
+
+static _headroom_t _headrooms[GNRC_PKTBUF_HEADROOM_NUMOF];
+
+static mutex_t _mutex = MUTEX_INIT;
+static _slab_t _slabs[_SLAB_NUMOF] = {
+    { .pool = (uint8_t *)_snip_pool, .refs = _snip_refs, .slot_size = _SNIP_SLOT_SIZE,
+      .numof = GNRC_PKTBUF_SLAB_SNIP_NUMOF },
+    { .pool = (uint8_t *)_tiny_pool, .refs = _tiny_refs, .slot_size = _TINY_SLOT_SIZE,
+      .numof = GNRC_PKTBUF_SLAB_TINY_NUMOF },
+    { .pool = (uint8_t *)_small_pool, .refs = _small_refs, .slot_size = _SMALL_SLOT_SIZE,
+      .numof = GNRC_PKTBUF_SLAB_SMALL_NUMOF },
+    { .pool = (uint8_t *)_medium_pool, .refs = _medium_refs, .slot_size = _MEDIUM_SLOT_SIZE,
+      .numof = GNRC_PKTBUF_SLAB_MEDIUM_NUMOF },
+    { .pool = (uint8_t *)_large_pool, .refs = _large_refs, .slot_size = _LARGE_SLOT_SIZE,
+      .numof = GNRC_PKTBUF_SLAB_LARGE_NUMOF },
+};
+
+/* internal gnrc_pktbuf functions */
+static gnrc_pktsnip_t *_create_snip(gnrc_pktsnip_t *next, void *data, size_t size,
+                                    gnrc_nettype_t type);
+static void *_slab_alloc(unsigned first, size_t size);
+static bool _slab_ref(void *ptr);
+static void _slab_free(void *ptr);
+static void _data_free(void *data, size_t size);
+
+static inline bool _slab_contains(const _slab_t *slab, const void *ptr)
+{
+    return (size_t)((uint8_t *)ptr - slab->pool) < (slab->slot_size * slab->numof);
+}
+
+static inline unsigned _slot_idx(const _slab_t *slab, const void *ptr)
+{
+    return (unsigned)(((uint8_t *)ptr - slab->pool) / slab->slot_size);
+}
+
+static inline uint8_t *_slot_start(const _slab_t *slab, unsigned idx)
+{
+    return slab->pool + (idx * slab->slot_size);
+}
+
+/* returns the size class ptr (which may point into the middle of a slot)
+ * belongs to or NULL if it is not in the packet buffer */
+static _slab_t *_find_slab(const void *ptr)
+{
+    for (unsigned i = 0; i < _SLAB_NUMOF; i++) {
+        if (_slab_contains(&_slabs[i], ptr)) {
+            return &_slabs[i];
+        }
+    }
+    return NULL;
+}
+
+/* checks if the data of b directly follows the data of a */
+static inline bool _contiguous(const gnrc_pktsnip_t *a, const gnrc_pktsnip_t *b)
+{
+    return (((uint8_t *)a->data) + a->size) == b->data;
+}
+
+/* returns the headroom slot ptr lies in, _mutex must be held */
+static _headroom_t *_headroom_find(const void *ptr)
+{
+    for (unsigned i = 0; i < GNRC_PKTBUF_HEADROOM_NUMOF; i++) {
+        _headroom_t *hr = &_headrooms[i];
+
+        if ((hr->start != NULL) &&
+            ((size_t)((const uint8_t *)ptr - hr->start) < hr->size)) {
+            return hr;
+        }
+    }
+    return NULL;
+}
+
+/* takes size bytes directly in front of the data of next from its headroom,
+ * _mutex must be held */
+static void *_headroom_take(gnrc_pktsnip_t *next, size_t size)
+{
+    _headroom_t *hr;
+
+    if ((next == NULL) || (next->data == NULL) ||
+        ((hr = _headroom_find(next->data)) == NULL) ||
+        (hr->front != next->data) || ((size_t)(hr->front - hr->start) < size) ||
+        !_slab_ref(hr->start)) {
+        return NULL;
+    }
+    hr->front -= size;
+    return hr->front;
+}
+
+static inline void _set_pktsnip(gnrc_pktsnip_t *pkt, gnrc_pktsnip_t *next,
+                                void *data, size_t size, gnrc_nettype_t type)
+{
+    pkt->next = next;
+    pkt->data = data;
+    pkt->size = size;
+    pkt->type = type;
+    pkt->users = 1;
+#ifdef MODULE_GNRC_NETERR
+    pkt->err_sub = KERNEL_PID_UNDEF;
+#endif
+}
+
+void gnrc_pktbuf_init(void)
+{
+    mutex_lock(&_mutex);
+    for (unsigned i = 0; i < _SLAB_NUMOF; i++) {
+        _slab_t *slab = &_slabs[i];
+
+        slab->first_free = NULL;
+        /* build free list back to front so slots are handed out in order */
+        for (unsigned j = slab->numof; j > 0; j--) {
+            _free_slot_t *slot = (_free_slot_t *)_slot_start(slab, j - 1);
+            slot->next = slab->first_free;
+            slab->first_free = slot;
+            slab->refs[j - 1] = 0;
+        }
+#ifdef DEVELHELP
+        slab->used = 0;
+        slab->max_used = 0;
+#endif
+    }
+    memset(_headrooms, 0, sizeof(_headrooms));
+    mutex_unlock(&_mutex);
+}
+
+gnrc_pktsnip_t *gnrc_pktbuf_add(gnrc_pktsnip_t *next, void *data, size_t size,
+                                gnrc_nettype_t type)
+{
+    gnrc_pktsnip_t *pkt;
+    void *_data;
+
+    if ((size == 0) || (size > GNRC_PKTBUF_SLAB_LARGE_SIZE)) {
+        DEBUG("pktbuf: size (%u) == 0 || size > GNRC_PKTBUF_SLAB_LARGE_SIZE (%u)\n",
+              (unsigned)size, GNRC_PKTBUF_SLAB_LARGE_SIZE);
+        return NULL;
+    }
+    mutex_lock(&_mutex);
+    _data = _headroom_take(next, size);
+    if (_data == NULL) {
+        pkt = _create_snip(next, data, size, type);
+    }
+    else if ((pkt = _slab_alloc(_SLAB_SNIP, sizeof(gnrc_pktsnip_t))) == NULL) {
+        DEBUG("pktbuf: error allocating new packet snip\n");
+        _data_free(_data, size);
+    }
+    else {
+        _set_pktsnip(pkt, next, _data, size, type);
+        if (data != NULL) {
+            memcpy(_data, data, size);
+        }
+    }
+    mutex_unlock(&_mutex);
+    return pkt;
+}
+
+gnrc_pktsnip_t *gnrc_pktbuf_add_headroom(gnrc_pktsnip_t *next, void *data,
+                                         size_t size, size_t headroom,
+                                         gnrc_nettype_t type)
+{
+    gnrc_pktsnip_t *pkt;
+    _headroom_t *hr = NULL;
+    uint8_t *slot;
+
+    /* keep the payload aligned */
+    headroom = _ALIGN(headroom);
+    if ((size == 0) || (size > GNRC_PKTBUF_SLAB_LARGE_SIZE)) {
+        DEBUG("pktbuf: size (%u) == 0 || size > GNRC_PKTBUF_SLAB_LARGE_SIZE (%u)\n",
+              (unsigned)size, GNRC_PKTBUF_SLAB_LARGE_SIZE);
+        return NULL;
+    }
+    mutex_lock(&_mutex);
+    for (unsigned i = 0; i < GNRC_PKTBUF_HEADROOM_NUMOF; i++) {
+        if (_headrooms[i].start == NULL) {
+            hr = &_headrooms[i];
+            break;
+        }
+    }
+    if ((hr == NULL) || (headroom == 0) ||
+        ((headroom + size) > GNRC_PKTBUF_SLAB_LARGE_SIZE)) {
+        DEBUG("pktbuf: no headroom available\n");
+        pkt = _create_snip(next, data, size, type);
+        mutex_unlock(&_mutex);
+        return pkt;
+    }
+    pkt = _slab_alloc(_SLAB_SNIP, sizeof(gnrc_pktsnip_t));
+    if (pkt == NULL) {
+        DEBUG("pktbuf: error allocating new packet snip\n");
+        mutex_unlock(&_mutex);
+        return NULL;
+    }
+    slot = _slab_alloc(_SLAB_TINY, headroom + size);
+    if (slot == NULL) {
+        DEBUG("pktbuf: error allocating data for new packet snip\n");
+        _slab_free(pkt);
+        mutex_unlock(&_mutex);
+        return NULL;
+    }
+    hr->start = slot;
+    hr->front = slot + headroom;
+    hr->size = headroom + size;
+    _set_pktsnip(pkt, next, hr->front, size, type);
+    if (data != NULL) {
+        memcpy(hr->front, data, size);
+    }
+    mutex_unlock(&_mutex);
+    return pkt;
+}
+
+size_t gnrc_pktbuf_headroom(gnrc_pktsnip_t *pkt)
+{
+    _headroom_t *hr;
+    size_t res = 0;
+
+    mutex_lock(&_mutex);
+    hr = _headroom_find(pkt->data);
+    if ((hr != NULL) && (hr->front == pkt->data)) {
+        res = hr->front - hr->start;
+    }
+    mutex_unlock(&_mutex);
+    return res;
+}
+
+gnrc_pktsnip_t *gnrc_pktbuf_mark(gnrc_pktsnip_t *pkt, size_t size, gnrc_nettype_t type)
+{
+    gnrc_pktsnip_t *marked_snip;
+
+    mutex_lock(&_mutex);
+    if ((size == 0) || (pkt == NULL) || (size > pkt->size) || (pkt->data == NULL)) {
+        DEBUG("pktbuf: size == 0 (was %u) or pkt == NULL (was %p) or "
+              "size > pkt->size (was %u) or pkt->data == NULL (was %p)\n",
+              (unsigned)size, (void *)pkt, (pkt ? (unsigned)pkt->size : 0),
+              (pkt ? pkt->data : NULL));
+        mutex_unlock(&_mutex);
+        return NULL;
+    }
+    else if (size == pkt->size) {
+        pkt->type = type;
+        mutex_unlock(&_mutex);
+        return pkt;
+    }
+    marked_snip = _slab_alloc(_SLAB_SNIP, sizeof(gnrc_pktsnip_t));
+    if (marked_snip == NULL) {
+        DEBUG("pktbuf: could not allocate marked snip.\n");
+        mutex_unlock(&_mutex);
+        return NULL;
+    }
+    /* both snips share the slot of pkt->data now */
+    if (!_slab_ref(pkt->data)) {
+        DEBUG("pktbuf: slot of pkt->data is referenced too often.\n");
+        _slab_free(marked_snip);
+        mutex_unlock(&_mutex);
+        return NULL;
+    }
+    _set_pktsnip(marked_snip, pkt->next, pkt->data, size, type);
+    pkt->data = ((uint8_t *)pkt->data) + size;
+    pkt->size -= size;
+    pkt->next = marked_snip;
+    mutex_unlock(&_mutex);
+    return marked_snip;
+}
+
+size_t gnrc_pktbuf_mark_headroom(size_t hdr_len)
+{
+    /* marking shares the slot and never moves data */
+    (void)hdr_len;
+    return 0;
+}
+
+int gnrc_pktbuf_realloc_data(gnrc_pktsnip_t *pkt, size_t size)
+{
+    _slab_t *slab;
+
+    mutex_lock(&_mutex);
+    assert((pkt != NULL) && (pkt->data != NULL));
+    slab = _find_slab(pkt->data);
+    assert(slab != NULL);
+    if (size == 0) {
+        DEBUG("pktbuf: size == 0\n");
+        mutex_unlock(&_mutex);
+        return ENOMEM;
+    }
+    if (size > pkt->size) {
+        unsigned idx = _slot_idx(slab, pkt->data);
+        uint8_t *slot_end = _slot_start(slab, idx) + slab->slot_size;
+
+        /* can only grow in place if no other snip shares the slot */
+        if ((slab->refs[idx] > 1) || ((((uint8_t *)pkt->data) + size) > slot_end)) {
+            void *new_data = _slab_alloc(_SLAB_TINY, size);
+            if (new_data == NULL) {
+                DEBUG("pktbuf: error allocating new data section\n");
+                mutex_unlock(&_mutex);
+                return ENOMEM;
+            }
+            memcpy(new_data, pkt->data, pkt->size);
+            _data_free(pkt->data, pkt->size);
+            pkt->data = new_data;
+        }
+        else {
+            _headroom_t *hr = _headroom_find(pkt->data);
+
+            if (hr != NULL) {
+                /* the payload grows beyond the part of the slot in use */
+                size_t used = (((uint8_t *)pkt->data) + size) - hr->start;
+
+                if (used > hr->size) {
+                    hr->size = used;
+                }
+            }
+        }
+    }
+    pkt->size = size;
+    mutex_unlock(&_mutex);
+    return 0;
+}
+
+void gnrc_pktbuf_hold(gnrc_pktsnip_t *pkt, unsigned int num)
+{
+    mutex_lock(&_mutex);
+    while (pkt) {
+        pkt->users += num;
+        pkt = pkt->next;
+    }
+    mutex_unlock(&_mutex);
+}
+
+static void _release_error_locked(gnrc_pktsnip_t *pkt, uint32_t err)
+{
+    while (pkt) {
+        gnrc_pktsnip_t *tmp;
+        assert(_slab_contains(&_slabs[_SLAB_SNIP], pkt));
+        tmp = pkt->next;
+        if (pkt->users == 1) {
+            pkt->users = 0; /* not necessary but to be on the safe side */
+            _data_free(pkt->data, pkt->size);
+            _slab_free(pkt);
+        }
+        else {
+            pkt->users--;
+        }
+        DEBUG("pktbuf: report status code %" PRIu32 "\n", err);
+        gnrc_neterr_report(pkt, err);
+        pkt = tmp;
+    }
+}
+
+void gnrc_pktbuf_release_error(gnrc_pktsnip_t *pkt, uint32_t err)
+{
+    mutex_lock(&_mutex);
+    _release_error_locked(pkt, err);
+    mutex_unlock(&_mutex);
+}
+
+gnrc_pktsnip_t *gnrc_pktbuf_start_write(gnrc_pktsnip_t *pkt)
+{
+    mutex_lock(&_mutex);
+    if ((pkt == NULL) || (pkt->size == 0)) {
+        mutex_unlock(&_mutex);
+        return NULL;
+    }
+    if (pkt->users > 1) {
+        gnrc_pktsnip_t *new;
+        new = _create_snip(pkt->next, pkt->data, pkt->size, pkt->type);
+        if (new != NULL) {
+            pkt->users--;
+        }
+        mutex_unlock(&_mutex);
+        return new;
+    }
+    mutex_unlock(&_mutex);
+    return pkt;
+}
+
+gnrc_pktsnip_t *gnrc_pktbuf_get_iovec(gnrc_pktsnip_t *pkt, size_t *len)
+{
+    size_t length;
+    gnrc_pktsnip_t *head, *prev = NULL;
+    struct iovec *vec;
+
+    if (pkt == NULL) {
+        *len = 0;
+        return NULL;
+    }
+
+    /* count the number of elements and allocate the IOVEC; the IOVEC must
+     * not take the headroom of pkt, so do not use gnrc_pktbuf_add() */
+    length = 1;
+    for (gnrc_pktsnip_t *ptr = pkt->next; ptr != NULL; ptr = ptr->next) {
+        if ((ptr == pkt->next) || !_contiguous(prev, ptr)) {
+            length++;
+        }
+        prev = ptr;
+    }
+    mutex_lock(&_mutex);
+    head = _create_snip(pkt, NULL, (length * sizeof(struct iovec)),
+                        GNRC_NETTYPE_IOVEC);
+    mutex_unlock(&_mutex);
+    if (head == NULL) {
+        *len = 0;
+        return NULL;
+    }
+    vec = (struct iovec *)(head->data);
+    /* fill the IOVEC */
+    vec->iov_base = pkt->data;
+    vec->iov_len = pkt->size;
+    for (gnrc_pktsnip_t *ptr = pkt->next; ptr != NULL; ptr = ptr->next) {
+        if ((ptr == pkt->next) || !_contiguous(prev, ptr)) {
+            ++vec;
+            vec->iov_base = ptr->data;
+            vec->iov_len = 0;
+        }
+        vec->iov_len += ptr->size;
+        prev = ptr;
+    }
+    *len = length;
+    return head;
+}
+
+#ifdef DEVELHELP
+void gnrc_pktbuf_stats(void)
+{
+    static const char *names[] = { "snip", "tiny", "small", "medium", "large" };
+
+    printf("packet buffer: %u size classes\n", (unsigned)_SLAB_NUMOF);
+    puts("  class   slot size  slots   used  max used");
+    mutex_lock(&_mutex);
+    for (unsigned i = 0; i < _SLAB_NUMOF; i++) {
+        _slab_t *slab = &_slabs[i];
+        printf("  %-6s  %9u  %5u  %5u  %8u\n", names[i],
+               (unsigned)slab->slot_size, slab->numof, slab->used,
+               slab->max_used);
+    }
+    mutex_unlock(&_mutex);
+}
+#endif
+
+#ifdef TEST_SUITES
+bool gnrc_pktbuf_is_empty(void)
+{
+    for (unsigned i = 0; i < _SLAB_NUMOF; i++) {
+        for (unsigned j = 0; j < _slabs[i].numof; j++) {
+            if (_slabs[i].refs[j] != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool gnrc_pktbuf_is_sane(void)
+{
+    /* Invariants of this implementation:
+     *  - forall slot in free list of a class: slot is a slot start of the class
+     *  - forall slot in free list of a class: the reference counter of slot is 0
+     *  - number of free slots in a class == number of slots with reference counter 0
+     */
+    for (unsigned i = 0; i < _SLAB_NUMOF; i++) {
+        _slab_t *slab = &_slabs[i];
+        unsigned free_slots = 0, unreferenced = 0;
+
+        for (_free_slot_t *ptr = slab->first_free; ptr != NULL; ptr = ptr->next) {
+            if (!_slab_contains(slab, ptr) ||
+                (((uint8_t *)ptr - slab->pool) % slab->slot_size) != 0 ||
+                (slab->refs[_slot_idx(slab, ptr)] != 0) ||
+                (++free_slots > slab->numof)) {
+                return false;
+            }
+        }
+        for (unsigned j = 0; j < slab->numof; j++) {
+            if (slab->refs[j] == 0) {
+                unreferenced++;
+            }
+        }
+        if (free_slots != unreferenced) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+static gnrc_pktsnip_t *_create_snip(gnrc_pktsnip_t *next, void *data, size_t size,
+                                    gnrc_nettype_t type)
+{
+    gnrc_pktsnip_t *pkt = _slab_alloc(_SLAB_SNIP, sizeof(gnrc_pktsnip_t));
+    void *_data;
+
+    if (pkt == NULL) {
+        DEBUG("pktbuf: error allocating new packet snip\n");
+        return NULL;
+    }
+    _data = _slab_alloc(_SLAB_TINY, size);
+    if (_data == NULL) {
+        DEBUG("pktbuf: error allocating data for new packet snip\n");
+        _slab_free(pkt);
+        return NULL;
+    }
+    _set_pktsnip(pkt, next, _data, size, type);
+    if (data != NULL) {
+        memcpy(_data, data, size);
+    }
+    return pkt;
+}
+
+/* takes a slot of the smallest class starting from `first` that fits `size`
+ * and still has free slots. Snips only use the snip class. */
+static void *_slab_alloc(unsigned first, size_t size)
+{
+    unsigned last = (first == _SLAB_SNIP) ? _SLAB_SNIP : (_SLAB_NUMOF - 1);
+
+    for (unsigned i = first; i <= last; i++) {
+        _slab_t *slab = &_slabs[i];
+        _free_slot_t *slot = slab->first_free;
+
+        if ((size > slab->slot_size) || (slot == NULL)) {
+            continue;
+        }
+        slab->first_free = slot->next;
+        slab->refs[_slot_idx(slab, slot)] = 1;
+#ifdef DEVELHELP
+        if (++slab->used > slab->max_used) {
+            slab->max_used = slab->used;
+        }
+#endif
+        return slot;
+    }
+    DEBUG("pktbuf: no slot left for %u byte\n", (unsigned)size);
+    return NULL;
+}
+
+/* takes another reference to the slot of ptr, returns false if the reference
+ * counter is at its limit */
+static bool _slab_ref(void *ptr)
+{
+    _slab_t *slab = _find_slab(ptr);
+
+    if (slab != NULL) {
+        unsigned idx = _slot_idx(slab, ptr);
+
+        if (slab->refs[idx] == _REF_MAX) {
+            return false;
+        }
+        slab->refs[idx]++;
+    }
+    return true;
+}
+
+static void _slab_free(void *ptr)
+{
+    _slab_t *slab = _find_slab(ptr);
+    unsigned idx;
+
+    if (slab == NULL) {
+        return;
+    }
+    idx = _slot_idx(slab, ptr);
+    assert(slab->refs[idx] > 0);
+    if (--slab->refs[idx] == 0) {
+        _free_slot_t *slot = (_free_slot_t *)_slot_start(slab, idx);
+        slot->next = slab->first_free;
+        slab->first_free = slot;
+#ifdef DEVELHELP
+        slab->used--;
+#endif
+    }
+}
+
+/* frees the data of a snip, _mutex must be held */
+static void _data_free(void *data, size_t size)
+{
+    _headroom_t *hr = _headroom_find(data);
+
+    if (hr != NULL) {
+        _slab_t *slab = _find_slab(hr->start);
+
+        if (slab->refs[_slot_idx(slab, hr->start)] == 1) {
+            /* last reference: slot is freed below */
+            hr->start = NULL;
+        }
+        else if (data == hr->front) {
+            /* give the space back to the headroom */
+            hr->front += size;
+        }
+    }
+    _slab_free(data);
+}
+
+gnrc_pktsnip_t *gnrc_pktbuf_remove_snip(gnrc_pktsnip_t *pkt, gnrc_pktsnip_t *snip)
+{
+    LL_DELETE(pkt, snip);
+    snip->next = NULL;
+    gnrc_pktbuf_release(snip);
+
+    return pkt;
+}
+
+gnrc_pktsnip_t *gnrc_pktbuf_replace_snip(gnrc_pktsnip_t *pkt, gnrc_pktsnip_t *old, gnrc_pktsnip_t *add)
+{
+    /* If add is a list we need to preserve its tail */
+    if (add->next != NULL) {
+        gnrc_pktsnip_t *tail = add->next;
+        gnrc_pktsnip_t *back;
+        LL_SEARCH_SCALAR(tail, back, next, NULL); /* find the last snip in add */
+        /* Replace old */
+        LL_REPLACE_ELEM(pkt, old, add);
+        /* and wire in the tail between */
+        back->next = add->next;
+        add->next = tail;
+    }
+    else {
+        /* add is a single element, has no tail, simply replace */
+        LL_REPLACE_ELEM(pkt, old, add);
+    }
+    old->next = NULL;
+    gnrc_pktbuf_release(old);
+
+    return pkt;
+}
+
+gnrc_pktsnip_t *gnrc_pktbuf_duplicate_upto(gnrc_pktsnip_t *pkt, gnrc_nettype_t type)
+{
+    mutex_lock(&_mutex);
+
+    bool is_shared = pkt->users > 1;
+    size_t size = gnrc_pkt_len_upto(pkt, type);
+
+    DEBUG("ipv6_ext: duplicating %d octets\n", (int) size);
+
+    gnrc_pktsnip_t *tmp;
+    gnrc_pktsnip_t *target = gnrc_pktsnip_search_type(pkt, type);
+    gnrc_pktsnip_t *next = (target == NULL) ? NULL : target->next;
+    gnrc_pktsnip_t *new = _create_snip(next, NULL, size, type);
+
+    if (new == NULL) {
+        mutex_unlock(&_mutex);
+
+        return NULL;
+    }
+
+    /* copy payloads */
+    for (tmp = pkt; tmp != NULL; tmp = tmp->next) {
+        uint8_t *dest = ((uint8_t *)new->data) + (size - tmp->size);
+
+        memcpy(dest, tmp->data, tmp->size);
+
+        size -= tmp->size;
+
+        if (tmp->type == type) {
+            break;
+        }
+    }
+
+    /* decrements reference counters */
+
+    if (target != NULL) {
+        target->next = NULL;
+    }
+
+    _release_error_locked(pkt, GNRC_NETERR_SUCCESS);
+
+    if (is_shared && (target != NULL)) {
+        target->next = next;
+    }
+
+    mutex_unlock(&_mutex);
+
+    return new;
+}
+
+/** @} */
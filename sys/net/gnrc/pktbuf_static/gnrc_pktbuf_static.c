@@ -24,8 +24,10 @@
 #include <sys/types.h>
 #include <sys/uio.h>
 
+#include "irq.h"
 #include "mutex.h"
 #include "od.h"
+#include "thread.h"
 #include "utlist.h"
 #include "net/gnrc/pktbuf.h"
 #include "net/gnrc/nettype.h"
@@ -45,6 +47,43 @@ static mutex_t _mutex = MUTEX_INIT;
 static uint8_t _pktbuf[GNRC_PKTBUF_SIZE];
 static _unused_t *_first_unused;
 
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CACHE
+/**
+ * @brief   Per-thread cache of free packet snips
+ *
+ * Only the owning thread adds snips to its cache. Snips are taken with
+ * interrupts disabled, since an allocation that fails with _mutex held returns
+ * the snips of all caches to the packet buffer.
+ */
+typedef struct {
+    unsigned fill;                                      /**< number of cached snips */
+    gnrc_pktsnip_t *snips[GNRC_PKTBUF_STATIC_CACHE_SIZE];  /**< cached snips */
+} _snip_cache_t;
+
+static _snip_cache_t _snip_caches[MAXTHREADS];
+
+/* lock-free LIFO of the snips released by their last user, freed by the next
+ * holder of _mutex, so that gnrc_pktbuf_release() never has to lock */
+static gnrc_pktsnip_t *_released;
+#endif
+
+/**
+ * @brief   Chunk holding a payload and the headroom in front of it
+ *
+ * Snips added in front of the payload get their data from the headroom, so
+ * all of them share the chunk. It is freed together with the last of them.
+ */
+typedef struct {
+    uint8_t *start;     /**< start of the chunk, NULL if unused */
+    uint8_t *front;     /**< start of the part of the chunk in use */
+    size_t size;        /**< size of the chunk */
+    unsigned refs;      /**< number of snips with data in the chunk */
+} _headroom_t;
+
+static _headroom_t _headrooms[GNRC_PKTBUF_HEADROOM_NUMOF];
+/* number of chunks in _headrooms, only changed atomically with _mutex held */
+static unsigned _headrooms_used;
+
 #ifdef DEVELHELP
 /* maximum number of bytes allocated */
 static uint16_t max_byte_count = 0;
@@ -55,6 +94,41 @@ static gnrc_pktsnip_t *_create_snip(gnrc_pktsnip_t *next, void *data, size_t siz
                                     gnrc_nettype_t type);
 static void *_pktbuf_alloc(size_t size);
 static void _pktbuf_free(void *data, size_t size);
+static void _data_free(void *data, size_t size);
+static gnrc_pktsnip_t *_snip_alloc(void);
+static gnrc_pktsnip_t *_snip_alloc_locked(void);
+static void _snip_free(gnrc_pktsnip_t *pkt);
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CACHE
+static bool _snip_caches_drain(void);
+static void _released_add(gnrc_pktsnip_t *first, gnrc_pktsnip_t *last);
+static void _released_free(void);
+#endif
+
+/* takes _mutex and frees the snips released without it */
+static inline void _lock(void)
+{
+    mutex_lock(&_mutex);
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CACHE
+    _released_free();
+#endif
+}
+
+/* gnrc_pktsnip_t::users is only ever changed atomically, so operations that
+ * only touch the reference counter do not need to take _mutex */
+static inline unsigned int _users_add(gnrc_pktsnip_t *pkt, unsigned int num)
+{
+    return __atomic_add_fetch(&pkt->users, num, __ATOMIC_SEQ_CST);
+}
+
+static inline unsigned int _users_sub(gnrc_pktsnip_t *pkt, unsigned int num)
+{
+    return __atomic_sub_fetch(&pkt->users, num, __ATOMIC_SEQ_CST);
+}
+
+static inline unsigned int _users_get(gnrc_pktsnip_t *pkt)
+{
+    return __atomic_load_n(&pkt->users, __ATOMIC_SEQ_CST);
+}
 
 static inline bool _pktbuf_contains(void *ptr)
 {
@@ -67,6 +141,42 @@ static inline size_t _align(size_t size)
     return (size + _ALIGNMENT_MASK) & ~(_ALIGNMENT_MASK);
 }
 
+/* checks if the data of b directly follows the data of a */
+static inline bool _contiguous(const gnrc_pktsnip_t *a, const gnrc_pktsnip_t *b)
+{
+    return (((uint8_t *)a->data) + a->size) == b->data;
+}
+
+/* returns the headroom chunk ptr lies in, _mutex must be held */
+static _headroom_t *_headroom_find(const void *ptr)
+{
+    for (unsigned i = 0; (i < GNRC_PKTBUF_HEADROOM_NUMOF) && (_headrooms_used > 0); i++) {
+        _headroom_t *hr = &_headrooms[i];
+
+        if ((hr->start != NULL) &&
+            ((size_t)((const uint8_t *)ptr - hr->start) < hr->size)) {
+            return hr;
+        }
+    }
+    return NULL;
+}
+
+/* takes size bytes directly in front of the data of next from its headroom,
+ * _mutex must be held */
+static void *_headroom_take(gnrc_pktsnip_t *next, size_t size)
+{
+    _headroom_t *hr;
+
+    if ((next == NULL) || (next->data == NULL) ||
+        ((hr = _headroom_find(next->data)) == NULL) ||
+        (hr->front != next->data) || ((size_t)(hr->front - hr->start) < size)) {
+        return NULL;
+    }
+    hr->front -= size;
+    hr->refs++;
+    return hr->front;
+}
+
 static inline void _set_pktsnip(gnrc_pktsnip_t *pkt, gnrc_pktsnip_t *next,
                                 void *data, size_t size, gnrc_nettype_t type)
 {
@@ -86,6 +196,12 @@ void gnrc_pktbuf_init(void)
     _first_unused = (_unused_t *)_pktbuf;
     _first_unused->next = NULL;
     _first_unused->size = sizeof(_pktbuf);
+    memset(_headrooms, 0, sizeof(_headrooms));
+    _headrooms_used = 0;
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CACHE
+    memset(_snip_caches, 0, sizeof(_snip_caches));
+    _released = NULL;
+#endif
     mutex_unlock(&_mutex);
 }
 
@@ -93,18 +209,114 @@ gnrc_pktsnip_t *gnrc_pktbuf_add(gnrc_pktsnip_t *next, void *data, size_t size,
                                 gnrc_nettype_t type)
 {
     gnrc_pktsnip_t *pkt;
+    void *_data;
 
     if ((size == 0) || (size > GNRC_PKTBUF_SIZE)) {
         DEBUG("pktbuf: size (%u) == 0 || size == GNRC_PKTBUF_SIZE (%u)\n",
               (unsigned)size, GNRC_PKTBUF_SIZE);
         return NULL;
     }
-    mutex_lock(&_mutex);
-    pkt = _create_snip(next, data, size, type);
+    _lock();
+    _data = _headroom_take(next, size);
+    if (_data == NULL) {
+        pkt = _create_snip(next, data, size, type);
+    }
+    else if ((pkt = _snip_alloc_locked()) == NULL) {
+        DEBUG("pktbuf: error allocating new packet snip\n");
+        _data_free(_data, size);
+    }
+    else {
+        _set_pktsnip(pkt, next, _data, size, type);
+        if (data != NULL) {
+            memcpy(_data, data, size);
+        }
+    }
     mutex_unlock(&_mutex);
     return pkt;
 }
 
+gnrc_pktsnip_t *gnrc_pktbuf_add_headroom(gnrc_pktsnip_t *next, void *data,
+                                         size_t size, size_t headroom,
+                                         gnrc_nettype_t type)
+{
+    gnrc_pktsnip_t *pkt;
+    _headroom_t *hr = NULL;
+    uint8_t *chunk;
+
+    /* keep the payload aligned */
+    headroom = _align(headroom);
+    if ((size == 0) || (size > GNRC_PKTBUF_SIZE)) {
+        DEBUG("pktbuf: size (%u) == 0 || size == GNRC_PKTBUF_SIZE (%u)\n",
+              (unsigned)size, GNRC_PKTBUF_SIZE);
+        return NULL;
+    }
+    _lock();
+    for (unsigned i = 0; i < GNRC_PKTBUF_HEADROOM_NUMOF; i++) {
+        if (_headrooms[i].start == NULL) {
+            hr = &_headrooms[i];
+            break;
+        }
+    }
+    if ((hr == NULL) || (headroom == 0) || ((headroom + size) > GNRC_PKTBUF_SIZE)) {
+        DEBUG("pktbuf: no headroom available\n");
+        pkt = _create_snip(next, data, size, type);
+        mutex_unlock(&_mutex);
+        return pkt;
+    }
+    pkt = _snip_alloc_locked();
+    if (pkt == NULL) {
+        DEBUG("pktbuf: error allocating new packet snip\n");
+        mutex_unlock(&_mutex);
+        return NULL;
+    }
+    chunk = _pktbuf_alloc(headroom + size);
+    if (chunk == NULL) {
+        DEBUG("pktbuf: error allocating data for new packet snip\n");
+        _snip_free(pkt);
+        mutex_unlock(&_mutex);
+        return NULL;
+    }
+    hr->start = chunk;
+    hr->front = chunk + headroom;
+    hr->size = headroom + size;
+    hr->refs = 1;
+    __atomic_add_fetch(&_headrooms_used, 1, __ATOMIC_SEQ_CST);
+    _set_pktsnip(pkt, next, hr->front, size, type);
+    if (data != NULL) {
+        memcpy(hr->front, data, size);
+    }
+    mutex_unlock(&_mutex);
+    return pkt;
+}
+
+size_t gnrc_pktbuf_headroom(gnrc_pktsnip_t *pkt)
+{
+    _headroom_t *hr;
+    size_t res = 0;
+
+    _lock();
+    hr = _headroom_find(pkt->data);
+    if ((hr != NULL) && (hr->front == pkt->data)) {
+        res = hr->front - hr->start;
+    }
+    mutex_unlock(&_mutex);
+    return res;
+}
+
+/* adds a reference to the headroom chunk of pkt, if it has one */
+static bool _mark_in_headroom(gnrc_pktsnip_t *pkt)
+{
+    _headroom_t *hr;
+
+    _lock();
+    hr = _headroom_find(pkt->data);
+    if (hr != NULL) {
+        hr->refs++;
+    }
+    mutex_unlock(&_mutex);
+    return (hr != NULL);
+}
+
 gnrc_pktsnip_t *gnrc_pktbuf_mark(gnrc_pktsnip_t *pkt, size_t size, gnrc_nettype_t type)
 {
     gnrc_pktsnip_t *marked_snip;
@@ -113,40 +325,44 @@ gnrc_pktsnip_t *gnrc_pktbuf_mark(gnrc_pktsnip_t *pkt, size_t size, gnrc_nettype_
                                _align(sizeof(_unused_t)) : _align(size);
     void *new_data_marked;
 
-    mutex_lock(&_mutex);
     if ((size == 0) || (pkt == NULL) || (size > pkt->size) || (pkt->data == NULL)) {
         DEBUG("pktbuf: size == 0 (was %u) or pkt == NULL (was %p) or "
               "size > pkt->size (was %u) or pkt->data == NULL (was %p)\n",
               (unsigned)size, (void *)pkt, (pkt ? (unsigned)pkt->size : 0),
               (pkt ? pkt->data : NULL));
-        mutex_unlock(&_mutex);
         return NULL;
     }
     else if (size == pkt->size) {
         pkt->type = type;
-        mutex_unlock(&_mutex);
         return pkt;
     }
-    marked_snip = _pktbuf_alloc(sizeof(gnrc_pktsnip_t));
+    marked_snip = _snip_alloc();
     if (marked_snip == NULL) {
         DEBUG("pktbuf: could not reallocate marked section.\n");
-        mutex_unlock(&_mutex);
         return NULL;
     }
+    /* a chunk with headroom can be shared by any number of snips; if there
+     * are none right now, pkt can not be in one while we hold it */
+    if ((__atomic_load_n(&_headrooms_used, __ATOMIC_SEQ_CST) > 0) &&
+        _mark_in_headroom(pkt)) {
+        new_data_marked = pkt->data;
+        pkt->data = ((uint8_t *)pkt->data) + size;
+    }
     /* would not fit unused marker => move data around */
-    if ((size < required_new_size) || ((pkt->size - size) < sizeof(_unused_t))) {
+    else if ((size < required_new_size) || ((pkt->size - size) < sizeof(_unused_t))) {
         void *new_data_rest;
+        _lock();
         new_data_marked = _pktbuf_alloc(size);
         if (new_data_marked == NULL) {
             DEBUG("pktbuf: could not reallocate marked section.\n");
-            _pktbuf_free(marked_snip, sizeof(gnrc_pktsnip_t));
+            _snip_free(marked_snip);
             mutex_unlock(&_mutex);
             return NULL;
         }
         new_data_rest = _pktbuf_alloc(pkt->size - size);
         if (new_data_rest == NULL) {
             DEBUG("pktbuf: could not reallocate remaining section.\n");
-            _pktbuf_free(marked_snip, sizeof(gnrc_pktsnip_t));
+            _snip_free(marked_snip);
             _pktbuf_free(new_data_marked, size);
             mutex_unlock(&_mutex);
             return NULL;
@@ -154,6 +370,7 @@ gnrc_pktsnip_t *gnrc_pktbuf_mark(gnrc_pktsnip_t *pkt, size_t size, gnrc_nettype_
         memcpy(new_data_marked, pkt->data, size);
         memcpy(new_data_rest, ((uint8_t *)pkt->data) + size, pkt->size - size);
         _pktbuf_free(pkt->data, pkt->size);
+        mutex_unlock(&_mutex);
         marked_snip->data = new_data_marked;
         pkt->data = new_data_rest;
     }
@@ -164,16 +381,28 @@ gnrc_pktsnip_t *gnrc_pktbuf_mark(gnrc_pktsnip_t *pkt, size_t size, gnrc_nettype_
     pkt->size -= size;
     _set_pktsnip(marked_snip, pkt->next, new_data_marked, size, type);
     pkt->next = marked_snip;
-    mutex_unlock(&_mutex);
     return marked_snip;
 }
 
+size_t gnrc_pktbuf_mark_headroom(size_t hdr_len)
+{
+    /* gnrc_pktbuf_mark() splits in place if the marked section is aligned and
+     * can hold an unused marker */
+    if (hdr_len == 0) {
+        return 0;
+    }
+    if (hdr_len < sizeof(_unused_t)) {
+        return sizeof(_unused_t) - hdr_len;
+    }
+    return _align(hdr_len) - hdr_len;
+}
+
 int gnrc_pktbuf_realloc_data(gnrc_pktsnip_t *pkt, size_t size)
 {
     size_t aligned_size = (size < sizeof(_unused_t)) ?
                           _align(sizeof(_unused_t)) : _align(size);
 
-    mutex_lock(&_mutex);
+    _lock();
     assert((pkt != NULL) && (pkt->data != NULL) && _pktbuf_contains(pkt->data));
     if (size == 0) {
         DEBUG("pktbuf: size == 0\n");
@@ -184,6 +413,12 @@ int gnrc_pktbuf_realloc_data(gnrc_pktsnip_t *pkt, size_t size)
         mutex_unlock(&_mutex);
         return 0;
     }
+    if ((size < pkt->size) && (_headroom_find(pkt->data) != NULL)) {
+        /* the chunk is shared, its tail is freed with it */
+        pkt->size = size;
+        mutex_unlock(&_mutex);
+        return 0;
+    }
     if ((size > pkt->size) ||                               /* new size does not fit */
         ((pkt->size - aligned_size) < sizeof(_unused_t))) { /* resulting hole would not fit marker */
         void *new_data = _pktbuf_alloc(size);
@@ -193,7 +428,7 @@ int gnrc_pktbuf_realloc_data(gnrc_pktsnip_t *pkt, size_t size)
             return ENOMEM;
         }
         memcpy(new_data, pkt->data, (pkt->size < size) ? pkt->size : size);
-        _pktbuf_free(pkt->data, pkt->size);
+        _data_free(pkt->data, pkt->size);
         pkt->data = new_data;
     }
     else {
@@ -209,12 +444,17 @@ int gnrc_pktbuf_realloc_data(gnrc_pktsnip_t *pkt, size_t size)
 
 void gnrc_pktbuf_hold(gnrc_pktsnip_t *pkt, unsigned int num)
 {
-    mutex_lock(&_mutex);
     while (pkt) {
-        pkt->users += num;
+        _users_add(pkt, num);
         pkt = pkt->next;
     }
-    mutex_unlock(&_mutex);
+}
+
+/* frees data and snip of pkt, _mutex must be held */
+static void _free_snip_locked(gnrc_pktsnip_t *pkt)
+{
+    _data_free(pkt->data, pkt->size);
+    _snip_free(pkt);
 }
 
 static void _release_error_locked(gnrc_pktsnip_t *pkt, uint32_t err)
@@ -223,51 +463,73 @@ static void _release_error_locked(gnrc_pktsnip_t *pkt, uint32_t err)
         gnrc_pktsnip_t *tmp;
         assert(_pktbuf_contains(pkt));
         tmp = pkt->next;
-        if (pkt->users == 1) {
-            pkt->users = 0; /* not necessary but to be on the safe side */
-            _pktbuf_free(pkt->data, pkt->size);
-            _pktbuf_free(pkt, sizeof(gnrc_pktsnip_t));
-        }
-        else {
-            pkt->users--;
-        }
         DEBUG("pktbuf: report status code %" PRIu32 "\n", err);
         gnrc_neterr_report(pkt, err);
+        if (_users_sub(pkt, 1) == 0) {
+            _free_snip_locked(pkt);
+        }
         pkt = tmp;
     }
 }
 
 void gnrc_pktbuf_release_error(gnrc_pktsnip_t *pkt, uint32_t err)
 {
-    mutex_lock(&_mutex);
-    _release_error_locked(pkt, err);
-    mutex_unlock(&_mutex);
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CACHE
+    gnrc_pktsnip_t *released = NULL, *last = NULL;
+#endif
+
+    while (pkt) {
+        gnrc_pktsnip_t *tmp;
+        assert(_pktbuf_contains(pkt));
+        tmp = pkt->next;
+        DEBUG("pktbuf: report status code %" PRIu32 "\n", err);
+        gnrc_neterr_report(pkt, err);
+        /* only the last user needs the lock to actually free the snip */
+        if (_users_sub(pkt, 1) == 0) {
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CACHE
+            pkt->next = released;
+            released = pkt;
+            if (last == NULL) {
+                last = pkt;
+            }
+#else
+            mutex_lock(&_mutex);
+            _free_snip_locked(pkt);
+            mutex_unlock(&_mutex);
+#endif
+        }
+        pkt = tmp;
+    }
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CACHE
+    if (released != NULL) {
+        _released_add(released, last);
+    }
+#endif
 }
 
 gnrc_pktsnip_t *gnrc_pktbuf_start_write(gnrc_pktsnip_t *pkt)
 {
-    mutex_lock(&_mutex);
     if ((pkt == NULL) || (pkt->size == 0)) {
-        mutex_unlock(&_mutex);
         return NULL;
     }
-    if (pkt->users > 1) {
+    if (_users_get(pkt) > 1) {
         gnrc_pktsnip_t *new;
+        _lock();
         new = _create_snip(pkt->next, pkt->data, pkt->size, pkt->type);
-        if (new != NULL) {
-            pkt->users--;
+        if ((new != NULL) && (_users_sub(pkt, 1) == 0)) {
+            /* all other users released pkt in the meantime */
+            _free_snip_locked(pkt);
         }
         mutex_unlock(&_mutex);
         return new;
     }
-    mutex_unlock(&_mutex);
     return pkt;
 }
 
 gnrc_pktsnip_t *gnrc_pktbuf_get_iovec(gnrc_pktsnip_t *pkt, size_t *len)
 {
     size_t length;
-    gnrc_pktsnip_t *head;
+    gnrc_pktsnip_t *head, *prev = NULL;
     struct iovec *vec;
 
     if (pkt == NULL) {
@@ -275,21 +537,35 @@ gnrc_pktsnip_t *gnrc_pktbuf_get_iovec(gnrc_pktsnip_t *pkt, size_t *len)
         return NULL;
     }
 
-    /* count the number of snips in the packet and allocate the IOVEC */
-    length = gnrc_pkt_count(pkt);
-    head = gnrc_pktbuf_add(pkt, NULL, (length * sizeof(struct iovec)),
-                           GNRC_NETTYPE_IOVEC);
+    /* count the number of elements and allocate the IOVEC; the IOVEC must
+     * not take the headroom of pkt, so do not use gnrc_pktbuf_add() */
+    length = 1;
+    for (gnrc_pktsnip_t *ptr = pkt->next; ptr != NULL; ptr = ptr->next) {
+        if ((ptr == pkt->next) || !_contiguous(prev, ptr)) {
+            length++;
+        }
+        prev = ptr;
+    }
+    _lock();
+    head = _create_snip(pkt, NULL, (length * sizeof(struct iovec)),
+                        GNRC_NETTYPE_IOVEC);
+    mutex_unlock(&_mutex);
     if (head == NULL) {
         *len = 0;
         return NULL;
     }
     vec = (struct iovec *)(head->data);
     /* fill the IOVEC */
-    while (pkt != NULL) {
-        vec->iov_base = pkt->data;
-        vec->iov_len = pkt->size;
-        ++vec;
-        pkt = pkt->next;
+    vec->iov_base = pkt->data;
+    vec->iov_len = pkt->size;
+    for (gnrc_pktsnip_t *ptr = pkt->next; ptr != NULL; ptr = ptr->next) {
+        if ((ptr == pkt->next) || !_contiguous(prev, ptr)) {
+            ++vec;
+            vec->iov_base = ptr->data;
+            vec->iov_len = 0;
+        }
+        vec->iov_len += ptr->size;
+        prev = ptr;
     }
     *len = length;
     return head;
@@ -357,6 +633,12 @@ void gnrc_pktbuf_stats(void)
 #ifdef TEST_SUITES
 bool gnrc_pktbuf_is_empty(void)
 {
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CACHE
+    /* cached snips are free for the user of the packet buffer */
+    _lock();
+    _snip_caches_drain();
+    mutex_unlock(&_mutex);
+#endif
     return (_first_unused == (_unused_t *)_pktbuf) &&
            (_first_unused->size == sizeof(_pktbuf));
 }
@@ -393,10 +675,125 @@ bool gnrc_pktbuf_is_sane(void)
 }
 #endif
 
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CACHE
+static inline _snip_cache_t *_snip_cache(void)
+{
+    /* interrupts would share the cache of the thread they interrupted */
+    return irq_is_in() ? NULL : &_snip_caches[thread_getpid() - KERNEL_PID_FIRST];
+}
+
+static gnrc_pktsnip_t *_snip_cache_pop(_snip_cache_t *cache)
+{
+    gnrc_pktsnip_t *pkt = NULL;
+    unsigned state = irq_disable();
+
+    if (cache->fill > 0) {
+        pkt = cache->snips[--cache->fill];
+    }
+    irq_restore(state);
+    return pkt;
+}
+
+/* returns the snips of all caches, including the ones of threads that exited,
+ * to the packet buffer. _mutex must be held */
+static bool _snip_caches_drain(void)
+{
+    bool drained = false;
+
+    for (unsigned i = 0; i < MAXTHREADS; i++) {
+        gnrc_pktsnip_t *pkt;
+
+        while ((pkt = _snip_cache_pop(&_snip_caches[i])) != NULL) {
+            _pktbuf_free(pkt, sizeof(gnrc_pktsnip_t));
+            drained = true;
+        }
+    }
+    return drained;
+}
+
+/* adds the list from first to last to _released */
+static void _released_add(gnrc_pktsnip_t *first, gnrc_pktsnip_t *last)
+{
+    gnrc_pktsnip_t *head = __atomic_load_n(&_released, __ATOMIC_RELAXED);
+
+    do {
+        last->next = head;
+    } while (!__atomic_compare_exchange_n(&_released, &head, first, 0,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/* _mutex must be held */
+static void _released_free(void)
+{
+    gnrc_pktsnip_t *pkt;
+
+    /* taking the whole list at once rules out ABA problems in _released_add() */
+    if ((__atomic_load_n(&_released, __ATOMIC_RELAXED) == NULL) ||
+        ((pkt = __atomic_exchange_n(&_released, NULL, __ATOMIC_ACQUIRE)) == NULL)) {
+        return;
+    }
+    while (pkt != NULL) {
+        gnrc_pktsnip_t *next = pkt->next;
+
+        _free_snip_locked(pkt);
+        pkt = next;
+    }
+}
+#endif
+
+/* takes a snip from the thread's snip cache without locking */
+static inline gnrc_pktsnip_t *_snip_cache_take(void)
+{
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CACHE
+    _snip_cache_t *cache = _snip_cache();
+
+    if (cache != NULL) {
+        return _snip_cache_pop(cache);
+    }
+#endif
+    return NULL;
+}
+
+/* _mutex must be held */
+static gnrc_pktsnip_t *_snip_alloc_locked(void)
+{
+    gnrc_pktsnip_t *pkt = _snip_cache_take();
+
+    return (pkt != NULL) ? pkt : _pktbuf_alloc(sizeof(gnrc_pktsnip_t));
+}
+
+/* only takes _mutex on a cache miss */
+static gnrc_pktsnip_t *_snip_alloc(void)
+{
+    gnrc_pktsnip_t *pkt = _snip_cache_take();
+
+    if (pkt == NULL) {
+        _lock();
+        pkt = _pktbuf_alloc(sizeof(gnrc_pktsnip_t));
+        mutex_unlock(&_mutex);
+    }
+    return pkt;
+}
+
+/* puts snip into the thread's snip cache or, if that is full, back into the
+ * packet buffer. _mutex must be held. */
+static void _snip_free(gnrc_pktsnip_t *pkt)
+{
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CACHE
+    _snip_cache_t *cache = _snip_cache();
+
+    if ((cache != NULL) && (cache->fill < GNRC_PKTBUF_STATIC_CACHE_SIZE)) {
+        cache->snips[cache->fill++] = pkt;
+        return;
+    }
+#endif
+    _pktbuf_free(pkt, sizeof(gnrc_pktsnip_t));
+}
+
 static gnrc_pktsnip_t *_create_snip(gnrc_pktsnip_t *next, void *data, size_t size,
                                     gnrc_nettype_t type)
 {
-    gnrc_pktsnip_t *pkt = _pktbuf_alloc(sizeof(gnrc_pktsnip_t));
+    gnrc_pktsnip_t *pkt = _snip_alloc_locked();
     void *_data;
 
     if (pkt == NULL) {
@@ -406,7 +803,7 @@ static gnrc_pktsnip_t *_create_snip(gnrc_pktsnip_t *next, void *data, size_t siz
     _data = _pktbuf_alloc(size);
     if (_data == NULL) {
         DEBUG("pktbuf: error allocating data for new packet snip\n");
-        _pktbuf_free(pkt, sizeof(gnrc_pktsnip_t));
+        _snip_free(pkt);
         return NULL;
     }
     _set_pktsnip(pkt, next, _data, size, type);
@@ -425,6 +822,12 @@ static void *_pktbuf_alloc(size_t size)
         prev = ptr;
         ptr = ptr->next;
     }
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CACHE
+    if ((ptr == NULL) && _snip_caches_drain()) {
+        /* cached snips may have taken the space needed */
+        return _pktbuf_alloc(size);
+    }
+#endif
     if (ptr == NULL) {
         DEBUG("pktbuf: no space left in packet buffer\n");
         return NULL;
@@ -499,6 +902,25 @@ static void _pktbuf_free(void *data, size_t size)
 }
 
 
+/* frees the data of a snip, _mutex must be held */
+static void _data_free(void *data, size_t size)
+{
+    _headroom_t *hr = _headroom_find(data);
+
+    if (hr == NULL) {
+        _pktbuf_free(data, size);
+    }
+    else if (--hr->refs == 0) {
+        _pktbuf_free(hr->start, hr->size);
+        hr->start = NULL;
+        __atomic_sub_fetch(&_headrooms_used, 1, __ATOMIC_SEQ_CST);
+    }
+    else if (data == hr->front) {
+        /* give the space back to the headroom */
+        hr->front += size;
+    }
+}
+
 gnrc_pktsnip_t *gnrc_pktbuf_remove_snip(gnrc_pktsnip_t *pkt, gnrc_pktsnip_t *snip)
 {
     LL_DELETE(pkt, snip);
@@ -533,9 +955,9 @@ gnrc_pktsnip_t *gnrc_pktbuf_replace_snip(gnrc_pktsnip_t *pkt, gnrc_pktsnip_t *ol
 
 gnrc_pktsnip_t *gnrc_pktbuf_duplicate_upto(gnrc_pktsnip_t *pkt, gnrc_nettype_t type)
 {
-    mutex_lock(&_mutex);
+    _lock();
 
-    bool is_shared = pkt->users > 1;
+    bool is_shared = _users_get(pkt) > 1;
     size_t size = gnrc_pkt_len_upto(pkt, type);
 
     DEBUG("ipv6_ext: duplicating %d octets\n", (int) size);
@@ -0,0 +1,1798 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_gnrc_tcp
+ * @{
+ *
+ * @file
+ * @brief       TCP implementation
+ * @}
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "byteorder.h"
+#include "msg.h"
+#include "mutex.h"
+#include "random.h"
+#include "sched.h"
+#include "thread.h"
+#include "thread_flags.h"
+#include "utlist.h"
+#include "net/ipv6/hdr.h"
+#include "net/gnrc.h"
+#include "net/gnrc/ipv6.h"
+#include "net/gnrc/tcp.h"
+#include "net/inet_csum.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+/**
+ * @name    Internal flags of a TCB
+ * @{
+ */
+#define TCB_FLAG_ACTIVE         (0x01)  /**< in _tcbs */
+#define TCB_FLAG_WS             (0x02)  /**< window scaling was negotiated */
+#define TCB_FLAG_SACK           (0x04)  /**< SACK was negotiated */
+#define TCB_FLAG_ACK_DELAYED    (0x08)  /**< an ACK is pending */
+#define TCB_FLAG_FIN_PENDING    (0x10)  /**< FIN follows the queued data */
+#define TCB_FLAG_FIN_RCVD       (0x20)  /**< peer closed its direction */
+#define TCB_FLAG_RTT            (0x40)  /**< round-trip time is measured */
+#define TCB_FLAG_RTX            (0x80)  /**< retransmission timer is set */
+/** @} */
+
+/**
+ * @brief   Maximum segment size assumed when the peer does not announce one
+ */
+#define TCP_MSS_DEFAULT         (536U)
+
+/**
+ * @brief   Maximum number of SACK blocks sent (RFC 2018, section 3)
+ */
+#define TCP_SACK_BLOCKS_MAX     (4U)
+
+#define SEQ_LT(a, b)            ((int32_t)((a) - (b)) < 0)
+#define SEQ_LEQ(a, b)           ((int32_t)((a) - (b)) <= 0)
+
+/**
+ * @brief   Save the TCP's thread PID for later reference
+ */
+static kernel_pid_t _pid = KERNEL_PID_UNDEF;
+
+/**
+ * @brief   Allocate memory for the TCP thread's stack
+ */
+#if ENABLE_DEBUG
+static char _stack[GNRC_TCP_STACK_SIZE + THREAD_EXTRA_STACKSIZE_PRINTF];
+#else
+static char _stack[GNRC_TCP_STACK_SIZE];
+#endif
+
+/**
+ * @brief   All active TCBs
+ */
+static gnrc_tcp_tcb_t *_tcbs;
+
+/**
+ * @brief   A connection closed by the application that waits for the FIN of
+ *          the peer (FIN-WAIT-2) or for its old segments to die out
+ *          (TIME-WAIT)
+ */
+typedef struct {
+    ipv6_addr_t local_addr;     /**< local address */
+    ipv6_addr_t peer_addr;      /**< address of the peer */
+    uint16_t local_port;        /**< local port */
+    uint16_t peer_port;         /**< port of the peer */
+    uint32_t snd_nxt;           /**< sequence number after the own FIN */
+    uint32_t rcv_nxt;           /**< next sequence number expected */
+    uint64_t expires;           /**< end of the state, 0 if unused */
+    uint8_t state;              /**< GNRC_TCP_STATE_FIN_WAIT_2 or
+                                 *   GNRC_TCP_STATE_TIME_WAIT */
+    uint8_t rcv_wscale;         /**< own window scale */
+} _tw_t;
+
+/**
+ * @brief   Closed connections in FIN-WAIT-2 or TIME-WAIT
+ */
+static _tw_t _tws[GNRC_TCP_TIME_WAIT_NUMOF];
+
+/**
+ * @brief   Protects all TCBs and _tws
+ */
+static mutex_t _lock = MUTEX_INIT;
+
+static void _output(gnrc_tcp_tcb_t *tcb, bool force);
+
+static inline uint32_t _min(uint32_t a, uint32_t b)
+{
+    return (a < b) ? a : b;
+}
+
+static inline uint32_t _max(uint32_t a, uint32_t b)
+{
+    return (a > b) ? a : b;
+}
+
+static inline uint32_t _get_u32(const uint8_t *buf)
+{
+    return ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) |
+           ((uint32_t)buf[2] << 8) | buf[3];
+}
+
+static inline void _set_u32(uint8_t *buf, uint32_t val)
+{
+    buf[0] = val >> 24;
+    buf[1] = val >> 16;
+    buf[2] = val >> 8;
+    buf[3] = val;
+}
+
+static inline gnrc_tcp_seg_t *_snd_seg(gnrc_tcp_tcb_t *tcb, unsigned i)
+{
+    return &tcb->snd_queue[(tcb->snd_head + i) & (GNRC_TCP_SND_QUEUE_SIZE - 1)];
+}
+
+/**
+ * @brief   Checks if queued data or a FIN is not acknowledged yet
+ */
+static inline bool _snd_pending(gnrc_tcp_tcb_t *tcb)
+{
+    uint32_t end = tcb->snd_end + ((tcb->flags & TCB_FLAG_FIN_PENDING) ? 1 : 0);
+
+    return tcb->snd_una != end;
+}
+
+/**
+ * @brief   Calculate the one's complement sum of a TCP segment including the
+ *          pseudo header
+ *
+ * @return  the sum, 0xffff for a valid segment
+ * @return  0 on error
+ */
+static uint16_t _calc_csum(gnrc_pktsnip_t *hdr, gnrc_pktsnip_t *pseudo_hdr,
+                           gnrc_pktsnip_t *payload)
+{
+    uint16_t csum = 0;
+    uint16_t len = (uint16_t)hdr->size;
+
+    /* process the payload */
+    while (payload && payload != hdr && payload != pseudo_hdr) {
+        csum = inet_csum_slice(csum, (uint8_t *)(payload->data), payload->size, len);
+        len += (uint16_t)payload->size;
+        payload = payload->next;
+    }
+    /* process the TCP header including options */
+    csum = inet_csum(csum, (uint8_t *)hdr->data, hdr->size);
+
+    switch (pseudo_hdr->type) {
+#ifdef MODULE_GNRC_IPV6
+        case GNRC_NETTYPE_IPV6:
+            csum = ipv6_hdr_inet_csum(csum, pseudo_hdr->data, PROTNUM_TCP, len);
+            break;
+#endif
+        default:
+            (void)len;
+            return 0;
+    }
+    return csum;
+}
+
+static void _link(gnrc_tcp_tcb_t *tcb)
+{
+    if (!(tcb->flags & TCB_FLAG_ACTIVE)) {
+        tcb->flags |= TCB_FLAG_ACTIVE;
+        LL_PREPEND(_tcbs, tcb);
+    }
+}
+
+static void _unlink(gnrc_tcp_tcb_t *tcb)
+{
+    if (tcb->flags & TCB_FLAG_ACTIVE) {
+        tcb->flags &= ~TCB_FLAG_ACTIVE;
+        LL_DELETE(_tcbs, tcb);
+    }
+}
+
+static gnrc_tcp_tcb_t *_active(gnrc_tcp_tcb_t *tcb)
+{
+    gnrc_tcp_tcb_t *tmp;
+
+    LL_FOREACH(_tcbs, tmp) {
+        if (tmp == tcb) {
+            return tcb;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief   Finds the TCB of a received segment: the one of the connection or
+ *          else a listening one
+ */
+static gnrc_tcp_tcb_t *_find(const ipv6_hdr_t *ipv6, const tcp_hdr_t *hdr)
+{
+    gnrc_tcp_tcb_t *tcb, *listener = NULL;
+    uint16_t dst_port = byteorder_ntohs(hdr->dst_port);
+    uint16_t src_port = byteorder_ntohs(hdr->src_port);
+
+    LL_FOREACH(_tcbs, tcb) {
+        if ((tcb->local_port != dst_port) ||
+            (!ipv6_addr_is_unspecified(&tcb->local_addr) &&
+             !ipv6_addr_equal(&tcb->local_addr, &ipv6->dst))) {
+            continue;
+        }
+        if (tcb->state == GNRC_TCP_STATE_LISTEN) {
+            listener = tcb;
+        }
+        else if ((tcb->peer_port == src_port) &&
+                 ipv6_addr_equal(&tcb->peer_addr, &ipv6->src)) {
+            return tcb;
+        }
+    }
+    return listener;
+}
+
+static inline void _notify(gnrc_tcp_tcb_t *tcb)
+{
+    gnrc_netapi_mbox_notify(tcb->mbox);
+}
+
+/**
+ * @brief   Waits for a notification of @p tcb
+ *
+ * @pre     _lock is held and the calling thread is the reader of the mailbox
+ *          of @p tcb.
+ */
+static void _wait(gnrc_tcp_tcb_t *tcb)
+{
+    mutex_unlock(&_lock);
+    thread_flags_wait_any(tcb->mbox->flag);
+    mutex_lock(&_lock);
+}
+
+static void _rtx_start(gnrc_tcp_tcb_t *tcb)
+{
+    tcb->flags |= TCB_FLAG_RTX;
+    xtimer_set_msg(&tcb->rtx_timer, tcb->rto, &tcb->rtx_msg, _pid);
+}
+
+static void _rtx_stop(gnrc_tcp_tcb_t *tcb)
+{
+    tcb->flags &= ~TCB_FLAG_RTX;
+    xtimer_remove(&tcb->rtx_timer);
+}
+
+static void _rtt_start(gnrc_tcp_tcb_t *tcb, uint32_t seq)
+{
+    tcb->flags |= TCB_FLAG_RTT;
+    tcb->rtt_seq = seq;
+    tcb->rtt_start = xtimer_now();
+}
+
+/**
+ * @brief   Updates the retransmission timeout with a round-trip time sample
+ *          (RFC 6298, section 2)
+ */
+static void _rtt_update(gnrc_tcp_tcb_t *tcb, uint32_t rtt)
+{
+    if (tcb->srtt == 0) {
+        tcb->srtt = rtt;
+        tcb->rttvar = rtt / 2;
+    }
+    else {
+        uint32_t delta = (tcb->srtt > rtt) ? (tcb->srtt - rtt) : (rtt - tcb->srtt);
+
+        tcb->rttvar = ((3 * tcb->rttvar) + delta) / 4;
+        tcb->srtt = ((7 * tcb->srtt) + rtt) / 8;
+    }
+    tcb->rto = _min(_max(tcb->srtt + (4 * tcb->rttvar), GNRC_TCP_RTO_MIN),
+                    GNRC_TCP_RTO_MAX);
+}
+
+/**
+ * @brief   Window scale that makes @ref GNRC_TCP_RCV_WND fit into the
+ *          window field
+ */
+static uint8_t _rcv_wscale(void)
+{
+    uint8_t shift = 0;
+
+    while (((GNRC_TCP_RCV_WND >> shift) > UINT16_MAX) && (shift < TCP_WS_MAX)) {
+        shift++;
+    }
+    return shift;
+}
+
+/**
+ * @brief   The receive window, never shrunk below what was announced already
+ */
+static uint32_t _rcv_wnd(gnrc_tcp_tcb_t *tcb)
+{
+    uint32_t wnd = 0;
+
+    if ((tcb->rcv_queued < GNRC_TCP_RCV_WND) &&
+        (gnrc_netapi_mbox_avail(tcb->mbox) <= tcb->mbox->cib.mask)) {
+        wnd = GNRC_TCP_RCV_WND - tcb->rcv_queued;
+    }
+    if (SEQ_LT(tcb->rcv_nxt + wnd, tcb->rcv_adv)) {
+        wnd = tcb->rcv_adv - tcb->rcv_nxt;
+    }
+    return wnd;
+}
+
+static void _release_queues(gnrc_tcp_tcb_t *tcb)
+{
+    for (unsigned i = 0; i < tcb->snd_numof; i++) {
+        gnrc_pktbuf_release(_snd_seg(tcb, i)->pkt);
+    }
+    tcb->snd_numof = 0;
+    for (unsigned i = 0; (i < GNRC_TCP_OOO_SIZE) && (tcb->ooo[i].pkt != NULL); i++) {
+        gnrc_pktbuf_release(tcb->ooo[i].pkt);
+        tcb->ooo[i].pkt = NULL;
+    }
+}
+
+/**
+ * @brief   Ends a connection and wakes up the threads waiting for it
+ */
+static void _abort(gnrc_tcp_tcb_t *tcb, int error)
+{
+    DEBUG("tcp: connection ended (%d)\n", error);
+    _rtx_stop(tcb);
+    xtimer_remove(&tcb->ack_timer);
+    _release_queues(tcb);
+    _unlink(tcb);
+    tcb->flags = 0;
+    tcb->state = GNRC_TCP_STATE_CLOSED;
+    tcb->error = error;
+    _notify(tcb);
+}
+
+/**
+ * @brief   Builds a segment and sends it to the network layer
+ *
+ * @param[in] payload   payload of the segment, released on error. May be NULL.
+ */
+static int _send(const ipv6_addr_t *src, const ipv6_addr_t *dst,
+                 uint16_t src_port, uint16_t dst_port, uint32_t seq,
+                 uint32_t ack, uint8_t flags, uint16_t window,
+                 const uint8_t *opts, unsigned opts_len,
+                 gnrc_pktsnip_t *payload)
+{
+    gnrc_pktsnip_t *tcp, *ipv6;
+    tcp_hdr_t *hdr;
+
+    tcp = gnrc_pktbuf_add(payload, NULL, sizeof(tcp_hdr_t) + opts_len,
+                          GNRC_NETTYPE_TCP);
+    if (tcp == NULL) {
+        DEBUG("tcp: unable to allocate TCP header\n");
+        if (payload != NULL) {
+            gnrc_pktbuf_release(payload);
+        }
+        return -ENOMEM;
+    }
+    hdr = (tcp_hdr_t *)tcp->data;
+    hdr->src_port = byteorder_htons(src_port);
+    hdr->dst_port = byteorder_htons(dst_port);
+    hdr->seq_num = byteorder_htonl(seq);
+    hdr->ack_num = byteorder_htonl(ack);
+    hdr->off_reserved = ((sizeof(tcp_hdr_t) + opts_len) / 4) << 4;
+    hdr->flags = flags;
+    hdr->window = byteorder_htons(window);
+    hdr->checksum = byteorder_htons(0);
+    hdr->urgent_ptr = byteorder_htons(0);
+    memcpy(hdr + 1, opts, opts_len);
+
+    ipv6 = gnrc_ipv6_hdr_build(tcp, ipv6_addr_is_unspecified(src) ? NULL : src,
+                               dst);
+    if (ipv6 == NULL) {
+        DEBUG("tcp: unable to allocate IPv6 header\n");
+        gnrc_pktbuf_release(tcp);
+        return -ENOMEM;
+    }
+    if (!gnrc_netapi_dispatch_send(GNRC_NETTYPE_IPV6, GNRC_NETREG_DEMUX_CTX_ALL,
+                                   ipv6)) {
+        DEBUG("tcp: cannot send segment: network layer not found\n");
+        gnrc_pktbuf_release(ipv6);
+        return -ENETUNREACH;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Answers a segment that belongs to no connection with a reset
+ *          (RFC 793, section 3.4)
+ */
+static void _reset(const ipv6_hdr_t *ipv6, const tcp_hdr_t *hdr, uint32_t seg_len)
+{
+    if ((hdr->flags & TCP_FLAG_RST) || ipv6_addr_is_multicast(&ipv6->dst)) {
+        return;
+    }
+    if (hdr->flags & TCP_FLAG_ACK) {
+        _send(&ipv6->dst, &ipv6->src, byteorder_ntohs(hdr->dst_port),
+              byteorder_ntohs(hdr->src_port), byteorder_ntohl(hdr->ack_num), 0,
+              TCP_FLAG_RST, 0, NULL, 0, NULL);
+    }
+    else {
+        _send(&ipv6->dst, &ipv6->src, byteorder_ntohs(hdr->dst_port),
+              byteorder_ntohs(hdr->src_port), 0,
+              byteorder_ntohl(hdr->seq_num) + seg_len,
+              TCP_FLAG_RST | TCP_FLAG_ACK, 0, NULL, 0, NULL);
+    }
+}
+
+/**
+ * @brief   Keeps a closed connection in FIN-WAIT-2 or TIME-WAIT
+ */
+static void _tw_add(gnrc_tcp_tcb_t *tcb)
+{
+    uint64_t now = xtimer_now64();
+    _tw_t *tw = &_tws[0];
+
+    for (unsigned i = 0; i < GNRC_TCP_TIME_WAIT_NUMOF; i++) {
+        if (_tws[i].expires <= now) {
+            tw = &_tws[i];
+            break;
+        }
+        if (_tws[i].expires < tw->expires) {
+            /* drop the one that would end first */
+            tw = &_tws[i];
+        }
+    }
+    memcpy(&tw->local_addr, &tcb->local_addr, sizeof(ipv6_addr_t));
+    memcpy(&tw->peer_addr, &tcb->peer_addr, sizeof(ipv6_addr_t));
+    tw->local_port = tcb->local_port;
+    tw->peer_port = tcb->peer_port;
+    tw->snd_nxt = tcb->snd_nxt;
+    tw->rcv_nxt = tcb->rcv_nxt;
+    tw->state = tcb->state;
+    tw->rcv_wscale = tcb->rcv_wscale;
+    tw->expires = now + ((tw->state == GNRC_TCP_STATE_TIME_WAIT) ?
+                         (2ULL * GNRC_TCP_MSL) : GNRC_TCP_FIN_WAIT_2_TIMEOUT);
+}
+
+static _tw_t *_tw_find(const ipv6_hdr_t *ipv6, const tcp_hdr_t *hdr)
+{
+    uint64_t now = xtimer_now64();
+
+    for (unsigned i = 0; i < GNRC_TCP_TIME_WAIT_NUMOF; i++) {
+        _tw_t *tw = &_tws[i];
+
+        if ((tw->expires > now) &&
+            (tw->local_port == byteorder_ntohs(hdr->dst_port)) &&
+            (tw->peer_port == byteorder_ntohs(hdr->src_port)) &&
+            ipv6_addr_equal(&tw->local_addr, &ipv6->dst) &&
+            ipv6_addr_equal(&tw->peer_addr, &ipv6->src)) {
+            return tw;
+        }
+    }
+    return NULL;
+}
+
+static void _tw_ack(_tw_t *tw)
+{
+    _send(&tw->local_addr, &tw->peer_addr, tw->local_port, tw->peer_port,
+          tw->snd_nxt, tw->rcv_nxt, TCP_FLAG_ACK,
+          _min(GNRC_TCP_RCV_WND >> tw->rcv_wscale, UINT16_MAX), NULL, 0, NULL);
+}
+
+/**
+ * @brief   Processes a segment of a connection in FIN-WAIT-2 or TIME-WAIT
+ *          (RFC 793, section 3.9)
+ *
+ * @return  false if the segment opens a new connection and @p tw was dropped
+ */
+static bool _tw_segment(_tw_t *tw, const tcp_hdr_t *hdr, size_t len)
+{
+    uint32_t seq = byteorder_ntohl(hdr->seq_num);
+
+    if (hdr->flags & TCP_FLAG_RST) {
+        /* a reset ends FIN-WAIT-2, TIME-WAIT ignores it (RFC 1337) */
+        if ((tw->state == GNRC_TCP_STATE_FIN_WAIT_2) && (seq == tw->rcv_nxt)) {
+            tw->expires = 0;
+        }
+        return true;
+    }
+    if (hdr->flags & TCP_FLAG_SYN) {
+        if ((tw->state == GNRC_TCP_STATE_TIME_WAIT) && SEQ_LT(tw->rcv_nxt, seq)) {
+            /* a new incarnation of the connection (RFC 1122, 4.2.2.13) */
+            tw->expires = 0;
+            return false;
+        }
+        _tw_ack(tw);
+        return true;
+    }
+    if (tw->state == GNRC_TCP_STATE_FIN_WAIT_2) {
+        if (seq == tw->rcv_nxt) {
+            /* nobody reads the data anymore */
+            tw->rcv_nxt += len;
+            if (hdr->flags & TCP_FLAG_FIN) {
+                tw->rcv_nxt++;
+                tw->state = GNRC_TCP_STATE_TIME_WAIT;
+                tw->expires = xtimer_now64() + (2ULL * GNRC_TCP_MSL);
+            }
+        }
+        if ((len > 0) || (hdr->flags & TCP_FLAG_FIN)) {
+            _tw_ack(tw);
+        }
+    }
+    else if (hdr->flags & TCP_FLAG_FIN) {
+        /* the ACK of the FIN was lost */
+        tw->expires = xtimer_now64() + (2ULL * GNRC_TCP_MSL);
+        _tw_ack(tw);
+    }
+    return true;
+}
+
+/**
+ * @brief   Writes the SACK option for the out-of-order segments
+ *
+ * @return  length of the option including padding, 0 if there are no
+ *          out-of-order segments
+ */
+static unsigned _sack_opts(gnrc_tcp_tcb_t *tcb, uint8_t *opts)
+{
+    uint8_t *block = opts + 4;
+    unsigned numof = 0;
+
+    for (unsigned i = 0; (i < GNRC_TCP_OOO_SIZE) && (tcb->ooo[i].pkt != NULL); i++) {
+        uint32_t start = tcb->ooo[i].seq;
+        uint32_t end = start + tcb->ooo[i].pkt->size;
+
+        if ((numof > 0) && (_get_u32(block - 4) == start)) {
+            /* adjacent to the previous block */
+            _set_u32(block - 4, end);
+            continue;
+        }
+        if (numof == TCP_SACK_BLOCKS_MAX) {
+            break;
+        }
+        _set_u32(block, start);
+        _set_u32(block + 4, end);
+        block += 8;
+        numof++;
+    }
+    if (numof == 0) {
+        return 0;
+    }
+    opts[0] = TCP_OPTION_KIND_NOP;
+    opts[1] = TCP_OPTION_KIND_NOP;
+    opts[2] = TCP_OPTION_KIND_SACK;
+    opts[3] = 2 + (8 * numof);
+    return 4 + (8 * numof);
+}
+
+/**
+ * @brief   Sends a segment of a connection
+ *
+ * @param[in] payload   payload of the segment, released on error. May be NULL.
+ */
+static int _send_segment(gnrc_tcp_tcb_t *tcb, uint8_t flags, uint32_t seq,
+                         gnrc_pktsnip_t *payload)
+{
+    uint8_t opts[TCP_HDR_LEN_MAX - sizeof(tcp_hdr_t)];
+    unsigned opts_len = 0;
+    uint32_t wnd = _rcv_wnd(tcb);
+    uint16_t window;
+    int res;
+
+    if (flags & TCP_FLAG_SYN) {
+        bool offer = (tcb->state == GNRC_TCP_STATE_SYN_SENT);
+
+        opts[opts_len++] = TCP_OPTION_KIND_MSS;
+        opts[opts_len++] = TCP_OPTION_LENGTH_MSS;
+        opts[opts_len++] = GNRC_TCP_MSS >> 8;
+        opts[opts_len++] = GNRC_TCP_MSS & 0xff;
+        if (offer || (tcb->flags & TCB_FLAG_WS)) {
+            opts[opts_len++] = TCP_OPTION_KIND_NOP;
+            opts[opts_len++] = TCP_OPTION_KIND_WS;
+            opts[opts_len++] = TCP_OPTION_LENGTH_WS;
+            opts[opts_len++] = tcb->rcv_wscale;
+        }
+        if (offer || (tcb->flags & TCB_FLAG_SACK)) {
+            opts[opts_len++] = TCP_OPTION_KIND_NOP;
+            opts[opts_len++] = TCP_OPTION_KIND_NOP;
+            opts[opts_len++] = TCP_OPTION_KIND_SACK_PERM;
+            opts[opts_len++] = TCP_OPTION_LENGTH_SACK_PERM;
+        }
+        /* the window of a SYN is never scaled (RFC 7323, section 2.2) */
+        window = _min(wnd, UINT16_MAX);
+        tcb->rcv_adv = tcb->rcv_nxt + window;
+    }
+    else {
+        if (tcb->flags & TCB_FLAG_SACK) {
+            opts_len = _sack_opts(tcb, opts);
+        }
+        window = _min(wnd >> tcb->rcv_wscale, UINT16_MAX);
+        tcb->rcv_adv = tcb->rcv_nxt + ((uint32_t)window << tcb->rcv_wscale);
+    }
+    res = _send(&tcb->local_addr, &tcb->peer_addr, tcb->local_port,
+                tcb->peer_port, seq, tcb->rcv_nxt, flags, window, opts,
+                opts_len, payload);
+    if ((res == 0) && (flags & TCP_FLAG_ACK) &&
+        (tcb->flags & TCB_FLAG_ACK_DELAYED)) {
+        tcb->flags &= ~TCB_FLAG_ACK_DELAYED;
+        xtimer_remove(&tcb->ack_timer);
+    }
+    return res;
+}
+
+static inline void _send_ack(gnrc_tcp_tcb_t *tcb)
+{
+    _send_segment(tcb, TCP_FLAG_ACK, tcb->snd_nxt, NULL);
+}
+
+/**
+ * @brief   Acknowledges every second segment right away and delays the
+ *          acknowledgment of the others
+ */
+static void _send_ack_delayed(gnrc_tcp_tcb_t *tcb)
+{
+    if ((GNRC_TCP_ACK_DELAY == 0) || (tcb->flags & TCB_FLAG_ACK_DELAYED)) {
+        _send_ack(tcb);
+        return;
+    }
+    tcb->flags |= TCB_FLAG_ACK_DELAYED;
+    xtimer_set_msg(&tcb->ack_timer, GNRC_TCP_ACK_DELAY, &tcb->ack_msg, _pid);
+}
+
+/**
+ * @brief   Sends a segment of the send queue
+ */
+static int _xmit(gnrc_tcp_tcb_t *tcb, gnrc_tcp_seg_t *seg)
+{
+    /* the segment stays queued until it is acknowledged */
+    gnrc_pktbuf_hold(seg->pkt, 1);
+    return _send_segment(tcb, TCP_FLAG_ACK | TCP_FLAG_PSH, seg->seq, seg->pkt);
+}
+
+/**
+ * @brief   Sends what the windows allow from the send queue, followed by a
+ *          pending FIN
+ *
+ * @param[in] force     send one segment even if the windows are closed
+ */
+static void _output(gnrc_tcp_tcb_t *tcb, bool force)
+{
+    uint32_t wnd = _min(tcb->snd_wnd, tcb->cwnd);
+
+    switch (tcb->state) {
+        case GNRC_TCP_STATE_ESTABLISHED:
+        case GNRC_TCP_STATE_CLOSE_WAIT:
+        case GNRC_TCP_STATE_FIN_WAIT_1:
+        case GNRC_TCP_STATE_CLOSING:
+        case GNRC_TCP_STATE_LAST_ACK:
+            break;
+        default:
+            return;
+    }
+    for (unsigned i = 0; i < tcb->snd_numof; i++) {
+        gnrc_tcp_seg_t *seg = _snd_seg(tcb, i);
+        uint32_t end = seg->seq + seg->pkt->size;
+
+        if (SEQ_LEQ(end, tcb->snd_nxt)) {
+            continue;
+        }
+        if (seg->sacked) {
+            /* the peer has it already */
+            tcb->snd_nxt = end;
+            continue;
+        }
+        if (SEQ_LT(tcb->snd_una + wnd, end) && !force) {
+            break;
+        }
+        force = false;
+        if (_xmit(tcb, seg) < 0) {
+            break;
+        }
+        if (SEQ_LEQ(tcb->snd_max, seg->seq) && !(tcb->flags & TCB_FLAG_RTT)) {
+            _rtt_start(tcb, end);
+        }
+        tcb->snd_nxt = end;
+        if (SEQ_LT(tcb->snd_max, end)) {
+            tcb->snd_max = end;
+        }
+        if (!(tcb->flags & TCB_FLAG_RTX)) {
+            _rtx_start(tcb);
+        }
+    }
+    if ((tcb->flags & TCB_FLAG_FIN_PENDING) && (tcb->snd_nxt == tcb->snd_end)) {
+        if (_send_segment(tcb, TCP_FLAG_FIN | TCP_FLAG_ACK, tcb->snd_end,
+                          NULL) == 0) {
+            tcb->snd_nxt = tcb->snd_end + 1;
+            tcb->snd_max = tcb->snd_nxt;
+        }
+    }
+    if (!(tcb->flags & TCB_FLAG_RTX) && _snd_pending(tcb)) {
+        /* a closed window is probed on timeout */
+        _rtx_start(tcb);
+    }
+}
+
+/**
+ * @brief   Handles an expired retransmission timer (RFC 6298, section 5 and
+ *          RFC 5681, section 3.1)
+ */
+static void _rtx_timeout(gnrc_tcp_tcb_t *tcb)
+{
+    tcb->flags &= ~(TCB_FLAG_RTX | TCB_FLAG_RTT);
+    if (++tcb->rtx_count > GNRC_TCP_RTX_MAX) {
+        _abort(tcb, -ETIMEDOUT);
+        return;
+    }
+    tcb->rto = _min(tcb->rto * 2, GNRC_TCP_RTO_MAX);
+    switch (tcb->state) {
+        case GNRC_TCP_STATE_SYN_SENT:
+            _send_segment(tcb, TCP_FLAG_SYN, tcb->iss, NULL);
+            _rtx_start(tcb);
+            return;
+        case GNRC_TCP_STATE_SYN_RCVD:
+            _send_segment(tcb, TCP_FLAG_SYN | TCP_FLAG_ACK, tcb->iss, NULL);
+            _rtx_start(tcb);
+            return;
+        default:
+            break;
+    }
+    if (tcb->snd_una != tcb->snd_max) {
+        tcb->ssthresh = _max((tcb->snd_max - tcb->snd_una) / 2, 2 * tcb->mss);
+        tcb->cwnd = tcb->mss;
+        tcb->dupacks = 0;
+    }
+    /* go back to the oldest unacknowledged segment; with a zero window this
+     * probes the window */
+    tcb->snd_nxt = tcb->snd_una;
+    _output(tcb, true);
+}
+
+/**
+ * @brief   Parses the options of a segment
+ *
+ * @param[out] syn      the options of a SYN are stored here, may be NULL
+ * @param[in,out] tcb   segments the SACK blocks cover are marked here, may be
+ *                      NULL
+ */
+static void _parse_opts(const tcp_hdr_t *hdr, gnrc_tcp_syn_t *syn,
+                        gnrc_tcp_tcb_t *tcb)
+{
+    const uint8_t *opt = (const uint8_t *)(hdr + 1);
+    const uint8_t *end = ((const uint8_t *)hdr) + tcp_hdr_len(hdr);
+
+    if (syn != NULL) {
+        syn->mss = TCP_MSS_DEFAULT;
+        syn->wscale = 0xff;
+        syn->sack_perm = 0;
+    }
+    while (opt < end) {
+        if (opt[0] == TCP_OPTION_KIND_EOL) {
+            break;
+        }
+        if (opt[0] == TCP_OPTION_KIND_NOP) {
+            opt++;
+            continue;
+        }
+        if (((opt + 1) >= end) || (opt[1] < 2) || ((opt + opt[1]) > end)) {
+            DEBUG("tcp: malformed option\n");
+            break;
+        }
+        switch (opt[0]) {
+            case TCP_OPTION_KIND_MSS:
+                if ((syn != NULL) && (opt[1] == TCP_OPTION_LENGTH_MSS)) {
+                    syn->mss = (opt[2] << 8) | opt[3];
+                }
+                break;
+            case TCP_OPTION_KIND_WS:
+                if ((syn != NULL) && (opt[1] == TCP_OPTION_LENGTH_WS)) {
+                    syn->wscale = _min(opt[2], TCP_WS_MAX);
+                }
+                break;
+            case TCP_OPTION_KIND_SACK_PERM:
+                if (syn != NULL) {
+                    syn->sack_perm = 1;
+                }
+                break;
+            case TCP_OPTION_KIND_SACK:
+                if (tcb == NULL) {
+                    break;
+                }
+                for (const uint8_t *block = opt + 2; (block + 8) <= (opt + opt[1]);
+                     block += 8) {
+                    uint32_t left = _get_u32(block);
+                    uint32_t right = _get_u32(block + 4);
+
+                    for (unsigned i = 0; i < tcb->snd_numof; i++) {
+                        gnrc_tcp_seg_t *seg = _snd_seg(tcb, i);
+
+                        if (SEQ_LEQ(left, seg->seq) &&
+                            SEQ_LEQ(seg->seq + seg->pkt->size, right)) {
+                            seg->sacked = 1;
+                        }
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+        opt += opt[1];
+    }
+}
+
+/**
+ * @brief   Applies the options of the peer's SYN to a TCB
+ */
+static void _syn_opts(gnrc_tcp_tcb_t *tcb, const gnrc_tcp_syn_t *syn)
+{
+    tcb->mss = _min(syn->mss, GNRC_TCP_MSS);
+    if (syn->wscale != 0xff) {
+        tcb->flags |= TCB_FLAG_WS;
+        tcb->snd_wscale = syn->wscale;
+    }
+    else {
+        tcb->snd_wscale = 0;
+        tcb->rcv_wscale = 0;
+    }
+    if (syn->sack_perm) {
+        tcb->flags |= TCB_FLAG_SACK;
+    }
+    /* initial window (RFC 3390) */
+    tcb->cwnd = _min(4 * tcb->mss, _max(2 * tcb->mss, 4380));
+}
+
+/**
+ * @brief   Prepares a TCB for a new connection and activates it
+ */
+static void _open(gnrc_tcp_tcb_t *tcb, uint8_t state)
+{
+    tcb->state = state;
+    tcb->flags &= TCB_FLAG_ACTIVE;
+    tcb->error = 0;
+    tcb->dupacks = 0;
+    tcb->rtx_count = 0;
+    tcb->mss = TCP_MSS_DEFAULT;
+    tcb->iss = random_uint32();
+    tcb->snd_una = tcb->iss;
+    tcb->snd_nxt = tcb->iss + 1;
+    tcb->snd_max = tcb->snd_nxt;
+    tcb->snd_end = tcb->snd_nxt;
+    tcb->snd_wnd = 0;
+    tcb->snd_wscale = 0;
+    tcb->cwnd = tcb->mss;
+    tcb->ssthresh = UINT32_MAX;
+    tcb->rcv_wscale = _rcv_wscale();
+    tcb->rcv_queued = 0;
+    tcb->snd_head = 0;
+    tcb->snd_numof = 0;
+    tcb->srtt = 0;
+    tcb->rttvar = 0;
+    tcb->rto = GNRC_TCP_RTO_INIT;
+    _link(tcb);
+}
+
+/**
+ * @brief   Hands in-order payload to the mailbox
+ *
+ * @return  false if the mailbox was full and @p pkt was dropped
+ */
+static bool _deliver(gnrc_tcp_tcb_t *tcb, gnrc_pktsnip_t *pkt)
+{
+    size_t len = pkt->size;
+
+    if (gnrc_netapi_mbox_put(tcb->mbox, pkt) < 0) {
+        DEBUG("tcp: mailbox full, dropping segment\n");
+        gnrc_pktbuf_release(pkt);
+        return false;
+    }
+    tcb->rcv_nxt += len;
+    tcb->rcv_queued += len;
+    return true;
+}
+
+/**
+ * @brief   Removes what was received already from the front of a payload
+ *
+ * @return  false if nothing is left and @p pkt was released
+ */
+static bool _trim_front(gnrc_tcp_tcb_t *tcb, gnrc_pktsnip_t *pkt, uint32_t *seq)
+{
+    uint32_t dup;
+
+    if (!SEQ_LT(*seq, tcb->rcv_nxt)) {
+        return true;
+    }
+    dup = tcb->rcv_nxt - *seq;
+    if ((dup >= pkt->size) ||
+        (gnrc_pktbuf_mark(pkt, dup, GNRC_NETTYPE_UNDEF) == NULL)) {
+        gnrc_pktbuf_release(pkt);
+        return false;
+    }
+    *seq = tcb->rcv_nxt;
+    return true;
+}
+
+/**
+ * @brief   Delivers the out-of-order segments that are in order now
+ */
+static void _ooo_pull(gnrc_tcp_tcb_t *tcb)
+{
+    while ((tcb->ooo[0].pkt != NULL) && SEQ_LEQ(tcb->ooo[0].seq, tcb->rcv_nxt)) {
+        gnrc_pktsnip_t *pkt = tcb->ooo[0].pkt;
+        uint32_t seq = tcb->ooo[0].seq;
+
+        memmove(&tcb->ooo[0], &tcb->ooo[1],
+                (GNRC_TCP_OOO_SIZE - 1) * sizeof(gnrc_tcp_seg_t));
+        tcb->ooo[GNRC_TCP_OOO_SIZE - 1].pkt = NULL;
+        if (_trim_front(tcb, pkt, &seq) && !_deliver(tcb, pkt)) {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief   Keeps an out-of-order segment, sorted by sequence number
+ */
+static void _ooo_insert(gnrc_tcp_tcb_t *tcb, gnrc_pktsnip_t *pkt, uint32_t seq)
+{
+    unsigned i = 0;
+
+    while ((i < GNRC_TCP_OOO_SIZE) && (tcb->ooo[i].pkt != NULL) &&
+           SEQ_LT(tcb->ooo[i].seq, seq)) {
+        i++;
+    }
+    if ((i == GNRC_TCP_OOO_SIZE) ||
+        (tcb->ooo[GNRC_TCP_OOO_SIZE - 1].pkt != NULL) ||
+        ((tcb->ooo[i].pkt != NULL) && (tcb->ooo[i].seq == seq))) {
+        DEBUG("tcp: dropping out-of-order segment\n");
+        gnrc_pktbuf_release(pkt);
+        return;
+    }
+    memmove(&tcb->ooo[i + 1], &tcb->ooo[i],
+            (GNRC_TCP_OOO_SIZE - 1 - i) * sizeof(gnrc_tcp_seg_t));
+    tcb->ooo[i].pkt = pkt;
+    tcb->ooo[i].seq = seq;
+}
+
+/**
+ * @brief   Processes the payload of an acceptable segment
+ */
+static void _data(gnrc_tcp_tcb_t *tcb, gnrc_pktsnip_t *pkt, uint32_t seq)
+{
+    uint32_t wnd_end = SEQ_LT(tcb->rcv_adv, tcb->rcv_nxt) ? tcb->rcv_nxt
+                                                           : tcb->rcv_adv;
+
+    if (!_trim_front(tcb, pkt, &seq)) {
+        _send_ack(tcb);
+        return;
+    }
+    if (SEQ_LT(wnd_end, seq + pkt->size)) {
+        /* cut off what exceeds the window */
+        if ((wnd_end == seq) ||
+            (gnrc_pktbuf_realloc_data(pkt, wnd_end - seq) != 0)) {
+            gnrc_pktbuf_release(pkt);
+            _send_ack(tcb);
+            return;
+        }
+    }
+    if (seq != tcb->rcv_nxt) {
+        _ooo_insert(tcb, pkt, seq);
+        /* duplicate ACK with SACK blocks (RFC 5681, section 4.2) */
+        _send_ack(tcb);
+        return;
+    }
+    if (!_deliver(tcb, pkt)) {
+        _send_ack(tcb);
+        return;
+    }
+    if (tcb->ooo[0].pkt != NULL) {
+        _ooo_pull(tcb);
+        /* a gap was filled, acknowledge it right away */
+        _send_ack(tcb);
+        return;
+    }
+    _send_ack_delayed(tcb);
+}
+
+/**
+ * @brief   Processes an acknowledgment (RFC 793, RFC 5681 and RFC 6298)
+ *
+ * @return  false if the segment must be dropped
+ */
+static bool _ack(gnrc_tcp_tcb_t *tcb, uint32_t seq, uint32_t ack, uint16_t window,
+                 size_t len)
+{
+    uint32_t wnd = (uint32_t)window << tcb->snd_wscale;
+
+    if (SEQ_LT(tcb->snd_max, ack)) {
+        /* acknowledges something not yet sent */
+        _send_ack(tcb);
+        return false;
+    }
+    if (SEQ_LT(tcb->snd_una, ack)) {
+        uint32_t acked = ack - tcb->snd_una;
+
+        if ((tcb->flags & TCB_FLAG_RTT) && SEQ_LEQ(tcb->rtt_seq, ack)) {
+            tcb->flags &= ~TCB_FLAG_RTT;
+            _rtt_update(tcb, xtimer_now() - tcb->rtt_start);
+        }
+        tcb->snd_una = ack;
+        if (SEQ_LT(tcb->snd_nxt, ack)) {
+            tcb->snd_nxt = ack;
+        }
+        while (tcb->snd_numof > 0) {
+            gnrc_tcp_seg_t *seg = _snd_seg(tcb, 0);
+
+            if (SEQ_LT(ack, seg->seq + seg->pkt->size)) {
+                break;
+            }
+            gnrc_pktbuf_release(seg->pkt);
+            tcb->snd_head = (tcb->snd_head + 1) & (GNRC_TCP_SND_QUEUE_SIZE - 1);
+            tcb->snd_numof--;
+        }
+        tcb->rtx_count = 0;
+        if (tcb->dupacks >= 3) {
+            /* leave fast recovery, deflate the window (RFC 5681,
+             * section 3.2, step 6) */
+            tcb->cwnd = tcb->ssthresh;
+        }
+        else if (tcb->cwnd < tcb->ssthresh) {
+            /* slow start */
+            tcb->cwnd += _min(acked, tcb->mss);
+        }
+        else {
+            /* congestion avoidance */
+            tcb->cwnd += _max(1, (tcb->mss * tcb->mss) / tcb->cwnd);
+        }
+        tcb->dupacks = 0;
+        if (tcb->snd_una == tcb->snd_max) {
+            _rtx_stop(tcb);
+        }
+        else {
+            _rtx_start(tcb);
+        }
+        /* space in the send queue */
+        _notify(tcb);
+    }
+    else if ((ack == tcb->snd_una) && (len == 0) && (wnd == tcb->snd_wnd) &&
+             (tcb->snd_una != tcb->snd_max) && (tcb->dupacks >= 3)) {
+        /* every further duplicate ACK means a segment left the network
+         * (RFC 5681, section 3.2, step 4) */
+        tcb->cwnd += tcb->mss;
+    }
+    else if ((ack == tcb->snd_una) && (len == 0) && (wnd == tcb->snd_wnd) &&
+             (tcb->snd_una != tcb->snd_max) && (++tcb->dupacks == 3)) {
+        /* fast retransmit of the first segment the peer misses, then fast
+         * recovery until new data is acknowledged (RFC 5681, section 3.2,
+         * steps 2 and 3) */
+        tcb->ssthresh = _max((tcb->snd_max - tcb->snd_una) / 2, 2 * tcb->mss);
+        tcb->cwnd = tcb->ssthresh + (3 * tcb->mss);
+        tcb->flags &= ~TCB_FLAG_RTT;
+        for (unsigned i = 0; i < tcb->snd_numof; i++) {
+            gnrc_tcp_seg_t *seg = _snd_seg(tcb, i);
+
+            if (!SEQ_LT(seg->seq, tcb->snd_max)) {
+                break;
+            }
+            if (!seg->sacked) {
+                _xmit(tcb, seg);
+                break;
+            }
+        }
+    }
+    if (SEQ_LT(tcb->snd_wl1, seq) ||
+        ((tcb->snd_wl1 == seq) && SEQ_LEQ(tcb->snd_wl2, ack))) {
+        tcb->snd_wnd = wnd;
+        tcb->snd_wl1 = seq;
+        tcb->snd_wl2 = ack;
+    }
+    return true;
+}
+
+/**
+ * @brief   Checks if a segment is within the receive window (RFC 793,
+ *          section 3.3)
+ */
+static bool _acceptable(gnrc_tcp_tcb_t *tcb, uint32_t seq, uint32_t seg_len)
+{
+    uint32_t wnd = SEQ_LT(tcb->rcv_adv, tcb->rcv_nxt) ? 0
+                                                       : (tcb->rcv_adv - tcb->rcv_nxt);
+
+    if (wnd == 0) {
+        return (seg_len == 0) && (seq == tcb->rcv_nxt);
+    }
+    if (SEQ_LEQ(tcb->rcv_nxt, seq) && SEQ_LT(seq, tcb->rcv_nxt + wnd)) {
+        return true;
+    }
+    return (seg_len > 0) && SEQ_LEQ(tcb->rcv_nxt, seq + seg_len - 1) &&
+           SEQ_LT(seq + seg_len - 1, tcb->rcv_nxt + wnd);
+}
+
+/**
+ * @brief   Drops the connection requests whose peer stopped retransmitting
+ *          its SYN
+ */
+static void _backlog_expire(gnrc_tcp_tcb_t *tcb)
+{
+    uint32_t now = xtimer_now();
+    unsigned i = 0;
+
+    while (i < tcb->backlog_numof) {
+        if ((now - tcb->backlog[i].time) <= GNRC_TCP_BACKLOG_TIMEOUT) {
+            i++;
+            continue;
+        }
+        DEBUG("tcp: connection request timed out\n");
+        tcb->backlog_numof--;
+        memmove(&tcb->backlog[i], &tcb->backlog[i + 1],
+                (tcb->backlog_numof - i) * sizeof(gnrc_tcp_syn_t));
+    }
+}
+
+static void _listen(gnrc_tcp_tcb_t *tcb, const ipv6_hdr_t *ipv6,
+                    const tcp_hdr_t *hdr)
+{
+    gnrc_tcp_syn_t *syn;
+    uint16_t src_port = byteorder_ntohs(hdr->src_port);
+
+    if (hdr->flags & TCP_FLAG_RST) {
+        return;
+    }
+    if (hdr->flags & TCP_FLAG_ACK) {
+        _reset(ipv6, hdr, 0);
+        return;
+    }
+    if (!(hdr->flags & TCP_FLAG_SYN) || ipv6_addr_is_multicast(&ipv6->dst)) {
+        return;
+    }
+    _backlog_expire(tcb);
+    for (unsigned i = 0; i < tcb->backlog_numof; i++) {
+        if ((tcb->backlog[i].peer_port == src_port) &&
+            ipv6_addr_equal(&tcb->backlog[i].peer_addr, &ipv6->src)) {
+            /* retransmitted SYN */
+            tcb->backlog[i].time = xtimer_now();
+            return;
+        }
+    }
+    if (tcb->backlog_numof >= tcb->backlog_max) {
+        DEBUG("tcp: backlog full, ignoring SYN\n");
+        return;
+    }
+    syn = &tcb->backlog[tcb->backlog_numof++];
+    memcpy(&syn->local_addr, &ipv6->dst, sizeof(ipv6_addr_t));
+    memcpy(&syn->peer_addr, &ipv6->src, sizeof(ipv6_addr_t));
+    syn->peer_port = src_port;
+    syn->irs = byteorder_ntohl(hdr->seq_num);
+    syn->time = xtimer_now();
+    _parse_opts(hdr, syn, NULL);
+    _notify(tcb);
+}
+
+static void _syn_sent(gnrc_tcp_tcb_t *tcb, const ipv6_hdr_t *ipv6,
+                      const tcp_hdr_t *hdr)
+{
+    gnrc_tcp_syn_t syn;
+    uint32_t seq = byteorder_ntohl(hdr->seq_num);
+    uint32_t ack = byteorder_ntohl(hdr->ack_num);
+
+    if ((hdr->flags & TCP_FLAG_ACK) &&
+        (SEQ_LEQ(ack, tcb->iss) || SEQ_LT(tcb->snd_max, ack))) {
+        _reset(ipv6, hdr, 0);
+        return;
+    }
+    if (hdr->flags & TCP_FLAG_RST) {
+        if (hdr->flags & TCP_FLAG_ACK) {
+            _abort(tcb, -ECONNREFUSED);
+        }
+        return;
+    }
+    /* simultaneous open is not supported */
+    if ((hdr->flags & (TCP_FLAG_SYN | TCP_FLAG_ACK)) !=
+        (TCP_FLAG_SYN | TCP_FLAG_ACK)) {
+        return;
+    }
+    _parse_opts(hdr, &syn, NULL);
+    _syn_opts(tcb, &syn);
+    if ((tcb->flags & TCB_FLAG_RTT) && SEQ_LEQ(tcb->rtt_seq, ack)) {
+        tcb->flags &= ~TCB_FLAG_RTT;
+        _rtt_update(tcb, xtimer_now() - tcb->rtt_start);
+    }
+    _rtx_stop(tcb);
+    tcb->rtx_count = 0;
+    tcb->irs = seq;
+    tcb->rcv_nxt = seq + 1;
+    /* the window of the SYN was announced before rcv_nxt was known */
+    tcb->rcv_adv = tcb->rcv_nxt;
+    tcb->snd_una = ack;
+    tcb->snd_wnd = byteorder_ntohs(hdr->window);
+    tcb->snd_wl1 = seq;
+    tcb->snd_wl2 = ack;
+    memcpy(&tcb->local_addr, &ipv6->dst, sizeof(ipv6_addr_t));
+    tcb->state = GNRC_TCP_STATE_ESTABLISHED;
+    _send_ack(tcb);
+    _notify(tcb);
+}
+
+/**
+ * @brief   Processes a segment of a TCB (RFC 793, section 3.9)
+ *
+ * @param[in] pkt       the segment, released by this function
+ * @param[in] payload   the payload of @p pkt, NULL if it has none
+ */
+static void _segment(gnrc_tcp_tcb_t *tcb, gnrc_pktsnip_t *pkt,
+                     gnrc_pktsnip_t *payload, const ipv6_hdr_t *ipv6,
+                     const tcp_hdr_t *hdr)
+{
+    uint8_t flags = hdr->flags;
+    uint32_t seq = byteorder_ntohl(hdr->seq_num);
+    uint32_t ack = byteorder_ntohl(hdr->ack_num);
+    size_t len = (payload != NULL) ? payload->size : 0;
+    uint32_t seg_len = len + ((flags & TCP_FLAG_SYN) ? 1 : 0) +
+                       ((flags & TCP_FLAG_FIN) ? 1 : 0);
+
+    switch (tcb->state) {
+        case GNRC_TCP_STATE_LISTEN:
+            _listen(tcb, ipv6, hdr);
+            gnrc_pktbuf_release(pkt);
+            return;
+        case GNRC_TCP_STATE_SYN_SENT:
+            _syn_sent(tcb, ipv6, hdr);
+            gnrc_pktbuf_release(pkt);
+            return;
+        default:
+            break;
+    }
+    if (!_acceptable(tcb, seq, seg_len)) {
+        if (!(flags & TCP_FLAG_RST)) {
+            _send_ack(tcb);
+        }
+        gnrc_pktbuf_release(pkt);
+        return;
+    }
+    if (flags & TCP_FLAG_RST) {
+        _abort(tcb, (tcb->state == GNRC_TCP_STATE_SYN_RCVD) ? -ECONNREFUSED
+                                                           : -ECONNRESET);
+        gnrc_pktbuf_release(pkt);
+        return;
+    }
+    if (flags & TCP_FLAG_SYN) {
+        /* challenge ACK (RFC 5961, section 4.2) */
+        _send_ack(tcb);
+        gnrc_pktbuf_release(pkt);
+        return;
+    }
+    if (!(flags & TCP_FLAG_ACK)) {
+        gnrc_pktbuf_release(pkt);
+        return;
+    }
+    if (tcb->state == GNRC_TCP_STATE_SYN_RCVD) {
+        if (!SEQ_LT(tcb->snd_una, ack) || SEQ_LT(tcb->snd_max, ack)) {
+            _reset(ipv6, hdr, seg_len);
+            gnrc_pktbuf_release(pkt);
+            return;
+        }
+        tcb->state = GNRC_TCP_STATE_ESTABLISHED;
+        tcb->snd_wl1 = seq - 1;
+        _notify(tcb);
+    }
+    if (tcb->flags & TCB_FLAG_SACK) {
+        _parse_opts(hdr, NULL, tcb);
+    }
+    if (!_ack(tcb, seq, ack, byteorder_ntohs(hdr->window), len)) {
+        gnrc_pktbuf_release(pkt);
+        return;
+    }
+    if ((tcb->flags & TCB_FLAG_FIN_PENDING) && (tcb->snd_una == tcb->snd_end + 1)) {
+        /* own FIN is acknowledged */
+        switch (tcb->state) {
+            case GNRC_TCP_STATE_FIN_WAIT_1:
+                tcb->state = GNRC_TCP_STATE_FIN_WAIT_2;
+                _notify(tcb);
+                break;
+            case GNRC_TCP_STATE_CLOSING:
+                tcb->state = GNRC_TCP_STATE_TIME_WAIT;
+                _notify(tcb);
+                break;
+            case GNRC_TCP_STATE_LAST_ACK:
+                _abort(tcb, 0);
+                gnrc_pktbuf_release(pkt);
+                return;
+            default:
+                break;
+        }
+    }
+    if (payload != NULL) {
+        switch (tcb->state) {
+            case GNRC_TCP_STATE_ESTABLISHED:
+            case GNRC_TCP_STATE_FIN_WAIT_1:
+            case GNRC_TCP_STATE_FIN_WAIT_2:
+                /* _data() takes over the packet */
+                _data(tcb, payload, seq);
+                pkt = NULL;
+                break;
+            default:
+                break;
+        }
+    }
+    if (pkt != NULL) {
+        gnrc_pktbuf_release(pkt);
+    }
+    if ((flags & TCP_FLAG_FIN) && !(tcb->flags & TCB_FLAG_FIN_RCVD) &&
+        ((seq + len) == tcb->rcv_nxt)) {
+        tcb->rcv_nxt++;
+        tcb->flags |= TCB_FLAG_FIN_RCVD;
+        switch (tcb->state) {
+            case GNRC_TCP_STATE_ESTABLISHED:
+                tcb->state = GNRC_TCP_STATE_CLOSE_WAIT;
+                break;
+            case GNRC_TCP_STATE_FIN_WAIT_1:
+                tcb->state = GNRC_TCP_STATE_CLOSING;
+                break;
+            case GNRC_TCP_STATE_FIN_WAIT_2:
+                tcb->state = GNRC_TCP_STATE_TIME_WAIT;
+                break;
+            default:
+                break;
+        }
+        _send_ack(tcb);
+        _notify(tcb);
+    }
+    _output(tcb, false);
+}
+
+static void _receive(gnrc_pktsnip_t *pkt)
+{
+    gnrc_pktsnip_t *tcp, *ipv6, *payload = NULL;
+    gnrc_tcp_tcb_t *tcb;
+    _tw_t *tw;
+    tcp_hdr_t *hdr;
+    unsigned hdr_len;
+
+    tcp = gnrc_pktbuf_start_write(pkt);
+    if (tcp == NULL) {
+        DEBUG("tcp: unable to get write access to packet\n");
+        gnrc_pktbuf_release(pkt);
+        return;
+    }
+    pkt = tcp;
+
+    ipv6 = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_IPV6);
+
+    assert(ipv6 != NULL);
+
+    if (pkt->size < sizeof(tcp_hdr_t)) {
+        DEBUG("tcp: segment too short, dropping it\n");
+        gnrc_pktbuf_release(pkt);
+        return;
+    }
+    hdr_len = tcp_hdr_len((tcp_hdr_t *)pkt->data);
+    if ((hdr_len < sizeof(tcp_hdr_t)) || (hdr_len > pkt->size)) {
+        DEBUG("tcp: invalid header length, dropping segment\n");
+        gnrc_pktbuf_release(pkt);
+        return;
+    }
+    tcp = gnrc_pktbuf_mark(pkt, hdr_len, GNRC_NETTYPE_TCP);
+    if (tcp == NULL) {
+        DEBUG("tcp: error marking TCP header, dropping segment\n");
+        gnrc_pktbuf_release(pkt);
+        return;
+    }
+    if (tcp != pkt) {
+        /* mark payload as Type: UNDEF */
+        payload = pkt;
+        payload->type = GNRC_NETTYPE_UNDEF;
+    }
+    if (_calc_csum(tcp, ipv6, payload) != 0xFFFF) {
+        DEBUG("tcp: received segment with invalid checksum, dropping it\n");
+        gnrc_pktbuf_release(pkt);
+        return;
+    }
+    hdr = (tcp_hdr_t *)tcp->data;
+
+    mutex_lock(&_lock);
+    tcb = _find(ipv6->data, hdr);
+    if (((tcb == NULL) || (tcb->state == GNRC_TCP_STATE_LISTEN)) &&
+        ((tw = _tw_find(ipv6->data, hdr)) != NULL) &&
+        _tw_segment(tw, hdr, (payload != NULL) ? payload->size : 0)) {
+        gnrc_pktbuf_release(pkt);
+    }
+    else if (tcb == NULL) {
+        DEBUG("tcp: no connection for segment, resetting\n");
+        _reset(ipv6->data, hdr, ((payload != NULL) ? payload->size : 0) +
+                                ((hdr->flags & TCP_FLAG_SYN) ? 1 : 0) +
+                                ((hdr->flags & TCP_FLAG_FIN) ? 1 : 0));
+        gnrc_pktbuf_release(pkt);
+    }
+    else {
+        _segment(tcb, pkt, payload, ipv6->data, hdr);
+    }
+    mutex_unlock(&_lock);
+}
+
+static void _timeout(msg_t *msg)
+{
+    gnrc_tcp_tcb_t *tcb;
+
+    mutex_lock(&_lock);
+    /* the TCB may have been closed after the timer fired */
+    tcb = _active((gnrc_tcp_tcb_t *)msg->content.ptr);
+    if (tcb != NULL) {
+        if ((msg->type == GNRC_TCP_MSG_TYPE_RTX) && (tcb->flags & TCB_FLAG_RTX)) {
+            _rtx_timeout(tcb);
+        }
+        else if ((msg->type == GNRC_TCP_MSG_TYPE_ACK) &&
+                 (tcb->flags & TCB_FLAG_ACK_DELAYED)) {
+            _send_ack(tcb);
+        }
+    }
+    mutex_unlock(&_lock);
+}
+
+static void *_event_loop(void *arg)
+{
+    (void)arg;
+    msg_t msg, reply;
+    msg_t msg_queue[GNRC_TCP_MSG_QUEUE_SIZE];
+    gnrc_netreg_entry_t netreg;
+
+    /* preset reply message */
+    reply.type = GNRC_NETAPI_MSG_TYPE_ACK;
+    reply.content.value = (uint32_t)-ENOTSUP;
+    /* initialize message queue */
+    msg_init_queue(msg_queue, GNRC_TCP_MSG_QUEUE_SIZE);
+    /* register TCP at netreg */
+    netreg.demux_ctx = GNRC_NETREG_DEMUX_CTX_ALL;
+    netreg.pid = thread_getpid();
+    gnrc_netreg_register(GNRC_NETTYPE_TCP, &netreg);
+
+    /* dispatch NETAPI and timer messages */
+    while (1) {
+        msg_receive(&msg);
+        switch (msg.type) {
+            case GNRC_NETAPI_MSG_TYPE_RCV:
+                DEBUG("tcp: GNRC_NETAPI_MSG_TYPE_RCV\n");
+                _receive((gnrc_pktsnip_t *)msg.content.ptr);
+                break;
+            case GNRC_NETAPI_MSG_TYPE_SND:
+                DEBUG("tcp: segments are sent by gnrc_tcp_send()\n");
+                gnrc_pktbuf_release((gnrc_pktsnip_t *)msg.content.ptr);
+                break;
+            case GNRC_TCP_MSG_TYPE_RTX:
+            case GNRC_TCP_MSG_TYPE_ACK:
+                _timeout(&msg);
+                break;
+            case GNRC_NETAPI_MSG_TYPE_SET:
+            case GNRC_NETAPI_MSG_TYPE_GET:
+                msg_reply(&msg, &reply);
+                break;
+            default:
+                DEBUG("tcp: received unidentified message\n");
+                break;
+        }
+    }
+
+    /* never reached */
+    return NULL;
+}
+
+void gnrc_tcp_tcb_init(gnrc_tcp_tcb_t *tcb, gnrc_netapi_mbox_t *mbox,
+                       const ipv6_addr_t *local_addr, uint16_t local_port)
+{
+    memset(tcb, 0, sizeof(gnrc_tcp_tcb_t));
+    tcb->mbox = mbox;
+    memcpy(&tcb->local_addr, local_addr, sizeof(ipv6_addr_t));
+    tcb->local_port = local_port;
+    tcb->state = GNRC_TCP_STATE_CLOSED;
+    tcb->rtx_msg.type = GNRC_TCP_MSG_TYPE_RTX;
+    tcb->rtx_msg.content.ptr = (char *)tcb;
+    tcb->ack_msg.type = GNRC_TCP_MSG_TYPE_ACK;
+    tcb->ack_msg.content.ptr = (char *)tcb;
+}
+
+int gnrc_tcp_connect(gnrc_tcp_tcb_t *tcb, const ipv6_addr_t *peer_addr,
+                     uint16_t peer_port)
+{
+    int res;
+
+    mutex_lock(&_lock);
+    if (tcb->state != GNRC_TCP_STATE_CLOSED) {
+        mutex_unlock(&_lock);
+        return -EISCONN;
+    }
+    memcpy(&tcb->peer_addr, peer_addr, sizeof(ipv6_addr_t));
+    tcb->peer_port = peer_port;
+    tcb->rcv_nxt = 0;
+    tcb->rcv_adv = 0;
+    _open(tcb, GNRC_TCP_STATE_SYN_SENT);
+    _send_segment(tcb, TCP_FLAG_SYN, tcb->iss, NULL);
+    _rtt_start(tcb, tcb->snd_nxt);
+    _rtx_start(tcb);
+    tcb->mbox->reader = sched_active_pid;
+    while (tcb->state == GNRC_TCP_STATE_SYN_SENT) {
+        _wait(tcb);
+    }
+    res = (tcb->state == GNRC_TCP_STATE_CLOSED) ? tcb->error : 0;
+    mutex_unlock(&_lock);
+    return res;
+}
+
+int gnrc_tcp_listen(gnrc_tcp_tcb_t *tcb, int backlog)
+{
+    int res = 0;
+
+    mutex_lock(&_lock);
+    if ((tcb->state != GNRC_TCP_STATE_CLOSED) &&
+        (tcb->state != GNRC_TCP_STATE_LISTEN)) {
+        res = -EISCONN;
+    }
+    else {
+        if (tcb->state == GNRC_TCP_STATE_CLOSED) {
+            tcb->flags &= TCB_FLAG_ACTIVE;
+            tcb->error = 0;
+            tcb->backlog_numof = 0;
+            tcb->state = GNRC_TCP_STATE_LISTEN;
+            _link(tcb);
+        }
+        tcb->backlog_max = (backlog < 1) ? 1 : _min(backlog, GNRC_TCP_BACKLOG_SIZE);
+    }
+    mutex_unlock(&_lock);
+    return res;
+}
+
+int gnrc_tcp_accept(gnrc_tcp_tcb_t *listener, gnrc_tcp_tcb_t *tcb,
+                    gnrc_netapi_mbox_t *mbox)
+{
+    gnrc_tcp_syn_t syn;
+
+    mutex_lock(&_lock);
+    while (1) {
+        listener->mbox->reader = sched_active_pid;
+        if (listener->state != GNRC_TCP_STATE_LISTEN) {
+            mutex_unlock(&_lock);
+            return -EINVAL;
+        }
+        _backlog_expire(listener);
+        if (listener->backlog_numof == 0) {
+            _wait(listener);
+            continue;
+        }
+        syn = listener->backlog[0];
+        listener->backlog_numof--;
+        memmove(&listener->backlog[0], &listener->backlog[1],
+                listener->backlog_numof * sizeof(gnrc_tcp_syn_t));
+
+        gnrc_tcp_tcb_init(tcb, mbox, &syn.local_addr, listener->local_port);
+        memcpy(&tcb->peer_addr, &syn.peer_addr, sizeof(ipv6_addr_t));
+        tcb->peer_port = syn.peer_port;
+        _open(tcb, GNRC_TCP_STATE_SYN_RCVD);
+        _syn_opts(tcb, &syn);
+        tcb->irs = syn.irs;
+        tcb->rcv_nxt = syn.irs + 1;
+        /* nothing was announced yet, the window must not be kept open up to
+         * the initial rcv_adv */
+        tcb->rcv_adv = tcb->rcv_nxt;
+        _send_segment(tcb, TCP_FLAG_SYN | TCP_FLAG_ACK, tcb->iss, NULL);
+        _rtt_start(tcb, tcb->snd_nxt);
+        _rtx_start(tcb);
+        tcb->mbox->reader = sched_active_pid;
+        while (tcb->state == GNRC_TCP_STATE_SYN_RCVD) {
+            _wait(tcb);
+        }
+        if (tcb->state != GNRC_TCP_STATE_CLOSED) {
+            break;
+        }
+        /* the request failed, take the next one */
+    }
+    mutex_unlock(&_lock);
+    return 0;
+}
+
+int gnrc_tcp_send(gnrc_tcp_tcb_t *tcb, const void *data, size_t len)
+{
+    size_t sent = 0;
+    int res = 0;
+
+    mutex_lock(&_lock);
+    while (sent < len) {
+        tcb->mbox->reader = sched_active_pid;
+        if (tcb->error != 0) {
+            res = tcb->error;
+            break;
+        }
+        if (tcb->flags & TCB_FLAG_FIN_PENDING) {
+            res = -EPIPE;
+            break;
+        }
+        if ((tcb->state != GNRC_TCP_STATE_ESTABLISHED) &&
+            (tcb->state != GNRC_TCP_STATE_CLOSE_WAIT)) {
+            res = -ENOTCONN;
+            break;
+        }
+        if (tcb->snd_numof < GNRC_TCP_SND_QUEUE_SIZE) {
+            size_t chunk = _min(len - sent, tcb->mss);
+            gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(NULL, ((uint8_t *)data) + sent,
+                                                  chunk, GNRC_NETTYPE_UNDEF);
+
+            if (pkt != NULL) {
+                gnrc_tcp_seg_t *seg = _snd_seg(tcb, tcb->snd_numof++);
+
+                seg->pkt = pkt;
+                seg->seq = tcb->snd_end;
+                seg->sacked = 0;
+                tcb->snd_end += chunk;
+                sent += chunk;
+                _output(tcb, false);
+                continue;
+            }
+            if (tcb->snd_numof == 0) {
+                /* nothing will be acknowledged to free space */
+                res = -ENOMEM;
+                break;
+            }
+        }
+        _wait(tcb);
+    }
+    mutex_unlock(&_lock);
+    return (sent > 0) ? (int)sent : res;
+}
+
+int gnrc_tcp_recv(gnrc_tcp_tcb_t *tcb, void *data, size_t max_len)
+{
+    size_t len = 0;
+    int res;
+
+    mutex_lock(&_lock);
+    while (1) {
+        tcb->mbox->reader = sched_active_pid;
+        while (len < max_len) {
+            size_t n;
+
+            if (tcb->rcv_pkt == NULL) {
+                tcb->rcv_pkt = gnrc_netapi_mbox_try_get(tcb->mbox);
+                tcb->rcv_off = 0;
+                if (tcb->rcv_pkt == NULL) {
+                    break;
+                }
+            }
+            n = _min(tcb->rcv_pkt->size - tcb->rcv_off, max_len - len);
+            memcpy(((uint8_t *)data) + len,
+                   ((uint8_t *)tcb->rcv_pkt->data) + tcb->rcv_off, n);
+            tcb->rcv_off += n;
+            len += n;
+            if (tcb->rcv_off == tcb->rcv_pkt->size) {
+                gnrc_pktbuf_release(tcb->rcv_pkt);
+                tcb->rcv_pkt = NULL;
+            }
+        }
+        if (len > 0) {
+            uint32_t wnd;
+
+            tcb->rcv_queued -= len;
+            wnd = _rcv_wnd(tcb);
+            /* window update, avoiding the silly window syndrome (RFC 1122,
+             * section 4.2.3.3) */
+            if ((tcb->flags & TCB_FLAG_ACTIVE) &&
+                (tcb->state != GNRC_TCP_STATE_LISTEN) &&
+                ((wnd - (tcb->rcv_adv - tcb->rcv_nxt)) >=
+                 _min(GNRC_TCP_RCV_WND / 2, tcb->mss))) {
+                _send_ack(tcb);
+            }
+            res = len;
+            break;
+        }
+        if ((tcb->flags & TCB_FLAG_FIN_RCVD) || (max_len == 0)) {
+            res = 0;
+            break;
+        }
+        if (tcb->error != 0) {
+            res = tcb->error;
+            break;
+        }
+        if ((tcb->state == GNRC_TCP_STATE_CLOSED) ||
+            (tcb->state == GNRC_TCP_STATE_LISTEN)) {
+            res = -ENOTCONN;
+            break;
+        }
+        _wait(tcb);
+    }
+    mutex_unlock(&_lock);
+    return res;
+}
+
+void gnrc_tcp_close(gnrc_tcp_tcb_t *tcb)
+{
+    mutex_lock(&_lock);
+    if ((tcb->state == GNRC_TCP_STATE_ESTABLISHED) ||
+        (tcb->state == GNRC_TCP_STATE_CLOSE_WAIT)) {
+        tcb->state = (tcb->state == GNRC_TCP_STATE_ESTABLISHED) ?
+                     GNRC_TCP_STATE_FIN_WAIT_1 : GNRC_TCP_STATE_LAST_ACK;
+        tcb->flags |= TCB_FLAG_FIN_PENDING;
+        _output(tcb, false);
+        tcb->mbox->reader = sched_active_pid;
+        while ((tcb->state == GNRC_TCP_STATE_FIN_WAIT_1) ||
+               (tcb->state == GNRC_TCP_STATE_CLOSING) ||
+               (tcb->state == GNRC_TCP_STATE_LAST_ACK)) {
+            _wait(tcb);
+        }
+        if ((tcb->state == GNRC_TCP_STATE_FIN_WAIT_2) ||
+            (tcb->state == GNRC_TCP_STATE_TIME_WAIT)) {
+            if (tcb->flags & TCB_FLAG_ACK_DELAYED) {
+                _send_ack(tcb);
+            }
+            _tw_add(tcb);
+        }
+    }
+    _rtx_stop(tcb);
+    xtimer_remove(&tcb->ack_timer);
+    _release_queues(tcb);
+    if (tcb->rcv_pkt != NULL) {
+        gnrc_pktbuf_release(tcb->rcv_pkt);
+        tcb->rcv_pkt = NULL;
+    }
+    _unlink(tcb);
+    tcb->flags = 0;
+    tcb->backlog_numof = 0;
+    tcb->state = GNRC_TCP_STATE_CLOSED;
+    /* wake up a thread in gnrc_tcp_accept() */
+    _notify(tcb);
+    mutex_unlock(&_lock);
+}
+
+unsigned gnrc_tcp_events(gnrc_tcp_tcb_t *tcb)
+{
+    unsigned events = 0;
+
+    mutex_lock(&_lock);
+    if ((tcb->rcv_pkt != NULL) || (gnrc_netapi_mbox_avail(tcb->mbox) > 0) ||
+        (tcb->flags & TCB_FLAG_FIN_RCVD) ||
+        ((tcb->state == GNRC_TCP_STATE_LISTEN) && (tcb->backlog_numof > 0))) {
+        events |= GNRC_TCP_EVENT_IN;
+    }
+    if (((tcb->state == GNRC_TCP_STATE_ESTABLISHED) ||
+         (tcb->state == GNRC_TCP_STATE_CLOSE_WAIT)) &&
+        (tcb->snd_numof < GNRC_TCP_SND_QUEUE_SIZE)) {
+        events |= GNRC_TCP_EVENT_OUT;
+    }
+    if (tcb->error != 0) {
+        events |= GNRC_TCP_EVENT_ERR;
+    }
+    mutex_unlock(&_lock);
+    return events;
+}
+
+int gnrc_tcp_calc_csum(gnrc_pktsnip_t *hdr, gnrc_pktsnip_t *pseudo_hdr)
+{
+    uint16_t csum;
+
+    if ((hdr == NULL) || (pseudo_hdr == NULL)) {
+        return -EFAULT;
+    }
+    if (hdr->type != GNRC_NETTYPE_TCP) {
+        return -EBADMSG;
+    }
+
+    ((tcp_hdr_t *)hdr->data)->checksum = byteorder_htons(0);
+    csum = _calc_csum(hdr, pseudo_hdr, hdr->next);
+    if (csum == 0) {
+        return -ENOENT;
+    }
+    ((tcp_hdr_t *)hdr->data)->checksum = byteorder_htons(~csum);
+    return 0;
+}
+
+int gnrc_tcp_init(void)
+{
+    /* check if thread is already running */
+    if (_pid == KERNEL_PID_UNDEF) {
+        /* start TCP thread */
+        _pid = thread_create(_stack, sizeof(_stack), GNRC_TCP_PRIO,
+                             THREAD_CREATE_STACKTEST, _event_loop, NULL, "tcp");
+    }
+    return _pid;
+}
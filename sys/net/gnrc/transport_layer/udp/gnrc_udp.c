@@ -165,6 +165,7 @@ static void _send(gnrc_pktsnip_t *pkt)
 {
     udp_hdr_t *hdr;
     gnrc_pktsnip_t *udp_snip, *tmp;
+    gnrc_nettype_t nettype;
 
     /* write protect first header */
     tmp = gnrc_pktbuf_start_write(pkt);
@@ -202,18 +203,34 @@ static void _send(gnrc_pktsnip_t *pkt)
     /* fill in size field */
     hdr->length = byteorder_htons(gnrc_pkt_len(udp_snip));
 
-    /* and forward packet to the network layer */
-    if (!gnrc_netapi_dispatch_send(pkt->type, GNRC_NETREG_DEMUX_CTX_ALL, pkt)) {
+    /* and forward packet to the network layer (the one behind the interface
+     * header, if the sender added one) */
+    nettype = (pkt->type == GNRC_NETTYPE_NETIF) ? pkt->next->type : pkt->type;
+    if (!gnrc_netapi_dispatch_send(nettype, GNRC_NETREG_DEMUX_CTX_ALL, pkt)) {
         DEBUG("udp: cannot send packet: network layer not found\n");
         gnrc_pktbuf_release(pkt);
     }
 }
 
+static void _receive_batched(gnrc_pktsnip_t *pkt, void *arg)
+{
+    (void)arg;
+    _receive(pkt);
+}
+
+static void _send_batched(gnrc_pktsnip_t *pkt, void *arg)
+{
+    (void)arg;
+    _send(pkt);
+}
+
 static void *_event_loop(void *arg)
 {
     (void)arg;
     msg_t msg, reply;
     msg_t msg_queue[GNRC_UDP_MSG_QUEUE_SIZE];
+    gnrc_netapi_batch_t batch;
+    int dropped;
     gnrc_netreg_entry_t netreg;
 
     /* preset reply message */
@@ -229,6 +246,7 @@ static void *_event_loop(void *arg)
     /* dispatch NETAPI messages */
     while (1) {
         msg_receive(&msg);
+        gnrc_netapi_batch_begin(&batch);
         switch (msg.type) {
             case GNRC_NETAPI_MSG_TYPE_RCV:
                 DEBUG("udp: GNRC_NETAPI_MSG_TYPE_RCV\n");
@@ -238,6 +256,14 @@ static void *_event_loop(void *arg)
                 DEBUG("udp: GNRC_NETAPI_MSG_TYPE_SND\n");
                 _send((gnrc_pktsnip_t *)msg.content.ptr);
                 break;
+            case GNRC_NETAPI_MSG_TYPE_RCV_BATCH:
+                DEBUG("udp: GNRC_NETAPI_MSG_TYPE_RCV_BATCH\n");
+                gnrc_netapi_batch_handle(&msg, _receive_batched, NULL);
+                break;
+            case GNRC_NETAPI_MSG_TYPE_SND_BATCH:
+                DEBUG("udp: GNRC_NETAPI_MSG_TYPE_SND_BATCH\n");
+                gnrc_netapi_batch_handle(&msg, _send_batched, NULL);
+                break;
             case GNRC_NETAPI_MSG_TYPE_SET:
             case GNRC_NETAPI_MSG_TYPE_GET:
                 msg_reply(&msg, &reply);
@@ -246,6 +272,9 @@ static void *_event_loop(void *arg)
                 DEBUG("udp: received unidentified message\n");
                 break;
         }
+        if ((dropped = gnrc_netapi_batch_end()) > 0) {
+            DEBUG("udp: %d packets passed on were dropped\n", dropped);
+        }
     }
 
     /* never reached */
@@ -19,6 +19,7 @@
  * @}
  */
 
+#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -64,6 +65,383 @@ static void fib_lifetime_to_absolute(uint32_t ms, uint64_t *target)
     *target = xtimer_now64() + (ms * 1000);
 }
 
+static int fib_remove(fib_table_t *table, fib_entry_t *entry);
+
+/**
+ * @brief returns the bit at position @p bit of @p addr, counted from the MSB
+ */
+static inline unsigned fib_trie_bit(const uint8_t *addr, unsigned bit)
+{
+    return (addr[bit >> 3] >> (7 - (bit & 0x07))) & 0x01;
+}
+
+/**
+ * @brief returns the number of leading bits @p a and @p b have in common,
+ *        at most @p max
+ */
+static unsigned fib_trie_match_bits(const uint8_t *a, const uint8_t *b, unsigned max)
+{
+    unsigned bits = 0;
+
+    for (unsigned i = 0; bits < max; i++, bits += 8) {
+        uint8_t diff = a[i] ^ b[i];
+
+        if (diff != 0) {
+            while (!(diff & 0x80)) {
+                diff <<= 1;
+                bits++;
+            }
+            break;
+        }
+    }
+
+    return (bits < max) ? bits : max;
+}
+
+/**
+ * @brief returns the length of the trie key of an entry in bits
+ *
+ * The key is the entry's address, cut to its prefix length if one is set in
+ * the global flags. All zero addresses are default routes and have an empty key.
+ */
+static uint8_t fib_trie_key_bits(fib_entry_t *entry)
+{
+    universal_address_container_t *global = entry->global;
+    size_t bits = global->address_size << 3;
+    size_t i = 0;
+
+    while ((i < global->address_size) && (global->address[i] == 0)) {
+        i++;
+    }
+
+    if (i == global->address_size) {
+        return 0;
+    }
+
+    if (entry->global_flags & FIB_FLAG_NET_PREFIX_MASK) {
+        size_t prefix_bits = (entry->global_flags & FIB_FLAG_NET_PREFIX_MASK)
+                             >> FIB_FLAG_NET_PREFIX_SHIFT;
+
+        if (prefix_bits < bits) {
+            bits = prefix_bits;
+        }
+    }
+
+    return bits;
+}
+
+/**
+ * @brief returns the key of a trie node, for branching nodes that of any
+ *        entry below it
+ */
+static uint8_t *fib_trie_key(fib_trie_node_t *node)
+{
+    while (node->glue) {
+        node = node->child[0];
+    }
+
+    return container_of(node, fib_entry_t, trie)->global->address;
+}
+
+/**
+ * @brief resets the prefix trie and the lifetime heap of the table
+ */
+static void fib_trie_init(fib_table_t *table)
+{
+    table->trie_root = NULL;
+    table->trie_free = NULL;
+    table->heap_len = 0;
+
+    for (size_t i = 0; i < table->size; ++i) {
+        table->data.entries[i].trie_glue.child[0] = table->trie_free;
+        table->trie_free = &table->data.entries[i].trie_glue;
+    }
+}
+
+/**
+ * @brief takes a branching node from the free list of the trie
+ *
+ * Every entry provides one branching node, and a trie with n entries needs
+ * at most n - 1 of them, so the free list never runs empty.
+ */
+static fib_trie_node_t *fib_trie_glue_get(fib_table_t *table, unsigned bits,
+                                          fib_trie_node_t *child0,
+                                          fib_trie_node_t *child1)
+{
+    fib_trie_node_t *glue = table->trie_free;
+
+    assert(glue != NULL);
+    table->trie_free = glue->child[0];
+    glue->child[0] = child0;
+    glue->child[1] = child1;
+    glue->bits = bits;
+    glue->glue = 1;
+
+    return glue;
+}
+
+static void fib_trie_glue_put(fib_table_t *table, fib_trie_node_t *glue)
+{
+    glue->child[0] = table->trie_free;
+    table->trie_free = glue;
+}
+
+/**
+ * @brief inserts an entry into the prefix trie of the table
+ */
+static void fib_trie_insert(fib_table_t *table, fib_entry_t *entry)
+{
+    fib_trie_node_t *new = &entry->trie;
+    fib_trie_node_t **link = &table->trie_root;
+    uint8_t *key = entry->global->address;
+
+    new->child[0] = NULL;
+    new->child[1] = NULL;
+    new->bits = fib_trie_key_bits(entry);
+    new->glue = 0;
+    entry->trie_dup = NULL;
+
+    while (*link != NULL) {
+        fib_trie_node_t *node = *link;
+        unsigned max = (new->bits < node->bits) ? new->bits : node->bits;
+        unsigned match = fib_trie_match_bits(key, fib_trie_key(node), max);
+
+        if (match < max) {
+            /* the keys differ before either ends: branch where they differ */
+            if (fib_trie_bit(key, match)) {
+                *link = fib_trie_glue_get(table, match, node, new);
+            }
+            else {
+                *link = fib_trie_glue_get(table, match, new, node);
+            }
+            return;
+        }
+        if (new->bits < node->bits) {
+            /* the new key is a prefix of the node's key */
+            new->child[fib_trie_bit(fib_trie_key(node), new->bits)] = node;
+            *link = new;
+            return;
+        }
+        if (new->bits == node->bits) {
+            if (node->glue) {
+                /* the entry takes the place of the branching node */
+                new->child[0] = node->child[0];
+                new->child[1] = node->child[1];
+                *link = new;
+                fib_trie_glue_put(table, node);
+            }
+            else {
+                /* same key, e.g. prefixes of equal length of distinct
+                 * addresses: chain it to the entry in the trie */
+                fib_entry_t *first = container_of(node, fib_entry_t, trie);
+
+                entry->trie_dup = first->trie_dup;
+                first->trie_dup = entry;
+            }
+            return;
+        }
+        link = &node->child[fib_trie_bit(key, node->bits)];
+    }
+
+    *link = new;
+}
+
+/**
+ * @brief removes an entry from the prefix trie of the table
+ */
+static void fib_trie_remove(fib_table_t *table, fib_entry_t *entry)
+{
+    fib_trie_node_t *node = &entry->trie;
+    fib_trie_node_t **link = &table->trie_root;
+    fib_trie_node_t **parent_link = NULL;
+    uint8_t *key = entry->global->address;
+
+    while ((*link != NULL) && ((*link)->bits < node->bits)) {
+        parent_link = link;
+        link = &(*link)->child[fib_trie_bit(key, (*link)->bits)];
+    }
+
+    if ((*link == NULL) || (*link)->glue || ((*link)->bits != node->bits)) {
+        DEBUG("[fib_trie_remove] entry not in trie\n");
+        return;
+    }
+
+    if (*link != node) {
+        /* the entry is chained to the entry in the trie */
+        fib_entry_t **dup = &container_of(*link, fib_entry_t, trie)->trie_dup;
+
+        while ((*dup != NULL) && (*dup != entry)) {
+            dup = &(*dup)->trie_dup;
+        }
+        if (*dup != NULL) {
+            *dup = entry->trie_dup;
+        }
+        return;
+    }
+
+    if (entry->trie_dup != NULL) {
+        /* the next entry with the same key takes its place */
+        fib_trie_node_t *next = &entry->trie_dup->trie;
+
+        *next = *node;
+        *link = next;
+    }
+    else if ((node->child[0] != NULL) && (node->child[1] != NULL)) {
+        *link = fib_trie_glue_get(table, node->bits, node->child[0], node->child[1]);
+    }
+    else if ((node->child[0] != NULL) || (node->child[1] != NULL)) {
+        *link = (node->child[0] != NULL) ? node->child[0] : node->child[1];
+    }
+    else {
+        *link = NULL;
+        /* a branching node with only one child left is not needed anymore */
+        if ((parent_link != NULL) && (*parent_link)->glue) {
+            fib_trie_node_t *glue = *parent_link;
+
+            *parent_link = (glue->child[0] != NULL) ? glue->child[0] : glue->child[1];
+            fib_trie_glue_put(table, glue);
+        }
+    }
+}
+
+/**
+ * @brief looks up the best entry for @p dst in the prefix trie of the table
+ *
+ * Walks down the trie along @p dst. The entries passed have increasing key
+ * lengths, so the last one matching @p dst is the longest prefix match.
+ * Below an entry not matching @p dst, no entry can match.
+ *
+ * @return 0 if we found a next-hop prefix
+ *         1 if we found the exact address next-hop
+ *         -EHOSTUNREACH if no fitting next-hop is available
+ */
+static int fib_trie_lookup(fib_table_t *table, uint8_t *dst, size_t dst_size,
+                           fib_entry_t **entry)
+{
+    fib_trie_node_t *node = table->trie_root;
+    unsigned dst_bits = dst_size << 3;
+    int ret = -EHOSTUNREACH;
+
+    while ((node != NULL) && (node->bits <= dst_bits)) {
+        if (!node->glue) {
+            fib_entry_t *e = container_of(node, fib_entry_t, trie);
+
+            if (fib_trie_match_bits(e->global->address, dst, node->bits) < node->bits) {
+                break;
+            }
+            for (; e != NULL; e = e->trie_dup) {
+                if (e->global->address_size != dst_size) {
+                    continue;
+                }
+                if (memcmp(e->global->address, dst, dst_size) == 0) {
+                    *entry = e;
+                    return 1;
+                }
+                *entry = e;
+                ret = 0;
+            }
+        }
+        if (node->bits == dst_bits) {
+            break;
+        }
+        node = node->child[fib_trie_bit(dst, node->bits)];
+    }
+
+    return ret;
+}
+
+/**
+ * @brief returns the entry at position @p pos of the lifetime heap
+ *
+ * The heap is stored across the entries: the entry at position i is the one
+ * with the index stored in fib_entry_t::heap_slot of the i-th entry.
+ */
+static inline fib_entry_t *fib_heap_get(fib_table_t *table, size_t pos)
+{
+    return &table->data.entries[table->data.entries[pos].heap_slot];
+}
+
+static inline void fib_heap_set(fib_table_t *table, size_t pos, fib_entry_t *entry)
+{
+    table->data.entries[pos].heap_slot = (uint16_t)(entry - table->data.entries);
+    entry->heap_pos = (uint16_t)pos;
+}
+
+/**
+ * @brief moves the entry at position @p pos of the lifetime heap up or down
+ *        to its place
+ */
+static void fib_heap_sift(fib_table_t *table, size_t pos)
+{
+    fib_entry_t *entry = fib_heap_get(table, pos);
+
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        fib_entry_t *parent_entry = fib_heap_get(table, parent);
+
+        if (parent_entry->lifetime <= entry->lifetime) {
+            break;
+        }
+        fib_heap_set(table, pos, parent_entry);
+        pos = parent;
+    }
+
+    while ((2 * pos + 1) < table->heap_len) {
+        size_t child = 2 * pos + 1;
+        fib_entry_t *child_entry = fib_heap_get(table, child);
+
+        if (((child + 1) < table->heap_len) &&
+            (fib_heap_get(table, child + 1)->lifetime < child_entry->lifetime)) {
+            child_entry = fib_heap_get(table, ++child);
+        }
+        if (entry->lifetime <= child_entry->lifetime) {
+            break;
+        }
+        fib_heap_set(table, pos, child_entry);
+        pos = child;
+    }
+
+    fib_heap_set(table, pos, entry);
+}
+
+/**
+ * @brief adds, moves or removes an entry in the lifetime heap after its
+ *        lifetime was changed
+ */
+static void fib_heap_update(fib_table_t *table, fib_entry_t *entry)
+{
+    bool expires = (entry->lifetime != 0) && (entry->lifetime != FIB_LIFETIME_NO_EXPIRE);
+    size_t pos = entry->heap_pos;
+
+    if ((pos < table->heap_len) && (fib_heap_get(table, pos) == entry)) {
+        if (expires) {
+            fib_heap_sift(table, pos);
+        }
+        else if (pos < --table->heap_len) {
+            fib_heap_set(table, pos, fib_heap_get(table, table->heap_len));
+            fib_heap_sift(table, pos);
+        }
+    }
+    else if (expires) {
+        fib_heap_set(table, table->heap_len, entry);
+        fib_heap_sift(table, table->heap_len++);
+    }
+}
+
+/**
+ * @brief removes all entries with an expired lifetime
+ *
+ * @param[in] table     the FIB table to clean up
+ */
+static void fib_expire(fib_table_t *table)
+{
+    uint64_t now = xtimer_now64();
+
+    while ((table->heap_len > 0) && (fib_heap_get(table, 0)->lifetime < now)) {
+        fib_remove(table, fib_heap_get(table, 0));
+    }
+}
+
 /**
  * @brief returns pointer to the entry for the given destination address
  *
@@ -80,14 +458,6 @@ static void fib_lifetime_to_absolute(uint32_t ms, uint64_t *target)
  */
 static int fib_find_entry(fib_table_t *table, uint8_t *dst, size_t dst_size,
                           fib_entry_t **entry_arr, size_t *entry_arr_size) {
-    uint64_t now = xtimer_now64();
-
-    size_t count = 0;
-    size_t prefix_size = 0;
-    size_t match_size = dst_size << 3;
-    int ret = -EHOSTUNREACH;
-    bool is_all_zeros_addr = true;
-
 #if ENABLE_DEBUG
     DEBUG("[fib_find_entry] dst =");
     for (size_t i = 0; i < dst_size; i++) {
@@ -96,86 +466,14 @@ static int fib_find_entry(fib_table_t *table, uint8_t *dst, size_t dst_size,
     DEBUG("\n");
 #endif
 
-    for (size_t i = 0; i < dst_size; ++i) {
-        if (dst[i] != 0) {
-            is_all_zeros_addr = false;
-            break;
-        }
-    }
+    fib_expire(table);
 
-    for (size_t i = 0; i < table->size; ++i) {
-
-        /* autoinvalidate if the entry lifetime is not set to not expire */
-        if (table->data.entries[i].lifetime != FIB_LIFETIME_NO_EXPIRE) {
+    int ret = fib_trie_lookup(table, dst, dst_size, entry_arr);
 
-            /* check if the lifetime expired */
-            if (table->data.entries[i].lifetime < now) {
-                /* remove this entry if its lifetime expired */
-                table->data.entries[i].lifetime = 0;
-                table->data.entries[i].global_flags = 0;
-                table->data.entries[i].next_hop_flags = 0;
-                table->data.entries[i].iface_id = KERNEL_PID_UNDEF;
-
-                if (table->data.entries[i].global != NULL) {
-                    universal_address_rem(table->data.entries[i].global);
-                    table->data.entries[i].global = NULL;
-                }
-
-                if (table->data.entries[i].next_hop != NULL) {
-                    universal_address_rem(table->data.entries[i].next_hop);
-                    table->data.entries[i].next_hop = NULL;
-                }
-            }
-        }
-
-        if ((prefix_size < (dst_size<<3)) && (table->data.entries[i].global != NULL)) {
-
-            int ret_comp = universal_address_compare(table->data.entries[i].global, dst, &match_size);
-            /* If we found an exact match */
-            if ((ret_comp == UNIVERSAL_ADDRESS_EQUAL)
-                || (is_all_zeros_addr && (ret_comp == UNIVERSAL_ADDRESS_IS_ALL_ZERO_ADDRESS))) {
-                entry_arr[0] = &(table->data.entries[i]);
-                *entry_arr_size = 1;
-                /* we will not find a better one so we return */
-                return 1;
-            }
-            else {
-                /* we try to find the most fitting prefix */
-                if (ret_comp == UNIVERSAL_ADDRESS_MATCHING_PREFIX) {
-                    if (table->data.entries[i].global_flags & FIB_FLAG_NET_PREFIX_MASK) {
-                        /* we shift the most upper flag byte back to get the number of prefix bits */
-                        size_t global_prefix_len = (table->data.entries[i].global_flags
-                                                    & FIB_FLAG_NET_PREFIX_MASK) >> FIB_FLAG_NET_PREFIX_SHIFT;
-
-                        if ((match_size >= global_prefix_len) &&
-                            ((prefix_size == 0) || (match_size > prefix_size))) {
-                            entry_arr[0] = &(table->data.entries[i]);
-                            /* we could find a better one so we move on */
-                            ret = 0;
-
-                            prefix_size = match_size;
-                            count = 1;
-                        }
-                    }
-                 }
-                 else if (ret_comp == UNIVERSAL_ADDRESS_IS_ALL_ZERO_ADDRESS) {
-                    /* we found the default gateway entry, e.g. ::/0 for IPv6
-                     * and we keep it only if there is no better one
-                     */
-                    if (prefix_size == 0) {
-                        entry_arr[0] = &(table->data.entries[i]);
-                        /* we could find a better one so we move on */
-                        ret = 0;
-                        count = 1;
-                    }
-                }
-                match_size = dst_size<<3;
-            }
-        }
-    }
+    *entry_arr_size = (ret >= 0) ? 1 : 0;
 
 #if ENABLE_DEBUG
-    if (count > 0) {
+    if (ret >= 0) {
         DEBUG("[fib_find_entry] found prefix on interface %d:", entry_arr[0]->iface_id);
         for (size_t i = 0; i < entry_arr[0]->global->address_size; i++) {
             DEBUG(" %02x", entry_arr[0]->global->address[i]);
@@ -184,13 +482,13 @@ static int fib_find_entry(fib_table_t *table, uint8_t *dst, size_t dst_size,
     }
 #endif
 
-    *entry_arr_size = count;
     return ret;
 }
 
 /**
  * @brief updates the next hop the lifetime and the interface id for a given entry
  *
+ * @param[in] table          the FIB table containing the entry
  * @param[in] entry          the entry to be updated
  * @param[in] next_hop       the next hop address to be updated
  * @param[in] next_hop_size  the next hop address size
@@ -200,7 +498,7 @@ static int fib_find_entry(fib_table_t *table, uint8_t *dst, size_t dst_size,
  * @return 0 if the entry has been updated
  *         -ENOMEM if the entry cannot be updated due to insufficient RAM
  */
-static int fib_upd_entry(fib_entry_t *entry, uint8_t *next_hop,
+static int fib_upd_entry(fib_table_t *table, fib_entry_t *entry, uint8_t *next_hop,
                          size_t next_hop_size, uint32_t next_hop_flags,
                          uint32_t lifetime)
 {
@@ -220,6 +518,8 @@ static int fib_upd_entry(fib_entry_t *entry, uint8_t *next_hop,
     else {
         entry->lifetime = FIB_LIFETIME_NO_EXPIRE;
     }
+    fib_heap_update(table, entry);
+    table->gen++;
 
     return 0;
 }
@@ -266,6 +566,9 @@ static int fib_create_entry(fib_table_t *table, kernel_pid_t iface_id,
                 else {
                     table->data.entries[i].lifetime = FIB_LIFETIME_NO_EXPIRE;
                 }
+                fib_trie_insert(table, &table->data.entries[i]);
+                fib_heap_update(table, &table->data.entries[i]);
+                table->gen++;
 
                 return 0;
             }
@@ -278,13 +581,15 @@ static int fib_create_entry(fib_table_t *table, kernel_pid_t iface_id,
 /**
  * @brief removes the given entry
  *
+ * @param[in] table the FIB table containing the entry
  * @param[in] entry the entry to be removed
  *
  * @return 0 on success
  */
-static int fib_remove(fib_entry_t *entry)
+static int fib_remove(fib_table_t *table, fib_entry_t *entry)
 {
     if (entry->global != NULL) {
+        fib_trie_remove(table, entry);
         universal_address_rem(entry->global);
     }
 
@@ -299,6 +604,8 @@ static int fib_remove(fib_entry_t *entry)
 
     entry->iface_id = KERNEL_PID_UNDEF;
     entry->lifetime = 0;
+    fib_heap_update(table, entry);
+    table->gen++;
 
     return 0;
 }
@@ -402,7 +709,7 @@ int fib_add_entry(fib_table_t *table,
 
     if (ret == 1) {
         /* we must take the according entry and update the values */
-        ret = fib_upd_entry(entry[0], next_hop, next_hop_size, next_hop_flags, lifetime);
+        ret = fib_upd_entry(table, entry[0], next_hop, next_hop_size, next_hop_flags, lifetime);
     }
     else {
         ret = fib_create_entry(table, iface_id, dst, dst_size, dst_flags,
@@ -432,7 +739,7 @@ int fib_update_entry(fib_table_t *table, uint8_t *dst, size_t dst_size,
     if (fib_find_entry(table, dst, dst_size, &(entry[0]), &count) == 1) {
         DEBUG("[fib_update_entry] found entry: %p\n", (void *)(entry[0]));
         /* we must take the according entry and update the values */
-        ret = fib_upd_entry(entry[0], next_hop, next_hop_size, next_hop_flags, lifetime);
+        ret = fib_upd_entry(table, entry[0], next_hop, next_hop_size, next_hop_flags, lifetime);
     }
     else {
         /* we have ambiguous entries, i.e. count > 1
@@ -456,7 +763,7 @@ void fib_remove_entry(fib_table_t *table, uint8_t *dst, size_t dst_size)
 
     if (ret == 1) {
         /* we must take the according entry and update the values */
-        fib_remove(entry[0]);
+        fib_remove(table, entry[0]);
     }
     else {
         /* we have ambiguous entries, i.e. count > 1
@@ -476,7 +783,7 @@ void fib_flush(fib_table_t *table, kernel_pid_t interface)
     for (size_t i = 0; i < table->size; ++i) {
         if ((interface == KERNEL_PID_UNDEF) ||
             (interface == table->data.entries[i].iface_id)) {
-            fib_remove(&table->data.entries[i]);
+            fib_remove(table, &table->data.entries[i]);
         }
     }
 
@@ -595,6 +902,8 @@ void fib_init(fib_table_t *table)
     }
     else {
         memset(table->data.entries, 0, (table->size * sizeof(fib_entry_t)));
+        fib_trie_init(table);
+        table->gen++;
     }
     universal_address_init();
     mutex_unlock(&(table->mtx_access));
@@ -620,6 +929,8 @@ void fib_deinit(fib_table_t *table)
     }
     else {
         memset(table->data.entries, 0, (table->size * sizeof(fib_entry_t)));
+        fib_trie_init(table);
+        table->gen++;
     }
     universal_address_reset();
     mutex_unlock(&(table->mtx_access));
@@ -664,6 +975,16 @@ int fib_get_num_used_entries(fib_table_t *table)
     return used_entries;
 }
 
+uint32_t fib_get_gen(fib_table_t *table)
+{
+    mutex_lock(&(table->mtx_access));
+    /* entries expire lazily, so let expired ones change the generation now */
+    fib_expire(table);
+    uint32_t gen = table->gen;
+    mutex_unlock(&(table->mtx_access));
+    return gen;
+}
+
 /* source route handling */
 int fib_sr_create(fib_table_t *table, fib_sr_t **fib_sr, kernel_pid_t sr_iface_id,
                   uint32_t sr_flags, uint32_t sr_lifetime)
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  posix_sockets
+ * @{
+ */
+
+/**
+ * @file
+ * @brief   Input/output multiplexing
+ * @see     <a href="http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/poll.h.html">
+ *              The Open Group Base Specifications Issue 7, <poll.h>
+ *          </a>
+ *
+ * Only sockets can be polled. Readiness for reading is signalled by the
+ * packet mailboxes of the sockets (see @ref gnrc_netapi_mbox_set_t), so a
+ * single thread can serve many sockets without any of them being polled
+ * actively.
+ */
+#ifndef POLL_H
+#define POLL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name    Event flags for struct pollfd::events and struct pollfd::revents
+ * @{
+ */
+#define POLLIN      (0x0001)    /**< Data other than high-priority data may be read */
+#define POLLRDNORM  (0x0002)    /**< Normal data may be read */
+#define POLLRDBAND  (0x0004)    /**< Priority data may be read */
+#define POLLPRI     (0x0008)    /**< High-priority data may be read */
+#define POLLOUT     (0x0010)    /**< Normal data may be written */
+#define POLLWRNORM  (POLLOUT)   /**< Equivalent to POLLOUT */
+#define POLLWRBAND  (0x0020)    /**< Priority data may be written */
+#define POLLERR     (0x0040)    /**< An error has occurred (revents only) */
+#define POLLHUP     (0x0080)    /**< Device has been disconnected (revents only) */
+#define POLLNVAL    (0x0100)    /**< Invalid fd member (revents only) */
+/** @} */
+
+/**
+ * @brief   Type for the number of file descriptors given to poll()
+ */
+typedef unsigned int nfds_t;
+
+/**
+ * @brief   File descriptor polled by poll()
+ */
+struct pollfd {
+    int fd;                     /**< The file descriptor, ignored if negative */
+    short events;               /**< The requested events */
+    short revents;              /**< The events that occurred */
+};
+
+/**
+ * @brief   Waits for events on file descriptors
+ *
+ * @see <a href="http://pubs.opengroup.org/onlinepubs/9699919799/functions/poll.html">
+ *          The Open Group Base Specification Issue 7, poll
+ *      </a>
+ *
+ * @param[in,out] fds   The file descriptors and events.
+ * @param[in] nfds      Number of elements in @p fds.
+ * @param[in] timeout   Maximum time to wait in milliseconds, 0 to not block,
+ *                      -1 to wait without timeout.
+ *
+ * @return  Number of elements of @p fds with a non-zero
+ *          struct pollfd::revents, 0 on timeout.
+ * @return  -1 on error. @p errno is set to indicate the error.
+ */
+int poll(struct pollfd fds[], nfds_t nfds, int timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POLL_H */
+/** @} */
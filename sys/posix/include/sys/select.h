@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  posix_sockets
+ * @{
+ */
+
+/**
+ * @file
+ * @brief   Select types
+ * @see     <a href="http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/sys_select.h.html">
+ *              The Open Group Base Specifications Issue 7, <sys/select.h>
+ *          </a>
+ *
+ * Only sockets can be selected, see poll().
+ */
+#ifndef SYS_SELECT_H
+#define SYS_SELECT_H
+
+/* the C library's headers may depend on its own fd_set (e.g. on native), so
+ * use it if there is one */
+#if defined(__has_include_next)
+#if __has_include_next(<sys/select.h>)
+#include_next <sys/select.h>
+#endif
+#endif
+
+#include <string.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef FD_SETSIZE
+/**
+ * @brief   Maximum number of file descriptors in an fd_set
+ */
+#define FD_SETSIZE      (16)
+
+/**
+ * @brief   Set of file descriptors
+ */
+typedef struct {
+    unsigned long fds_bits[(FD_SETSIZE + (8 * sizeof(unsigned long)) - 1) /
+                           (8 * sizeof(unsigned long))];    /**< bit per fd */
+} fd_set;
+
+/**
+ * @name    Manipulation of fd_set
+ * @{
+ */
+#define _FD_BITS        (8 * sizeof(unsigned long))
+#define FD_CLR(fd, set) ((set)->fds_bits[(fd) / _FD_BITS] &= ~(1UL << ((fd) % _FD_BITS)))
+#define FD_ISSET(fd, set) \
+    (((set)->fds_bits[(fd) / _FD_BITS] & (1UL << ((fd) % _FD_BITS))) != 0)
+#define FD_SET(fd, set) ((set)->fds_bits[(fd) / _FD_BITS] |= (1UL << ((fd) % _FD_BITS)))
+#define FD_ZERO(set)    memset((set), 0, sizeof(fd_set))
+/** @} */
+#endif
+
+/**
+ * @brief   Synchronous I/O multiplexing
+ *
+ * @see <a href="http://pubs.opengroup.org/onlinepubs/9699919799/functions/select.html">
+ *          The Open Group Base Specification Issue 7, select
+ *      </a>
+ *
+ * @param[in] nfds          The file descriptors 0 to @p nfds - 1 are checked.
+ * @param[in,out] readfds   File descriptors to check for readiness to read,
+ *                          may be NULL.
+ * @param[in,out] writefds  File descriptors to check for readiness to write,
+ *                          may be NULL.
+ * @param[in,out] errorfds  File descriptors to check for pending errors, may
+ *                          be NULL.
+ * @param[in] timeout       Maximum time to wait, NULL to wait without
+ *                          timeout.
+ *
+ * @return  Total number of bits set in the three sets, 0 on timeout.
+ * @return  -1 on error. @p errno is set to indicate the error.
+ */
+int select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *errorfds,
+           struct timeval *timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SYS_SELECT_H */
+/** @} */
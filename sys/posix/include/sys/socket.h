@@ -19,7 +19,8 @@
  *          </a>
  *
  * @todo Omitted from original specification for now:
- * * struct msghdr, struct cmesghdr, and struct linger and all related defines
+ * * struct cmesghdr and struct linger and all related defines
+ * * recvmsg() and sendmsg()
  * * getsockopt()/setsockopt() and all related defines.
  * * shutdown() and all related defines.
  * * sockatmark()
@@ -59,6 +60,14 @@ extern "C" {
  */
 #define SOCKADDR_MAX_DATA_LEN   (26)
 
+/**
+ * @brief   Maximum number of messages handled by one recvmmsg() or sendmmsg()
+ *          call
+ */
+#ifndef SOCKET_MMSG_MAX
+#define SOCKET_MMSG_MAX         (8)
+#endif
+
 /**
  * @name    Socket types
  * @{
@@ -69,6 +78,14 @@ extern "C" {
 #define SOCK_STREAM     (4)     /**< Stream socket */
 /** @} */
 
+/**
+ * @name    Message flags
+ * @{
+ */
+#define MSG_TRUNC       (0x0020)    /**< Truncate datagrams that exceed the buffer and
+                                     *   return their real length */
+/** @} */
+
 #define SOL_SOCKET      (-1)    /**< Options to be accessed at socket level, not protocol level */
 
 /**
@@ -113,6 +130,31 @@ struct sockaddr_storage {
     uint8_t ss_data[SOCKADDR_MAX_DATA_LEN]; /**< Socket address */
 };
 
+/**
+ * @brief   Message header
+ *
+ * @note    Ancillary data (msghdr::msg_control) is not supported.
+ */
+struct msghdr {
+    void *msg_name;             /**< Optional address */
+    socklen_t msg_namelen;      /**< Size of address */
+    struct iovec *msg_iov;      /**< Scatter/gather array */
+    int msg_iovlen;             /**< Members in msghdr::msg_iov */
+    void *msg_control;          /**< Ancillary data */
+    socklen_t msg_controllen;   /**< Ancillary data buffer length */
+    int msg_flags;              /**< Flags on received message */
+};
+
+/**
+ * @brief   Message header for recvmmsg() and sendmmsg()
+ */
+struct mmsghdr {
+    struct msghdr msg_hdr;      /**< The message */
+    unsigned int msg_len;       /**< Number of bytes transmitted */
+};
+
+struct timespec;
+
 
 /**
  * @brief   Accept a new connection on a socket
@@ -308,8 +350,8 @@ int listen(int socket, int backlog);
  * @param[out] buffer   Points to a buffer where the message should be stored.
  * @param[in] length    Specifies the length in bytes of the buffer pointed to
  *                      by the buffer argument.
- * @param[in] flags     Specifies the type of message reception. Support for
- *                      values other than 0 is not implemented yet.
+ * @param[in] flags     Specifies the type of message reception. See
+ *                      recvfrom().
  *
  * @return  Upon successful completion, recv() shall return the length of the
  *          message in bytes. If no messages are available to be received and
@@ -334,8 +376,11 @@ ssize_t recv(int socket, void *buffer, size_t length, int flags);
  *                          stored.
  * @param[in] length        Specifies the length in bytes of the buffer pointed
  *                          to by the buffer argument.
- * @param[in] flags         Specifies the type of message reception. Support
- *                          for values other than 0 is not implemented yet.
+ * @param[in] flags         Specifies the type of message reception. Only
+ *                          @ref MSG_TRUNC is supported, and only for datagram
+ *                          sockets with @ref net_gnrc. Without it, a datagram
+ *                          that exceeds @p length is dropped and errno is set
+ *                          to ENOMEM.
  * @param[out] address      A null pointer, or points to a sockaddr structure
  *                          in which the sending address is to be stored. The
  *                          length and format of the address depend on the
@@ -356,6 +401,37 @@ ssize_t recvfrom(int socket, void *__restrict buffer, size_t length, int flags,
                  struct sockaddr *__restrict address,
                  socklen_t *__restrict address_len);
 
+/**
+ * @brief   Receive multiple messages from a socket.
+ * @details Blocks until at least one message is received and then takes up to
+ *          @p vlen messages already received by the stack, so a burst of
+ *          datagrams is received with a single call. The function is not part
+ *          of POSIX but modeled after the Linux function of the same name.
+ *
+ * @see <a href="http://man7.org/linux/man-pages/man2/recvmmsg.2.html">
+ *          Linux Programmer's Manual, recvmmsg
+ *      </a>
+ *
+ * @param[in] socket        Specifies the socket file descriptor. Only
+ *                          datagram sockets are supported.
+ * @param[in,out] msgvec    The messages. Each message must have exactly one
+ *                          element in its msghdr::msg_iov. On return,
+ *                          mmsghdr::msg_len is set to the number of bytes
+ *                          received and msghdr::msg_name, if not NULL, to the
+ *                          source address.
+ * @param[in] vlen          Number of messages in @p msgvec. At most
+ *                          @ref SOCKET_MMSG_MAX messages are received.
+ * @param[in] flags         Specifies the type of message reception. Support
+ *                          for values other than 0 is not implemented yet.
+ * @param[in] timeout       Not supported, must be NULL.
+ *
+ * @return  Upon successful completion, recvmmsg() shall return the number of
+ *          messages received. Otherwise, -1 shall be returned and errno set to
+ *          indicate the error.
+ */
+int recvmmsg(int socket, struct mmsghdr *msgvec, unsigned int vlen, int flags,
+             struct timespec *timeout);
+
 /**
  * @brief   Send a message on a socket.
  * @details Shall initiate transmission of a message from the specified socket
@@ -423,6 +499,38 @@ ssize_t send(int socket, const void *buffer, size_t length, int flags);
 ssize_t sendto(int socket, const void *buffer, size_t length, int flags,
                const struct sockaddr *address, socklen_t address_len);
 
+/**
+ * @brief   Send multiple messages on a socket.
+ * @details Passes up to @p vlen messages to the network stack at once. The
+ *          function is not part of POSIX but modeled after the Linux function
+ *          of the same name.
+ *
+ * @see <a href="http://man7.org/linux/man-pages/man2/sendmmsg.2.html">
+ *          Linux Programmer's Manual, sendmmsg
+ *      </a>
+ *
+ * @param[in] socket        Specifies the socket file descriptor. Only
+ *                          datagram sockets are supported.
+ * @param[in,out] msgvec    The messages. Each message must have a destination
+ *                          address in msghdr::msg_name and exactly one element
+ *                          in its msghdr::msg_iov. On return,
+ *                          mmsghdr::msg_len is set to the number of bytes
+ *                          sent.
+ * @param[in] vlen          Number of messages in @p msgvec. At most
+ *                          @ref SOCKET_MMSG_MAX messages are sent.
+ * @param[in] flags         Specifies the type of message transmission.
+ *                          Support for values other than 0 is not implemented
+ *                          yet.
+ *
+ * @post    The socket will implicitely be bound like with sendto(), in case
+ *          it is not already bound.
+ *
+ * @return  Upon successful completion, sendmmsg() shall return the number of
+ *          messages sent. Otherwise, -1 shall be returned and errno set to
+ *          indicate the error.
+ */
+int sendmmsg(int socket, struct mmsghdr *msgvec, unsigned int vlen, int flags);
+
 /**
  * @brief   Create an endpoint for communication.
  * @details Shall create an unbound socket in a communications domain, and
@@ -18,6 +18,7 @@
 
 #include <arpa/inet.h>
 #include <errno.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <string.h>
 
@@ -27,7 +28,10 @@
 #include "net/ipv4/addr.h"
 #include "net/ipv6/addr.h"
 #include "random.h"
+#include "timex.h"
 
+#include "poll.h"
+#include "sys/select.h"
 #include "sys/socket.h"
 #include "netinet/in.h"
 
@@ -40,9 +44,21 @@
 #ifdef  MODULE_CONN_UDP
 #   include "net/conn/udp.h"
 #endif  /* MODULE_CONN_UDP */
+#ifdef  MODULE_GNRC_CONN
+#   include "net/gnrc/conn.h"
+#   include "xtimer.h"
+#endif  /* MODULE_GNRC_CONN */
 
 #define SOCKET_POOL_SIZE    (4)
 
+/**
+ * @brief   Interval in microseconds poll() rescans sockets it can not wait
+ *          for, because their mailbox is in a set of another waiter
+ */
+#ifndef SOCKET_POLL_INTERVAL
+#define SOCKET_POLL_INTERVAL    (10U * MS_IN_USEC)
+#endif
+
 /**
  * @brief   Unitfied connection type.
  */
@@ -87,14 +103,28 @@ static socket_t *_get_free_socket(void)
     return NULL;
 }
 
+static int socket_close(int socket);
+
+/* the file descriptor table entry already knows the socket, so there is no
+ * need to search the pool
+ *
+ * @pre _pool_mutex is locked */
 static socket_t *_get_socket(int fd)
 {
-    for (int i = 0; i < SOCKET_POOL_SIZE; i++) {
-        if (_pool[i].fd == fd) {
-            return &_pool[i];
-        }
+    fd_t *fd_s = fd_get(fd);
+    socket_t *s;
+
+    if ((fd_s == NULL) || !fd_s->internal_active ||
+        (fd_s->close != socket_close) ||
+        ((unsigned)fd_s->internal_fd >= SOCKET_POOL_SIZE)) {
+        return NULL;
     }
-    return NULL;
+    s = &_pool[fd_s->internal_fd];
+    /* the socket may have been closed before the file descriptor */
+    if ((s->domain == AF_UNSPEC) || (s->fd != fd)) {
+        return NULL;
+    }
+    return s;
 }
 
 static inline int _choose_ipproto(int type, int protocol)
@@ -160,6 +190,28 @@ static inline socklen_t _addr_truncate(struct sockaddr *out, socklen_t out_len,
     return out_len;
 }
 
+static inline socklen_t _sockaddr_set(struct sockaddr *out, socklen_t out_len,
+                                      sa_family_t domain, const void *addr,
+                                      uint16_t port)
+{
+    struct sockaddr_storage tmp;
+    socklen_t tmp_len;
+
+    memset(&tmp, 0, sizeof(struct sockaddr_storage));
+    tmp.ss_family = domain;
+    if (domain == AF_INET) {
+        memcpy(_in_addr_ptr(&tmp), addr, sizeof(ipv4_addr_t));
+        *_in_port_ptr(&tmp) = htons(port);
+        tmp_len = sizeof(struct sockaddr_in);
+    }
+    else {
+        memcpy(_in6_addr_ptr(&tmp), addr, sizeof(ipv6_addr_t));
+        *_in6_port_ptr(&tmp) = htons(port);
+        tmp_len = sizeof(struct sockaddr_in6);
+    }
+    return _addr_truncate(out, out_len, &tmp, tmp_len);
+}
+
 static inline int _get_data_from_sockaddr(const struct sockaddr *address, size_t address_len,
                                           void **addr, size_t *addr_len, network_uint16_t *port)
 {
@@ -208,7 +260,7 @@ static int _implicit_bind(socket_t *s, void *addr)
     switch (s->type) {
 #ifdef MODULE_CONN_TCP
         case SOCK_STREAM:
-            res = conn_tcp_create(&s->conn.udp, best_match, sizeof(unspec),
+            res = conn_tcp_create(&s->conn.tcp, best_match, sizeof(unspec),
                                   s->domain, s->src_port);
             break;
 #endif
@@ -235,7 +287,7 @@ static int socket_close(int socket)
 {
     socket_t *s;
     int res = 0;
-    if ((unsigned)(socket - 1) > (SOCKET_POOL_SIZE - 1)) {
+    if ((unsigned)socket >= SOCKET_POOL_SIZE) {
         return -1;
     }
     mutex_lock(&_pool_mutex);
@@ -387,29 +439,37 @@ int accept(int socket, struct sockaddr *restrict address,
                 res = -1;
                 break;
             }
-            if ((res = conn_tcp_accept(&s->conn.tcp, &new_s->conn.tcp)) < 0) {
+            /* reserve the socket, accepting blocks until a peer connects */
+            new_s->domain = s->domain;
+            new_s->type = s->type;
+            new_s->protocol = s->protocol;
+            new_s->bound = false;
+            new_s->src_port = 0;
+            mutex_unlock(&_pool_mutex);
+            res = conn_tcp_accept(&s->conn.tcp, &new_s->conn.tcp);
+            mutex_lock(&_pool_mutex);
+            if (res < 0) {
+                new_s->domain = AF_UNSPEC;
                 errno = -res;
                 res = -1;
                 break;
             }
-            else if ((address != NULL) && (address_len != NULL)) {
-                /* TODO: add read and write */
-                int fd = fd_new(new_s - _pool, NULL, NULL, socket_close);
-                if (fd < 0) {
-                    errno = ENFILE;
-                    res = -1;
-                    break;
-                }
-                else {
-                    new_s->fd = res = fd;
-                }
-                new_s->domain = s->domain;
-                new_s->type = s->type;
-                new_s->protocol = s->protocol;
+            new_s->bound = true;
+            if ((res = fd_new(new_s - _pool, socket_read, socket_write,
+                              socket_close)) < 0) {
+                conn_tcp_close(&new_s->conn.tcp);
+                new_s->bound = false;
+                new_s->domain = AF_UNSPEC;
+                errno = ENFILE;
+                res = -1;
+                break;
+            }
+            new_s->fd = res;
+            if ((address != NULL) && (address_len != NULL)) {
                 tmp.ss_family = s->domain;
-                if ((res = conn_tcp_getpeeraddr(&s->conn.tcp, addr, port)) < 0) {
-                    errno = -res;
-                    res = -1;
+                if (conn_tcp_getpeeraddr(&new_s->conn.tcp, addr, port) < 0) {
+                    /* the peer is unknown */
+                    *address_len = 0;
                     break;
                 }
                 *port = htons(*port); /* XXX: sin(6)_port is supposed to be
@@ -532,6 +592,21 @@ int connect(int socket, const struct sockaddr *address, socklen_t address_len)
                 return -1;
             }
             break;
+#endif
+#ifdef MODULE_GNRC_CONN_UDP
+        case SOCK_DGRAM:
+            if (!s->bound) {
+                if ((res = _implicit_bind(s, addr)) < 0) {
+                    return res;
+                }
+            }
+
+            if ((res = conn_udp_connect(&s->conn.udp, addr, addr_len,
+                                        byteorder_ntohs(port))) < 0) {
+                errno = -res;
+                return -1;
+            }
+            break;
 #endif
         default:
             (void)res;
@@ -696,6 +771,10 @@ int listen(int socket, int backlog)
     mutex_lock(&_pool_mutex);
     s = _get_socket(socket);
     mutex_unlock(&_pool_mutex);
+    if (s == NULL) {
+        errno = EBADF;
+        return -1;
+    }
     if (!s->bound) {
         errno = EINVAL;
         return -1;
@@ -726,6 +805,29 @@ int listen(int socket, int backlog)
     return 0;
 }
 
+#ifdef MODULE_CONN_UDP
+static int _udp_recvfrom(conn_udp_t *conn, void *buffer, size_t length, int flags,
+                         void *addr, size_t *addr_len, uint16_t *port)
+{
+#ifdef MODULE_GNRC_CONN_UDP
+    if (flags & MSG_TRUNC) {
+        /* receive in place and copy as much as fits */
+        gnrc_pktsnip_t *pkt;
+        int res = gnrc_conn_udp_recv_buf(conn, &pkt, addr, addr_len, port);
+
+        if (res >= 0) {
+            memcpy(buffer, pkt->data, ((size_t)res < length) ? (size_t)res : length);
+            gnrc_pktbuf_release(pkt);
+        }
+        return res;
+    }
+#else
+    (void)flags;
+#endif
+    return conn_udp_recvfrom(conn, buffer, length, addr, addr_len, port);
+}
+#endif
+
 ssize_t recv(int socket, void *buffer, size_t length, int flags)
 {
     return recvfrom(socket, buffer, length, flags, NULL, NULL);
@@ -785,8 +887,8 @@ ssize_t recvfrom(int socket, void *restrict buffer, size_t length, int flags,
     switch (s->type) {
 #ifdef MODULE_CONN_UDP
         case SOCK_DGRAM:
-            if ((res = conn_udp_recvfrom(&s->conn.udp, buffer, length, addr,
-                                         &addr_len, port)) < 0) {
+            if ((res = _udp_recvfrom(&s->conn.udp, buffer, length, flags, addr,
+                                     &addr_len, port)) < 0) {
                 errno = -res;
                 return -1;
             }
@@ -826,6 +928,69 @@ ssize_t recvfrom(int socket, void *restrict buffer, size_t length, int flags,
     return res;
 }
 
+int recvmmsg(int socket, struct mmsghdr *msgvec, unsigned int vlen, int flags,
+             struct timespec *timeout)
+{
+    socket_t *s;
+    (void)flags;
+    mutex_lock(&_pool_mutex);
+    s = _get_socket(socket);
+    mutex_unlock(&_pool_mutex);
+    if (s == NULL) {
+        errno = ENOTSOCK;
+        return -1;
+    }
+    if (!s->bound || (timeout != NULL)) {
+        errno = EINVAL;
+        return -1;
+    }
+    switch (s->type) {
+#ifdef MODULE_CONN_UDP
+        case SOCK_DGRAM: {
+            conn_udp_dgram_t dgrams[SOCKET_MMSG_MAX];
+            ipv6_addr_t addrs[SOCKET_MMSG_MAX];     /* fits addresses of any domain */
+            int res;
+
+            if (vlen > SOCKET_MMSG_MAX) {
+                vlen = SOCKET_MMSG_MAX;
+            }
+            for (unsigned i = 0; i < vlen; i++) {
+                struct msghdr *hdr = &msgvec[i].msg_hdr;
+
+                if (hdr->msg_iovlen != 1) {
+                    errno = EINVAL;
+                    return -1;
+                }
+                dgrams[i].data = hdr->msg_iov[0].iov_base;
+                dgrams[i].len = hdr->msg_iov[0].iov_len;
+                dgrams[i].addr = &addrs[i];
+                dgrams[i].addr_len = sizeof(ipv6_addr_t);
+            }
+            if ((res = conn_udp_recv_many(&s->conn.udp, dgrams, vlen)) < 0) {
+                errno = -res;
+                return -1;
+            }
+            for (int i = 0; i < res; i++) {
+                struct msghdr *hdr = &msgvec[i].msg_hdr;
+
+                msgvec[i].msg_len = dgrams[i].len;
+                hdr->msg_flags = 0;
+                if (hdr->msg_name != NULL) {
+                    hdr->msg_namelen = _sockaddr_set(hdr->msg_name, hdr->msg_namelen,
+                                                     s->domain, &addrs[i], dgrams[i].port);
+                }
+            }
+            return res;
+        }
+#endif
+        default:
+            (void)msgvec;
+            (void)vlen;
+            errno = EOPNOTSUPP;
+            return -1;
+    }
+}
+
 ssize_t send(int socket, const void *buffer, size_t length, int flags)
 {
     return sendto(socket, buffer, length, flags, NULL, 0);
@@ -928,6 +1093,12 @@ ssize_t sendto(int socket, const void *buffer, size_t length, int flags,
                 res = conn_udp_sendto(buffer, length, NULL, 0, addr, addr_len, s->domain,
                                       s->src_port, byteorder_ntohs(port));
             }
+#ifdef MODULE_GNRC_CONN_UDP
+            else if (s->bound) {
+                /* fails with -ENOTCONN if connect() was not called */
+                res = conn_udp_send(&s->conn.udp, buffer, length);
+            }
+#endif
             else {
                 errno = ENOTCONN;
                 return -1;
@@ -947,6 +1118,314 @@ ssize_t sendto(int socket, const void *buffer, size_t length, int flags,
     return res;
 }
 
+int sendmmsg(int socket, struct mmsghdr *msgvec, unsigned int vlen, int flags)
+{
+    socket_t *s;
+    (void)flags;
+    mutex_lock(&_pool_mutex);
+    s = _get_socket(socket);
+    mutex_unlock(&_pool_mutex);
+    if (s == NULL) {
+        errno = ENOTSOCK;
+        return -1;
+    }
+    switch (s->type) {
+#ifdef MODULE_CONN_UDP
+        case SOCK_DGRAM: {
+            conn_udp_dgram_t dgrams[SOCKET_MMSG_MAX];
+            uint8_t src_addr[sizeof(ipv6_addr_t)];
+            uint16_t sport;
+            int res;
+
+            if (vlen > SOCKET_MMSG_MAX) {
+                vlen = SOCKET_MMSG_MAX;
+            }
+            for (unsigned i = 0; i < vlen; i++) {
+                struct msghdr *hdr = &msgvec[i].msg_hdr;
+                const struct sockaddr *address = hdr->msg_name;
+                network_uint16_t port;
+
+                if (address == NULL) {
+                    errno = ENOTCONN;
+                    return -1;
+                }
+                if (address->sa_family != s->domain) {
+                    errno = EAFNOSUPPORT;
+                    return -1;
+                }
+                if (hdr->msg_iovlen != 1) {
+                    errno = EINVAL;
+                    return -1;
+                }
+                if (_get_data_from_sockaddr(address, hdr->msg_namelen, &dgrams[i].addr,
+                                            &dgrams[i].addr_len, &port) < 0) {
+                    return -1;
+                }
+                dgrams[i].data = hdr->msg_iov[0].iov_base;
+                dgrams[i].len = hdr->msg_iov[0].iov_len;
+                dgrams[i].port = byteorder_ntohs(port);
+            }
+            if (vlen == 0) {
+                return 0;
+            }
+            if (!s->bound && (_implicit_bind(s, dgrams[0].addr) < 0)) {
+                return -1;
+            }
+            if ((res = conn_udp_getlocaladdr(&s->conn.udp, src_addr, &sport)) < 0) {
+                errno = ENOTSOCK;   /* Something seems to be wrong with the socket */
+                return -1;
+            }
+            if ((res = conn_udp_send_many(dgrams, vlen, src_addr, (size_t)res, s->domain,
+                                          sport)) < 0) {
+                errno = -res;
+                return -1;
+            }
+            for (int i = 0; i < res; i++) {
+                msgvec[i].msg_len = dgrams[i].len;
+            }
+            return res;
+        }
+#endif
+        default:
+            (void)msgvec;
+            (void)vlen;
+            errno = EOPNOTSUPP;
+            return -1;
+    }
+}
+
+#ifdef MODULE_GNRC_CONN
+static inline gnrc_netapi_mbox_t *_mbox(socket_t *s)
+{
+    /* all GNRC connection types start like conn_t */
+    return &((conn_t *)&s->conn)->mbox;
+}
+
+static inline bool _has_mbox(socket_t *s)
+{
+#ifdef MODULE_GNRC_CONN_TCP
+    if (s->type == SOCK_STREAM) {
+        /* the TCB notifies its state changes through the mailbox */
+        return s->bound;
+    }
+#endif
+    return s->bound && ((s->type == SOCK_DGRAM) || (s->type == SOCK_RAW));
+}
+#endif
+
+static short _revents(socket_t *s, short events)
+{
+    /* sending datagrams never blocks */
+    short revents = events & (POLLOUT | POLLWRNORM);
+
+#ifdef MODULE_GNRC_CONN
+#ifdef MODULE_GNRC_CONN_TCP
+    if ((s->type == SOCK_STREAM) && s->bound) {
+        unsigned tcp_events = gnrc_tcp_events(&s->conn.tcp.tcb);
+
+        revents = 0;
+        if (tcp_events & GNRC_TCP_EVENT_IN) {
+            revents |= events & (POLLIN | POLLRDNORM);
+        }
+        if (tcp_events & GNRC_TCP_EVENT_OUT) {
+            revents |= events & (POLLOUT | POLLWRNORM);
+        }
+        if (tcp_events & GNRC_TCP_EVENT_ERR) {
+            revents |= POLLERR;
+        }
+        return revents;
+    }
+#endif
+    if (_has_mbox(s)) {
+        if (gnrc_netapi_mbox_avail(_mbox(s)) > 0) {
+            revents |= events & (POLLIN | POLLRDNORM);
+        }
+        return revents;
+    }
+    if ((s->type == SOCK_DGRAM) || (s->type == SOCK_RAW)) {
+        /* not bound yet, nothing can have been received */
+        return revents;
+    }
+#else
+    (void)s;
+#endif
+    /* readiness is unknown, let the caller try */
+    return revents | (events & (POLLIN | POLLRDNORM));
+}
+
+static int _poll_scan(struct pollfd fds[], nfds_t nfds)
+{
+    int res = 0;
+
+    for (nfds_t i = 0; i < nfds; i++) {
+        socket_t *s;
+
+        fds[i].revents = 0;
+        if (fds[i].fd < 0) {
+            continue;
+        }
+        mutex_lock(&_pool_mutex);
+        s = _get_socket(fds[i].fd);
+        mutex_unlock(&_pool_mutex);
+        if (s == NULL) {
+            fds[i].revents = POLLNVAL;
+        }
+        else {
+            fds[i].revents = _revents(s, fds[i].events);
+        }
+        if (fds[i].revents != 0) {
+            res++;
+        }
+    }
+    return res;
+}
+
+int poll(struct pollfd fds[], nfds_t nfds, int timeout)
+{
+    int res = _poll_scan(fds, nfds);
+
+#ifdef MODULE_GNRC_CONN
+    if ((res == 0) && (timeout != 0)) {
+        gnrc_netapi_mbox_set_t set;
+        gnrc_netapi_mbox_t *ready;
+        uint32_t timeout_us = GNRC_NETAPI_MBOX_WAIT_FOREVER;
+        uint32_t start = xtimer_now();
+        bool shared = false;
+
+        if (timeout > 0) {
+            timeout_us = ((unsigned)timeout < ((UINT32_MAX - 1) / MS_IN_USEC)) ?
+                         (uint32_t)timeout * MS_IN_USEC : (UINT32_MAX - 1);
+        }
+        /* the mailboxes wake this thread up when a packet arrives */
+        gnrc_netapi_mbox_set_init(&set, GNRC_CONN_FLAG_RCV);
+        mutex_lock(&_pool_mutex);
+        for (nfds_t i = 0; i < nfds; i++) {
+            socket_t *s = (fds[i].fd < 0) ? NULL : _get_socket(fds[i].fd);
+
+            /* stream sockets are notified about sending space as well, a
+             * socket polled twice is added once */
+            if ((s != NULL) && _has_mbox(s) &&
+                ((fds[i].events & (POLLIN | POLLRDNORM)) ||
+                 (s->type == SOCK_STREAM))) {
+                if (_mbox(s)->set == NULL) {
+                    gnrc_netapi_mbox_set_add(&set, _mbox(s), NULL);
+                }
+                else if (_mbox(s)->set != &set) {
+                    /* another waiter owns the mailbox and its wake-ups, so
+                     * this socket can only be rescanned periodically */
+                    shared = true;
+                }
+            }
+        }
+        mutex_unlock(&_pool_mutex);
+        /* catch notifications between the first scan and adding the
+         * mailboxes */
+        res = _poll_scan(fds, nfds);
+        while (res == 0) {
+            uint32_t wait = timeout_us;
+
+            if (timeout_us != GNRC_NETAPI_MBOX_WAIT_FOREVER) {
+                uint32_t elapsed = xtimer_now() - start;
+
+                if (elapsed >= timeout_us) {
+                    break;
+                }
+                wait = timeout_us - elapsed;
+            }
+            if (shared && (wait > SOCKET_POLL_INTERVAL)) {
+                wait = SOCKET_POLL_INTERVAL;
+            }
+            gnrc_netapi_mbox_set_wait(&set, &ready, 1, wait);
+            res = _poll_scan(fds, nfds);
+        }
+        mutex_lock(&_pool_mutex);
+        for (nfds_t i = 0; i < nfds; i++) {
+            socket_t *s = (fds[i].fd < 0) ? NULL : _get_socket(fds[i].fd);
+
+            if ((s != NULL) && _has_mbox(s) && (_mbox(s)->set == &set)) {
+                gnrc_netapi_mbox_set_remove(_mbox(s));
+            }
+        }
+        mutex_unlock(&_pool_mutex);
+    }
+#else
+    (void)timeout;
+#endif
+    return res;
+}
+
+int select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *errorfds,
+           struct timeval *timeout)
+{
+    struct pollfd fds[SOCKET_POOL_SIZE];
+    nfds_t numof = 0;
+    int res, ms = -1;
+
+    if ((nfds < 0) || (nfds > FD_SETSIZE)) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (int fd = 0; fd < nfds; fd++) {
+        socket_t *s;
+        short events = 0;
+        bool error = (errorfds != NULL) && FD_ISSET(fd, errorfds);
+
+        if ((readfds != NULL) && FD_ISSET(fd, readfds)) {
+            events |= POLLIN;
+        }
+        if ((writefds != NULL) && FD_ISSET(fd, writefds)) {
+            events |= POLLOUT;
+        }
+        if ((events == 0) && !error) {
+            continue;
+        }
+        /* only sockets can be selected */
+        mutex_lock(&_pool_mutex);
+        s = (numof < SOCKET_POOL_SIZE) ? _get_socket(fd) : NULL;
+        mutex_unlock(&_pool_mutex);
+        if (s == NULL) {
+            errno = EBADF;
+            return -1;
+        }
+        fds[numof].fd = fd;
+        fds[numof].events = events;
+        numof++;
+    }
+    if (timeout != NULL) {
+        ms = (timeout->tv_sec < (time_t)((INT_MAX / SEC_IN_MS) - 1)) ?
+             (int)((timeout->tv_sec * SEC_IN_MS) +
+                   ((timeout->tv_usec + MS_IN_USEC - 1) / MS_IN_USEC)) :
+             INT_MAX;
+    }
+    if (poll(fds, numof, ms) < 0) {
+        return -1;
+    }
+    if (readfds != NULL) {
+        FD_ZERO(readfds);
+    }
+    if (writefds != NULL) {
+        FD_ZERO(writefds);
+    }
+    if (errorfds != NULL) {
+        FD_ZERO(errorfds);
+    }
+    res = 0;
+    for (nfds_t i = 0; i < numof; i++) {
+        if ((readfds != NULL) && (fds[i].revents & POLLIN)) {
+            FD_SET(fds[i].fd, readfds);
+            res++;
+        }
+        if ((writefds != NULL) && (fds[i].revents & POLLOUT)) {
+            FD_SET(fds[i].fd, writefds);
+            res++;
+        }
+        if ((errorfds != NULL) && (fds[i].revents & POLLERR)) {
+            FD_SET(fds[i].fd, errorfds);
+            res++;
+        }
+    }
+    return res;
+}
 
 /**
  * @}
@@ -22,10 +22,6 @@
 #include "thread.h"
 #include "kernel_types.h"
 
-#ifdef MODULE_SCHEDSTATISTICS
-#include "xtimer.h"
-#endif
-
 #ifdef MODULE_TLSF
 #include "tlsf.h"
 #endif
@@ -39,7 +35,9 @@ const char *state_names[] = {
     [STATUS_MUTEX_BLOCKED] = "bl mutex",
     [STATUS_RECEIVE_BLOCKED] = "bl rx",
     [STATUS_SEND_BLOCKED] = "bl send",
-    [STATUS_REPLY_BLOCKED] = "bl reply"
+    [STATUS_REPLY_BLOCKED] = "bl reply",
+    [STATUS_FLAG_BLOCKED_ANY] = "bl anyfl",
+    [STATUS_FLAG_BLOCKED_ALL] = "bl allfl"
 };
 
 /**
@@ -61,7 +59,7 @@ void ps(void)
            "| stack ( used) | location   "
 #endif
 #ifdef MODULE_SCHEDSTATISTICS
-           "| runtime | switches"
+           "| runtime | pending | blocked | switches (vol/yld/inv) | msgq"
 #endif
            "\n",
 #ifdef DEVELHELP
@@ -83,8 +81,19 @@ void ps(void)
             overall_used += stacksz;
 #endif
 #ifdef MODULE_SCHEDSTATISTICS
-            double runtime_ticks =  sched_pidlist[i].runtime_ticks / (double) xtimer_now() * 100;
-            int switches = sched_pidlist[i].schedules;
+            schedstat stat;
+            uint64_t elapsed = sched_stat_elapsed();
+            /* no time has passed right after sched_stat_reset() */
+            double scale = (elapsed > 0) ? (100.0 / elapsed) : 0.0;
+            uint64_t blocked = 0;
+
+            sched_stat_get(i, &stat);
+            for (int s = STATUS_SLEEPING; s < STATUS_ON_RUNQUEUE; s++) {
+                blocked += stat.status_ticks[s];
+            }
+            double runtime_ticks = stat.runtime_ticks * scale;
+            double pending_ticks = stat.status_ticks[STATUS_PENDING] * scale;
+            double blocked_ticks = blocked * scale;
 #endif
             printf("\t%3" PRIkernel_pid
 #ifdef DEVELHELP
@@ -95,7 +104,7 @@ void ps(void)
                    " | %5i (%5i) | %p "
 #endif
 #ifdef MODULE_SCHEDSTATISTICS
-                   " | %6.3f%% |  %8d"
+                   " | %6.3f%% | %6.3f%% | %6.3f%% | %8u (%5u/%5u/%5u) | %4u"
 #endif
                    "\n",
                    p->pid,
@@ -107,7 +116,8 @@ void ps(void)
                    , p->stack_size, stacksz, (void *)p->stack_start
 #endif
 #ifdef MODULE_SCHEDSTATISTICS
-                   , runtime_ticks, switches
+                   , runtime_ticks, pending_ticks, blocked_ticks, stat.schedules,
+                   stat.voluntary, stat.yields, stat.involuntary, (unsigned)stat.msg_queue_max
 #endif
                   );
         }
@@ -15,6 +15,7 @@
  * @author      Martine Lenders <mlenders@inf.fu-berlin.de>
  */
 
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -230,6 +231,19 @@ static int _ipv6_nc_reset(void)
     return 0;
 }
 
+static int _ipv6_nc_stats(void)
+{
+    gnrc_ipv6_nc_stats_t stats;
+
+    gnrc_ipv6_nc_get_stats(&stats);
+    printf("lookups: %" PRIu32 ", hits: %" PRIu32 ", misses: %" PRIu32 "\n",
+           stats.lookups, stats.hits, stats.lookups - stats.hits);
+    printf("evictions: %" PRIu32 ", failed additions: %" PRIu32 "\n",
+           stats.evictions, stats.add_fails);
+
+    return 0;
+}
+
 int _ipv6_nc_manage(int argc, char **argv)
 {
     if ((argc == 1) || (strcmp("list", argv[1]) == 0)) {
@@ -246,13 +260,17 @@ int _ipv6_nc_manage(int argc, char **argv)
         if (strcmp("reset", argv[1]) == 0) {
             return _ipv6_nc_reset();
         }
+        if (strcmp("stats", argv[1]) == 0) {
+            return _ipv6_nc_stats();
+        }
     }
 
     printf("usage: %s [list]\n"
            "   or: %s add [<iface pid>] <ipv6_addr> <l2_addr>\n"
            "      * <iface pid> is optional if only one interface exists.\n"
            "   or: %s del <ipv6_addr>\n"
-           "   or: %s reset\n", argv[0], argv[0], argv[0], argv[0]);
+           "   or: %s reset\n"
+           "   or: %s stats\n", argv[0], argv[0], argv[0], argv[0], argv[0]);
     return 1;
 }
 
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_thread_periodic
+ * @{
+ *
+ * @file
+ *
+ * @}
+ */
+
+#include "irq.h"
+#include "sched.h"
+#include "thread.h"
+#include "thread_periodic.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+/* all periodic threads, sorted by period */
+static thread_periodic_t *_threads;
+
+static void _release(void *arg);
+static void _budget_exceeded(void *arg);
+
+/**
+ * @pre Interrupts are disabled
+ */
+static void _set_priority(thread_periodic_t *pt, uint8_t priority)
+{
+    thread_t *thread = (thread_t *)thread_get(pt->pid);
+
+    if (thread != NULL) {
+        sched_change_priority(thread, priority);
+    }
+}
+
+/**
+ * @brief   Assigns the rate-monotonic priorities
+ *
+ * @pre Interrupts are disabled
+ */
+static void _assign_priorities(void)
+{
+    uint8_t priority = THREAD_PERIODIC_PRIO_FIRST;
+
+    for (thread_periodic_t *pt = _threads; pt != NULL; pt = pt->next) {
+        pt->priority = priority;
+        if (!pt->demoted) {
+            _set_priority(pt, priority);
+        }
+        if (priority < (THREAD_PERIODIC_PRIO_FIRST + THREAD_PERIODIC_PRIO_NUMOF - 1)) {
+            priority++;
+        }
+    }
+}
+
+static void _release(void *arg)
+{
+    thread_periodic_t *pt = arg;
+    uint32_t now = xtimer_now();
+    unsigned state;
+
+    pt->release += pt->period;
+    if ((int32_t)(pt->release - now) <= 0) {
+        /* fell behind by more than a period: skip the missed releases */
+        pt->release = now + pt->period;
+    }
+    xtimer_set(&pt->release_timer, pt->release - now);
+
+    state = irq_disable();
+    if (pt->waiting) {
+        pt->waiting = 0;
+        sched_set_status((thread_t *)thread_get(pt->pid), STATUS_PENDING);
+    }
+    else {
+        DEBUG("thread_periodic: %" PRIkernel_pid " missed its deadline\n",
+              pt->pid);
+        pt->deadline_misses++;
+        pt->pending = 1;
+        if (pt->demoted && pt->budget) {
+            /* the overrunning job continues on the budget of this release */
+            xtimer_set(&pt->budget_timer, pt->budget);
+        }
+    }
+    if (pt->demoted) {
+        pt->demoted = 0;
+        _set_priority(pt, pt->priority);
+    }
+    irq_restore(state);
+    sched_switch(pt->priority);
+}
+
+static void _budget_exceeded(void *arg)
+{
+    thread_periodic_t *pt = arg;
+    unsigned state = irq_disable();
+
+    DEBUG("thread_periodic: %" PRIkernel_pid " exceeded its budget\n", pt->pid);
+    pt->budget_overruns++;
+    pt->demoted = 1;
+    _set_priority(pt, THREAD_PERIODIC_PRIO_BACKGROUND);
+    irq_restore(state);
+    sched_context_switch_request = 1;
+}
+
+static void *_periodic_thread(void *arg)
+{
+    thread_periodic_t *pt = arg;
+
+    while (1) {
+        unsigned state = irq_disable();
+
+        if (pt->pending) {
+            pt->pending = 0;
+        }
+        else {
+            /* wait for the next release */
+            pt->waiting = 1;
+            sched_set_status((thread_t *)sched_active_thread, STATUS_SLEEPING);
+            irq_restore(state);
+            thread_yield_higher();
+            state = irq_disable();
+        }
+        irq_restore(state);
+
+        if (pt->budget) {
+            xtimer_set(&pt->budget_timer, pt->budget);
+        }
+        pt->job(pt->arg);
+        if (pt->budget) {
+            xtimer_remove(&pt->budget_timer);
+        }
+        pt->jobs++;
+    }
+
+    return NULL;
+}
+
+kernel_pid_t thread_create_periodic(thread_periodic_t *pt, char *stack,
+                                    int stacksize, uint32_t period,
+                                    uint32_t budget, thread_periodic_job_t job,
+                                    void *arg, const char *name)
+{
+    thread_periodic_t **prev = &_threads;
+
+    pt->job = job;
+    pt->arg = arg;
+    pt->period = period;
+    pt->budget = budget;
+    pt->jobs = 0;
+    pt->deadline_misses = 0;
+    pt->budget_overruns = 0;
+    pt->waiting = 0;
+    pt->pending = 1;
+    pt->demoted = 0;
+    pt->release_timer.callback = _release;
+    pt->release_timer.arg = pt;
+    pt->budget_timer.callback = _budget_exceeded;
+    pt->budget_timer.arg = pt;
+    pt->pid = thread_create(stack, stacksize,
+                            THREAD_PERIODIC_PRIO_FIRST + THREAD_PERIODIC_PRIO_NUMOF - 1,
+                            THREAD_CREATE_WOUT_YIELD | THREAD_CREATE_STACKTEST,
+                            _periodic_thread, pt, name);
+    if (pt->pid <= KERNEL_PID_UNDEF) {
+        return pt->pid;
+    }
+
+    unsigned state = irq_disable();
+
+    while ((*prev != NULL) && ((*prev)->period <= period)) {
+        prev = &(*prev)->next;
+    }
+    pt->next = *prev;
+    *prev = pt;
+    _assign_priorities();
+    pt->release = xtimer_now();
+    xtimer_set(&pt->release_timer, period);
+    irq_restore(state);
+
+    thread_yield_higher();
+
+    return pt->pid;
+}
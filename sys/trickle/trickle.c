@@ -55,13 +55,17 @@ void trickle_interval(trickle_t *trickle)
     trickle->c = 0;
     trickle->t = (trickle->I / 2) + (rand() % ((trickle->I / 2) + 1));
 
+    /* Both timers may fire late, so they can share wake-ups with other
+     * timers: the callback at most halfway to the end of the interval, so it
+     * still fires within it, and the interval by a sixteenth of its length. */
     trickle->msg_callback_time = trickle->t * SEC_IN_MS;
-    xtimer_set_msg64(&trickle->msg_callback_timer, trickle->msg_callback_time,
-                     &trickle->msg_callback, trickle->pid);
-
     trickle->msg_interval_time = trickle->I * SEC_IN_MS;
-    xtimer_set_msg64(&trickle->msg_interval_timer, trickle->msg_interval_time,
-                     &trickle->msg_interval, trickle->pid);
+    xtimer_set_msg64_slack(&trickle->msg_callback_timer, trickle->msg_callback_time,
+                           (trickle->msg_interval_time - trickle->msg_callback_time) / 2,
+                           &trickle->msg_callback, trickle->pid);
+    xtimer_set_msg64_slack(&trickle->msg_interval_timer, trickle->msg_interval_time,
+                           trickle->msg_interval_time / 16,
+                           &trickle->msg_interval, trickle->pid);
 }
 
 void trickle_reset_timer(trickle_t *trickle)
@@ -104,6 +104,60 @@ out:
     *last_wakeup = target;
 }
 
+/**
+ * @brief   Turns @p offset into the offset from now of the time with the most
+ *          trailing zero bits within [now + offset, now + offset + slack]
+ *
+ * The chosen time is the limit with all bits cleared below the highest bit
+ * in which the start and the limit of the window differ.
+ */
+static uint32_t _slack_offset(uint32_t offset, uint32_t slack)
+{
+    if (slack > (UINT32_MAX - offset)) {
+        slack = UINT32_MAX - offset;
+    }
+    if (!slack) {
+        return offset;
+    }
+
+    uint32_t now = xtimer_now();
+    uint32_t limit = now + offset + slack;
+    uint32_t mask = (now + offset) ^ limit;
+
+    mask |= mask >> 1;
+    mask |= mask >> 2;
+    mask |= mask >> 4;
+    mask |= mask >> 8;
+    mask |= mask >> 16;
+
+    return (limit & ~(mask >> 1)) - now;
+}
+
+static uint64_t _slack_offset64(uint64_t offset, uint64_t slack)
+{
+    if (!slack) {
+        return offset;
+    }
+
+    uint64_t now = xtimer_now64();
+    uint64_t limit = now + offset + slack;
+    uint64_t mask = (now + offset) ^ limit;
+
+    mask |= mask >> 1;
+    mask |= mask >> 2;
+    mask |= mask >> 4;
+    mask |= mask >> 8;
+    mask |= mask >> 16;
+    mask |= mask >> 32;
+
+    return (limit & ~(mask >> 1)) - now;
+}
+
+void xtimer_set_slack(xtimer_t *timer, uint32_t offset, uint32_t slack)
+{
+    xtimer_set(timer, _slack_offset(offset, slack));
+}
+
 static void _callback_msg(void* arg)
 {
     msg_t *msg = (msg_t*)arg;
@@ -131,6 +185,21 @@ void xtimer_set_msg64(xtimer_t *timer, uint64_t offset, msg_t *msg, kernel_pid_t
     _xtimer_set64(timer, offset, offset >> 32);
 }
 
+void xtimer_set_msg_slack(xtimer_t *timer, uint32_t offset, uint32_t slack,
+                          msg_t *msg, kernel_pid_t target_pid)
+{
+    _setup_msg(timer, msg, target_pid);
+    xtimer_set(timer, _slack_offset(offset, slack));
+}
+
+void xtimer_set_msg64_slack(xtimer_t *timer, uint64_t offset, uint64_t slack,
+                            msg_t *msg, kernel_pid_t target_pid)
+{
+    _setup_msg(timer, msg, target_pid);
+    offset = _slack_offset64(offset, slack);
+    _xtimer_set64(timer, offset, offset >> 32);
+}
+
 static void _callback_wakeup(void* arg)
 {
     thread_wakeup((kernel_pid_t)((intptr_t)arg));
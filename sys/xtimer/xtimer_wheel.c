@@ -0,0 +1,654 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ *
+ * @ingroup xtimer
+ * @{
+ * @file
+ * @brief xtimer core functionality based on a hierarchical timer wheel
+ *
+ * Replaces xtimer_core.c with the `xtimer_wheel` module. Timers are hashed
+ * into XTIMER_WHEEL_LEVELS levels of 32 slots each by their 64 bit target
+ * time in wheel ticks. Level 0 slots are one tick wide, every level above
+ * covers 32 times the range of the level below. A timer is put on the lowest
+ * level on which it falls into another slot than the current time, so
+ * inserting and removing it is O(1). Whenever the wheel reaches the start of
+ * a slot on a higher level, the slot's timers are cascaded down. Timers of the
+ * current tick are kept in a sorted list of due timers, which fire with the
+ * precision of the low-level timer as before.
+ *
+ * The low-level timer is programmed to the earlier of the first due timer and
+ * the start of the next non-empty slot, which is found with a bitmap per
+ * level. As in xtimer_core.c, it is programmed to the end of the low-level
+ * timer period if neither is within the current period.
+ *
+ * @}
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "board.h"
+#include "periph/timer.h"
+#include "periph_conf.h"
+
+#include "bitarithm.h"
+#include "xtimer.h"
+#include "irq.h"
+
+/* WARNING! enabling this will have side effects and can lead to timer underflows. */
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#define _SLOT_BITS      (5U)
+#define _SLOTS          (1U << _SLOT_BITS)
+#define _SLOT_MASK      (_SLOTS - 1)
+/* number of wheel ticks covered by the wheel */
+#define _HORIZON_BITS   (_SLOT_BITS * XTIMER_WHEEL_LEVELS)
+#define _NEVER          (UINT64_MAX)
+
+static volatile int _in_handler = 0;
+
+static volatile uint32_t _long_cnt = 0;
+#if XTIMER_MASK
+volatile uint32_t _high_cnt = 0;
+#endif
+
+static xtimer_t *_wheel[XTIMER_WHEEL_LEVELS][_SLOTS];
+static uint32_t _bitmap[XTIMER_WHEEL_LEVELS];
+static xtimer_t *_due = NULL;       /* timers of the current tick, sorted */
+static xtimer_t *_far = NULL;       /* timers beyond the wheel, unsorted */
+static uint64_t _wheel_time = 0;    /* current wheel tick */
+static uint64_t _armed = _NEVER;    /* deadline the low-level timer is set to */
+
+static void _shoot(xtimer_t *timer);
+static void _add(xtimer_t *timer);
+static void _remove(xtimer_t *timer);
+static inline void _lltimer_set(uint32_t target);
+static uint32_t _time_left(uint32_t target, uint32_t reference);
+
+static void _timer_callback(void);
+static void _periph_timer_callback(void *arg, int chan);
+
+static inline uintptr_t _tag(const xtimer_t *timer)
+{
+    return ((uintptr_t)timer) ^ ((uintptr_t)timer->pprev);
+}
+
+static inline int _is_set(xtimer_t *timer)
+{
+    /* the struct might not be initialized, so trust pprev only if it is
+     * tagged */
+    return (timer->pprev != NULL) && (timer->tag == _tag(timer));
+}
+
+static inline uint64_t _target64(const xtimer_t *timer)
+{
+    return (((uint64_t)timer->long_target) << 32) | timer->target;
+}
+
+static inline uint64_t _period_start(void)
+{
+#if XTIMER_MASK
+    return (((uint64_t)_long_cnt) << 32) | _high_cnt;
+#else
+    return ((uint64_t)_long_cnt) << 32;
+#endif
+}
+
+static inline uint64_t _period_end(void)
+{
+    return _period_start() + _lltimer_mask(0xFFFFFFFF) + 1;
+}
+
+/* bitarithm_lsb() takes an unsigned, which might be only 16 bit wide */
+static inline unsigned _lsb(uint32_t v)
+{
+    if (v & 0xffff) {
+        return bitarithm_lsb((unsigned)(v & 0xffff));
+    }
+    return 16 + bitarithm_lsb((unsigned)(v >> 16));
+}
+
+static inline void _set_pprev(xtimer_t *timer, xtimer_t **pprev)
+{
+    timer->pprev = pprev;
+    timer->tag = _tag(timer);
+}
+
+static void _link(xtimer_t **pos, xtimer_t *timer)
+{
+    timer->next = *pos;
+    if (timer->next) {
+        _set_pprev(timer->next, &timer->next);
+    }
+    _set_pprev(timer, pos);
+    *pos = timer;
+}
+
+static void _unlink(xtimer_t *timer)
+{
+    xtimer_t **pprev = timer->pprev;
+    uintptr_t idx = ((uintptr_t)pprev - (uintptr_t)&_wheel[0][0]) /
+                    sizeof(xtimer_t *);
+
+    *pprev = timer->next;
+    if (timer->next) {
+        _set_pprev(timer->next, pprev);
+    }
+    if ((*pprev == NULL) && (idx < (XTIMER_WHEEL_LEVELS * _SLOTS))) {
+        /* wheel slot got empty */
+        _bitmap[idx / _SLOTS] &= ~(((uint32_t)1) << (idx % _SLOTS));
+    }
+    timer->pprev = NULL;
+    timer->tag = 0;
+}
+
+static void _add_to_due(xtimer_t *timer)
+{
+    xtimer_t **pos = &_due;
+    uint64_t target = _target64(timer);
+
+    while (*pos && (_target64(*pos) <= target)) {
+        pos = &((*pos)->next);
+    }
+    _link(pos, timer);
+}
+
+static void _add_to_wheel(xtimer_t *timer)
+{
+    uint64_t tick = _target64(timer) >> XTIMER_WHEEL_TICK_SHIFT;
+    uint64_t diff = tick ^ _wheel_time;
+
+    if (tick <= _wheel_time) {
+        _add_to_due(timer);
+        return;
+    }
+    for (unsigned level = 0; level < XTIMER_WHEEL_LEVELS; level++) {
+        if ((diff >> (_SLOT_BITS * (level + 1))) == 0) {
+            /* timer falls into the current slot of all levels above */
+            unsigned slot = (tick >> (_SLOT_BITS * level)) & _SLOT_MASK;
+
+            _link(&_wheel[level][slot], timer);
+            _bitmap[level] |= ((uint32_t)1) << slot;
+            return;
+        }
+    }
+    DEBUG("_add_to_wheel(): timer beyond the wheel\n");
+    _link(&_far, timer);
+}
+
+/* re-adds a detached list of timers relative to the current wheel tick */
+static void _readd(xtimer_t *list)
+{
+    while (list) {
+        xtimer_t *timer = list;
+
+        list = list->next;
+        _add_to_wheel(timer);
+    }
+}
+
+static xtimer_t *_detach(xtimer_t **head)
+{
+    xtimer_t *list = *head;
+
+    *head = NULL;
+    return list;
+}
+
+/* returns the wheel tick of the next non-empty slot, _NEVER if there is
+ * none */
+static uint64_t _next_event(void)
+{
+    for (unsigned level = 0; level < XTIMER_WHEEL_LEVELS; level++) {
+        unsigned shift = _SLOT_BITS * level;
+        unsigned idx = (_wheel_time >> shift) & _SLOT_MASK;
+        /* only slots behind the current one can be in use */
+        uint32_t pending = _bitmap[level] & ~((((uint32_t)2) << idx) - 1);
+
+        if (pending) {
+            uint64_t base = (_wheel_time >> (shift + _SLOT_BITS)) << (shift + _SLOT_BITS);
+
+            return base | (((uint64_t)_lsb(pending)) << shift);
+        }
+    }
+    if (_far) {
+        return ((_wheel_time >> _HORIZON_BITS) + 1) << _HORIZON_BITS;
+    }
+    return _NEVER;
+}
+
+/* cascades the slots that start at the current wheel tick */
+static void _process_tick(void)
+{
+    if ((_wheel_time & ((((uint64_t)1) << _HORIZON_BITS) - 1)) == 0) {
+        _readd(_detach(&_far));
+    }
+    for (unsigned level = XTIMER_WHEEL_LEVELS; level > 0; level--) {
+        unsigned shift = _SLOT_BITS * (level - 1);
+        unsigned slot;
+
+        if (_wheel_time & ((((uint64_t)1) << shift) - 1)) {
+            continue;
+        }
+        slot = (_wheel_time >> shift) & _SLOT_MASK;
+        if (_bitmap[level - 1] & (((uint32_t)1) << slot)) {
+            _bitmap[level - 1] &= ~(((uint32_t)1) << slot);
+            /* lands on a lower level or on the due list */
+            _readd(_detach(&_wheel[level - 1][slot]));
+        }
+    }
+}
+
+/* moves the wheel forward to tick, skipping empty slots */
+static void _advance(uint64_t tick)
+{
+    while (_wheel_time < tick) {
+        uint64_t next = _next_event();
+
+        if (next > tick) {
+            _wheel_time = tick;
+            break;
+        }
+        _wheel_time = next;
+        _process_tick();
+    }
+}
+
+/* moves the wheel forward to tick without cascading, so it can be used
+ * outside of _timer_callback(): stops short of the next non-empty slot */
+static void _catch_up(uint64_t tick)
+{
+    uint64_t next = _next_event();
+
+    if (next <= tick) {
+        tick = next - 1;
+    }
+    if (tick > _wheel_time) {
+        _wheel_time = tick;
+    }
+}
+
+/* returns the time the next timer needs attention */
+static uint64_t _next_deadline(void)
+{
+    uint64_t res = _next_event();
+
+    if (res != _NEVER) {
+        res <<= XTIMER_WHEEL_TICK_SHIFT;
+    }
+    if (_due && (_target64(_due) < res)) {
+        res = _target64(_due);
+    }
+    return res;
+}
+
+/* reprograms the low-level timer if the deadline changed */
+static void _update(void)
+{
+    uint64_t deadline;
+
+    if (_in_handler) {
+        /* _timer_callback() sets the low-level timer when done */
+        return;
+    }
+    deadline = _next_deadline();
+    if (deadline >= _period_end()) {
+        deadline = _NEVER;
+    }
+    if (deadline == _armed) {
+        return;
+    }
+    _armed = deadline;
+    if (deadline == _NEVER) {
+        _lltimer_set(_lltimer_mask(0xFFFFFFFF));
+    }
+    else {
+        /* the start of a slot can be closer than a timer itself */
+        uint64_t earliest = _period_start() + _lltimer_now() + XTIMER_OVERHEAD +
+                            XTIMER_BACKOFF;
+
+        if (deadline < earliest) {
+            deadline = earliest;
+        }
+        _lltimer_set(((uint32_t)deadline) - XTIMER_OVERHEAD);
+    }
+}
+
+void xtimer_init(void)
+{
+    /* initialize low-level timer */
+    timer_init(XTIMER, XTIMER_USEC_TO_TICKS(1000000ul), _periph_timer_callback, NULL);
+
+    /* register initial overflow tick */
+    _lltimer_set(0xFFFFFFFF);
+}
+
+static void _xtimer_now64(uint32_t *short_term, uint32_t *long_term)
+{
+    uint32_t before, after, long_value;
+
+    /* loop to cope with possible overflow of xtimer_now() */
+    do {
+        before = xtimer_now();
+        long_value = _long_cnt;
+        after = xtimer_now();
+
+    } while(before > after);
+
+    *short_term = after;
+    *long_term = long_value;
+}
+
+uint64_t xtimer_now64(void)
+{
+    uint32_t short_term, long_term;
+    _xtimer_now64(&short_term, &long_term);
+
+    return ((uint64_t)long_term<<32) + short_term;
+}
+
+void _xtimer_set64(xtimer_t *timer, uint32_t offset, uint32_t long_offset)
+{
+    DEBUG(" _xtimer_set64() offset=%" PRIu32 " long_offset=%" PRIu32 "\n", offset, long_offset);
+    if (!long_offset) {
+        /* timer fits into the short timer */
+        xtimer_set(timer, (uint32_t) offset);
+    }
+    else {
+        int state = irq_disable();
+        if (_is_set(timer)) {
+            _remove(timer);
+        }
+
+        _xtimer_now64(&timer->target, &timer->long_target);
+        timer->target += offset;
+        timer->long_target += long_offset;
+        if (timer->target < offset) {
+            timer->long_target++;
+        }
+
+        _add(timer);
+        irq_restore(state);
+        DEBUG("xtimer_set64(): added longterm timer (long_target=%" PRIu32 " target=%" PRIu32 ")\n",
+                timer->long_target, timer->target);
+    }
+}
+
+void xtimer_set(xtimer_t *timer, uint32_t offset)
+{
+    DEBUG("timer_set(): offset=%" PRIu32 " now=%" PRIu32 " (%" PRIu32 ")\n", offset, xtimer_now(), _lltimer_now());
+    if (!timer->callback) {
+        DEBUG("timer_set(): timer has no callback.\n");
+        return;
+    }
+
+    xtimer_remove(timer);
+
+    if (offset < XTIMER_BACKOFF) {
+        xtimer_spin(offset);
+        _shoot(timer);
+    }
+    else {
+        uint32_t target = xtimer_now() + offset;
+        _xtimer_set_absolute(timer, target);
+    }
+}
+
+static void _periph_timer_callback(void *arg, int chan)
+{
+    (void)arg;
+    (void)chan;
+    _timer_callback();
+}
+
+static void _shoot(xtimer_t *timer)
+{
+    timer->callback(timer->arg);
+}
+
+static inline void _lltimer_set(uint32_t target)
+{
+    if (_in_handler) {
+        return;
+    }
+    DEBUG("_lltimer_set(): setting %" PRIu32 "\n", _lltimer_mask(target));
+#ifdef XTIMER_SHIFT
+    target = XTIMER_USEC_TO_TICKS(target);
+    if (!target) {
+        target++;
+    }
+#endif
+    timer_set_absolute(XTIMER, XTIMER_CHAN, _lltimer_mask(target));
+}
+
+int _xtimer_set_absolute(xtimer_t *timer, uint32_t target)
+{
+    uint32_t now = xtimer_now();
+    int res = 0;
+
+    DEBUG("timer_set_absolute(): now=%" PRIu32 " target=%" PRIu32 "\n", now, target);
+
+    if ((target >= now) && ((target - XTIMER_BACKOFF) < now)) {
+        /* backoff */
+        xtimer_spin_until(target + XTIMER_BACKOFF);
+        _shoot(timer);
+        return 0;
+    }
+
+    unsigned state = irq_disable();
+    if (_is_set(timer)) {
+        _remove(timer);
+    }
+
+    timer->target = target;
+    timer->long_target = _long_cnt;
+    if (target < now) {
+        timer->long_target++;
+    }
+
+    _add(timer);
+
+    irq_restore(state);
+
+    return res;
+}
+
+static void _add(xtimer_t *timer)
+{
+    if (!_in_handler) {
+        /* the wheel lags behind if no timer needed attention for a while,
+         * so catch up before hashing a timer relative to it */
+        uint32_t short_term, long_term;
+
+        _xtimer_now64(&short_term, &long_term);
+        _catch_up(((((uint64_t)long_term) << 32) | short_term) >> XTIMER_WHEEL_TICK_SHIFT);
+    }
+    _add_to_wheel(timer);
+    _update();
+}
+
+static void _remove(xtimer_t *timer)
+{
+    _unlink(timer);
+    _update();
+}
+
+void xtimer_remove(xtimer_t *timer)
+{
+    int state = irq_disable();
+    if (_is_set(timer)) {
+        _remove(timer);
+    }
+    irq_restore(state);
+}
+
+static uint32_t _time_left(uint32_t target, uint32_t reference)
+{
+    uint32_t now = _lltimer_now();
+
+    if (now < reference) {
+        return 0;
+    }
+
+    if (target > now) {
+        return target - now;
+    }
+    else {
+        return 0;
+    }
+}
+
+/**
+ * @brief check if a due timer is close to expiring
+ */
+static inline int _is_expiring(xtimer_t *timer, uint32_t reference)
+{
+    uint64_t target = _target64(timer);
+
+    if (target < _period_start()) {
+        /* late */
+        return 1;
+    }
+    if (target >= _period_end()) {
+        return 0;
+    }
+    return _time_left(_lltimer_mask(timer->target), reference) < XTIMER_ISR_BACKOFF;
+}
+
+/**
+ * @brief handle low-level timer overflow, advance to next short timer period
+ */
+static void _next_period(void)
+{
+#if XTIMER_MASK
+    /* advance <32bit mask register */
+    _high_cnt += ~XTIMER_MASK_SHIFTED + 1;
+    if (! _high_cnt) {
+        /* high_cnt overflowed, so advance >32bit counter */
+        _long_cnt++;
+    }
+#else
+    /* advance >32bit counter */
+    _long_cnt++;
+#endif
+}
+
+/**
+ * @brief main xtimer callback function
+ */
+static void _timer_callback(void)
+{
+    uint64_t deadline;
+    uint32_t next_target;
+    uint32_t reference;
+
+    _in_handler = 1;
+
+    DEBUG("_timer_callback() now=%" PRIu32 " (%" PRIu32 ")pleft=%" PRIu32 "\n", xtimer_now(),
+            _lltimer_mask(xtimer_now()), _lltimer_mask(0xffffffff-xtimer_now()));
+
+    if (_armed == _NEVER) {
+        DEBUG("_timer_callback(): tick\n");
+        /* nothing needed attention in this timer period,
+         * so this was a timer overflow callback.
+         *
+         * In this case, we advance to the next timer period.
+         */
+        _next_period();
+
+        reference = 0;
+
+        /* make sure the timer counter also arrived
+         * in the next timer period */
+        while (_lltimer_now() == _lltimer_mask(0xFFFFFFFF));
+    }
+    else {
+        /* set our period reference to the current time. */
+        reference = _lltimer_now();
+    }
+
+overflow:
+    /* move timers that are about to expire to the due list; moving them
+     * early does no harm, they are sorted there */
+    _advance((_period_start() + _lltimer_now() + XTIMER_OVERHEAD +
+              XTIMER_ISR_BACKOFF) >> XTIMER_WHEEL_TICK_SHIFT);
+
+    /* check if next timers are close to expiring */
+    while (_due && _is_expiring(_due, reference)) {
+        /* pick first timer in list */
+        xtimer_t *timer = _due;
+
+        /* make sure we don't fire too early */
+        if (_target64(timer) >= _period_start()) {
+            while (_time_left(_lltimer_mask(timer->target), reference));
+        }
+
+        /* advance list */
+        _unlink(timer);
+
+        /* make sure timer is recognized as being already fired */
+        timer->target = 0;
+        timer->long_target = 0;
+
+        /* fire timer */
+        _shoot(timer);
+    }
+
+    /* possibly executing all callbacks took enough
+     * time to overflow.  In that case we advance to
+     * next timer period and check again for expired
+     * timers.*/
+    if (reference > _lltimer_now()) {
+        DEBUG("_timer_callback: overflowed while executing callbacks. %i\n", _due != 0);
+        _next_period();
+        reference = 0;
+        goto overflow;
+    }
+
+    deadline = _next_deadline();
+    if (deadline < _period_end()) {
+        /* schedule callback on next deadline */
+        next_target = ((uint32_t)deadline) - XTIMER_OVERHEAD;
+
+        /* make sure we're not setting a time in the past */
+        if ((deadline < _period_start()) ||
+            ((uint32_t)(deadline - _period_start()) <
+             (_lltimer_now() + XTIMER_OVERHEAD + XTIMER_ISR_BACKOFF))) {
+            goto overflow;
+        }
+    }
+    else {
+        /* there's no timer planned for this timer period */
+        /* schedule callback on next overflow */
+        deadline = _NEVER;
+        next_target = _lltimer_mask(0xFFFFFFFF);
+        uint32_t now = _lltimer_now();
+
+        /* check for overflow again */
+        if (now < reference) {
+            _next_period();
+            reference = 0;
+            goto overflow;
+        }
+        else {
+            /* check if the end of this period is very soon */
+            if (_lltimer_mask(now + XTIMER_ISR_BACKOFF) < now) {
+                /* spin until next period, then advance */
+                while (_lltimer_now() >= now);
+                _next_period();
+                reference = 0;
+                goto overflow;
+            }
+        }
+    }
+
+    _armed = deadline;
+    _in_handler = 0;
+
+    /* set low level timer */
+    _lltimer_set(next_target);
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measures packet throughput of GNRC over the IPv6 loopback
+ *
+ * @}
+ */
+
+#include <stdio.h>
+
+#include "msg.h"
+#include "thread.h"
+#include "xtimer.h"
+#include "net/af.h"
+#include "net/conn/udp.h"
+#include "net/gnrc/netapi.h"
+#include "net/gnrc/netreg.h"
+#include "net/gnrc/pktbuf.h"
+#include "net/ipv6/addr.h"
+
+#define TIMEOUT_S       (5ul)
+#define TIMEOUT         (TIMEOUT_S * SEC_IN_USEC)
+#define TEST_PORT       (61616U)
+#define PAYLOAD_SIZE    (32U)
+#define RCV_QUEUE_SIZE  (8U)
+
+static char _rcv_stack[THREAD_STACKSIZE_DEFAULT];
+static volatile unsigned long _received = 0;
+
+static void *_rcv_thread(void *arg)
+{
+    msg_t msg, msg_queue[RCV_QUEUE_SIZE];
+    gnrc_netreg_entry_t entry = GNRC_NETREG_ENTRY_INIT_PID(TEST_PORT, KERNEL_PID_UNDEF);
+
+    (void)arg;
+    msg_init_queue(msg_queue, RCV_QUEUE_SIZE);
+    entry.pid = thread_getpid();
+    gnrc_netreg_register(GNRC_NETTYPE_UDP, &entry);
+    while (1) {
+        msg_receive(&msg);
+        if (msg.type == GNRC_NETAPI_MSG_TYPE_RCV) {
+            _received++;
+            gnrc_pktbuf_release((gnrc_pktsnip_t *)msg.content.ptr);
+        }
+    }
+    return NULL;
+}
+
+static void _timeout(void *arg)
+{
+    *((volatile int *)arg) = 1;
+}
+
+int main(void)
+{
+    volatile int done = 0;
+    unsigned long sent = 0;
+    ipv6_addr_t dst = IPV6_ADDR_LOOPBACK;
+    uint8_t payload[PAYLOAD_SIZE] = { 0 };
+    xtimer_t timer = { .callback = _timeout, .arg = (void *)&done };
+
+    puts("Start.");
+#ifdef MODULE_GNRC_PKTBUF_STATIC_CACHE
+    puts("gnrc_pktbuf_static_cache: enabled");
+#else
+    puts("gnrc_pktbuf_static_cache: disabled");
+#endif
+    /* receiver runs with higher priority than the sender, so every packet
+     * passes the whole stack before the next one is sent */
+    thread_create(_rcv_stack, sizeof(_rcv_stack), THREAD_PRIORITY_MAIN - 1,
+                  THREAD_CREATE_STACKTEST, _rcv_thread, NULL, "rcv");
+    xtimer_set(&timer, TIMEOUT);
+    while (!done) {
+        if (conn_udp_sendto(payload, sizeof(payload), NULL, 0, &dst, sizeof(dst),
+                            AF_INET6, TEST_PORT, TEST_PORT) > 0) {
+            sent++;
+        }
+    }
+    printf("+ sent %lu packets, received %lu packets: %lu packets per second\n",
+           sent, _received, _received / TIMEOUT_S);
+    puts("Done.");
+    return 0;
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measures IPHC encoding with and without the flow cache and
+ *              IPHC decoding
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "xtimer.h"
+#include "net/gnrc/netif/hdr.h"
+#include "net/gnrc/pktbuf.h"
+#include "net/gnrc/sixlowpan/ctx.h"
+#include "net/gnrc/sixlowpan/iphc.h"
+#include "net/ipv6/hdr.h"
+#include "net/protnum.h"
+#include "net/udp.h"
+
+#define RUNS        (100U)
+#define IF_PID      (1)
+#define CTX_ID      (0)
+#define PAYLOAD     "ABCDEFGH"
+
+static const uint8_t _l2src[] = { 0x02, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x01 };
+static const uint8_t _l2dst[] = { 0x02, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x02 };
+/* IIDs derived from _l2src and _l2dst */
+static const ipv6_addr_t _ll_src = { {
+        0xfe, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x01
+    } };
+static const ipv6_addr_t _ll_dst = { {
+        0xfe, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x02
+    } };
+static const ipv6_addr_t _global_src = { {
+        0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x01
+    } };
+static const ipv6_addr_t _global_dst = { {
+        0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x02
+    } };
+
+static gnrc_pktsnip_t *_build_netif_hdr(void)
+{
+    gnrc_pktsnip_t *netif = gnrc_netif_hdr_build((uint8_t *)_l2src, sizeof(_l2src),
+                                                 (uint8_t *)_l2dst, sizeof(_l2dst));
+
+    if (netif != NULL) {
+        ((gnrc_netif_hdr_t *)netif->data)->if_pid = IF_PID;
+    }
+    return netif;
+}
+
+/* netif header -> IPv6 header -> UDP header -> payload, as sent by UDP */
+static gnrc_pktsnip_t *_build_udp_pkt(const ipv6_addr_t *src, const ipv6_addr_t *dst)
+{
+    gnrc_pktsnip_t *pkt, *netif;
+    ipv6_hdr_t *ipv6_hdr;
+    udp_hdr_t *udp_hdr;
+
+    if ((pkt = gnrc_pktbuf_add(NULL, PAYLOAD, sizeof(PAYLOAD) - 1,
+                               GNRC_NETTYPE_UNDEF)) == NULL) {
+        return NULL;
+    }
+    if ((pkt = gnrc_pktbuf_add(pkt, NULL, sizeof(udp_hdr_t),
+                               GNRC_NETTYPE_UNDEF)) == NULL) {
+        return NULL;
+    }
+    udp_hdr = pkt->data;
+    udp_hdr->src_port = byteorder_htons(0xf0b1);
+    udp_hdr->dst_port = byteorder_htons(0xf0b2);
+    udp_hdr->length = byteorder_htons(gnrc_pkt_len(pkt));
+    udp_hdr->checksum = byteorder_htons(0xabcd);
+    if ((pkt = gnrc_pktbuf_add(pkt, NULL, sizeof(ipv6_hdr_t),
+                               GNRC_NETTYPE_UNDEF)) == NULL) {
+        return NULL;
+    }
+    ipv6_hdr = pkt->data;
+    memset(ipv6_hdr, 0, sizeof(ipv6_hdr_t));
+    ipv6_hdr_set_version(ipv6_hdr);
+    ipv6_hdr->len = byteorder_htons(gnrc_pkt_len(pkt->next));
+    ipv6_hdr->nh = PROTNUM_UDP;
+    ipv6_hdr->hl = 64;
+    ipv6_hdr->src = *src;
+    ipv6_hdr->dst = *dst;
+    if ((netif = _build_netif_hdr()) == NULL) {
+        return NULL;
+    }
+    netif->next = pkt;
+    return netif;
+}
+
+static int _benchmark(const char *name, const ipv6_addr_t *src,
+                      const ipv6_addr_t *dst)
+{
+    uint8_t frame[64];
+    uint32_t uncached = 0, cached = 0, decode = 0;
+    size_t len = 0;
+    gnrc_pktsnip_t *pkt;
+
+    for (unsigned i = 0; i < (2 * RUNS); i++) {
+        bool flush = (i < RUNS);
+        uint32_t start;
+
+        if ((pkt = _build_udp_pkt(src, dst)) == NULL) {
+            return -1;
+        }
+        if (flush) {
+            /* changing the contexts makes the encoder derive everything anew */
+            gnrc_sixlowpan_ctx_update(CTX_ID, &_global_src, 64, 60, false);
+            gnrc_sixlowpan_ctx_update(CTX_ID, &_global_src, 64, 60, true);
+        }
+        start = xtimer_now();
+        if (!gnrc_sixlowpan_iphc_encode(pkt)) {
+            gnrc_pktbuf_release(pkt);
+            return -1;
+        }
+        if (flush) {
+            uncached += xtimer_now() - start;
+        }
+        else {
+            cached += xtimer_now() - start;
+        }
+        if (i == ((2 * RUNS) - 1)) {
+            /* keep the last frame to decode it */
+            for (gnrc_pktsnip_t *snip = pkt->next; snip != NULL; snip = snip->next) {
+                memcpy(frame + len, snip->data, snip->size);
+                len += snip->size;
+            }
+        }
+        gnrc_pktbuf_release(pkt);
+    }
+    for (unsigned i = 0; i < RUNS; i++) {
+        gnrc_pktsnip_t *dec_hdr = gnrc_pktbuf_add(NULL, NULL, sizeof(ipv6_hdr_t),
+                                                  GNRC_NETTYPE_IPV6);
+        size_t nh_len = 0;
+        uint32_t start;
+        size_t res;
+
+        pkt = gnrc_pktbuf_add(_build_netif_hdr(), frame, len, GNRC_NETTYPE_SIXLOWPAN);
+        if ((pkt == NULL) || (dec_hdr == NULL)) {
+            return -1;
+        }
+        start = xtimer_now();
+        res = gnrc_sixlowpan_iphc_decode(&dec_hdr, pkt, 0, 0, &nh_len);
+        decode += xtimer_now() - start;
+        gnrc_pktbuf_release(dec_hdr);
+        gnrc_pktbuf_release(pkt);
+        if (res == 0) {
+            return -1;
+        }
+    }
+    printf("%s: encode %" PRIu32 " us (cached %" PRIu32 " us), "
+           "decode %" PRIu32 " us per %u packets\n", name, uncached, cached,
+           decode, RUNS);
+    return 0;
+}
+
+int main(void)
+{
+    puts("Start.");
+    if ((_benchmark("link-local", &_ll_src, &_ll_dst) < 0) ||
+        (_benchmark("context 0", &_global_src, &_global_dst) < 0)) {
+        puts("error: unable to encode or decode");
+        return 1;
+    }
+    puts("Done.");
+    return 0;
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Throughput test for GNRC's TCP
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "net/af.h"
+#include "net/conn/tcp.h"
+#include "net/gnrc/conn.h"
+#include "net/ipv6/addr.h"
+#include "shell.h"
+#include "thread.h"
+#include "xtimer.h"
+
+#define BUF_SIZE        (512U)
+#define LOOPBACK_PORT   (8000U)
+
+static conn_tcp_t listener, conn, client;
+static uint8_t rcv_buf[BUF_SIZE], snd_buf[BUF_SIZE];
+static char loopback_stack[THREAD_STACKSIZE_DEFAULT];
+
+static void _print_rate(uint32_t bytes, uint32_t start)
+{
+    uint32_t duration = xtimer_now() - start;
+
+    if (duration == 0) {
+        duration = 1;
+    }
+    printf("%" PRIu32 " bytes in %" PRIu32 " us: %" PRIu32 " bytes/s\n",
+           bytes, duration,
+           (uint32_t)(((uint64_t)bytes * 1000000U) / duration));
+}
+
+static int _listen(uint16_t port)
+{
+    ipv6_addr_t unspec = IPV6_ADDR_UNSPECIFIED;
+    uint32_t bytes = 0, start;
+    int res;
+
+    if ((res = conn_tcp_create(&listener, &unspec, sizeof(unspec), AF_INET6,
+                               port)) < 0) {
+        printf("error: unable to create connection (%d)\n", res);
+        return 1;
+    }
+    if ((res = conn_tcp_listen(&listener, 1)) < 0) {
+        printf("error: unable to listen (%d)\n", res);
+        conn_tcp_close(&listener);
+        return 1;
+    }
+    printf("listening on port %u\n", (unsigned)port);
+    if ((res = conn_tcp_accept(&listener, &conn)) < 0) {
+        printf("error: unable to accept (%d)\n", res);
+        conn_tcp_close(&listener);
+        return 1;
+    }
+    puts("connected");
+    start = xtimer_now();
+    while ((res = conn_tcp_recv(&conn, rcv_buf, sizeof(rcv_buf))) > 0) {
+        bytes += res;
+    }
+    if (res < 0) {
+        printf("error: connection failed (%d)\n", res);
+    }
+    _print_rate(bytes, start);
+    conn_tcp_close(&conn);
+    conn_tcp_close(&listener);
+    return (res < 0) ? 1 : 0;
+}
+
+static int _send(const char *addr_str, uint16_t port, uint32_t bytes)
+{
+    ipv6_addr_t unspec = IPV6_ADDR_UNSPECIFIED, addr;
+    uint32_t sent = 0, start;
+    int res;
+
+    if (ipv6_addr_from_str(&addr, addr_str) == NULL) {
+        puts("error: unable to parse destination address");
+        return 1;
+    }
+    if ((res = conn_tcp_create(&client, &unspec, sizeof(unspec), AF_INET6,
+                               (uint16_t)(49152 + (xtimer_now() % 16384)))) < 0) {
+        printf("error: unable to create connection (%d)\n", res);
+        return 1;
+    }
+    if ((res = conn_tcp_connect(&client, &addr, sizeof(addr), port)) < 0) {
+        printf("error: unable to connect (%d)\n", res);
+        conn_tcp_close(&client);
+        return 1;
+    }
+    puts("connected");
+    for (unsigned i = 0; i < sizeof(snd_buf); i++) {
+        snd_buf[i] = (uint8_t)i;
+    }
+    start = xtimer_now();
+    while (sent < bytes) {
+        size_t len = ((bytes - sent) < sizeof(snd_buf)) ? (bytes - sent)
+                                                        : sizeof(snd_buf);
+
+        if ((res = conn_tcp_send(&client, snd_buf, len)) < 0) {
+            printf("error: connection failed (%d)\n", res);
+            break;
+        }
+        sent += res;
+    }
+    /* returns when everything is acknowledged */
+    conn_tcp_close(&client);
+    _print_rate(sent, start);
+    return (res < 0) ? 1 : 0;
+}
+
+static void *_loopback_thread(void *arg)
+{
+    (void)arg;
+    _listen(LOOPBACK_PORT);
+    return NULL;
+}
+
+static int _loopback(uint32_t bytes)
+{
+    /* runs until it waits for the connection */
+    thread_create(loopback_stack, sizeof(loopback_stack),
+                  THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST,
+                  _loopback_thread, NULL, "tcp listen");
+    return _send("::1", LOOPBACK_PORT, bytes);
+}
+
+static int _tcp_cmd(int argc, char **argv)
+{
+    if ((argc == 3) && (strcmp(argv[1], "listen") == 0)) {
+        return _listen((uint16_t)atoi(argv[2]));
+    }
+    if ((argc == 5) && (strcmp(argv[1], "send") == 0)) {
+        return _send(argv[2], (uint16_t)atoi(argv[3]),
+                     (uint32_t)strtoul(argv[4], NULL, 10));
+    }
+    if ((argc == 3) && (strcmp(argv[1], "loopback") == 0)) {
+        return _loopback((uint32_t)strtoul(argv[2], NULL, 10));
+    }
+    printf("usage: %s listen <port>\n", argv[0]);
+    printf("       %s send <addr> <port> <bytes>\n", argv[0]);
+    printf("       %s loopback <bytes>\n", argv[0]);
+    return 1;
+}
+
+static const shell_command_t shell_commands[] = {
+    { "tcp", "receive or send a TCP stream and print the throughput", _tcp_cmd },
+    { NULL, NULL, NULL }
+};
+
+int main(void)
+{
+    char line_buf[SHELL_DEFAULT_BUFSIZE];
+
+    puts("GNRC TCP throughput test");
+    shell_run(shell_commands, line_buf, SHELL_DEFAULT_BUFSIZE);
+
+    /* should be never reached */
+    return 0;
+}
@@ -0,0 +1,31 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2016 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import os
+import sys
+
+sys.path.append(os.path.join(os.environ['RIOTBASE'], 'dist/tools/testrunner'))
+import testrunner
+
+BYTES = 100000
+
+def testfunc(child):
+    child.expect_exact("GNRC TCP throughput test")
+    child.sendline("tcp loopback %d" % BYTES)
+    child.expect_exact("listening on port 8000")
+    child.expect_exact("connected")
+    child.expect_exact("connected")
+    # the receiver sees the end of the stream first, then the sender's close
+    # returns
+    for _ in range(2):
+        child.expect(r"(\d+) bytes in \d+ us: (\d+) bytes/s")
+        assert int(child.match.group(1)) == BYTES
+        print("%s bytes/s" % child.match.group(2))
+
+if __name__ == "__main__":
+    sys.exit(testrunner.run(testfunc))
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measures uncontended mutex latency and the latency of a
+ *              priority inversion scenario
+ *
+ * @}
+ */
+
+#include <stdio.h>
+
+#include "mutex.h"
+#include "thread.h"
+#include "xtimer.h"
+
+#define REPEAT      (10000U)
+#define MID_DELAY   (10U * MS_IN_USEC)  /* mid starts hogging the CPU */
+#define HIGH_DELAY  (11U * MS_IN_USEC)  /* high tries to take the mutex */
+#define HOLD        (20U * MS_IN_USEC)  /* low holds the mutex this long */
+#define HOG         (50U * MS_IN_USEC)  /* mid hogs the CPU this long */
+#define SETTLE      (200U * MS_IN_USEC)
+
+static char stack_low[THREAD_STACKSIZE_DEFAULT];
+static char stack_mid[THREAD_STACKSIZE_DEFAULT];
+static char stack_high[THREAD_STACKSIZE_DEFAULT];
+
+static mutex_t lock = MUTEX_INIT;
+static uint32_t high_wait;
+
+static void *_low(void *arg)
+{
+    (void)arg;
+    mutex_lock(&lock);
+    xtimer_spin(HOLD);
+    mutex_unlock(&lock);
+    return NULL;
+}
+
+static void *_mid(void *arg)
+{
+    (void)arg;
+    xtimer_usleep(MID_DELAY);
+    xtimer_spin(HOG);
+    return NULL;
+}
+
+static void *_high(void *arg)
+{
+    (void)arg;
+    xtimer_usleep(HIGH_DELAY);
+
+    uint32_t start = xtimer_now();
+
+    mutex_lock(&lock);
+    high_wait = xtimer_now() - start;
+    mutex_unlock(&lock);
+    return NULL;
+}
+
+int main(void)
+{
+    puts("mutex benchmark");
+#ifdef MODULE_CORE_MUTEX_PI
+    puts("priority inheritance: on");
+#else
+    puts("priority inheritance: off");
+#endif
+
+    uint32_t start = xtimer_now();
+
+    for (unsigned i = 0; i < REPEAT; i++) {
+        mutex_lock(&lock);
+        mutex_unlock(&lock);
+    }
+    printf("lock/unlock: %lu ns\n",
+           (unsigned long)(((xtimer_now() - start) * 1000UL) / REPEAT));
+
+    /* high and mid go to sleep first, then low takes the mutex */
+    thread_create(stack_high, sizeof(stack_high), THREAD_PRIORITY_MAIN - 3,
+                  THREAD_CREATE_STACKTEST, _high, NULL, "high");
+    thread_create(stack_mid, sizeof(stack_mid), THREAD_PRIORITY_MAIN - 2,
+                  THREAD_CREATE_STACKTEST, _mid, NULL, "mid");
+    thread_create(stack_low, sizeof(stack_low), THREAD_PRIORITY_MAIN - 1,
+                  THREAD_CREATE_STACKTEST, _low, NULL, "low");
+
+    xtimer_usleep(SETTLE);
+    printf("priority inversion: high waited %lu us\n", (unsigned long)high_wait);
+    puts("done");
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measures the deadline miss rate of periodic threads with and
+ *              without background network load
+ *
+ * @}
+ */
+
+#include <stdio.h>
+
+#include "net/gnrc.h"
+#include "net/gnrc/ipv6.h"
+#include "net/gnrc/udp.h"
+#include "thread.h"
+#include "thread_periodic.h"
+#include "xtimer.h"
+
+#define TASK_NUMOF  (3U)
+#define PHASE       (5U * SEC_IN_USEC)
+#define LOAD_PORT   (0xf0b0)
+
+typedef struct {
+    uint32_t period;
+    uint32_t exec;
+} task_t;
+
+static const task_t tasks[TASK_NUMOF] = {
+    { .period = 2000U, .exec = 300U },
+    { .period = 5000U, .exec = 1000U },
+    { .period = 10000U, .exec = 2000U },
+};
+
+static thread_periodic_t periodic[TASK_NUMOF];
+static char stacks[TASK_NUMOF][THREAD_STACKSIZE_DEFAULT];
+static char load_stack[THREAD_STACKSIZE_DEFAULT];
+static volatile int load;
+
+static void _job(void *arg)
+{
+    const task_t *task = arg;
+
+    xtimer_spin(task->exec);
+}
+
+static void *_load(void *arg)
+{
+    ipv6_addr_t dst = IPV6_ADDR_ALL_NODES_LINK_LOCAL;
+    static char data[] = "background load";
+
+    (void)arg;
+    while (1) {
+        gnrc_pktsnip_t *payload, *udp, *ip;
+
+        if (!load) {
+            xtimer_usleep(10U * MS_IN_USEC);
+            continue;
+        }
+        payload = gnrc_pktbuf_add(NULL, data, sizeof(data), GNRC_NETTYPE_UNDEF);
+        if (payload == NULL) {
+            thread_yield();
+            continue;
+        }
+        udp = gnrc_udp_hdr_build(payload, LOAD_PORT, LOAD_PORT);
+        if (udp == NULL) {
+            gnrc_pktbuf_release(payload);
+            thread_yield();
+            continue;
+        }
+        ip = gnrc_ipv6_hdr_build(udp, NULL, &dst);
+        if (ip == NULL) {
+            gnrc_pktbuf_release(udp);
+            thread_yield();
+            continue;
+        }
+        if (!gnrc_netapi_dispatch_send(GNRC_NETTYPE_UDP,
+                                       GNRC_NETREG_DEMUX_CTX_ALL, ip)) {
+            gnrc_pktbuf_release(ip);
+        }
+        thread_yield();
+    }
+
+    return NULL;
+}
+
+static void _phase(const char *name)
+{
+    for (unsigned i = 0; i < TASK_NUMOF; i++) {
+        periodic[i].jobs = 0;
+        periodic[i].deadline_misses = 0;
+        periodic[i].budget_overruns = 0;
+    }
+    xtimer_usleep(PHASE);
+    printf("%s\n", name);
+    puts("period [us] | jobs | deadline misses [permille] | budget overruns");
+    for (unsigned i = 0; i < TASK_NUMOF; i++) {
+        unsigned jobs = periodic[i].jobs;
+        unsigned misses = periodic[i].deadline_misses;
+
+        printf("%11lu | %4u | %4u (%4u) | %4u\n",
+               (unsigned long)periodic[i].period, jobs, misses,
+               (jobs + misses) ? (misses * 1000U) / (jobs + misses) : 0,
+               periodic[i].budget_overruns);
+    }
+}
+
+int main(void)
+{
+    puts("periodic thread test");
+
+    thread_create(load_stack, sizeof(load_stack), THREAD_PRIORITY_MAIN + 1,
+                  THREAD_CREATE_STACKTEST, _load, NULL, "load");
+    for (unsigned i = 0; i < TASK_NUMOF; i++) {
+        thread_create_periodic(&periodic[i], stacks[i], sizeof(stacks[i]),
+                               tasks[i].period, 2 * tasks[i].exec, _job,
+                               (void *)&tasks[i], "periodic");
+    }
+
+    _phase("without load");
+    load = 1;
+    _phase("with gnrc load");
+    load = 0;
+    puts("done");
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+#include <stdint.h>
+#include <string.h>
+
+#include "embUnit.h"
+
+#include "chan.h"
+#include "msg.h"
+#include "thread.h"
+#include "thread_flags.h"
+
+#include "tests-core_chan.h"
+
+#define TEST_CHAN_SIZE  (64U)
+#define TEST_CHAN_FLAG  (0x1)
+
+static chan_t chan;
+static uint32_t buf[TEST_CHAN_SIZE / sizeof(uint32_t)];
+
+static void set_up(void)
+{
+    chan_init(&chan, buf, sizeof(buf), thread_getpid(), TEST_CHAN_FLAG);
+    thread_flags_clear(TEST_CHAN_FLAG);
+}
+
+static int _put(const char *data, size_t len)
+{
+    void *rec = chan_try_reserve(&chan, len);
+
+    if (rec == NULL) {
+        return 0;
+    }
+    memcpy(rec, data, len);
+    chan_commit(&chan, len);
+    return 1;
+}
+
+static void test_chan_empty(void)
+{
+    size_t len;
+
+    TEST_ASSERT_NULL(chan_try_peek(&chan, &len));
+}
+
+static void test_chan_commit_and_peek(void)
+{
+    size_t len;
+    char *rec;
+
+    TEST_ASSERT_EQUAL_INT(1, _put("abcde", 5));
+    TEST_ASSERT_EQUAL_INT(TEST_CHAN_FLAG, thread_flags_clear(TEST_CHAN_FLAG));
+    rec = chan_try_peek(&chan, &len);
+    TEST_ASSERT_NOT_NULL(rec);
+    TEST_ASSERT_EQUAL_INT(5, len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp("abcde", rec, len));
+    TEST_ASSERT_EQUAL_INT(0, ((uintptr_t)rec) % CHAN_ALIGN);
+    /* peek does not consume */
+    TEST_ASSERT(rec == chan_try_peek(&chan, &len));
+    chan_release(&chan);
+    TEST_ASSERT_NULL(chan_try_peek(&chan, &len));
+}
+
+static void test_chan_commit_shorter(void)
+{
+    size_t len;
+    char *rec = chan_try_reserve(&chan, 16);
+
+    TEST_ASSERT_NOT_NULL(rec);
+    memcpy(rec, "xy", 2);
+    chan_commit(&chan, 2);
+    TEST_ASSERT(rec == chan_try_peek(&chan, &len));
+    TEST_ASSERT_EQUAL_INT(2, len);
+}
+
+static void test_chan_full(void)
+{
+    size_t len;
+
+    /* every record takes CHAN_HDR_SIZE + 12 bytes */
+    for (unsigned i = 0; i < (TEST_CHAN_SIZE / (CHAN_HDR_SIZE + 12)); i++) {
+        TEST_ASSERT_EQUAL_INT(1, _put("0123456789ab", 12));
+    }
+    TEST_ASSERT_EQUAL_INT(0, _put("0123456789ab", 12));
+    TEST_ASSERT_NOT_NULL(chan_try_peek(&chan, &len));
+    chan_release(&chan);
+    TEST_ASSERT_EQUAL_INT(1, _put("0123456789ab", 12));
+}
+
+static void test_chan_too_big(void)
+{
+    TEST_ASSERT_NULL(chan_try_reserve(&chan, TEST_CHAN_SIZE));
+    TEST_ASSERT_NOT_NULL(chan_try_reserve(&chan, TEST_CHAN_SIZE - CHAN_HDR_SIZE));
+}
+
+static void test_chan_wrap(void)
+{
+    size_t len;
+    char *rec;
+
+    /* 3 * 20 bytes leave 4 bytes at the end of the buffer */
+    for (unsigned i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(1, _put("0123456789abcdef", 16));
+    }
+    /* does not fit before the consumer made space */
+    TEST_ASSERT_EQUAL_INT(0, _put("ABCDEFGH", 8));
+    chan_try_peek(&chan, &len);
+    chan_release(&chan);
+    TEST_ASSERT_EQUAL_INT(1, _put("ABCDEFGH", 8));
+    for (unsigned i = 0; i < 2; i++) {
+        rec = chan_try_peek(&chan, &len);
+        TEST_ASSERT_EQUAL_INT(16, len);
+        TEST_ASSERT_EQUAL_INT(0, memcmp("0123456789abcdef", rec, len));
+        chan_release(&chan);
+    }
+    /* record is contiguous at the start of the buffer */
+    rec = chan_try_peek(&chan, &len);
+    TEST_ASSERT(rec == ((char *)buf) + CHAN_HDR_SIZE);
+    TEST_ASSERT_EQUAL_INT(8, len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp("ABCDEFGH", rec, len));
+    chan_release(&chan);
+    TEST_ASSERT_NULL(chan_try_peek(&chan, &len));
+}
+
+static void test_msg_waiting_cleared(void)
+{
+    static msg_t queue[2];
+    msg_t msg = { .type = 0 };
+    thread_t *me = (thread_t *)sched_active_thread;
+
+    msg_init_queue(queue, 2);
+    thread_flags_clear(THREAD_FLAG_MSG_WAITING);
+    TEST_ASSERT_EQUAL_INT(1, msg_send_to_self(&msg));
+    TEST_ASSERT_EQUAL_INT(1, msg_send_to_self(&msg));
+    TEST_ASSERT(me->flags & THREAD_FLAG_MSG_WAITING);
+    TEST_ASSERT_EQUAL_INT(1, msg_try_receive(&msg));
+    TEST_ASSERT(me->flags & THREAD_FLAG_MSG_WAITING);
+    /* an empty queue must not wake up a thread waiting for messages */
+    TEST_ASSERT_EQUAL_INT(1, msg_receive(&msg));
+    TEST_ASSERT_EQUAL_INT(0, me->flags & THREAD_FLAG_MSG_WAITING);
+    TEST_ASSERT_EQUAL_INT(-1, msg_try_receive(&msg));
+}
+
+Test *tests_core_chan_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_chan_empty),
+        new_TestFixture(test_chan_commit_and_peek),
+        new_TestFixture(test_chan_commit_shorter),
+        new_TestFixture(test_chan_full),
+        new_TestFixture(test_chan_too_big),
+        new_TestFixture(test_chan_wrap),
+        new_TestFixture(test_msg_waiting_cleared),
+    };
+
+    EMB_UNIT_TESTCALLER(core_chan_tests, set_up, NULL, fixtures);
+
+    return (Test *)&core_chan_tests;
+}
+
+void tests_core_chan(void)
+{
+    TESTS_RUN(tests_core_chan_tests());
+}
+/** @} */
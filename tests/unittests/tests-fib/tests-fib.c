@@ -976,6 +976,102 @@ static void test_fib_20_replace_prefix(void)
     fib_deinit(&test_fib_table);
 }
 
+/*
+* @brief testing that the longest of nested prefixes matches,
+*        regardless of the order of adding and removing them
+*/
+static void test_fib_21_longest_prefix_match(void)
+{
+    size_t add_buf_size = 16;
+    uint8_t addr_dst[add_buf_size];
+    uint8_t addr_nxt[add_buf_size];
+    uint8_t addr_lookup[add_buf_size];
+    kernel_pid_t iface_id = KERNEL_PID_UNDEF;
+    uint32_t next_hop_flags = 0;
+    /* prefix lengths in the order of adding, 0 is the default route */
+    size_t prefix_lens[] = { 48, 0, 32, 64, 56 };
+    /* prefix lengths in the order of removing, longest first */
+    size_t remove_lens[] = { 64, 56, 48, 32, 0 };
+
+    memset(addr_lookup, 0, add_buf_size);
+    for (size_t i = 0; i < 8; i++) {
+        addr_lookup[i] = i + 1;
+    }
+    addr_lookup[15] = 0x42;
+
+    for (size_t i = 0; i < sizeof(prefix_lens) / sizeof(prefix_lens[0]); i++) {
+        memset(addr_dst, 0, add_buf_size);
+        memcpy(addr_dst, addr_lookup, prefix_lens[i] / 8);
+        memset(addr_nxt, prefix_lens[i], add_buf_size);
+
+        TEST_ASSERT_EQUAL_INT(0, fib_add_entry(&test_fib_table, 42, addr_dst, add_buf_size,
+                                               (prefix_lens[i] << FIB_FLAG_NET_PREFIX_SHIFT),
+                                               addr_nxt, add_buf_size, 0x23, 100000));
+    }
+
+    for (size_t i = 0; i < sizeof(remove_lens) / sizeof(remove_lens[0]); i++) {
+        add_buf_size = 16;
+        memset(addr_nxt, 0xff, add_buf_size);
+
+        TEST_ASSERT_EQUAL_INT(0, fib_get_next_hop(&test_fib_table, &iface_id,
+                                                  addr_nxt, &add_buf_size, &next_hop_flags,
+                                                  addr_lookup, add_buf_size, 0x123));
+        TEST_ASSERT_EQUAL_INT(remove_lens[i], addr_nxt[0]);
+
+        memset(addr_dst, 0, add_buf_size);
+        memcpy(addr_dst, addr_lookup, remove_lens[i] / 8);
+        fib_remove_entry(&test_fib_table, addr_dst, add_buf_size);
+    }
+
+    add_buf_size = 16;
+    TEST_ASSERT_EQUAL_INT(-EHOSTUNREACH, fib_get_next_hop(&test_fib_table, &iface_id,
+                                                          addr_nxt, &add_buf_size,
+                                                          &next_hop_flags, addr_lookup,
+                                                          add_buf_size, 0x123));
+    TEST_ASSERT_EQUAL_INT(0, fib_get_num_used_entries(&test_fib_table));
+
+    fib_deinit(&test_fib_table);
+}
+
+/*
+* @brief testing that changes to the table change its generation
+* and lookups do not
+*/
+static void test_fib_22_gen(void)
+{
+    size_t add_buf_size = 16;
+    char addr_dst[] = "Test address221";
+    char addr_nxt[] = "Test address222";
+    char addr_lookup[add_buf_size];
+    size_t lookup_size = add_buf_size;
+    kernel_pid_t iface_id = KERNEL_PID_UNDEF;
+    uint32_t next_hop_flags = 0;
+    uint32_t gen = fib_get_gen(&test_fib_table);
+
+    TEST_ASSERT_EQUAL_INT(0, fib_add_entry(&test_fib_table, 42, (uint8_t *)addr_dst,
+                                           add_buf_size - 1, 0x12, (uint8_t *)addr_nxt,
+                                           add_buf_size - 1, 0x21, 100000));
+    TEST_ASSERT(gen != fib_get_gen(&test_fib_table));
+    gen = fib_get_gen(&test_fib_table);
+
+    TEST_ASSERT_EQUAL_INT(0, fib_get_next_hop(&test_fib_table, &iface_id,
+                                              (uint8_t *)addr_lookup, &lookup_size,
+                                              &next_hop_flags, (uint8_t *)addr_dst,
+                                              add_buf_size - 1, 0x12));
+    TEST_ASSERT_EQUAL_INT(gen, fib_get_gen(&test_fib_table));
+
+    TEST_ASSERT_EQUAL_INT(0, fib_update_entry(&test_fib_table, (uint8_t *)addr_dst,
+                                              add_buf_size - 1, (uint8_t *)addr_dst,
+                                              add_buf_size - 1, 0x21, 100000));
+    TEST_ASSERT(gen != fib_get_gen(&test_fib_table));
+    gen = fib_get_gen(&test_fib_table);
+
+    fib_remove_entry(&test_fib_table, (uint8_t *)addr_dst, add_buf_size - 1);
+    TEST_ASSERT(gen != fib_get_gen(&test_fib_table));
+
+    fib_deinit(&test_fib_table);
+}
+
 Test *tests_fib_tests(void)
 {
     fib_init(&test_fib_table);
@@ -1000,6 +1096,8 @@ Test *tests_fib_tests(void)
                         new_TestFixture(test_fib_18_get_next_hop_invalid_parameters),
                         new_TestFixture(test_fib_19_default_gateway),
                         new_TestFixture(test_fib_20_replace_prefix),
+                        new_TestFixture(test_fib_21_longest_prefix_match),
+                        new_TestFixture(test_fib_22_gen),
     };
 
     EMB_UNIT_TESTCALLER(fib_tests, NULL, NULL, fixtures);
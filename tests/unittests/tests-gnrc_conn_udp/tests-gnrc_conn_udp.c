@@ -0,0 +1,322 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ *
+ * Received datagrams are dispatched to the connection directly, sent ones are
+ * taken by this thread in place of the UDP thread.
+ */
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "embUnit.h"
+
+#include "byteorder.h"
+#include "msg.h"
+#include "thread.h"
+#include "net/af.h"
+#include "net/conn/udp.h"
+#include "net/gnrc.h"
+#include "net/gnrc/conn.h"
+#include "net/ipv6/hdr.h"
+#include "net/udp.h"
+
+#include "tests-gnrc_conn_udp.h"
+
+#define TEST_LOCAL_PORT     (5683U)
+#define TEST_PEER_PORT      (61616U)
+#define TEST_DATA_LEN       (32U)
+#define TEST_MSG_QUEUE_SIZE (8U)
+#define TEST_MSG_TYPE_FILL  (0x7fffU)
+
+static const ipv6_addr_t _local = IPV6_ADDR_UNSPECIFIED;
+static const ipv6_addr_t _peer = { {
+        0xfe, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02
+    } };
+
+static msg_t _msg_queue[TEST_MSG_QUEUE_SIZE];
+static gnrc_netreg_entry_t _udp_entry = GNRC_NETREG_ENTRY_INIT_PID(GNRC_NETREG_DEMUX_CTX_ALL,
+                                                                KERNEL_PID_UNDEF);
+static conn_udp_t _conn;
+static uint8_t _data[TEST_DATA_LEN + 1];
+static uint8_t _large[TEST_DATA_LEN + 1];
+static uint8_t _bufs[GNRC_NETAPI_BATCH_SIZE + 1][TEST_DATA_LEN];
+static ipv6_addr_t _addrs[GNRC_NETAPI_BATCH_SIZE + 1];
+static conn_udp_dgram_t _dgrams[GNRC_NETAPI_BATCH_SIZE + 1];
+static unsigned _batch_pkts;
+
+/* puts a datagram of the peer into the connection's mailbox */
+static void _inject(uint16_t sport, const void *data, size_t len)
+{
+    ipv6_hdr_t ipv6;
+    udp_hdr_t udp;
+    gnrc_pktsnip_t *pkt;
+
+    memset(&ipv6, 0, sizeof(ipv6));
+    ipv6_hdr_set_version(&ipv6);
+    ipv6.len = byteorder_htons(sizeof(udp) + len);
+    ipv6.nh = PROTNUM_UDP;
+    memcpy(&ipv6.src, &_peer, sizeof(ipv6_addr_t));
+    udp.src_port = byteorder_htons(sport);
+    udp.dst_port = byteorder_htons(TEST_LOCAL_PORT);
+    udp.length = byteorder_htons(sizeof(udp) + len);
+    udp.checksum = byteorder_htons(0);
+    pkt = gnrc_pktbuf_add(NULL, &ipv6, sizeof(ipv6), GNRC_NETTYPE_IPV6);
+    pkt = gnrc_pktbuf_add(pkt, &udp, sizeof(udp), GNRC_NETTYPE_UDP);
+    pkt = gnrc_pktbuf_add(pkt, (void *)data, len, GNRC_NETTYPE_UNDEF);
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_UDP, TEST_LOCAL_PORT,
+                                                          pkt));
+}
+
+/* checks a datagram the connection passed to the UDP thread */
+static void _check_sent(gnrc_pktsnip_t *pkt, uint16_t dport, const void *data, size_t len)
+{
+    gnrc_pktsnip_t *ipv6 = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_IPV6);
+    gnrc_pktsnip_t *udp = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_UDP);
+
+    TEST_ASSERT_NOT_NULL(ipv6);
+    TEST_ASSERT_NOT_NULL(udp);
+    TEST_ASSERT(ipv6_addr_equal(&_peer, &((ipv6_hdr_t *)ipv6->data)->dst));
+    TEST_ASSERT_EQUAL_INT(TEST_LOCAL_PORT,
+                          byteorder_ntohs(((udp_hdr_t *)udp->data)->src_port));
+    TEST_ASSERT_EQUAL_INT(dport, byteorder_ntohs(((udp_hdr_t *)udp->data)->dst_port));
+    TEST_ASSERT_NOT_NULL(udp->next);
+    TEST_ASSERT_EQUAL_INT(len, udp->next->size);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, udp->next->data, len));
+}
+
+static void _count_batch(gnrc_pktsnip_t *pkt, void *arg)
+{
+    (void)arg;
+    _check_sent(pkt, TEST_PEER_PORT + _batch_pkts, _data, _batch_pkts + 1);
+    gnrc_pktbuf_release(pkt);
+    _batch_pkts++;
+}
+
+static void _init_dgrams(size_t len)
+{
+    for (unsigned i = 0; i <= GNRC_NETAPI_BATCH_SIZE; i++) {
+        _dgrams[i].data = _bufs[i];
+        _dgrams[i].len = len;
+        _dgrams[i].addr = &_addrs[i];
+        _dgrams[i].addr_len = sizeof(ipv6_addr_t);
+        _dgrams[i].port = 0;
+    }
+}
+
+static void set_up(void)
+{
+    for (unsigned i = 0; i < sizeof(_data); i++) {
+        _data[i] = (uint8_t)i;
+    }
+    memset(_bufs, 0, sizeof(_bufs));
+    memset(_addrs, 0, sizeof(_addrs));
+    _batch_pkts = 0;
+    conn_udp_create(&_conn, &_local, sizeof(_local), AF_INET6, TEST_LOCAL_PORT);
+}
+
+static void tear_down(void)
+{
+    msg_t msg;
+
+    conn_udp_close(&_conn);
+    while (msg_try_receive(&msg) > 0) {
+        if (msg.type == GNRC_NETAPI_MSG_TYPE_SND) {
+            gnrc_pktbuf_release((gnrc_pktsnip_t *)msg.content.ptr);
+        }
+    }
+}
+
+static void test_conn_udp_recv_many(void)
+{
+    _init_dgrams(TEST_DATA_LEN);
+    for (unsigned i = 0; i < 3; i++) {
+        _inject(TEST_PEER_PORT + i, _data, i + 1);
+    }
+    TEST_ASSERT_EQUAL_INT(3, conn_udp_recv_many(&_conn, _dgrams, GNRC_NETAPI_BATCH_SIZE));
+    for (unsigned i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(i + 1, _dgrams[i].len);
+        TEST_ASSERT_EQUAL_INT(0, memcmp(_data, _bufs[i], i + 1));
+        TEST_ASSERT_EQUAL_INT(sizeof(ipv6_addr_t), _dgrams[i].addr_len);
+        TEST_ASSERT(ipv6_addr_equal(&_peer, &_addrs[i]));
+        TEST_ASSERT_EQUAL_INT(TEST_PEER_PORT + i, _dgrams[i].port);
+    }
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_conn_udp_recv_many__numof(void)
+{
+    _init_dgrams(TEST_DATA_LEN);
+    for (unsigned i = 0; i < 3; i++) {
+        _inject(TEST_PEER_PORT + i, _data, i + 1);
+    }
+    TEST_ASSERT_EQUAL_INT(2, conn_udp_recv_many(&_conn, _dgrams, 2));
+    _init_dgrams(TEST_DATA_LEN);
+    TEST_ASSERT_EQUAL_INT(1, conn_udp_recv_many(&_conn, _dgrams, 2));
+    TEST_ASSERT_EQUAL_INT(3, _dgrams[0].len);
+    TEST_ASSERT_EQUAL_INT(TEST_PEER_PORT + 2, _dgrams[0].port);
+}
+
+static void test_conn_udp_recv_many__too_large(void)
+{
+    _init_dgrams(TEST_DATA_LEN);
+    _inject(TEST_PEER_PORT, _data, TEST_DATA_LEN);
+    _inject(TEST_PEER_PORT + 1, _data, TEST_DATA_LEN + 1);
+    _inject(TEST_PEER_PORT + 2, _data, 1);
+    /* the second datagram does not fit and stays queued ... */
+    TEST_ASSERT_EQUAL_INT(1, conn_udp_recv_many(&_conn, _dgrams, GNRC_NETAPI_BATCH_SIZE));
+    TEST_ASSERT_EQUAL_INT(TEST_DATA_LEN, _dgrams[0].len);
+    TEST_ASSERT_EQUAL_INT(2, gnrc_netapi_mbox_avail(&_conn.mbox));
+    /* ... for a call with enough space */
+    _init_dgrams(TEST_DATA_LEN);
+    _dgrams[0].data = _large;
+    _dgrams[0].len = sizeof(_large);
+    TEST_ASSERT_EQUAL_INT(2, conn_udp_recv_many(&_conn, _dgrams, GNRC_NETAPI_BATCH_SIZE));
+    TEST_ASSERT_EQUAL_INT(TEST_DATA_LEN + 1, _dgrams[0].len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_data, _large, sizeof(_large)));
+    TEST_ASSERT_EQUAL_INT(TEST_PEER_PORT + 1, _dgrams[0].port);
+    TEST_ASSERT_EQUAL_INT(1, _dgrams[1].len);
+    TEST_ASSERT_EQUAL_INT(TEST_PEER_PORT + 2, _dgrams[1].port);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_conn_udp_recv_many__first_too_large(void)
+{
+    _init_dgrams(TEST_DATA_LEN);
+    _inject(TEST_PEER_PORT, _data, TEST_DATA_LEN + 1);
+    TEST_ASSERT_EQUAL_INT(-ENOMEM, conn_udp_recv_many(&_conn, _dgrams,
+                                                      GNRC_NETAPI_BATCH_SIZE));
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_gnrc_conn_udp_recv_buf(void)
+{
+    gnrc_pktsnip_t *pkt;
+    ipv6_addr_t addr;
+    size_t addr_len;
+    uint16_t port;
+
+    /* larger than any buffer of the other tests */
+    _inject(TEST_PEER_PORT, _data, sizeof(_data));
+    TEST_ASSERT_EQUAL_INT(sizeof(_data), gnrc_conn_udp_recv_buf(&_conn, &pkt, &addr,
+                                                                &addr_len, &port));
+    TEST_ASSERT_EQUAL_INT(sizeof(_data), pkt->size);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_data, pkt->data, sizeof(_data)));
+    TEST_ASSERT_EQUAL_INT(sizeof(ipv6_addr_t), addr_len);
+    TEST_ASSERT(ipv6_addr_equal(&_peer, &addr));
+    TEST_ASSERT_EQUAL_INT(TEST_PEER_PORT, port);
+    /* the payload is still in the packet buffer ... */
+    TEST_ASSERT(!gnrc_pktbuf_is_empty());
+    gnrc_pktbuf_release(pkt);
+    /* ... until it is released */
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_gnrc_conn_udp_recv_buf__no_addr(void)
+{
+    gnrc_pktsnip_t *pkt;
+
+    _inject(TEST_PEER_PORT, _data, 1);
+    TEST_ASSERT_EQUAL_INT(1, gnrc_conn_udp_recv_buf(&_conn, &pkt, NULL, NULL, NULL));
+    TEST_ASSERT_EQUAL_INT(_data[0], ((uint8_t *)pkt->data)[0]);
+    gnrc_pktbuf_release(pkt);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_conn_udp_send_many(void)
+{
+    msg_t msg;
+
+    _init_dgrams(0);
+    for (unsigned i = 0; i < 3; i++) {
+        _dgrams[i].data = _data;
+        _dgrams[i].len = i + 1;
+        _dgrams[i].addr = (void *)&_peer;
+        _dgrams[i].port = TEST_PEER_PORT + i;
+    }
+    TEST_ASSERT_EQUAL_INT(3, conn_udp_send_many(_dgrams, 3, NULL, 0, AF_INET6,
+                                                TEST_LOCAL_PORT));
+    /* this thread does not take batches */
+    for (unsigned i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(1, msg_try_receive(&msg));
+        TEST_ASSERT_EQUAL_INT(GNRC_NETAPI_MSG_TYPE_SND, msg.type);
+        _check_sent((gnrc_pktsnip_t *)msg.content.ptr, TEST_PEER_PORT + i, _data, i + 1);
+        gnrc_pktbuf_release((gnrc_pktsnip_t *)msg.content.ptr);
+    }
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_conn_udp_send_many__dropped(void)
+{
+    gnrc_netapi_batch_t batch;
+    msg_t msg;
+    unsigned numof = GNRC_NETAPI_BATCH_SIZE + 1;
+
+    /* this thread takes batches now, with room for exactly one message */
+    gnrc_netapi_batch_begin(&batch);
+    gnrc_netapi_batch_end();
+    msg.type = TEST_MSG_TYPE_FILL;
+    for (unsigned i = 0; i < (TEST_MSG_QUEUE_SIZE - 1); i++) {
+        TEST_ASSERT_EQUAL_INT(1, msg_try_send(&msg, thread_getpid()));
+    }
+    _init_dgrams(0);
+    for (unsigned i = 0; i < numof; i++) {
+        _dgrams[i].data = _data;
+        _dgrams[i].len = i + 1;
+        _dgrams[i].addr = (void *)&_peer;
+        _dgrams[i].port = TEST_PEER_PORT + i;
+    }
+    /* a full batch fits, the last datagram is dropped */
+    TEST_ASSERT_EQUAL_INT(GNRC_NETAPI_BATCH_SIZE,
+                          conn_udp_send_many(_dgrams, numof, NULL, 0, AF_INET6,
+                                             TEST_LOCAL_PORT));
+    gnrc_netapi_batch_disable(thread_getpid());
+    for (unsigned i = 0; i < TEST_MSG_QUEUE_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT(1, msg_try_receive(&msg));
+        if (msg.type == GNRC_NETAPI_MSG_TYPE_SND_BATCH) {
+            gnrc_netapi_batch_handle(&msg, _count_batch, NULL);
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(GNRC_NETAPI_BATCH_SIZE, _batch_pkts);
+    TEST_ASSERT_EQUAL_INT(-1, msg_try_receive(&msg));
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+Test *tests_gnrc_conn_udp_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_conn_udp_recv_many),
+        new_TestFixture(test_conn_udp_recv_many__numof),
+        new_TestFixture(test_conn_udp_recv_many__too_large),
+        new_TestFixture(test_conn_udp_recv_many__first_too_large),
+        new_TestFixture(test_gnrc_conn_udp_recv_buf),
+        new_TestFixture(test_gnrc_conn_udp_recv_buf__no_addr),
+        new_TestFixture(test_conn_udp_send_many),
+        new_TestFixture(test_conn_udp_send_many__dropped),
+    };
+
+    EMB_UNIT_TESTCALLER(gnrc_conn_udp_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&gnrc_conn_udp_tests;
+}
+
+void tests_gnrc_conn_udp(void)
+{
+    /* this thread plays the UDP thread */
+    msg_init_queue(_msg_queue, TEST_MSG_QUEUE_SIZE);
+    gnrc_pktbuf_init();
+    _udp_entry.pid = thread_getpid();
+    gnrc_netreg_register(GNRC_NETTYPE_UDP, &_udp_entry);
+    TESTS_RUN(tests_gnrc_conn_udp_tests());
+    gnrc_netreg_unregister(GNRC_NETTYPE_UDP, &_udp_entry);
+}
+/** @} */
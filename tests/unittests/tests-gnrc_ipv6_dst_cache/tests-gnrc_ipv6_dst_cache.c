@@ -0,0 +1,279 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ *
+ * The IPv6 thread is the real one, this thread plays the interface it sends
+ * to and the UDP thread.
+ */
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "embUnit.h"
+
+#include "msg.h"
+#include "thread.h"
+#include "net/af.h"
+#include "net/conn/udp.h"
+#include "net/fib.h"
+#include "net/gnrc.h"
+#include "net/gnrc/ipv6.h"
+#include "net/gnrc/ipv6/dst_cache.h"
+#include "net/gnrc/ipv6/nc.h"
+#include "net/gnrc/ipv6/netif.h"
+#include "net/gnrc/netif/hdr.h"
+#include "net/ipv6/hdr.h"
+
+#include "tests-gnrc_ipv6_dst_cache.h"
+
+#define TEST_LOCAL_PORT     (5683U)
+#define TEST_PEER_PORT      (61616U)
+#define TEST_MSG_QUEUE_SIZE (8U)
+
+static const ipv6_addr_t _local = { {
+        0xfe, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01
+    } };
+static const ipv6_addr_t _local_global = { {
+        0x20, 0x01, 0x0d, 0xb8, 0, 0x01, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01
+    } };
+static const ipv6_addr_t _peer = { {
+        0xfe, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02
+    } };
+static const ipv6_addr_t _remote = { {
+        0x20, 0x01, 0x0d, 0xb8, 0, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01
+    } };
+static const uint8_t _peer_l2addr[] = { 0x02, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x02 };
+static const uint8_t _data[] = { 0xde, 0xad, 0xbe, 0xef };
+
+static msg_t _msg_queue[TEST_MSG_QUEUE_SIZE];
+static gnrc_netreg_entry_t _udp_entry = GNRC_NETREG_ENTRY_INIT_PID(GNRC_NETREG_DEMUX_CTX_ALL,
+                                                                KERNEL_PID_UNDEF);
+static gnrc_ipv6_dst_cache_t _cache;
+static conn_udp_t _conn;
+static gnrc_pktsnip_t *_sent;
+
+/* takes the packet sent to the interface (or the UDP thread) into _sent and
+ * checks its headers */
+static void _expect_sent(const ipv6_addr_t *src, const ipv6_addr_t *dst)
+{
+    msg_t msg;
+    gnrc_pktsnip_t *ipv6;
+    gnrc_netif_hdr_t *netif_hdr;
+
+    TEST_ASSERT_EQUAL_INT(1, msg_try_receive(&msg));
+    TEST_ASSERT_EQUAL_INT(GNRC_NETAPI_MSG_TYPE_SND, msg.type);
+    _sent = (gnrc_pktsnip_t *)msg.content.ptr;
+    ipv6 = gnrc_pktsnip_search_type(_sent, GNRC_NETTYPE_IPV6);
+    TEST_ASSERT_EQUAL_INT(GNRC_NETTYPE_NETIF, _sent->type);
+    TEST_ASSERT_NOT_NULL(ipv6);
+    netif_hdr = _sent->data;
+    TEST_ASSERT_EQUAL_INT(thread_getpid(), netif_hdr->if_pid);
+    TEST_ASSERT_EQUAL_INT(sizeof(_peer_l2addr), netif_hdr->dst_l2addr_len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_peer_l2addr, gnrc_netif_hdr_get_dst_addr(netif_hdr),
+                                    sizeof(_peer_l2addr)));
+    TEST_ASSERT(ipv6_addr_equal(src, &((ipv6_hdr_t *)ipv6->data)->src));
+    TEST_ASSERT(ipv6_addr_equal(dst, &((ipv6_hdr_t *)ipv6->data)->dst));
+}
+
+/* routes everything via _peer */
+static int _add_default_route(void)
+{
+    return fib_add_entry(&gnrc_ipv6_fib_table, thread_getpid(),
+                         (uint8_t *)ipv6_addr_unspecified.u8, sizeof(ipv6_addr_t), 0,
+                         (uint8_t *)_peer.u8, sizeof(ipv6_addr_t), 0,
+                         (uint32_t)FIB_LIFETIME_NO_EXPIRE);
+}
+
+static void set_up(void)
+{
+    kernel_pid_t iface = thread_getpid();
+
+    gnrc_ipv6_nc_init();
+    gnrc_ipv6_netif_init();
+    fib_flush(&gnrc_ipv6_fib_table, KERNEL_PID_UNDEF);
+    gnrc_ipv6_netif_add(iface);
+    gnrc_ipv6_netif_add_addr(iface, &_local, 64, GNRC_IPV6_NETIF_ADDR_FLAGS_UNICAST);
+    gnrc_ipv6_netif_add_addr(iface, &_local_global, 64, GNRC_IPV6_NETIF_ADDR_FLAGS_UNICAST);
+    gnrc_ipv6_nc_add(iface, &_peer, _peer_l2addr, sizeof(_peer_l2addr),
+                     GNRC_IPV6_NC_STATE_REACHABLE);
+    memset(&_cache, 0, sizeof(_cache));
+    gnrc_ipv6_dst_cache_init(&_cache);
+}
+
+static void tear_down(void)
+{
+    msg_t msg;
+
+    if (_sent != NULL) {
+        gnrc_pktbuf_release(_sent);
+        _sent = NULL;
+    }
+    while (msg_try_receive(&msg) > 0) {
+        if (msg.type == GNRC_NETAPI_MSG_TYPE_SND) {
+            gnrc_pktbuf_release((gnrc_pktsnip_t *)msg.content.ptr);
+        }
+    }
+    /* stops the timers of the neighbor cache entries */
+    gnrc_ipv6_nc_init();
+}
+
+static void test_gnrc_ipv6_dst_cache_fill(void)
+{
+    TEST_ASSERT(!gnrc_ipv6_dst_cache_valid(&_cache, &_peer));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_dst_cache_fill(&_cache, &_peer));
+    TEST_ASSERT(gnrc_ipv6_dst_cache_valid(&_cache, &_peer));
+    TEST_ASSERT(!gnrc_ipv6_dst_cache_valid(&_cache, &_remote));
+    TEST_ASSERT_EQUAL_INT(thread_getpid(), _cache.iface);
+    TEST_ASSERT(ipv6_addr_equal(&_local, &_cache.src));
+    TEST_ASSERT_EQUAL_INT(sizeof(_peer_l2addr), _cache.l2addr_len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_peer_l2addr, _cache.l2addr, sizeof(_peer_l2addr)));
+}
+
+static void test_gnrc_ipv6_dst_cache_fill__route(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, _add_default_route());
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_dst_cache_fill(&_cache, &_remote));
+    TEST_ASSERT(gnrc_ipv6_dst_cache_valid(&_cache, &_remote));
+    TEST_ASSERT(ipv6_addr_equal(&_local_global, &_cache.src));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_peer_l2addr, _cache.l2addr, sizeof(_peer_l2addr)));
+}
+
+static void test_gnrc_ipv6_dst_cache_fill__unresolved(void)
+{
+    ipv6_addr_t dst = _peer;
+
+    dst.u8[15]++;
+    TEST_ASSERT_EQUAL_INT(-EHOSTUNREACH, gnrc_ipv6_dst_cache_fill(&_cache, &dst));
+    TEST_ASSERT(!gnrc_ipv6_dst_cache_valid(&_cache, &dst));
+    /* no address resolution is started for the lookup */
+    TEST_ASSERT_NULL(gnrc_ipv6_nc_get(KERNEL_PID_UNDEF, &dst));
+}
+
+static void test_gnrc_ipv6_dst_cache_fill__not_cached(void)
+{
+    TEST_ASSERT_EQUAL_INT(-ENOTSUP, gnrc_ipv6_dst_cache_fill(&_cache, &ipv6_addr_all_nodes_link_local));
+    TEST_ASSERT_EQUAL_INT(-ENOTSUP, gnrc_ipv6_dst_cache_fill(&_cache, &ipv6_addr_loopback));
+    TEST_ASSERT_EQUAL_INT(-ENOTSUP, gnrc_ipv6_dst_cache_fill(&_cache, &_local));
+    TEST_ASSERT(!gnrc_ipv6_dst_cache_valid(&_cache, &_local));
+}
+
+static void test_gnrc_ipv6_dst_cache_valid__nc_change(void)
+{
+    ipv6_addr_t other = _peer;
+
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_dst_cache_fill(&_cache, &_peer));
+    other.u8[15]++;
+    /* any neighbor, not only the cached one */
+    gnrc_ipv6_nc_add(thread_getpid(), &other, _peer_l2addr, sizeof(_peer_l2addr),
+                     GNRC_IPV6_NC_STATE_REACHABLE);
+    TEST_ASSERT(!gnrc_ipv6_dst_cache_valid(&_cache, &_peer));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_dst_cache_fill(&_cache, &_peer));
+    TEST_ASSERT(gnrc_ipv6_dst_cache_valid(&_cache, &_peer));
+    gnrc_ipv6_nc_remove(thread_getpid(), &_peer);
+    TEST_ASSERT(!gnrc_ipv6_dst_cache_valid(&_cache, &_peer));
+    TEST_ASSERT_EQUAL_INT(-EHOSTUNREACH, gnrc_ipv6_dst_cache_fill(&_cache, &_peer));
+}
+
+static void test_gnrc_ipv6_dst_cache_valid__fib_change(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, _add_default_route());
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_dst_cache_fill(&_cache, &_remote));
+    fib_remove_entry(&gnrc_ipv6_fib_table, (uint8_t *)ipv6_addr_unspecified.u8,
+                     sizeof(ipv6_addr_t));
+    TEST_ASSERT(!gnrc_ipv6_dst_cache_valid(&_cache, &_remote));
+}
+
+static void test_gnrc_ipv6_dst_cache_valid__netif_change(void)
+{
+    ipv6_addr_t addr = _local_global;
+
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_dst_cache_fill(&_cache, &_peer));
+    addr.u8[15]++;
+    TEST_ASSERT_NOT_NULL(gnrc_ipv6_netif_add_addr(thread_getpid(), &addr, 64,
+                                                  GNRC_IPV6_NETIF_ADDR_FLAGS_UNICAST));
+    TEST_ASSERT(!gnrc_ipv6_dst_cache_valid(&_cache, &_peer));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_dst_cache_fill(&_cache, &_peer));
+    gnrc_ipv6_netif_remove_addr(thread_getpid(), &addr);
+    TEST_ASSERT(!gnrc_ipv6_dst_cache_valid(&_cache, &_peer));
+}
+
+static void test_gnrc_ipv6_dst_cache_hdr_build__send(void)
+{
+    gnrc_pktsnip_t *pkt;
+
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_dst_cache_fill(&_cache, &_peer));
+    pkt = gnrc_pktbuf_add(NULL, (void *)_data, sizeof(_data), GNRC_NETTYPE_UNDEF);
+    pkt = gnrc_ipv6_dst_cache_hdr_build(&_cache, pkt, NULL);
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_INT(GNRC_NETTYPE_NETIF, pkt->type);
+    TEST_ASSERT(((gnrc_netif_hdr_t *)pkt->data)->flags & GNRC_NETIF_HDR_FLAGS_RESOLVED);
+    /* the IPv6 thread must not look the neighbor up again: without the cache
+     * the packet would be dropped now */
+    gnrc_ipv6_nc_remove(thread_getpid(), &_peer);
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_send(gnrc_ipv6_pid, pkt));
+    _expect_sent(&_local, &_peer);
+    /* the flag is not meant for the interface */
+    TEST_ASSERT_EQUAL_INT(0, ((gnrc_netif_hdr_t *)_sent->data)->flags &
+                          GNRC_NETIF_HDR_FLAGS_RESOLVED);
+    TEST_ASSERT_EQUAL_INT(sizeof(_data), gnrc_pkt_len(_sent->next->next));
+    gnrc_pktbuf_release(_sent);
+    _sent = NULL;
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_conn_udp_send__cached(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, conn_udp_create(&_conn, &ipv6_addr_unspecified,
+                                             sizeof(ipv6_addr_t), AF_INET6, TEST_LOCAL_PORT));
+    TEST_ASSERT_EQUAL_INT(-ENOTCONN, conn_udp_send(&_conn, _data, sizeof(_data)));
+    TEST_ASSERT_EQUAL_INT(0, conn_udp_connect(&_conn, &_peer, sizeof(_peer), TEST_PEER_PORT));
+    TEST_ASSERT_EQUAL_INT(sizeof(_data), conn_udp_send(&_conn, _data, sizeof(_data)));
+    /* taken by this thread as the UDP thread: the next hop is already set */
+    _expect_sent(&_local, &_peer);
+    TEST_ASSERT(((gnrc_netif_hdr_t *)_sent->data)->flags & GNRC_NETIF_HDR_FLAGS_RESOLVED);
+    TEST_ASSERT(gnrc_ipv6_dst_cache_valid(&_conn.dst_cache, &_peer));
+    conn_udp_close(&_conn);
+    gnrc_pktbuf_release(_sent);
+    _sent = NULL;
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+Test *tests_gnrc_ipv6_dst_cache_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_gnrc_ipv6_dst_cache_fill),
+        new_TestFixture(test_gnrc_ipv6_dst_cache_fill__route),
+        new_TestFixture(test_gnrc_ipv6_dst_cache_fill__unresolved),
+        new_TestFixture(test_gnrc_ipv6_dst_cache_fill__not_cached),
+        new_TestFixture(test_gnrc_ipv6_dst_cache_valid__nc_change),
+        new_TestFixture(test_gnrc_ipv6_dst_cache_valid__fib_change),
+        new_TestFixture(test_gnrc_ipv6_dst_cache_valid__netif_change),
+        new_TestFixture(test_gnrc_ipv6_dst_cache_hdr_build__send),
+        new_TestFixture(test_conn_udp_send__cached),
+    };
+
+    EMB_UNIT_TESTCALLER(gnrc_ipv6_dst_cache_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&gnrc_ipv6_dst_cache_tests;
+}
+
+void tests_gnrc_ipv6_dst_cache(void)
+{
+    msg_init_queue(_msg_queue, TEST_MSG_QUEUE_SIZE);
+    gnrc_pktbuf_init();
+    gnrc_ipv6_init();
+    _udp_entry.pid = thread_getpid();
+    gnrc_netreg_register(GNRC_NETTYPE_UDP, &_udp_entry);
+    TESTS_RUN(tests_gnrc_ipv6_dst_cache_tests());
+    gnrc_netreg_unregister(GNRC_NETTYPE_UDP, &_udp_entry);
+}
+/** @} */
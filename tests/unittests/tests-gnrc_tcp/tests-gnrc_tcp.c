@@ -0,0 +1,652 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ *
+ * The tests play the peer: they register for the segments gnrc_tcp hands to
+ * the network layer and inject the answers into the TCP thread. Blocking
+ * calls run in an application thread.
+ */
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "embUnit.h"
+
+#include "byteorder.h"
+#include "msg.h"
+#include "thread.h"
+#include "xtimer.h"
+#include "net/gnrc.h"
+#include "net/gnrc/tcp.h"
+#include "net/inet_csum.h"
+#include "net/ipv6/hdr.h"
+#include "net/protnum.h"
+
+#include "tests-gnrc_tcp.h"
+
+#define TEST_LOCAL_PORT     (8000U)
+#define TEST_PEER_PORT      (49152U)
+#define TEST_PEER_ISS       (0xffff0000U)   /**< wraps around, so a window
+                                             *   announced before the SYN-ACK
+                                             *   is off */
+#define TEST_PEER_MSS       (100U)
+#define TEST_PEER_WS        (2U)
+#define TEST_MBOX_SIZE      (8U)
+#define TEST_MBOX_FLAG      (0x1 << 11)
+#define TEST_MSG_QUEUE_SIZE (8U)
+#define TEST_TIMEOUT        (500U * MS_IN_USEC)
+#define TEST_QUIET          (20U * MS_IN_USEC)
+#define TEST_APP_FAILED     (INT_MIN)
+
+/**
+ * @brief   A segment gnrc_tcp sent
+ */
+typedef struct {
+    uint32_t seq;
+    uint32_t ack;
+    uint16_t dst_port;
+    uint16_t window;
+    uint8_t flags;
+    uint8_t opts[TCP_HDR_LEN_MAX - sizeof(tcp_hdr_t)];
+    unsigned opts_len;
+    uint8_t data[TEST_PEER_MSS];
+    size_t len;
+} _seg_t;
+
+static const ipv6_addr_t _local = { {
+        0xfe, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01
+    } };
+static const ipv6_addr_t _peer = { {
+        0xfe, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02
+    } };
+static const uint8_t _syn_opts[] = {
+    TCP_OPTION_KIND_MSS, TCP_OPTION_LENGTH_MSS, 0, TEST_PEER_MSS,
+    TCP_OPTION_KIND_NOP, TCP_OPTION_KIND_WS, TCP_OPTION_LENGTH_WS, TEST_PEER_WS,
+    TCP_OPTION_KIND_NOP, TCP_OPTION_KIND_NOP,
+    TCP_OPTION_KIND_SACK_PERM, TCP_OPTION_LENGTH_SACK_PERM,
+};
+
+static msg_t _msg_queue[TEST_MSG_QUEUE_SIZE];
+static gnrc_netreg_entry_t _ipv6_entry = GNRC_NETREG_ENTRY_INIT_PID(GNRC_NETREG_DEMUX_CTX_ALL,
+                                                                 KERNEL_PID_UNDEF);
+static kernel_pid_t _tcp_pid;
+static gnrc_tcp_tcb_t _tcb, _listener;
+static gnrc_netapi_mbox_t _mbox, _listener_mbox;
+static gnrc_pktsnip_t *_mbox_queue[TEST_MBOX_SIZE];
+static gnrc_pktsnip_t *_listener_queue[TEST_MBOX_SIZE];
+static uint8_t _data[4 * TEST_PEER_MSS];
+static uint8_t _buf[sizeof(_data)];
+static uint16_t _peer_port = TEST_PEER_PORT;
+static uint32_t _peer_nxt;  /* next sequence number the peer sends */
+static uint32_t _peer_ack;  /* next sequence number the peer expects */
+
+static char _app_stack[THREAD_STACKSIZE_DEFAULT];
+static int (*_app_func)(void);
+static volatile bool _app_done;
+static volatile int _app_res;
+
+static void *_app_thread(void *arg)
+{
+    (void)arg;
+    _app_res = _app_func();
+    _app_done = true;
+    return NULL;
+}
+
+/* runs func in a thread of higher priority, so it runs until it blocks */
+static void _app_start(int (*func)(void))
+{
+    _app_func = func;
+    _app_done = false;
+    thread_create(_app_stack, sizeof(_app_stack), THREAD_PRIORITY_MAIN - 1,
+                  THREAD_CREATE_STACKTEST, _app_thread, NULL, "app");
+}
+
+static int _app_wait(void)
+{
+    for (unsigned i = 0; !_app_done && (i < (TEST_TIMEOUT / MS_IN_USEC)); i++) {
+        xtimer_usleep(MS_IN_USEC);
+    }
+    return _app_done ? _app_res : TEST_APP_FAILED;
+}
+
+static int _app_connect(void)
+{
+    return gnrc_tcp_connect(&_tcb, &_peer, _peer_port);
+}
+
+static int _app_accept(void)
+{
+    return gnrc_tcp_accept(&_listener, &_tcb, &_mbox);
+}
+
+static int _app_send(void)
+{
+    return gnrc_tcp_send(&_tcb, _data, sizeof(_data));
+}
+
+static int _app_close(void)
+{
+    gnrc_tcp_close(&_tcb);
+    return 0;
+}
+
+/* injects a segment of the peer into the TCP thread */
+static void _inject(uint32_t seq, uint32_t ack, uint8_t flags, uint16_t window,
+                    const uint8_t *opts, unsigned opts_len,
+                    const void *data, size_t len)
+{
+    uint8_t seg[TCP_HDR_LEN_MAX + TEST_PEER_MSS];
+    tcp_hdr_t *hdr = (tcp_hdr_t *)seg;
+    unsigned seg_len = sizeof(tcp_hdr_t) + opts_len + len;
+    ipv6_hdr_t ipv6;
+    gnrc_pktsnip_t *ipv6_snip, *pkt;
+    uint16_t csum;
+
+    memset(seg, 0, sizeof(seg));
+    hdr->src_port = byteorder_htons(_peer_port);
+    hdr->dst_port = byteorder_htons(TEST_LOCAL_PORT);
+    hdr->seq_num = byteorder_htonl(seq);
+    hdr->ack_num = byteorder_htonl(ack);
+    hdr->off_reserved = ((sizeof(tcp_hdr_t) + opts_len) / 4) << 4;
+    hdr->flags = flags;
+    hdr->window = byteorder_htons(window);
+    memcpy(hdr + 1, opts, opts_len);
+    memcpy(seg + sizeof(tcp_hdr_t) + opts_len, data, len);
+
+    memset(&ipv6, 0, sizeof(ipv6));
+    ipv6_hdr_set_version(&ipv6);
+    ipv6.len = byteorder_htons(seg_len);
+    ipv6.nh = PROTNUM_TCP;
+    ipv6.hl = 64;
+    memcpy(&ipv6.src, &_peer, sizeof(ipv6_addr_t));
+    memcpy(&ipv6.dst, &_local, sizeof(ipv6_addr_t));
+    csum = ipv6_hdr_inet_csum(0, &ipv6, PROTNUM_TCP, seg_len);
+    csum = inet_csum(csum, seg, seg_len);
+    hdr->checksum = byteorder_htons(~csum);
+
+    ipv6_snip = gnrc_pktbuf_add(NULL, &ipv6, sizeof(ipv6), GNRC_NETTYPE_IPV6);
+    pkt = gnrc_pktbuf_add(ipv6_snip, seg, seg_len, GNRC_NETTYPE_TCP);
+    gnrc_netapi_receive(_tcp_pid, pkt);
+}
+
+static inline void _inject_ack(uint16_t window, const uint8_t *opts,
+                               unsigned opts_len)
+{
+    _inject(_peer_nxt, _peer_ack, TCP_FLAG_ACK, window, opts, opts_len, NULL, 0);
+}
+
+static void _inject_data(uint32_t seq, uint8_t flags, const void *data,
+                         size_t len)
+{
+    _inject(seq, _peer_ack, TCP_FLAG_ACK | flags, 1000, NULL, 0, data, len);
+}
+
+/* waits for the next segment gnrc_tcp sends */
+static int _expect(_seg_t *seg, uint32_t timeout)
+{
+    msg_t msg;
+    gnrc_pktsnip_t *pkt, *tcp;
+    tcp_hdr_t *hdr;
+
+    if ((xtimer_msg_receive_timeout(&msg, timeout) < 0) ||
+        (msg.type != GNRC_NETAPI_MSG_TYPE_SND)) {
+        return -1;
+    }
+    pkt = (gnrc_pktsnip_t *)msg.content.ptr;
+    tcp = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_TCP);
+    if (tcp == NULL) {
+        gnrc_pktbuf_release(pkt);
+        return -1;
+    }
+    hdr = (tcp_hdr_t *)tcp->data;
+    seg->seq = byteorder_ntohl(hdr->seq_num);
+    seg->ack = byteorder_ntohl(hdr->ack_num);
+    seg->dst_port = byteorder_ntohs(hdr->dst_port);
+    seg->window = byteorder_ntohs(hdr->window);
+    seg->flags = hdr->flags;
+    seg->opts_len = tcp->size - sizeof(tcp_hdr_t);
+    memcpy(seg->opts, hdr + 1, seg->opts_len);
+    seg->len = 0;
+    for (gnrc_pktsnip_t *ptr = tcp->next; ptr != NULL; ptr = ptr->next) {
+        if ((seg->len + ptr->size) <= sizeof(seg->data)) {
+            memcpy(seg->data + seg->len, ptr->data, ptr->size);
+        }
+        seg->len += ptr->size;
+    }
+    gnrc_pktbuf_release(pkt);
+    return 0;
+}
+
+/* returns the option of kind in seg, NULL if there is none */
+static const uint8_t *_opt(const _seg_t *seg, uint8_t kind)
+{
+    const uint8_t *opt = seg->opts, *end = seg->opts + seg->opts_len;
+
+    while ((opt < end) && (opt[0] != TCP_OPTION_KIND_EOL)) {
+        if (opt[0] == TCP_OPTION_KIND_NOP) {
+            opt++;
+            continue;
+        }
+        if (opt[0] == kind) {
+            return opt;
+        }
+        opt += opt[1];
+    }
+    return NULL;
+}
+
+static uint32_t _u32(const uint8_t *buf)
+{
+    return ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) |
+           ((uint32_t)buf[2] << 8) | buf[3];
+}
+
+/* opens _tcb actively, the SYN-ACK announces window and the peer's options */
+static void _connect(uint16_t window)
+{
+    _seg_t seg;
+
+    _app_start(_app_connect);
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT_EQUAL_INT(TCP_FLAG_SYN, seg.flags);
+    _peer_nxt = TEST_PEER_ISS;
+    _peer_ack = seg.seq + 1;
+    _inject(_peer_nxt++, _peer_ack, TCP_FLAG_SYN | TCP_FLAG_ACK, window,
+            _syn_opts, sizeof(_syn_opts), NULL, 0);
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT_EQUAL_INT(TCP_FLAG_ACK, seg.flags);
+    TEST_ASSERT_EQUAL_INT(0, _app_wait());
+}
+
+static void set_up(void)
+{
+    for (unsigned i = 0; i < sizeof(_data); i++) {
+        _data[i] = (uint8_t)i;
+    }
+    memset(_buf, 0, sizeof(_buf));
+    /* a new port for every test keeps the tests out of each other's
+     * TIME-WAIT */
+    _peer_port++;
+    gnrc_netapi_mbox_init(&_mbox, _mbox_queue, TEST_MBOX_SIZE, TEST_MBOX_FLAG);
+    gnrc_netapi_mbox_init(&_listener_mbox, _listener_queue, TEST_MBOX_SIZE,
+                          TEST_MBOX_FLAG);
+    gnrc_tcp_tcb_init(&_tcb, &_mbox, &_local, TEST_LOCAL_PORT);
+    gnrc_tcp_tcb_init(&_listener, &_listener_mbox, &_local, TEST_LOCAL_PORT);
+}
+
+static void tear_down(void)
+{
+    _seg_t seg;
+
+    if ((_tcb.state != GNRC_TCP_STATE_CLOSED) &&
+        (_tcb.state != GNRC_TCP_STATE_LISTEN)) {
+        _inject(_peer_nxt, 0, TCP_FLAG_RST, 0, NULL, 0, NULL, 0);
+    }
+    gnrc_tcp_close(&_listener);
+    _app_wait();
+    gnrc_tcp_close(&_tcb);
+    while (_expect(&seg, TEST_QUIET) == 0) {}
+}
+
+static void test_gnrc_tcp_connect(void)
+{
+    _seg_t seg;
+    const uint8_t *opt;
+
+    _app_start(_app_connect);
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT_EQUAL_INT(TCP_FLAG_SYN, seg.flags);
+    TEST_ASSERT_EQUAL_INT(_peer_port, seg.dst_port);
+    /* the window of a SYN is not scaled */
+    TEST_ASSERT_EQUAL_INT(UINT16_MAX, seg.window);
+    TEST_ASSERT_NOT_NULL((opt = _opt(&seg, TCP_OPTION_KIND_MSS)));
+    TEST_ASSERT_EQUAL_INT(GNRC_TCP_MSS, (opt[2] << 8) | opt[3]);
+    TEST_ASSERT_NOT_NULL((opt = _opt(&seg, TCP_OPTION_KIND_WS)));
+    TEST_ASSERT_EQUAL_INT(1, opt[2]);
+    TEST_ASSERT_NOT_NULL(_opt(&seg, TCP_OPTION_KIND_SACK_PERM));
+
+    _peer_nxt = TEST_PEER_ISS;
+    _peer_ack = seg.seq + 1;
+    _inject(_peer_nxt++, _peer_ack, TCP_FLAG_SYN | TCP_FLAG_ACK, 1000,
+            _syn_opts, sizeof(_syn_opts), NULL, 0);
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT_EQUAL_INT(TCP_FLAG_ACK, seg.flags);
+    TEST_ASSERT_EQUAL_INT(_peer_ack, seg.seq);
+    TEST_ASSERT_EQUAL_INT(_peer_nxt, seg.ack);
+    /* the whole window, scaled */
+    TEST_ASSERT_EQUAL_INT(GNRC_TCP_RCV_WND >> 1, seg.window);
+    TEST_ASSERT_EQUAL_INT(0, _app_wait());
+    TEST_ASSERT_EQUAL_INT(GNRC_TCP_STATE_ESTABLISHED, _tcb.state);
+}
+
+static void test_gnrc_tcp_connect__refused(void)
+{
+    _seg_t seg;
+
+    _app_start(_app_connect);
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    _inject(0, seg.seq + 1, TCP_FLAG_RST | TCP_FLAG_ACK, 0, NULL, 0, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(-ECONNREFUSED, _app_wait());
+    TEST_ASSERT_EQUAL_INT(GNRC_TCP_STATE_CLOSED, _tcb.state);
+}
+
+static void test_gnrc_tcp_accept(void)
+{
+    _seg_t seg;
+    const uint8_t *opt;
+
+    TEST_ASSERT_EQUAL_INT(0, gnrc_tcp_listen(&_listener, 1));
+    _app_start(_app_accept);
+    _peer_nxt = TEST_PEER_ISS;
+    _inject(_peer_nxt++, 0, TCP_FLAG_SYN, 1000, _syn_opts, sizeof(_syn_opts),
+            NULL, 0);
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT_EQUAL_INT(TCP_FLAG_SYN | TCP_FLAG_ACK, seg.flags);
+    TEST_ASSERT_EQUAL_INT(_peer_nxt, seg.ack);
+    TEST_ASSERT_NOT_NULL((opt = _opt(&seg, TCP_OPTION_KIND_WS)));
+    TEST_ASSERT_EQUAL_INT(1, opt[2]);
+    TEST_ASSERT_NOT_NULL(_opt(&seg, TCP_OPTION_KIND_SACK_PERM));
+    _peer_ack = seg.seq + 1;
+    _inject_ack(1000, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(0, _app_wait());
+    TEST_ASSERT_EQUAL_INT(GNRC_TCP_STATE_ESTABLISHED, _tcb.state);
+}
+
+static void test_gnrc_tcp_accept__backlog_timeout(void)
+{
+    _seg_t seg;
+    uint16_t stale_port = _peer_port++;
+
+    TEST_ASSERT_EQUAL_INT(0, gnrc_tcp_listen(&_listener, 1));
+    /* the peer of this request gives up */
+    _peer_port = stale_port;
+    _inject(TEST_PEER_ISS, 0, TCP_FLAG_SYN, 1000, NULL, 0, NULL, 0);
+    xtimer_usleep(GNRC_TCP_BACKLOG_TIMEOUT + TEST_QUIET);
+    /* takes the place of the stale request in the full backlog */
+    _peer_port = stale_port + 1;
+    _peer_nxt = TEST_PEER_ISS;
+    _inject(_peer_nxt++, 0, TCP_FLAG_SYN, 1000, NULL, 0, NULL, 0);
+    _app_start(_app_accept);
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT_EQUAL_INT(TCP_FLAG_SYN | TCP_FLAG_ACK, seg.flags);
+    TEST_ASSERT_EQUAL_INT(_peer_port, seg.dst_port);
+    _peer_ack = seg.seq + 1;
+    _inject_ack(1000, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(0, _app_wait());
+}
+
+static void test_gnrc_tcp_close__listen(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, gnrc_tcp_listen(&_listener, 1));
+    _app_start(_app_accept);
+    gnrc_tcp_close(&_listener);
+    TEST_ASSERT_EQUAL_INT(-EINVAL, _app_wait());
+}
+
+static void test_gnrc_tcp_recv__in_order(void)
+{
+    _seg_t seg;
+
+    _connect(1000);
+    _inject_data(_peer_nxt, 0, _data, TEST_PEER_MSS);
+    _peer_nxt += TEST_PEER_MSS;
+    /* the ACK of the first segment is delayed ... */
+    TEST_ASSERT_EQUAL_INT(-1, _expect(&seg, TEST_QUIET));
+    _inject_data(_peer_nxt, 0, _data + TEST_PEER_MSS, TEST_PEER_MSS);
+    _peer_nxt += TEST_PEER_MSS;
+    /* ... the second one is acknowledged right away */
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT_EQUAL_INT(_peer_nxt, seg.ack);
+    TEST_ASSERT_EQUAL_INT(2 * TEST_PEER_MSS,
+                          gnrc_tcp_recv(&_tcb, _buf, sizeof(_buf)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_data, _buf, 2 * TEST_PEER_MSS));
+}
+
+static void test_gnrc_tcp_recv__out_of_order(void)
+{
+    _seg_t seg;
+    const uint8_t *opt;
+
+    _connect(1000);
+    _inject_data(_peer_nxt + TEST_PEER_MSS, 0, _data + TEST_PEER_MSS,
+                 TEST_PEER_MSS);
+    /* duplicate ACK reporting the segment */
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT_EQUAL_INT(_peer_nxt, seg.ack);
+    TEST_ASSERT_NOT_NULL((opt = _opt(&seg, TCP_OPTION_KIND_SACK)));
+    TEST_ASSERT_EQUAL_INT(10, opt[1]);
+    TEST_ASSERT_EQUAL_INT(_peer_nxt + TEST_PEER_MSS, _u32(opt + 2));
+    TEST_ASSERT_EQUAL_INT(_peer_nxt + (2 * TEST_PEER_MSS), _u32(opt + 6));
+    /* nothing to read before the gap is filled */
+    TEST_ASSERT_EQUAL_INT(0, gnrc_tcp_events(&_tcb) & GNRC_TCP_EVENT_IN);
+    /* filling the gap is acknowledged right away */
+    _inject_data(_peer_nxt, 0, _data, TEST_PEER_MSS);
+    _peer_nxt += 2 * TEST_PEER_MSS;
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT_EQUAL_INT(_peer_nxt, seg.ack);
+    TEST_ASSERT_NULL(_opt(&seg, TCP_OPTION_KIND_SACK));
+    TEST_ASSERT_EQUAL_INT(2 * TEST_PEER_MSS,
+                          gnrc_tcp_recv(&_tcb, _buf, sizeof(_buf)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_data, _buf, 2 * TEST_PEER_MSS));
+}
+
+static void test_gnrc_tcp_send__window_scaling(void)
+{
+    _seg_t seg;
+
+    /* two segments fit into the window of the SYN-ACK, which is not
+     * scaled */
+    _connect(2 * TEST_PEER_MSS);
+    /* four segments fit into the scaled window */
+    _inject_ack((4 * TEST_PEER_MSS) >> TEST_PEER_WS, NULL, 0);
+    _app_start(_app_send);
+    for (unsigned i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+        TEST_ASSERT_EQUAL_INT(_peer_ack + (i * TEST_PEER_MSS), seg.seq);
+        TEST_ASSERT_EQUAL_INT(TEST_PEER_MSS, seg.len);
+        TEST_ASSERT_EQUAL_INT(0, memcmp(_data + (i * TEST_PEER_MSS), seg.data,
+                                        seg.len));
+    }
+    _peer_ack += 4 * TEST_PEER_MSS;
+    _inject_ack((4 * TEST_PEER_MSS) >> TEST_PEER_WS, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(sizeof(_data), _app_wait());
+}
+
+static void test_gnrc_tcp_send__rto(void)
+{
+    _seg_t seg;
+    uint32_t start;
+
+    _connect(1000);
+    TEST_ASSERT_EQUAL_INT(TEST_PEER_MSS,
+                          gnrc_tcp_send(&_tcb, _data, TEST_PEER_MSS));
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    start = xtimer_now();
+    TEST_ASSERT_EQUAL_INT(_peer_ack, seg.seq);
+    /* the segment is lost */
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT((xtimer_now() - start) >= (GNRC_TCP_RTO_MIN - TEST_QUIET));
+    TEST_ASSERT_EQUAL_INT(_peer_ack, seg.seq);
+    TEST_ASSERT_EQUAL_INT(TEST_PEER_MSS, seg.len);
+    _peer_ack += TEST_PEER_MSS;
+    _inject_ack(1000, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(-1, _expect(&seg, 2 * GNRC_TCP_RTO_MIN));
+}
+
+static void test_gnrc_tcp_send__sack(void)
+{
+    _seg_t seg;
+    uint8_t sack[12] = {
+        TCP_OPTION_KIND_NOP, TCP_OPTION_KIND_NOP, TCP_OPTION_KIND_SACK, 10,
+    };
+    uint32_t first;
+
+    _connect(1000);
+    _inject_ack(1000, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(sizeof(_data),
+                          gnrc_tcp_send(&_tcb, _data, sizeof(_data)));
+    first = _peer_ack;
+    for (unsigned i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    }
+    /* the first segment is lost, the peer reports the others */
+    for (unsigned i = 1; i < 4; i++) {
+        sack[4] = sack[5] = sack[6] = sack[7] = 0;
+        sack[4] = (first + TEST_PEER_MSS) >> 24;
+        sack[5] = (first + TEST_PEER_MSS) >> 16;
+        sack[6] = (first + TEST_PEER_MSS) >> 8;
+        sack[7] = (first + TEST_PEER_MSS);
+        sack[8] = (first + ((i + 1) * TEST_PEER_MSS)) >> 24;
+        sack[9] = (first + ((i + 1) * TEST_PEER_MSS)) >> 16;
+        sack[10] = (first + ((i + 1) * TEST_PEER_MSS)) >> 8;
+        sack[11] = (first + ((i + 1) * TEST_PEER_MSS));
+        _inject_ack(1000, sack, sizeof(sack));
+    }
+    /* fast retransmit of the first segment only */
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_QUIET));
+    TEST_ASSERT_EQUAL_INT(first, seg.seq);
+    TEST_ASSERT_EQUAL_INT(TEST_PEER_MSS, seg.len);
+    _peer_ack += sizeof(_data);
+    _inject_ack(1000, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(-1, _expect(&seg, 2 * GNRC_TCP_RTO_MIN));
+}
+
+static void test_gnrc_tcp_send__fast_recovery(void)
+{
+    _seg_t seg;
+    uint32_t first;
+
+    _connect(1000);
+    _inject_ack(1000, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(sizeof(_data),
+                          gnrc_tcp_send(&_tcb, _data, sizeof(_data)));
+    first = _peer_ack;
+    for (unsigned i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    }
+    /* the first segment is lost, the peer acknowledges the others without
+     * SACK */
+    for (unsigned i = 1; i < 4; i++) {
+        _inject_ack(1000, NULL, 0);
+    }
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_QUIET));
+    TEST_ASSERT_EQUAL_INT(first, seg.seq);
+    /* the window is inflated by the three segments that left the network */
+    TEST_ASSERT_EQUAL_INT(2 * TEST_PEER_MSS, _tcb.ssthresh);
+    TEST_ASSERT_EQUAL_INT(_tcb.ssthresh + (3 * TEST_PEER_MSS), _tcb.cwnd);
+    /* and by one more for every further duplicate ACK */
+    _inject_ack(1000, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(-1, _expect(&seg, TEST_QUIET));
+    TEST_ASSERT_EQUAL_INT(_tcb.ssthresh + (4 * TEST_PEER_MSS), _tcb.cwnd);
+    /* new data ends fast recovery and deflates the window */
+    _peer_ack += sizeof(_data);
+    _inject_ack(1000, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(-1, _expect(&seg, TEST_QUIET));
+    TEST_ASSERT_EQUAL_INT(_tcb.ssthresh, _tcb.cwnd);
+}
+
+static void test_gnrc_tcp_close__active(void)
+{
+    _seg_t seg;
+
+    _connect(1000);
+    _app_start(_app_close);
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT_EQUAL_INT(TCP_FLAG_FIN | TCP_FLAG_ACK, seg.flags);
+    TEST_ASSERT_EQUAL_INT(_peer_ack, seg.seq);
+    _peer_ack++;
+    _inject_ack(1000, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(0, _app_wait());
+    TEST_ASSERT_EQUAL_INT(GNRC_TCP_STATE_CLOSED, _tcb.state);
+    /* FIN-WAIT-2: the peer still sends data */
+    _inject_data(_peer_nxt, 0, _data, TEST_PEER_MSS);
+    _peer_nxt += TEST_PEER_MSS;
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT_EQUAL_INT(TCP_FLAG_ACK, seg.flags);
+    TEST_ASSERT_EQUAL_INT(_peer_nxt, seg.ack);
+    _inject_data(_peer_nxt++, TCP_FLAG_FIN, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT_EQUAL_INT(TCP_FLAG_ACK, seg.flags);
+    TEST_ASSERT_EQUAL_INT(_peer_ack, seg.seq);
+    TEST_ASSERT_EQUAL_INT(_peer_nxt, seg.ack);
+    /* TIME-WAIT: the ACK of the FIN got lost */
+    _inject_data(_peer_nxt - 1, TCP_FLAG_FIN, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT_EQUAL_INT(TCP_FLAG_ACK, seg.flags);
+    TEST_ASSERT_EQUAL_INT(_peer_nxt, seg.ack);
+    /* after TIME-WAIT the connection is gone */
+    xtimer_usleep(2 * GNRC_TCP_MSL + TEST_QUIET);
+    _inject_data(_peer_nxt - 1, TCP_FLAG_FIN, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT(seg.flags & TCP_FLAG_RST);
+}
+
+static void test_gnrc_tcp_close__passive(void)
+{
+    _seg_t seg;
+
+    _connect(1000);
+    _inject_data(_peer_nxt++, TCP_FLAG_FIN, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT_EQUAL_INT(_peer_nxt, seg.ack);
+    TEST_ASSERT_EQUAL_INT(GNRC_TCP_STATE_CLOSE_WAIT, _tcb.state);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_tcp_recv(&_tcb, _buf, sizeof(_buf)));
+    _app_start(_app_close);
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT_EQUAL_INT(TCP_FLAG_FIN | TCP_FLAG_ACK, seg.flags);
+    _peer_ack++;
+    _inject_ack(1000, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(0, _app_wait());
+    /* no TIME-WAIT after a passive close */
+    _inject_ack(1000, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(0, _expect(&seg, TEST_TIMEOUT));
+    TEST_ASSERT(seg.flags & TCP_FLAG_RST);
+}
+
+Test *tests_gnrc_tcp_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_gnrc_tcp_connect),
+        new_TestFixture(test_gnrc_tcp_connect__refused),
+        new_TestFixture(test_gnrc_tcp_accept),
+        new_TestFixture(test_gnrc_tcp_accept__backlog_timeout),
+        new_TestFixture(test_gnrc_tcp_close__listen),
+        new_TestFixture(test_gnrc_tcp_recv__in_order),
+        new_TestFixture(test_gnrc_tcp_recv__out_of_order),
+        new_TestFixture(test_gnrc_tcp_send__window_scaling),
+        new_TestFixture(test_gnrc_tcp_send__rto),
+        new_TestFixture(test_gnrc_tcp_send__sack),
+        new_TestFixture(test_gnrc_tcp_send__fast_recovery),
+        new_TestFixture(test_gnrc_tcp_close__active),
+        new_TestFixture(test_gnrc_tcp_close__passive),
+    };
+
+    EMB_UNIT_TESTCALLER(gnrc_tcp_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&gnrc_tcp_tests;
+}
+
+void tests_gnrc_tcp(void)
+{
+    /* this thread plays the network layer */
+    msg_init_queue(_msg_queue, TEST_MSG_QUEUE_SIZE);
+    gnrc_pktbuf_init();
+    _tcp_pid = gnrc_tcp_init();
+    _ipv6_entry.pid = thread_getpid();
+    gnrc_netreg_register(GNRC_NETTYPE_IPV6, &_ipv6_entry);
+    TESTS_RUN(tests_gnrc_tcp_tests());
+    gnrc_netreg_unregister(GNRC_NETTYPE_IPV6, &_ipv6_entry);
+}
+/** @} */
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file
+ * @brief       Unittests for the ``gnrc_tcp`` module
+ */
+#ifndef TESTS_GNRC_TCP_H_
+#define TESTS_GNRC_TCP_H_
+
+#include "embUnit.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_gnrc_tcp(void);
+
+/**
+ * @brief   Generates tests for gnrc_tcp
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_gnrc_tcp_tests(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TESTS_GNRC_TCP_H_ */
+/** @} */
@@ -12,11 +12,15 @@
  * @file
  */
 #include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "embUnit.h"
 
 #include "net/inet_csum.h"
+#include "xtimer.h"
 
 #include "unittests-constants.h"
 #include "tests-inet_csum.h"
@@ -165,6 +169,118 @@ static void test_inet_csum__empty_app_buffer(void)
     TEST_ASSERT_EQUAL_INT(hdr_expected, pyld_sum);
 }
 
+#define TEST_BUF_LEN    (1024U)
+#define TEST_BENCH_RUNS (1000U)
+
+static uint8_t _buf[TEST_BUF_LEN + 8];
+
+static void _fill(uint8_t *buf, size_t len)
+{
+    uint32_t x = 0x12345678;
+
+    for (size_t i = 0; i < len; i++) {
+        x = (x * 1103515245) + 12345;
+        buf[i] = x >> 16;
+    }
+}
+
+/* byte pair-wise reference implementation */
+static uint16_t _ref_csum_slice(uint16_t sum, const uint8_t *buf, uint16_t len,
+                                size_t accum_len)
+{
+    uint32_t csum = sum;
+
+    for (size_t i = 0; i < len; i++, accum_len++) {
+        csum += (accum_len & 1) ? buf[i] : (buf[i] << 8);
+    }
+    while (csum >> 16) {
+        csum = (csum & 0xffff) + (csum >> 16);
+    }
+    return csum;
+}
+
+static void test_inet_csum__unaligned(void)
+{
+    _fill(_buf, sizeof(_buf));
+    for (unsigned offset = 0; offset < 8; offset++) {
+        for (uint16_t len = 0; len < 100; len++) {
+            TEST_ASSERT_EQUAL_INT(_ref_csum_slice(0x1234, _buf + offset, len, 0),
+                                  inet_csum(0x1234, _buf + offset, len));
+        }
+    }
+}
+
+static void test_inet_csum__slices(void)
+{
+    uint16_t expected;
+
+    _fill(_buf, sizeof(_buf));
+    expected = inet_csum(0, _buf, 200);
+    /* split the domain at every byte, so the second slice starts at odd and
+     * even offsets and addresses */
+    for (uint16_t split = 0; split <= 200; split++) {
+        uint16_t sum = inet_csum_slice(0, _buf, split, 0);
+
+        sum = inet_csum_slice(sum, _buf + split, 200 - split, split);
+        TEST_ASSERT_EQUAL_INT(expected, sum);
+    }
+}
+
+static void test_inet_csum__replace(void)
+{
+    uint8_t data[64], old[5];
+    uint16_t csum;
+
+    _fill(data, sizeof(data));
+    csum = ~inet_csum(0, data, sizeof(data));
+    for (size_t offset = 0; offset < (sizeof(data) - sizeof(old)); offset++) {
+        memcpy(old, &data[offset], sizeof(old));
+        memset(&data[offset], (int)offset, sizeof(old));
+        csum = inet_csum_replace(csum, old, &data[offset], sizeof(old), offset);
+        TEST_ASSERT_EQUAL_INT((uint16_t)~inet_csum(0, data, sizeof(data)), csum);
+    }
+}
+
+static void test_inet_csum__update16(void)
+{
+    /* IPv4 header as in RFC 1624, section 4: TTL is decremented */
+    uint8_t hdr[] = {
+        0x45, 0x00, 0x00, 0x54, 0x00, 0x00, 0x40, 0x00,
+        0x40, 0x01, 0x00, 0x00, 0xc0, 0xa8, 0x00, 0x01,
+        0xc0, 0xa8, 0x00, 0xc7,
+    };
+    uint16_t csum = ~inet_csum(0, hdr, sizeof(hdr));
+    uint16_t old = (hdr[8] << 8) | hdr[9];
+
+    hdr[8]--;
+    csum = inet_csum_update16(csum, old, (hdr[8] << 8) | hdr[9]);
+    TEST_ASSERT_EQUAL_INT((uint16_t)~inet_csum(0, hdr, sizeof(hdr)), csum);
+}
+
+/* reports the throughput of inet_csum() against the byte pair-wise
+ * reference */
+static void test_inet_csum__benchmark(void)
+{
+    uint32_t start, fast, ref;
+    volatile uint16_t sum = 0;
+
+    _fill(_buf, sizeof(_buf));
+    start = xtimer_now();
+    for (unsigned i = 0; i < TEST_BENCH_RUNS; i++) {
+        sum += inet_csum(0, _buf + (i & 1), TEST_BUF_LEN);
+    }
+    fast = xtimer_now() - start;
+    start = xtimer_now();
+    for (unsigned i = 0; i < TEST_BENCH_RUNS; i++) {
+        sum += _ref_csum_slice(0, _buf + (i & 1), TEST_BUF_LEN, 0);
+    }
+    ref = xtimer_now() - start;
+    printf("\ninet_csum: %" PRIu32 " bytes/ms (byte-wise: %" PRIu32 " bytes/ms)",
+           (uint32_t)(((uint64_t)TEST_BUF_LEN * TEST_BENCH_RUNS * 1000) / (fast ? fast : 1)),
+           (uint32_t)(((uint64_t)TEST_BUF_LEN * TEST_BENCH_RUNS * 1000) / (ref ? ref : 1)));
+    (void)sum;
+}
+
 Test *tests_inet_csum_tests(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
@@ -176,6 +292,11 @@ Test *tests_inet_csum_tests(void)
         new_TestFixture(test_inet_csum__odd_len),
         new_TestFixture(test_inet_csum__two_app_snips),
         new_TestFixture(test_inet_csum__empty_app_buffer),
+        new_TestFixture(test_inet_csum__unaligned),
+        new_TestFixture(test_inet_csum__slices),
+        new_TestFixture(test_inet_csum__replace),
+        new_TestFixture(test_inet_csum__update16),
+        new_TestFixture(test_inet_csum__benchmark),
     };
 
     EMB_UNIT_TESTCALLER(inet_csum_tests, NULL, NULL, fixtures);
@@ -118,6 +118,35 @@ static void test_ipv6_nc_add__full(void)
                                       sizeof(TEST_STRING4), 0));
 }
 
+static void test_ipv6_nc_add__full_replace_stale(void)
+{
+    ipv6_addr_t addr = DEFAULT_TEST_IPV6_ADDR;
+    ipv6_addr_t first = DEFAULT_TEST_IPV6_ADDR, second = DEFAULT_TEST_IPV6_ADDR;
+    gnrc_ipv6_nc_stats_t stats;
+
+    for (int i = 0; i < GNRC_IPV6_NC_SIZE; i++) {
+        TEST_ASSERT_NOT_NULL(gnrc_ipv6_nc_add(DEFAULT_TEST_NETIF, &addr, TEST_STRING4,
+                                              sizeof(TEST_STRING4),
+                                              GNRC_IPV6_NC_STATE_STALE));
+        addr.u16[7].u16++;
+    }
+
+    second.u16[7].u16++;
+    /* use first entry so the second one becomes least recently used */
+    TEST_ASSERT_NOT_NULL(gnrc_ipv6_nc_get(DEFAULT_TEST_NETIF, &first));
+    TEST_ASSERT_NOT_NULL(gnrc_ipv6_nc_add(DEFAULT_TEST_NETIF, &addr, TEST_STRING4,
+                                          sizeof(TEST_STRING4), 0));
+    TEST_ASSERT_NOT_NULL(gnrc_ipv6_nc_get(DEFAULT_TEST_NETIF, &addr));
+    TEST_ASSERT_NOT_NULL(gnrc_ipv6_nc_get(DEFAULT_TEST_NETIF, &first));
+    TEST_ASSERT_NULL(gnrc_ipv6_nc_get(DEFAULT_TEST_NETIF, &second));
+
+    gnrc_ipv6_nc_get_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, stats.evictions);
+    TEST_ASSERT_EQUAL_INT(0, stats.add_fails);
+    TEST_ASSERT_EQUAL_INT(4, stats.lookups);
+    TEST_ASSERT_EQUAL_INT(3, stats.hits);
+}
+
 static void test_ipv6_nc_add__success(void)
 {
     ipv6_addr_t addr = DEFAULT_TEST_IPV6_ADDR;
@@ -398,6 +427,28 @@ static void test_ipv6_nc_still_reachable__success(void)
     TEST_ASSERT(gnrc_ipv6_nc_is_reachable(entry));
 }
 
+static void test_ipv6_nc_get_gen__changes(void)
+{
+    ipv6_addr_t addr = DEFAULT_TEST_IPV6_ADDR;
+    gnrc_ipv6_nc_t *entry = NULL;
+    uint32_t gen = gnrc_ipv6_nc_get_gen();
+
+    test_ipv6_nc_add__success(); /* adds DEFAULT_TEST_IPV6_ADDR to DEFAULT_TEST_NETIF */
+    TEST_ASSERT(gen != gnrc_ipv6_nc_get_gen());
+    gen = gnrc_ipv6_nc_get_gen();
+
+    TEST_ASSERT_NOT_NULL((entry = gnrc_ipv6_nc_get(KERNEL_PID_UNDEF, &addr)));
+    TEST_ASSERT_EQUAL_INT(gen, gnrc_ipv6_nc_get_gen());
+
+    entry->flags = (GNRC_IPV6_NC_STATE_STALE << GNRC_IPV6_NC_STATE_POS);
+    TEST_ASSERT_NOT_NULL(gnrc_ipv6_nc_still_reachable(&addr));
+    TEST_ASSERT(gen != gnrc_ipv6_nc_get_gen());
+    gen = gnrc_ipv6_nc_get_gen();
+
+    gnrc_ipv6_nc_remove(DEFAULT_TEST_NETIF, &addr);
+    TEST_ASSERT(gen != gnrc_ipv6_nc_get_gen());
+}
+
 static void test_ipv6_nc_get_l2_addr__NULL_entry(void)
 {
     gnrc_ipv6_nc_t *entry = NULL;
@@ -449,6 +500,7 @@ Test *tests_ipv6_nc_tests(void)
         new_TestFixture(test_ipv6_nc_add__addr_unspecified),
         new_TestFixture(test_ipv6_nc_add__l2addr_too_long),
         new_TestFixture(test_ipv6_nc_add__full),
+        new_TestFixture(test_ipv6_nc_add__full_replace_stale),
         new_TestFixture(test_ipv6_nc_add__success),
         new_TestFixture(test_ipv6_nc_add__address_update_despite_free_entry),
         new_TestFixture(test_ipv6_nc_remove__no_entry_pid),
@@ -472,6 +524,7 @@ Test *tests_ipv6_nc_tests(void)
         new_TestFixture(test_ipv6_nc_is_reachable__unmanaged),
         new_TestFixture(test_ipv6_nc_still_reachable__incomplete),
         new_TestFixture(test_ipv6_nc_still_reachable__success),
+        new_TestFixture(test_ipv6_nc_get_gen__changes),
         new_TestFixture(test_ipv6_nc_get_l2_addr__NULL_entry),
         new_TestFixture(test_ipv6_nc_get_l2_addr__unreachable),
         new_TestFixture(test_ipv6_nc_get_l2_addr__reachable),
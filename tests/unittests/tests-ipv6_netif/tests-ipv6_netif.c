@@ -254,6 +254,23 @@ static void test_ipv6_netif_reset_addr__success(void)
     TEST_ASSERT_NULL(gnrc_ipv6_netif_find_addr(DEFAULT_TEST_NETIF, &addr));
 }
 
+static void test_ipv6_netif_get_gen__changes(void)
+{
+    ipv6_addr_t addr = DEFAULT_TEST_IPV6_ADDR;
+    uint32_t gen = gnrc_ipv6_netif_get_gen();
+
+    test_ipv6_netif_add_addr__success(); /* adds DEFAULT_TEST_IPV6_ADDR to
+                                          * DEFAULT_TEST_NETIF */
+    TEST_ASSERT(gen != gnrc_ipv6_netif_get_gen());
+    gen = gnrc_ipv6_netif_get_gen();
+
+    TEST_ASSERT_NOT_NULL(gnrc_ipv6_netif_find_addr(DEFAULT_TEST_NETIF, &addr));
+    TEST_ASSERT_EQUAL_INT(gen, gnrc_ipv6_netif_get_gen());
+
+    gnrc_ipv6_netif_remove_addr(DEFAULT_TEST_NETIF, &addr);
+    TEST_ASSERT(gen != gnrc_ipv6_netif_get_gen());
+}
+
 static void test_ipv6_netif_find_by_addr__empty(void)
 {
     ipv6_addr_t addr = DEFAULT_TEST_IPV6_ADDR;
@@ -549,6 +566,7 @@ Test *tests_ipv6_netif_tests(void)
         new_TestFixture(test_ipv6_netif_remove_addr__not_allocated),
         new_TestFixture(test_ipv6_netif_remove_addr__success),
         new_TestFixture(test_ipv6_netif_reset_addr__success),
+        new_TestFixture(test_ipv6_netif_get_gen__changes),
         new_TestFixture(test_ipv6_netif_find_by_addr__empty),
         new_TestFixture(test_ipv6_netif_find_by_addr__success),
         new_TestFixture(test_ipv6_netif_find_addr__no_iface),
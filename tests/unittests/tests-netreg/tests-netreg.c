@@ -15,20 +15,27 @@
 
 #include "embUnit.h"
 
+#include "msg.h"
+#include "net/gnrc/netapi.h"
 #include "net/gnrc/netreg.h"
 #include "net/gnrc/nettype.h"
+#include "net/gnrc/pktbuf.h"
+#include "thread.h"
+#include "thread_flags.h"
+#include "xtimer.h"
 
 #include "unittests-constants.h"
 #include "tests-netreg.h"
 
 static gnrc_netreg_entry_t entries[] = {
-    { NULL, TEST_UINT16, TEST_UINT8 },
-    { NULL, TEST_UINT16, TEST_UINT8 + 1 }
+    GNRC_NETREG_ENTRY_INIT_PID(TEST_UINT16, TEST_UINT8),
+    GNRC_NETREG_ENTRY_INIT_PID(TEST_UINT16, TEST_UINT8 + 1)
 };
 
 static void set_up(void)
 {
     gnrc_netreg_init();
+    gnrc_pktbuf_init();
 }
 
 static void test_netreg_register__inval_numof(void)
@@ -139,6 +146,308 @@ void test_netreg_getnext__2_entries(void)
     TEST_ASSERT_NOT_NULL(gnrc_netreg_getnext(res));
 }
 
+void test_netreg_getnext__same_bucket(void)
+{
+    gnrc_netreg_entry_t other[] = {
+        GNRC_NETREG_ENTRY_INIT_PID(TEST_UINT16 + GNRC_NETREG_BUCKETS, TEST_UINT8 + 2),
+        GNRC_NETREG_ENTRY_INIT_PID(TEST_UINT16 + GNRC_NETREG_BUCKETS, TEST_UINT8 + 3),
+    };
+    gnrc_netreg_entry_t *res = NULL;
+
+    /* interleave registrations of two demux contexts in the same bucket */
+    TEST_ASSERT_EQUAL_INT(0, gnrc_netreg_register(GNRC_NETTYPE_TEST, &entries[0]));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_netreg_register(GNRC_NETTYPE_TEST, &other[0]));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_netreg_register(GNRC_NETTYPE_TEST, &entries[1]));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_netreg_register(GNRC_NETTYPE_TEST, &other[1]));
+    TEST_ASSERT_EQUAL_INT(2, gnrc_netreg_num(GNRC_NETTYPE_TEST, TEST_UINT16));
+    TEST_ASSERT_EQUAL_INT(2, gnrc_netreg_num(GNRC_NETTYPE_TEST,
+                                             TEST_UINT16 + GNRC_NETREG_BUCKETS));
+    TEST_ASSERT_NOT_NULL((res = gnrc_netreg_lookup(GNRC_NETTYPE_TEST, TEST_UINT16)));
+    TEST_ASSERT_EQUAL_INT(TEST_UINT16, res->demux_ctx);
+    TEST_ASSERT_NOT_NULL((res = gnrc_netreg_getnext(res)));
+    TEST_ASSERT_EQUAL_INT(TEST_UINT16, res->demux_ctx);
+    TEST_ASSERT_NULL(gnrc_netreg_getnext(res));
+    gnrc_netreg_unregister(GNRC_NETTYPE_TEST, &other[0]);
+    gnrc_netreg_unregister(GNRC_NETTYPE_TEST, &other[1]);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_netreg_num(GNRC_NETTYPE_TEST,
+                                             TEST_UINT16 + GNRC_NETREG_BUCKETS));
+    TEST_ASSERT_EQUAL_INT(2, gnrc_netreg_num(GNRC_NETTYPE_TEST, TEST_UINT16));
+}
+
+#define TEST_MBOX_SIZE  (2U)
+#define TEST_MBOX_FLAG  (0x1)
+
+static void test_netreg_register_mbox__dispatch(void)
+{
+    gnrc_netapi_mbox_t mbox;
+    gnrc_pktsnip_t *queue[TEST_MBOX_SIZE];
+    gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(NULL, TEST_STRING8, sizeof(TEST_STRING8),
+                                          GNRC_NETTYPE_TEST);
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    gnrc_netapi_mbox_init(&mbox, queue, TEST_MBOX_SIZE, TEST_MBOX_FLAG);
+    thread_flags_clear(TEST_MBOX_FLAG);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_netreg_register_mbox(GNRC_NETTYPE_TEST, &entries[0],
+                                                       &mbox));
+    TEST_ASSERT_NULL(gnrc_netapi_mbox_try_get(&mbox));
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_TEST,
+                                                          TEST_UINT16, pkt));
+    TEST_ASSERT_EQUAL_INT(TEST_MBOX_FLAG, thread_flags_clear(TEST_MBOX_FLAG));
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_mbox_avail(&mbox));
+    TEST_ASSERT(pkt == gnrc_netapi_mbox_try_get(&mbox));
+    TEST_ASSERT_NULL(gnrc_netapi_mbox_try_get(&mbox));
+    gnrc_pktbuf_release(pkt);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_netreg_register_mbox__full(void)
+{
+    gnrc_netapi_mbox_t mbox;
+    gnrc_pktsnip_t *queue[TEST_MBOX_SIZE];
+
+    gnrc_netapi_mbox_init(&mbox, queue, TEST_MBOX_SIZE, TEST_MBOX_FLAG);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_netreg_register_mbox(GNRC_NETTYPE_TEST, &entries[0],
+                                                       &mbox));
+    for (unsigned i = 0; i < (TEST_MBOX_SIZE + 1); i++) {
+        gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(NULL, TEST_STRING8, sizeof(TEST_STRING8),
+                                              GNRC_NETTYPE_TEST);
+
+        TEST_ASSERT_NOT_NULL(pkt);
+        gnrc_netapi_dispatch_receive(GNRC_NETTYPE_TEST, TEST_UINT16, pkt);
+    }
+    thread_flags_clear(TEST_MBOX_FLAG);
+    TEST_ASSERT_EQUAL_INT(TEST_MBOX_SIZE, gnrc_netapi_mbox_avail(&mbox));
+    TEST_ASSERT_EQUAL_INT(1, mbox.drops);
+    gnrc_netapi_mbox_flush(&mbox);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_netapi_mbox_avail(&mbox));
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_netreg_register_mbox__set(void)
+{
+    gnrc_netapi_mbox_set_t set;
+    gnrc_netapi_mbox_t mbox[2], *ready[2];
+    gnrc_pktsnip_t *queue[2][TEST_MBOX_SIZE], *pkt;
+
+    gnrc_netapi_mbox_set_init(&set, TEST_MBOX_FLAG);
+    for (unsigned i = 0; i < 2; i++) {
+        gnrc_netapi_mbox_init(&mbox[i], queue[i], TEST_MBOX_SIZE, TEST_MBOX_FLAG);
+        TEST_ASSERT_EQUAL_INT(0, gnrc_netreg_register_mbox(GNRC_NETTYPE_TEST, &entries[i],
+                                                           &mbox[i]));
+        gnrc_netapi_mbox_set_add(&set, &mbox[i], &entries[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(0, gnrc_netapi_mbox_set_wait(&set, ready, 2, 0));
+    pkt = gnrc_pktbuf_add(NULL, TEST_STRING8, sizeof(TEST_STRING8), GNRC_NETTYPE_TEST);
+    TEST_ASSERT_NOT_NULL(pkt);
+    /* both entries have the same demux context, the last registered gets
+     * the packet first */
+    TEST_ASSERT_EQUAL_INT(2, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_TEST, TEST_UINT16,
+                                                          pkt));
+    /* mailboxes with packets are reported in turns */
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_mbox_set_wait(&set, ready, 1, 0));
+    TEST_ASSERT(ready[0]->ctx == &entries[1]);
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_mbox_set_wait(&set, ready, 1, 0));
+    TEST_ASSERT(ready[0]->ctx == &entries[0]);
+    /* emptied mailboxes are not reported anymore */
+    gnrc_netapi_mbox_flush(&mbox[0]);
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_mbox_set_wait(&set, ready, 2, 0));
+    TEST_ASSERT(ready[0] == &mbox[1]);
+    gnrc_netapi_mbox_set_remove(&mbox[1]);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_netapi_mbox_set_wait(&set, ready, 2, 0));
+    gnrc_netapi_mbox_flush(&mbox[1]);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void _notify_cb(void *arg)
+{
+    gnrc_netapi_mbox_notify(arg);
+}
+
+static void test_netreg_register_mbox__set_stale_timeout(void)
+{
+    gnrc_netapi_mbox_set_t set;
+    gnrc_netapi_mbox_t mbox, *ready;
+    gnrc_pktsnip_t *queue[TEST_MBOX_SIZE];
+    xtimer_t timer = { .callback = _notify_cb, .arg = &mbox };
+
+    gnrc_netapi_mbox_set_init(&set, TEST_MBOX_FLAG);
+    gnrc_netapi_mbox_init(&mbox, queue, TEST_MBOX_SIZE, TEST_MBOX_FLAG);
+    gnrc_netapi_mbox_set_add(&set, &mbox, NULL);
+    /* left over from a timed wait that was interrupted by its timeout */
+    thread_flags_set((thread_t *)sched_active_thread, THREAD_FLAG_TIMEOUT);
+    xtimer_set(&timer, 1000);
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_mbox_set_wait(&set, &ready, 1,
+                                                       GNRC_NETAPI_MBOX_WAIT_FOREVER));
+    TEST_ASSERT(ready == &mbox);
+    gnrc_netapi_mbox_set_remove(&mbox);
+    thread_flags_clear(TEST_MBOX_FLAG);
+}
+
+#define TEST_BATCH_QUEUE_SIZE   (2U)
+#define TEST_BATCH_MSG_STOP     (0x7fff)
+#define TEST_BATCH_WAIT         (10U * 1000U)
+
+static char _batch_stack[THREAD_STACKSIZE_DEFAULT];
+static unsigned _batch_msgs, _batch_pkts, _single_pkts;
+static bool _batch_in_order;
+static gnrc_netreg_entry_t _batch_entry = GNRC_NETREG_ENTRY_INIT_PID(TEST_UINT16,
+                                                                      KERNEL_PID_UNDEF);
+
+static void _batch_count(gnrc_pktsnip_t *pkt, void *arg)
+{
+    (void)arg;
+    if (((uint8_t *)pkt->data)[0] != (uint8_t)_batch_pkts) {
+        _batch_in_order = false;
+    }
+    _batch_pkts++;
+    gnrc_pktbuf_release(pkt);
+}
+
+static void *_batch_receiver(void *arg)
+{
+    msg_t msg, queue[TEST_BATCH_QUEUE_SIZE];
+
+    msg_init_queue(queue, TEST_BATCH_QUEUE_SIZE);
+    _batch_entry.pid = thread_getpid();
+    gnrc_netreg_register(GNRC_NETTYPE_TEST, &_batch_entry);
+    if (arg != NULL) {
+        /* become a thread that is passed batches */
+        gnrc_netapi_batch_begin(arg);
+        gnrc_netapi_batch_end();
+    }
+    while (1) {
+        msg_receive(&msg);
+        switch (msg.type) {
+            case GNRC_NETAPI_MSG_TYPE_RCV_BATCH:
+                _batch_msgs++;
+                gnrc_netapi_batch_handle(&msg, _batch_count, NULL);
+                break;
+            case GNRC_NETAPI_MSG_TYPE_RCV:
+                _single_pkts++;
+                gnrc_pktbuf_release((gnrc_pktsnip_t *)msg.content.ptr);
+                break;
+            default:
+                gnrc_netreg_unregister(GNRC_NETTYPE_TEST, &_batch_entry);
+                return NULL;
+        }
+    }
+    return NULL;
+}
+
+/* the receiver has a lower priority, so it only handles its messages while
+ * the test sleeps */
+static kernel_pid_t _batch_receiver_start(gnrc_netapi_batch_t *batch)
+{
+    kernel_pid_t pid = thread_create(_batch_stack, sizeof(_batch_stack),
+                                     THREAD_PRIORITY_MAIN + 1,
+                                     THREAD_CREATE_STACKTEST,
+                                     _batch_receiver, batch, "batch");
+
+    _batch_msgs = 0;
+    _batch_pkts = 0;
+    _single_pkts = 0;
+    _batch_in_order = true;
+    xtimer_usleep(TEST_BATCH_WAIT);
+    return pid;
+}
+
+static void _batch_receiver_stop(kernel_pid_t pid)
+{
+    msg_t msg = { .type = TEST_BATCH_MSG_STOP };
+
+    msg_send(&msg, pid);
+    xtimer_usleep(TEST_BATCH_WAIT);
+    TEST_ASSERT_NULL(thread_get(pid));
+}
+
+static void _batch_receive(kernel_pid_t pid, unsigned numof)
+{
+    for (unsigned i = 0; i < numof; i++) {
+        uint8_t idx = (uint8_t)i;
+        gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(NULL, &idx, sizeof(idx),
+                                              GNRC_NETTYPE_TEST);
+
+        TEST_ASSERT_NOT_NULL(pkt);
+        TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_receive(pid, pkt));
+    }
+}
+
+static void test_netapi_batch__one_msg(void)
+{
+    gnrc_netapi_batch_t receiver_batch, batch;
+    kernel_pid_t pid = _batch_receiver_start(&receiver_batch);
+
+    gnrc_netapi_batch_collect(&batch);
+    _batch_receive(pid, 3);
+    TEST_ASSERT_EQUAL_INT(0, _batch_msgs);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_netapi_batch_end());
+    xtimer_usleep(TEST_BATCH_WAIT);
+    TEST_ASSERT_EQUAL_INT(1, _batch_msgs);
+    TEST_ASSERT_EQUAL_INT(3, _batch_pkts);
+    TEST_ASSERT_EQUAL_INT(0, _single_pkts);
+    TEST_ASSERT(_batch_in_order);
+    _batch_receiver_stop(pid);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_netapi_batch__dropped(void)
+{
+    gnrc_netapi_batch_t receiver_batch, batch;
+    kernel_pid_t pid = _batch_receiver_start(&receiver_batch);
+
+    gnrc_netapi_batch_collect(&batch);
+    /* the first batch is copied to the waiting receiver, the next two are
+     * queued, the fourth is dropped when the fifth is collected and the
+     * fifth when the batch ends */
+    _batch_receive(pid, 5 * GNRC_NETAPI_BATCH_SIZE);
+    TEST_ASSERT_EQUAL_INT(2 * GNRC_NETAPI_BATCH_SIZE, gnrc_netapi_batch_end());
+    xtimer_usleep(TEST_BATCH_WAIT);
+    TEST_ASSERT_EQUAL_INT(3, _batch_msgs);
+    TEST_ASSERT_EQUAL_INT(3 * GNRC_NETAPI_BATCH_SIZE, _batch_pkts);
+    _batch_receiver_stop(pid);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_netapi_batch__pid_reused(void)
+{
+    gnrc_netapi_batch_t receiver_batch, batch;
+    kernel_pid_t pid = _batch_receiver_start(&receiver_batch);
+
+    /* the receiver unregisters before it exits, the new thread with the
+     * same stack does not handle batch messages */
+    _batch_receiver_stop(pid);
+    TEST_ASSERT_EQUAL_INT(pid, _batch_receiver_start(NULL));
+    gnrc_netapi_batch_collect(&batch);
+    _batch_receive(pid, 2);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_netapi_batch_end());
+    xtimer_usleep(TEST_BATCH_WAIT);
+    TEST_ASSERT_EQUAL_INT(0, _batch_msgs);
+    TEST_ASSERT_EQUAL_INT(2, _single_pkts);
+    _batch_receiver_stop(pid);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_netapi_batch__other_registration(void)
+{
+    gnrc_netapi_batch_t receiver_batch, batch;
+    kernel_pid_t pid = _batch_receiver_start(&receiver_batch);
+    gnrc_netreg_entry_t entry = GNRC_NETREG_ENTRY_INIT_PID(TEST_UINT16 + 1, pid);
+
+    /* the receiver is still registered with _batch_entry, so it keeps
+     * getting batches */
+    TEST_ASSERT_EQUAL_INT(0, gnrc_netreg_register(GNRC_NETTYPE_TEST, &entry));
+    gnrc_netreg_unregister(GNRC_NETTYPE_TEST, &entry);
+    gnrc_netapi_batch_collect(&batch);
+    _batch_receive(pid, 2);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_netapi_batch_end());
+    xtimer_usleep(TEST_BATCH_WAIT);
+    TEST_ASSERT_EQUAL_INT(1, _batch_msgs);
+    TEST_ASSERT_EQUAL_INT(2, _batch_pkts);
+    TEST_ASSERT_EQUAL_INT(0, _single_pkts);
+    _batch_receiver_stop(pid);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
 Test *tests_netreg_tests(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
@@ -155,6 +464,15 @@ Test *tests_netreg_tests(void)
         new_TestFixture(test_netreg_num__2_entries),
         new_TestFixture(test_netreg_getnext__NULL),
         new_TestFixture(test_netreg_getnext__2_entries),
+        new_TestFixture(test_netreg_getnext__same_bucket),
+        new_TestFixture(test_netreg_register_mbox__dispatch),
+        new_TestFixture(test_netreg_register_mbox__full),
+        new_TestFixture(test_netreg_register_mbox__set),
+        new_TestFixture(test_netreg_register_mbox__set_stale_timeout),
+        new_TestFixture(test_netapi_batch__one_msg),
+        new_TestFixture(test_netapi_batch__dropped),
+        new_TestFixture(test_netapi_batch__pid_reused),
+        new_TestFixture(test_netapi_batch__other_registration),
     };
 
     EMB_UNIT_TESTCALLER(netreg_tests, set_up, NULL, fixtures);
@@ -25,6 +25,15 @@
 #include "unittests-constants.h"
 #include "tests-pktbuf.h"
 
+#ifdef MODULE_GNRC_PKTBUF_SLAB
+/* only fits the largest size class */
+#define TEST_ADD_SIZE   (GNRC_PKTBUF_SLAB_MEDIUM_SIZE + 1)
+#define TEST_ADD_NUMOF  (GNRC_PKTBUF_SLAB_LARGE_NUMOF)
+#else
+#define TEST_ADD_SIZE   ((GNRC_PKTBUF_SIZE / 10) + 4)
+#define TEST_ADD_NUMOF  (9)
+#endif
+
 typedef struct __attribute__((packed)) {
     uint8_t u8;
     uint16_t u16;
@@ -180,13 +189,13 @@ static void test_pktbuf_add__success(void)
 {
     gnrc_pktsnip_t *pkt, *pkt_prev = NULL;
 
-    for (int i = 0; i < 9; i++) {
-        pkt = gnrc_pktbuf_add(NULL, NULL, (GNRC_PKTBUF_SIZE / 10) + 4, GNRC_NETTYPE_TEST);
+    for (int i = 0; i < TEST_ADD_NUMOF; i++) {
+        pkt = gnrc_pktbuf_add(NULL, NULL, TEST_ADD_SIZE, GNRC_NETTYPE_TEST);
 
         TEST_ASSERT_NOT_NULL(pkt);
         TEST_ASSERT_NULL(pkt->next);
         TEST_ASSERT_NOT_NULL(pkt->data);
-        TEST_ASSERT_EQUAL_INT((GNRC_PKTBUF_SIZE / 10) + 4, pkt->size);
+        TEST_ASSERT_EQUAL_INT(TEST_ADD_SIZE, pkt->size);
         TEST_ASSERT_EQUAL_INT(GNRC_NETTYPE_TEST, pkt->type);
         TEST_ASSERT_EQUAL_INT(1, pkt->users);
 
@@ -428,6 +437,67 @@ static void test_pktbuf_mark__success_small(void)
     TEST_ASSERT(gnrc_pktbuf_is_empty());
 }
 
+static void test_pktbuf_mark__split_often(void)
+{
+    uint8_t data[64];
+    gnrc_pktsnip_t *pkt;
+    const unsigned splits = 24;
+
+    for (unsigned i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)i;
+    }
+    pkt = gnrc_pktbuf_add(NULL, data, sizeof(data), GNRC_NETTYPE_TEST);
+    TEST_ASSERT_NOT_NULL(pkt);
+    /* all marked snips may share the data of pkt */
+    for (unsigned i = 0; i < splits; i++) {
+        gnrc_pktsnip_t *marked = gnrc_pktbuf_mark(pkt, 1, GNRC_NETTYPE_UNDEF);
+
+        TEST_ASSERT_NOT_NULL(marked);
+        TEST_ASSERT(pkt->next == marked);
+        TEST_ASSERT_EQUAL_INT(1, marked->size);
+        TEST_ASSERT_EQUAL_INT(i, *((uint8_t *)marked->data));
+    }
+    TEST_ASSERT(gnrc_pktbuf_is_sane());
+    TEST_ASSERT_EQUAL_INT(sizeof(data) - splits, pkt->size);
+    TEST_ASSERT_EQUAL_INT(splits, *((uint8_t *)pkt->data));
+
+    gnrc_pktbuf_release(pkt);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_pktbuf_mark_headroom__no_move(void)
+{
+    /* odd header length, like the ethernet header */
+    const size_t hdr_len = 14;
+    size_t headroom = gnrc_pktbuf_mark_headroom(hdr_len);
+    gnrc_pktsnip_t *pkt1 = gnrc_pktbuf_add(NULL, NULL, headroom + hdr_len +
+                                           sizeof(TEST_STRING16),
+                                           GNRC_NETTYPE_TEST);
+    gnrc_pktsnip_t *pkt2;
+    uint8_t *payload;
+
+    TEST_ASSERT_EQUAL_INT(0, gnrc_pktbuf_mark_headroom(0));
+    TEST_ASSERT_NOT_NULL(pkt1);
+    payload = (uint8_t *)pkt1->data + headroom + hdr_len;
+    memset((uint8_t *)pkt1->data + headroom, 0x2a, hdr_len);
+    memcpy(payload, TEST_STRING16, sizeof(TEST_STRING16));
+    TEST_ASSERT_NOT_NULL((pkt2 = gnrc_pktbuf_mark(pkt1, headroom + hdr_len,
+                                                  GNRC_NETTYPE_UNDEF)));
+    TEST_ASSERT(gnrc_pktbuf_is_sane());
+    TEST_ASSERT(pkt1->next == pkt2);
+    TEST_ASSERT(pkt1->data == payload);
+    TEST_ASSERT_EQUAL_INT(sizeof(TEST_STRING16), pkt1->size);
+    TEST_ASSERT_EQUAL_STRING(TEST_STRING16, pkt1->data);
+    TEST_ASSERT_EQUAL_INT(headroom + hdr_len, pkt2->size);
+    TEST_ASSERT_EQUAL_INT(0x2a, ((uint8_t *)pkt2->data)[headroom]);
+    TEST_ASSERT_EQUAL_INT(0x2a, ((uint8_t *)pkt2->data)[headroom + hdr_len - 1]);
+
+    gnrc_pktbuf_remove_snip(pkt1, pkt2);
+    TEST_ASSERT(gnrc_pktbuf_is_sane());
+    gnrc_pktbuf_release(pkt1);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
 static void test_pktbuf_realloc_data__size_0(void)
 {
     gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(NULL, NULL, sizeof(TEST_STRING8), GNRC_NETTYPE_TEST);
@@ -559,6 +629,68 @@ static void test_pktbuf_realloc_data__success2(void)
     TEST_ASSERT_EQUAL_INT(1, pkt->users);
 }
 
+static void test_pktbuf_realloc_data__headroom_grow_shrink(void)
+{
+    gnrc_pktsnip_t *pkts[GNRC_PKTBUF_HEADROOM_NUMOF];
+    gnrc_pktsnip_t *pkt, *hdr;
+
+    pkt = gnrc_pktbuf_add_headroom(NULL, TEST_STRING8, sizeof(TEST_STRING8),
+                                   GNRC_PKTBUF_TX_HEADROOM, GNRC_NETTYPE_TEST);
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_pktbuf_realloc_data(pkt, sizeof(TEST_STRING16)));
+    TEST_ASSERT_EQUAL_STRING(TEST_STRING8, pkt->data);
+    memcpy(pkt->data, TEST_STRING16, sizeof(TEST_STRING16));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_pktbuf_realloc_data(pkt, sizeof(TEST_STRING12)));
+    TEST_ASSERT_EQUAL_INT(sizeof(TEST_STRING12), pkt->size);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(TEST_STRING16, pkt->data, sizeof(TEST_STRING12)));
+    TEST_ASSERT(gnrc_pktbuf_is_sane());
+
+    /* leaves pkt with data behind the original payload */
+    TEST_ASSERT_NOT_NULL((hdr = gnrc_pktbuf_mark(pkt, sizeof(TEST_STRING8) + 1,
+                                                 GNRC_NETTYPE_UNDEF)));
+    gnrc_pktbuf_remove_snip(pkt, hdr);
+    gnrc_pktbuf_release(pkt);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+
+    /* all headrooms are available again */
+    for (unsigned i = 0; i < GNRC_PKTBUF_HEADROOM_NUMOF; i++) {
+        pkts[i] = gnrc_pktbuf_add_headroom(NULL, TEST_STRING8, sizeof(TEST_STRING8),
+                                           GNRC_PKTBUF_TX_HEADROOM, GNRC_NETTYPE_TEST);
+        TEST_ASSERT_NOT_NULL(pkts[i]);
+        TEST_ASSERT(gnrc_pktbuf_headroom(pkts[i]) >= GNRC_PKTBUF_TX_HEADROOM);
+    }
+    for (unsigned i = 0; i < GNRC_PKTBUF_HEADROOM_NUMOF; i++) {
+        gnrc_pktbuf_release(pkts[i]);
+    }
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+#ifndef MODULE_GNRC_PKTBUF_SLAB
+static void test_pktbuf_realloc_data__released_snip(void)
+{
+    gnrc_pktsnip_t *pkt1 = gnrc_pktbuf_add(NULL, TEST_STRING8, sizeof(TEST_STRING8),
+                                           GNRC_NETTYPE_TEST);
+    gnrc_pktsnip_t *pkt2 = gnrc_pktbuf_add(NULL, TEST_STRING8, sizeof(TEST_STRING8),
+                                           GNRC_NETTYPE_TEST);
+    size_t size;
+
+    TEST_ASSERT_NOT_NULL(pkt1);
+    TEST_ASSERT_NOT_NULL(pkt2);
+    /* everything from the snip of pkt2 on; the first snip is at the start of
+     * the packet buffer */
+    size = GNRC_PKTBUF_SIZE - ((uint8_t *)pkt2 - (uint8_t *)pkt1);
+    /* the snip of pkt2 may be kept in a snip cache */
+    gnrc_pktbuf_release(pkt2);
+
+    TEST_ASSERT_EQUAL_INT(0, gnrc_pktbuf_realloc_data(pkt1, size));
+    TEST_ASSERT_EQUAL_STRING(TEST_STRING8, pkt1->data);
+    TEST_ASSERT_EQUAL_INT(size, pkt1->size);
+
+    gnrc_pktbuf_release(pkt1);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+#endif
+
 static void test_pktbuf_hold__pkt_null(void)
 {
     gnrc_pktbuf_hold(NULL, 1);
@@ -713,6 +845,63 @@ static void test_pktbuf_get_iovec__3_elem(void)
     TEST_ASSERT(gnrc_pktbuf_is_empty());
 }
 
+static void test_pktbuf_get_iovec__headroom(void)
+{
+    struct iovec *vec;
+    size_t len;
+    gnrc_pktsnip_t *snip = gnrc_pktbuf_add_headroom(NULL, TEST_STRING16,
+                                                    sizeof(TEST_STRING16),
+                                                    GNRC_PKTBUF_TX_HEADROOM,
+                                                    GNRC_NETTYPE_UNDEF);
+
+    TEST_ASSERT_NOT_NULL(snip);
+    TEST_ASSERT(gnrc_pktbuf_headroom(snip) >= GNRC_PKTBUF_TX_HEADROOM);
+    snip = gnrc_pktbuf_add(snip, TEST_STRING8, sizeof(TEST_STRING8), GNRC_NETTYPE_UNDEF);
+    TEST_ASSERT_NOT_NULL(snip);
+    TEST_ASSERT(((uint8_t *)snip->data) + sizeof(TEST_STRING8) == snip->next->data);
+    snip = gnrc_pktbuf_add(snip, TEST_STRING4, sizeof(TEST_STRING4), GNRC_NETTYPE_UNDEF);
+    TEST_ASSERT_NOT_NULL(snip);
+    TEST_ASSERT(((uint8_t *)snip->data) + sizeof(TEST_STRING4) == snip->next->data);
+    TEST_ASSERT(gnrc_pktbuf_is_sane());
+    snip = gnrc_pktbuf_get_iovec(snip, &len);
+    vec = (struct iovec *)snip->data;
+
+    /* the first snip always gets its own element, the rest is merged */
+    TEST_ASSERT_EQUAL_INT(2, len);
+    TEST_ASSERT(snip->next->data == vec[0].iov_base);
+    TEST_ASSERT_EQUAL_INT(sizeof(TEST_STRING4), vec[0].iov_len);
+    TEST_ASSERT(snip->next->next->data == vec[1].iov_base);
+    TEST_ASSERT_EQUAL_INT(sizeof(TEST_STRING8) + sizeof(TEST_STRING16), vec[1].iov_len);
+    TEST_ASSERT_EQUAL_STRING(TEST_STRING16, (char *)vec[1].iov_base + sizeof(TEST_STRING8));
+
+    gnrc_pktbuf_release(snip);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_pktbuf_headroom__removed_snip(void)
+{
+    gnrc_pktsnip_t *pkt = gnrc_pktbuf_add_headroom(NULL, TEST_STRING16,
+                                                   sizeof(TEST_STRING16),
+                                                   GNRC_PKTBUF_TX_HEADROOM,
+                                                   GNRC_NETTYPE_UNDEF);
+    gnrc_pktsnip_t *hdr;
+    size_t headroom;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    headroom = gnrc_pktbuf_headroom(pkt);
+    TEST_ASSERT_NOT_NULL((hdr = gnrc_pktbuf_add(pkt, TEST_STRING8, sizeof(TEST_STRING8),
+                                                GNRC_NETTYPE_UNDEF)));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_pktbuf_headroom(pkt));
+    TEST_ASSERT_EQUAL_INT(headroom - sizeof(TEST_STRING8), gnrc_pktbuf_headroom(hdr));
+    /* removing the front snip gives its space back */
+    gnrc_pktbuf_remove_snip(hdr, hdr);
+    TEST_ASSERT_EQUAL_INT(headroom, gnrc_pktbuf_headroom(pkt));
+    TEST_ASSERT(gnrc_pktbuf_is_sane());
+
+    gnrc_pktbuf_release(pkt);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
 static void test_pktbuf_get_iovec__null(void)
 {
     gnrc_pktsnip_t *res;
@@ -747,6 +936,8 @@ Test *tests_pktbuf_tests(void)
         new_TestFixture(test_pktbuf_mark__success_large),
         new_TestFixture(test_pktbuf_mark__success_aligned),
         new_TestFixture(test_pktbuf_mark__success_small),
+        new_TestFixture(test_pktbuf_mark__split_often),
+        new_TestFixture(test_pktbuf_mark_headroom__no_move),
         new_TestFixture(test_pktbuf_realloc_data__size_0),
         new_TestFixture(test_pktbuf_realloc_data__memfull),
         new_TestFixture(test_pktbuf_realloc_data__nomemenough),
@@ -755,6 +946,10 @@ Test *tests_pktbuf_tests(void)
         new_TestFixture(test_pktbuf_realloc_data__alignment),
         new_TestFixture(test_pktbuf_realloc_data__success),
         new_TestFixture(test_pktbuf_realloc_data__success2),
+        new_TestFixture(test_pktbuf_realloc_data__headroom_grow_shrink),
+#ifndef MODULE_GNRC_PKTBUF_SLAB
+        new_TestFixture(test_pktbuf_realloc_data__released_snip),
+#endif
         new_TestFixture(test_pktbuf_hold__pkt_null),
         new_TestFixture(test_pktbuf_hold__pkt_external),
         new_TestFixture(test_pktbuf_hold__success),
@@ -766,6 +961,8 @@ Test *tests_pktbuf_tests(void)
         new_TestFixture(test_pktbuf_start_write__pkt_users_2),
         new_TestFixture(test_pktbuf_get_iovec__1_elem),
         new_TestFixture(test_pktbuf_get_iovec__3_elem),
+        new_TestFixture(test_pktbuf_get_iovec__headroom),
+        new_TestFixture(test_pktbuf_headroom__removed_snip),
         new_TestFixture(test_pktbuf_get_iovec__null),
     };
 
@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ *
+ * Received datagrams are dispatched to the socket's connection directly, sent
+ * ones are taken by this thread in place of the UDP thread.
+ */
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "embUnit.h"
+
+#include "byteorder.h"
+#include "msg.h"
+#include "thread.h"
+#include "net/gnrc.h"
+#include "net/ipv6/hdr.h"
+#include "net/udp.h"
+
+#include "tests-posix_sockets.h"
+
+#define TEST_LOCAL_PORT     (5683U)
+#define TEST_PEER_PORT      (61616U)
+#define TEST_NUMOF          (3U)
+#define TEST_DATA_LEN       (32U)
+#define TEST_MSG_QUEUE_SIZE (8U)
+
+static const ipv6_addr_t _peer = { {
+        0xfe, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02
+    } };
+static const ipv6_addr_t _other = { {
+        0xfe, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x03
+    } };
+
+static msg_t _msg_queue[TEST_MSG_QUEUE_SIZE];
+static gnrc_netreg_entry_t _udp_entry = GNRC_NETREG_ENTRY_INIT_PID(GNRC_NETREG_DEMUX_CTX_ALL,
+                                                                KERNEL_PID_UNDEF);
+static int _sock;
+static uint8_t _data[TEST_DATA_LEN];
+static uint8_t _bufs[TEST_NUMOF][TEST_DATA_LEN];
+static struct iovec _iovs[TEST_NUMOF];
+static struct sockaddr_in6 _addrs[TEST_NUMOF];
+static struct mmsghdr _msgs[TEST_NUMOF];
+
+/* puts a datagram of src into the socket's mailbox */
+static void _inject_from(const ipv6_addr_t *src, uint16_t sport, const void *data, size_t len)
+{
+    ipv6_hdr_t ipv6;
+    udp_hdr_t udp;
+    gnrc_pktsnip_t *pkt;
+
+    memset(&ipv6, 0, sizeof(ipv6));
+    ipv6_hdr_set_version(&ipv6);
+    ipv6.len = byteorder_htons(sizeof(udp) + len);
+    ipv6.nh = PROTNUM_UDP;
+    memcpy(&ipv6.src, src, sizeof(ipv6_addr_t));
+    udp.src_port = byteorder_htons(sport);
+    udp.dst_port = byteorder_htons(TEST_LOCAL_PORT);
+    udp.length = byteorder_htons(sizeof(udp) + len);
+    udp.checksum = byteorder_htons(0);
+    pkt = gnrc_pktbuf_add(NULL, &ipv6, sizeof(ipv6), GNRC_NETTYPE_IPV6);
+    pkt = gnrc_pktbuf_add(pkt, &udp, sizeof(udp), GNRC_NETTYPE_UDP);
+    pkt = gnrc_pktbuf_add(pkt, (void *)data, len, GNRC_NETTYPE_UNDEF);
+    TEST_ASSERT_EQUAL_INT(1, gnrc_netapi_dispatch_receive(GNRC_NETTYPE_UDP, TEST_LOCAL_PORT,
+                                                          pkt));
+}
+
+/* puts a datagram of the peer into the socket's mailbox */
+static void _inject(uint16_t sport, const void *data, size_t len)
+{
+    _inject_from(&_peer, sport, data, len);
+}
+
+/* takes a datagram the socket passed to the UDP thread */
+static void _expect_sent(uint16_t sport, uint16_t dport, const void *data, size_t len)
+{
+    msg_t msg;
+    gnrc_pktsnip_t *pkt, *ipv6, *udp;
+
+    TEST_ASSERT_EQUAL_INT(1, msg_try_receive(&msg));
+    TEST_ASSERT_EQUAL_INT(GNRC_NETAPI_MSG_TYPE_SND, msg.type);
+    pkt = (gnrc_pktsnip_t *)msg.content.ptr;
+    ipv6 = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_IPV6);
+    udp = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_UDP);
+    if ((ipv6 == NULL) || (udp == NULL) || (udp->next == NULL)) {
+        gnrc_pktbuf_release(pkt);
+        TEST_FAIL("not a UDP packet");
+        return;
+    }
+    TEST_ASSERT(ipv6_addr_equal(&_peer, &((ipv6_hdr_t *)ipv6->data)->dst));
+    if (sport != 0) {
+        TEST_ASSERT_EQUAL_INT(sport, byteorder_ntohs(((udp_hdr_t *)udp->data)->src_port));
+    }
+    TEST_ASSERT_EQUAL_INT(dport, byteorder_ntohs(((udp_hdr_t *)udp->data)->dst_port));
+    TEST_ASSERT_EQUAL_INT(len, udp->next->size);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, udp->next->data, len));
+    gnrc_pktbuf_release(pkt);
+}
+
+static void _init_msgs(void)
+{
+    memset(_msgs, 0, sizeof(_msgs));
+    memset(_addrs, 0, sizeof(_addrs));
+    for (unsigned i = 0; i < TEST_NUMOF; i++) {
+        _iovs[i].iov_base = _bufs[i];
+        _iovs[i].iov_len = sizeof(_bufs[i]);
+        _msgs[i].msg_hdr.msg_name = &_addrs[i];
+        _msgs[i].msg_hdr.msg_namelen = sizeof(_addrs[i]);
+        _msgs[i].msg_hdr.msg_iov = &_iovs[i];
+        _msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
+static void _set_peer(struct sockaddr_in6 *addr, uint16_t port)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->sin6_family = AF_INET6;
+    addr->sin6_port = htons(port);
+    memcpy(&addr->sin6_addr, &_peer, sizeof(_peer));
+}
+
+static void set_up(void)
+{
+    struct sockaddr_in6 local = { .sin6_family = AF_INET6 };
+
+    for (unsigned i = 0; i < sizeof(_data); i++) {
+        _data[i] = (uint8_t)i;
+    }
+    memset(_bufs, 0, sizeof(_bufs));
+    _sock = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+    local.sin6_port = htons(TEST_LOCAL_PORT);
+    bind(_sock, (struct sockaddr *)&local, sizeof(local));
+}
+
+static void tear_down(void)
+{
+    msg_t msg;
+
+    close(_sock);
+    while (msg_try_receive(&msg) > 0) {
+        if (msg.type == GNRC_NETAPI_MSG_TYPE_SND) {
+            gnrc_pktbuf_release((gnrc_pktsnip_t *)msg.content.ptr);
+        }
+    }
+}
+
+static void test_recvmmsg(void)
+{
+    _init_msgs();
+    for (unsigned i = 0; i < TEST_NUMOF; i++) {
+        _inject(TEST_PEER_PORT + i, _data, i + 1);
+    }
+    TEST_ASSERT_EQUAL_INT(TEST_NUMOF, recvmmsg(_sock, _msgs, TEST_NUMOF, 0, NULL));
+    for (unsigned i = 0; i < TEST_NUMOF; i++) {
+        TEST_ASSERT_EQUAL_INT(i + 1, _msgs[i].msg_len);
+        TEST_ASSERT_EQUAL_INT(0, memcmp(_data, _bufs[i], i + 1));
+        TEST_ASSERT_EQUAL_INT(sizeof(struct sockaddr_in6), _msgs[i].msg_hdr.msg_namelen);
+        TEST_ASSERT_EQUAL_INT(AF_INET6, _addrs[i].sin6_family);
+        TEST_ASSERT_EQUAL_INT(TEST_PEER_PORT + i, ntohs(_addrs[i].sin6_port));
+        TEST_ASSERT_EQUAL_INT(0, memcmp(&_peer, &_addrs[i].sin6_addr, sizeof(_peer)));
+    }
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_recvmmsg__invalid(void)
+{
+    struct timespec timeout = { 0, 0 };
+
+    _init_msgs();
+    TEST_ASSERT_EQUAL_INT(-1, recvmmsg(_sock, _msgs, TEST_NUMOF, 0, &timeout));
+    TEST_ASSERT_EQUAL_INT(EINVAL, errno);
+    _msgs[0].msg_hdr.msg_iovlen = 2;
+    TEST_ASSERT_EQUAL_INT(-1, recvmmsg(_sock, _msgs, TEST_NUMOF, 0, NULL));
+    TEST_ASSERT_EQUAL_INT(EINVAL, errno);
+}
+
+static void test_recv__trunc(void)
+{
+    uint8_t buf[TEST_DATA_LEN / 2];
+
+    _inject(TEST_PEER_PORT, _data, sizeof(_data));
+    _inject(TEST_PEER_PORT, _data, sizeof(_data));
+    /* the real length is reported, as much as fits is copied */
+    TEST_ASSERT_EQUAL_INT(sizeof(_data), recv(_sock, buf, sizeof(buf), MSG_TRUNC));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_data, buf, sizeof(buf)));
+    /* without MSG_TRUNC the datagram is dropped */
+    TEST_ASSERT_EQUAL_INT(-1, recv(_sock, buf, sizeof(buf), 0));
+    TEST_ASSERT_EQUAL_INT(ENOMEM, errno);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_connect__send(void)
+{
+    struct sockaddr_in6 peer;
+
+    TEST_ASSERT_EQUAL_INT(-1, send(_sock, _data, sizeof(_data), 0));
+    TEST_ASSERT_EQUAL_INT(ENOTCONN, errno);
+    _set_peer(&peer, TEST_PEER_PORT);
+    TEST_ASSERT_EQUAL_INT(0, connect(_sock, (struct sockaddr *)&peer, sizeof(peer)));
+    TEST_ASSERT_EQUAL_INT(sizeof(_data), send(_sock, _data, sizeof(_data), 0));
+    /* without an IPv6 thread the next hop can not be cached, so the datagram
+     * takes the usual way */
+    _expect_sent(TEST_LOCAL_PORT, TEST_PEER_PORT, _data, sizeof(_data));
+    TEST_ASSERT_EQUAL_INT(sizeof(_data), send(_sock, _data, sizeof(_data), 0));
+    _expect_sent(TEST_LOCAL_PORT, TEST_PEER_PORT, _data, sizeof(_data));
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_connect__recv(void)
+{
+    struct sockaddr_in6 peer;
+
+    _init_msgs();
+    _set_peer(&peer, TEST_PEER_PORT);
+    TEST_ASSERT_EQUAL_INT(0, connect(_sock, (struct sockaddr *)&peer, sizeof(peer)));
+    /* datagrams from other ports or addresses than the peer's are dropped */
+    _inject(TEST_PEER_PORT + 1, _data, 1);
+    _inject_from(&_other, TEST_PEER_PORT, _data, 2);
+    _inject(TEST_PEER_PORT, _data, 3);
+    TEST_ASSERT_EQUAL_INT(3, recv(_sock, _bufs[0], sizeof(_bufs[0]), 0));
+    _inject_from(&_other, TEST_PEER_PORT, _data, 1);
+    _inject(TEST_PEER_PORT, _data, 2);
+    _inject(TEST_PEER_PORT + 1, _data, 3);
+    _inject(TEST_PEER_PORT, _data, 4);
+    TEST_ASSERT_EQUAL_INT(2, recvmmsg(_sock, _msgs, TEST_NUMOF, 0, NULL));
+    TEST_ASSERT_EQUAL_INT(2, _msgs[0].msg_len);
+    TEST_ASSERT_EQUAL_INT(4, _msgs[1].msg_len);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_sendmmsg(void)
+{
+    _init_msgs();
+    for (unsigned i = 0; i < TEST_NUMOF; i++) {
+        _iovs[i].iov_base = _data;
+        _iovs[i].iov_len = i + 1;
+        _set_peer(&_addrs[i], TEST_PEER_PORT + i);
+    }
+    TEST_ASSERT_EQUAL_INT(TEST_NUMOF, sendmmsg(_sock, _msgs, TEST_NUMOF, 0));
+    for (unsigned i = 0; i < TEST_NUMOF; i++) {
+        TEST_ASSERT_EQUAL_INT(i + 1, _msgs[i].msg_len);
+        _expect_sent(TEST_LOCAL_PORT, TEST_PEER_PORT + i, _data, i + 1);
+    }
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_sendmmsg__no_address(void)
+{
+    _init_msgs();
+    _msgs[0].msg_hdr.msg_name = NULL;
+    TEST_ASSERT_EQUAL_INT(-1, sendmmsg(_sock, _msgs, TEST_NUMOF, 0));
+    TEST_ASSERT_EQUAL_INT(ENOTCONN, errno);
+}
+
+Test *tests_posix_sockets_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_recvmmsg),
+        new_TestFixture(test_recvmmsg__invalid),
+        new_TestFixture(test_recv__trunc),
+        new_TestFixture(test_connect__send),
+        new_TestFixture(test_connect__recv),
+        new_TestFixture(test_sendmmsg),
+        new_TestFixture(test_sendmmsg__no_address),
+    };
+
+    EMB_UNIT_TESTCALLER(posix_sockets_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&posix_sockets_tests;
+}
+
+void tests_posix_sockets(void)
+{
+    /* this thread plays the UDP thread */
+    msg_init_queue(_msg_queue, TEST_MSG_QUEUE_SIZE);
+    gnrc_pktbuf_init();
+    _udp_entry.pid = thread_getpid();
+    gnrc_netreg_register(GNRC_NETTYPE_UDP, &_udp_entry);
+    TESTS_RUN(tests_posix_sockets_tests());
+    gnrc_netreg_unregister(GNRC_NETTYPE_UDP, &_udp_entry);
+}
+/** @} */
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file
+ * @brief       Unittests for the ``posix_sockets`` module
+ */
+#ifndef TESTS_POSIX_SOCKETS_H_
+#define TESTS_POSIX_SOCKETS_H_
+
+#include "embUnit.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_posix_sockets(void);
+
+/**
+ * @brief   Generates tests for posix_sockets
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_posix_sockets_tests(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TESTS_POSIX_SOCKETS_H_ */
+/** @} */
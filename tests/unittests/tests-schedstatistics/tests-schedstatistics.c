@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+#include <stdint.h>
+
+#include "embUnit.h"
+
+#include "irq.h"
+#include "sched.h"
+#include "thread.h"
+#include "xtimer.h"
+
+#include "tests-schedstatistics.h"
+
+#define TEST_SLEEP  (10U * MS_IN_USEC)
+
+static char _stack[THREAD_STACKSIZE_DEFAULT];
+
+static void *_yielder(void *arg)
+{
+    (void)arg;
+    thread_yield();
+    return NULL;
+}
+
+static void set_up(void)
+{
+    sched_stat_reset();
+}
+
+static void test_sched_stat_get__invalid(void)
+{
+    schedstat stat;
+
+    TEST_ASSERT_EQUAL_INT(-1, sched_stat_get(KERNEL_PID_UNDEF, &stat));
+    TEST_ASSERT_EQUAL_INT(-1, sched_stat_get(KERNEL_PID_LAST + 1, &stat));
+}
+
+static void test_sched_stat_reset(void)
+{
+    schedstat stat;
+
+    TEST_ASSERT_EQUAL_INT(0, sched_stat_get(thread_getpid(), &stat));
+    TEST_ASSERT_EQUAL_INT(0, stat.schedules);
+    TEST_ASSERT(stat.runtime_ticks <= sched_stat_elapsed());
+    TEST_ASSERT(stat.status_ticks[STATUS_RUNNING] <= sched_stat_elapsed());
+    TEST_ASSERT(sched_stat_elapsed() < TEST_SLEEP);
+}
+
+static void test_sched_stat_get__blocked(void)
+{
+    schedstat stat;
+    uint64_t blocked = 0;
+
+    xtimer_usleep(TEST_SLEEP);
+    TEST_ASSERT_EQUAL_INT(0, sched_stat_get(thread_getpid(), &stat));
+    for (int s = STATUS_SLEEPING; s < STATUS_ON_RUNQUEUE; s++) {
+        blocked += stat.status_ticks[s];
+    }
+    TEST_ASSERT(blocked >= TEST_SLEEP);
+    TEST_ASSERT(sched_stat_elapsed() >= blocked);
+    TEST_ASSERT(stat.voluntary >= 1);
+    TEST_ASSERT(stat.schedules >= 1);
+}
+
+static void test_sched_stat_get__yield(void)
+{
+    schedstat stat;
+
+    thread_create(_stack, sizeof(_stack), THREAD_PRIORITY_MAIN,
+                  THREAD_CREATE_WOUT_YIELD | THREAD_CREATE_STACKTEST,
+                  _yielder, NULL, "yielder");
+    /* runs _yielder until it yields back to us */
+    thread_yield();
+    TEST_ASSERT_EQUAL_INT(0, sched_stat_get(thread_getpid(), &stat));
+    TEST_ASSERT_EQUAL_INT(1, stat.yields);
+    TEST_ASSERT_EQUAL_INT(0, stat.involuntary);
+    TEST_ASSERT_EQUAL_INT(0, stat.voluntary);
+    /* let _yielder exit */
+    thread_yield();
+}
+
+static void test_sched_stat_get__beyond_32bit(void)
+{
+    schedstat stat;
+    unsigned state = irq_disable();
+
+    /* pretend the thread ran for 2^32 - 1 ticks, i.e. ~71 minutes */
+    sched_pidlist[thread_getpid()].runtime_ticks = UINT32_MAX;
+    sched_pidlist[thread_getpid()].status_ticks[STATUS_RUNNING] = UINT32_MAX;
+    irq_restore(state);
+    xtimer_spin(100);
+    TEST_ASSERT_EQUAL_INT(0, sched_stat_get(thread_getpid(), &stat));
+    TEST_ASSERT(stat.runtime_ticks > UINT32_MAX);
+    TEST_ASSERT(stat.status_ticks[STATUS_RUNNING] > UINT32_MAX);
+}
+
+Test *tests_schedstatistics_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_sched_stat_get__invalid),
+        new_TestFixture(test_sched_stat_reset),
+        new_TestFixture(test_sched_stat_get__blocked),
+        new_TestFixture(test_sched_stat_get__yield),
+        new_TestFixture(test_sched_stat_get__beyond_32bit),
+    };
+
+    EMB_UNIT_TESTCALLER(schedstatistics_tests, set_up, NULL, fixtures);
+
+    return (Test *)&schedstatistics_tests;
+}
+
+void tests_schedstatistics(void)
+{
+    TESTS_RUN(tests_schedstatistics_tests());
+}
+/** @} */
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file
+ * @brief       Unittests for the ``schedstatistics`` module
+ */
+#ifndef TESTS_SCHEDSTATISTICS_H_
+#define TESTS_SCHEDSTATISTICS_H_
+
+#include "embUnit.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_schedstatistics(void);
+
+/**
+ * @brief   Generates tests for the scheduler statistics
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_schedstatistics_tests(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TESTS_SCHEDSTATISTICS_H_ */
+/** @} */
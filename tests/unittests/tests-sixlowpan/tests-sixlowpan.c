@@ -21,7 +21,17 @@
 
 #include "unittests-constants.h"
 
+#include "net/gnrc/netapi.h"
+#include "net/gnrc/netif.h"
+#include "net/gnrc/netif/hdr.h"
+#include "net/gnrc/pktbuf.h"
+#include "net/gnrc/sixlowpan/ctx.h"
+#include "net/gnrc/sixlowpan/iphc.h"
+#include "net/ieee802154.h"
+#include "net/ipv6/hdr.h"
+#include "net/protnum.h"
 #include "net/sixlowpan.h"
+#include "net/udp.h"
 
 #define NALP_0  (0x00) /* 00 00 00 00 */
 #define NALP_1  (0x01) /* 00 00 00 01 */
@@ -45,11 +55,177 @@
 #define FRAG1_DISP      (0xC5)  /* 11 00 01 01 */
 #define FRAGN_DISP      (0xE5)  /* 11 10 01 01 */
 
+#define TEST_IF_PID     (1)
+#define TEST_CTX_ID     (0)
+#define TEST_HDR_LEN    (6)     /* IPHC (2), NHC UDP (1), ports (1), checksum (2) */
+#define TEST_PAYLOAD    "ABCDEFGH"
+
+static const uint8_t _l2src[] = { 0x02, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x01 };
+static const uint8_t _l2dst[] = { 0x02, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x02 };
+static const uint8_t _l2other[] = { 0x02, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x03 };
+/* IIDs derived from _l2src and _l2dst */
+static const ipv6_addr_t _ll_src = { {
+        0xfe, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x01
+    } };
+static const ipv6_addr_t _ll_dst = { {
+        0xfe, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x02
+    } };
+static const ipv6_addr_t _global_src = { {
+        0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x01
+    } };
+static const ipv6_addr_t _global_dst = { {
+        0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x02
+    } };
+
+static char _iface_stack[THREAD_STACKSIZE_DEFAULT];
+static kernel_pid_t _iface_pid = KERNEL_PID_UNDEF;
+static eui64_t _iface_iid;
+
+/* an interface that only knows its IID and lets its long address be set */
+static void *_iface_thread(void *arg)
+{
+    msg_t msg, reply;
+
+    (void)arg;
+    reply.type = GNRC_NETAPI_MSG_TYPE_ACK;
+    while (1) {
+        gnrc_netapi_opt_t *opt;
+
+        msg_receive(&msg);
+        opt = (gnrc_netapi_opt_t *)msg.content.ptr;
+        reply.content.value = (uint32_t)(-ENOTSUP);
+        if ((msg.type == GNRC_NETAPI_MSG_TYPE_GET) && (opt->opt == NETOPT_IPV6_IID)) {
+            memcpy(opt->data, &_iface_iid, sizeof(eui64_t));
+            reply.content.value = sizeof(eui64_t);
+        }
+        else if ((msg.type == GNRC_NETAPI_MSG_TYPE_SET) &&
+                 (opt->opt == NETOPT_ADDRESS_LONG)) {
+            ieee802154_get_iid(&_iface_iid, opt->data, opt->data_len);
+            /* like the glue of a real interface */
+            gnrc_netif_opt_applied(opt->opt);
+            reply.content.value = opt->data_len;
+        }
+        msg_reply(&msg, &reply);
+    }
+    return NULL;
+}
+
+static gnrc_pktsnip_t *_build_netif_hdr(void)
+{
+    gnrc_pktsnip_t *netif = gnrc_netif_hdr_build((uint8_t *)_l2src, sizeof(_l2src),
+                                                 (uint8_t *)_l2dst, sizeof(_l2dst));
+
+    if (netif != NULL) {
+        ((gnrc_netif_hdr_t *)netif->data)->if_pid = TEST_IF_PID;
+    }
+    return netif;
+}
+
+/* netif header -> IPv6 header -> UDP header -> payload, as sent by UDP */
+static gnrc_pktsnip_t *_build_udp_pkt(const ipv6_addr_t *src, const ipv6_addr_t *dst)
+{
+    gnrc_pktsnip_t *pkt, *netif;
+    ipv6_hdr_t *ipv6_hdr;
+    udp_hdr_t *udp_hdr;
+
+    if ((pkt = gnrc_pktbuf_add(NULL, TEST_PAYLOAD, sizeof(TEST_PAYLOAD) - 1,
+                               GNRC_NETTYPE_UNDEF)) == NULL) {
+        return NULL;
+    }
+    if ((pkt = gnrc_pktbuf_add(pkt, NULL, sizeof(udp_hdr_t),
+                               GNRC_NETTYPE_UNDEF)) == NULL) {
+        return NULL;
+    }
+    udp_hdr = pkt->data;
+    udp_hdr->src_port = byteorder_htons(0xf0b1);
+    udp_hdr->dst_port = byteorder_htons(0xf0b2);
+    udp_hdr->length = byteorder_htons(gnrc_pkt_len(pkt));
+    udp_hdr->checksum = byteorder_htons(0xabcd);
+    if ((pkt = gnrc_pktbuf_add(pkt, NULL, sizeof(ipv6_hdr_t),
+                               GNRC_NETTYPE_UNDEF)) == NULL) {
+        return NULL;
+    }
+    ipv6_hdr = pkt->data;
+    memset(ipv6_hdr, 0, sizeof(ipv6_hdr_t));
+    ipv6_hdr_set_version(ipv6_hdr);
+    ipv6_hdr->len = byteorder_htons(gnrc_pkt_len(pkt->next));
+    ipv6_hdr->nh = PROTNUM_UDP;
+    ipv6_hdr->hl = 64;
+    ipv6_hdr->src = *src;
+    ipv6_hdr->dst = *dst;
+    if ((netif = _build_netif_hdr()) == NULL) {
+        return NULL;
+    }
+    netif->next = pkt;
+    return netif;
+}
+
+/* encodes pkt and flattens everything behind the netif header into frame */
+static size_t _encode_pkt(gnrc_pktsnip_t *pkt, uint8_t *frame)
+{
+    size_t len = 0;
+
+    if ((pkt == NULL) || !gnrc_sixlowpan_iphc_encode(pkt)) {
+        return 0;
+    }
+    for (gnrc_pktsnip_t *snip = pkt->next; snip != NULL; snip = snip->next) {
+        memcpy(frame + len, snip->data, snip->size);
+        len += snip->size;
+    }
+    gnrc_pktbuf_release(pkt);
+    return len;
+}
+
+/* encodes a packet of the flow into frame */
+static size_t _encode(const ipv6_addr_t *src, const ipv6_addr_t *dst,
+                      uint8_t *frame)
+{
+    return _encode_pkt(_build_udp_pkt(src, dst), frame);
+}
+
+/* encodes a packet of the flow sent over _iface_pid into frame, which has to
+ * take the source IID from the interface */
+static size_t _encode_from_iface(const ipv6_addr_t *src, const ipv6_addr_t *dst,
+                                 uint8_t *frame)
+{
+    gnrc_pktsnip_t *pkt = _build_udp_pkt(src, dst);
+    gnrc_pktsnip_t *netif = gnrc_netif_hdr_build(NULL, 0, (uint8_t *)_l2dst, sizeof(_l2dst));
+
+    if ((pkt == NULL) || (netif == NULL)) {
+        return 0;
+    }
+    ((gnrc_netif_hdr_t *)netif->data)->if_pid = _iface_pid;
+    netif->next = gnrc_pktbuf_remove_snip(pkt, pkt);
+    return _encode_pkt(netif, frame);
+}
+
+/* decodes frame as received from _l2src, returns the decoded header */
+static gnrc_pktsnip_t *_decode(uint8_t *frame, size_t len, size_t *payload_offset)
+{
+    gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(_build_netif_hdr(), frame, len,
+                                          GNRC_NETTYPE_SIXLOWPAN);
+    gnrc_pktsnip_t *dec_hdr = gnrc_pktbuf_add(NULL, NULL, sizeof(ipv6_hdr_t),
+                                              GNRC_NETTYPE_IPV6);
+    size_t nh_len = 0;
+
+    *payload_offset = 0;
+    if ((pkt != NULL) && (dec_hdr != NULL)) {
+        *payload_offset = gnrc_sixlowpan_iphc_decode(&dec_hdr, pkt, 0, 0, &nh_len);
+    }
+    gnrc_pktbuf_release(pkt);
+    return dec_hdr;
+}
+
+static void set_up(void)
+{
+    gnrc_pktbuf_init();
+    gnrc_sixlowpan_ctx_reset();
+}
 
-/* Test with 6LoWPAN dispatch byte indicating a none-LoWPAN frame (NALP = Not a
- * LoWPAN frame)
- * see https://tools.ietf.org/html/rfc4944#section-5.1
- */
 static void test_sixlowpan_nalp_is_no_6lowpan_frame_0(void)
 {
     TEST_ASSERT(sixlowpan_nalp(NALP_0));
@@ -147,6 +323,100 @@ static void test_sixlowpan_nalp_is_6lowpan_frame_12(void)
     TEST_ASSERT(!sixlowpan_nalp(FRAGN_DISP));
 }
 
+static void test_sixlowpan_iphc_encode__link_local_udp(void)
+{
+    uint8_t frame[64], cached[64];
+    size_t len;
+
+    len = _encode(&_ll_src, &_ll_dst, frame);
+    TEST_ASSERT_EQUAL_INT(TEST_HDR_LEN + sizeof(TEST_PAYLOAD) - 1, len);
+    /* TF elided, NH compressed, HL 64 */
+    TEST_ASSERT_EQUAL_INT(0x7e, frame[0]);
+    /* SAM and DAM derived from link-layer */
+    TEST_ASSERT_EQUAL_INT(0x33, frame[1]);
+    /* NHC UDP with both ports compressed to 4 bit */
+    TEST_ASSERT_EQUAL_INT(0xf3, frame[2]);
+    TEST_ASSERT_EQUAL_INT(0x12, frame[3]);
+    TEST_ASSERT_EQUAL_INT(0xab, frame[4]);
+    TEST_ASSERT_EQUAL_INT(0xcd, frame[5]);
+    /* second packet of the flow is encoded from cache */
+    TEST_ASSERT_EQUAL_INT(len, _encode(&_ll_src, &_ll_dst, cached));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(frame, cached, len));
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_sixlowpan_iphc_encode__ctx_change(void)
+{
+    uint8_t frame[64];
+    size_t len;
+
+    len = _encode(&_global_src, &_global_dst, frame);
+    /* no context => both addresses carried inline */
+    TEST_ASSERT_EQUAL_INT(TEST_HDR_LEN + (2 * sizeof(ipv6_addr_t)) +
+                          sizeof(TEST_PAYLOAD) - 1, len);
+    TEST_ASSERT_NOT_NULL(gnrc_sixlowpan_ctx_update(TEST_CTX_ID, &_global_src, 64,
+                                                   60, true));
+    /* new context is used right away, though the flow is cached */
+    TEST_ASSERT_EQUAL_INT(TEST_HDR_LEN + sizeof(TEST_PAYLOAD) - 1,
+                          _encode(&_global_src, &_global_dst, frame));
+    /* SAC and DAC set, addresses derived from link-layer */
+    TEST_ASSERT_EQUAL_INT(0x77, frame[1]);
+    gnrc_sixlowpan_ctx_remove(TEST_CTX_ID);
+    TEST_ASSERT_EQUAL_INT(len, _encode(&_global_src, &_global_dst, frame));
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_sixlowpan_iphc_encode__l2addr_change(void)
+{
+    uint8_t frame[64];
+    size_t len;
+
+    ieee802154_get_iid(&_iface_iid, _l2src, sizeof(_l2src));
+    len = _encode_from_iface(&_ll_src, &_ll_dst, frame);
+    TEST_ASSERT_EQUAL_INT(TEST_HDR_LEN + sizeof(TEST_PAYLOAD) - 1, len);
+    /* SAM and DAM derived from link-layer */
+    TEST_ASSERT_EQUAL_INT(0x33, frame[1]);
+    TEST_ASSERT_EQUAL_INT(sizeof(_l2other),
+                          gnrc_netapi_set(_iface_pid, NETOPT_ADDRESS_LONG, 0,
+                                          (void *)_l2other, sizeof(_l2other)));
+    /* source IID does not match the interface anymore, though the flow is
+     * cached */
+    TEST_ASSERT_EQUAL_INT(len + 2, _encode_from_iface(&_ll_src, &_ll_dst, frame));
+    /* SAM 16 bits inline */
+    TEST_ASSERT_EQUAL_INT(0x23, frame[1]);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_sixlowpan_iphc_decode__link_local_udp(void)
+{
+    uint8_t frame[64];
+    gnrc_pktsnip_t *dec_hdr;
+    ipv6_hdr_t *ipv6_hdr;
+    udp_hdr_t *udp_hdr;
+    size_t len, payload_offset;
+
+    len = _encode(&_ll_src, &_ll_dst, frame);
+    TEST_ASSERT(len > 0);
+    dec_hdr = _decode(frame, len, &payload_offset);
+    TEST_ASSERT_NOT_NULL(dec_hdr);
+    TEST_ASSERT_EQUAL_INT(TEST_HDR_LEN, payload_offset);
+    /* NHC prepends the UDP header */
+    TEST_ASSERT_NOT_NULL(dec_hdr->next);
+    udp_hdr = dec_hdr->data;
+    ipv6_hdr = dec_hdr->next->data;
+    TEST_ASSERT(ipv6_addr_equal(&_ll_src, &ipv6_hdr->src));
+    TEST_ASSERT(ipv6_addr_equal(&_ll_dst, &ipv6_hdr->dst));
+    TEST_ASSERT_EQUAL_INT(64, ipv6_hdr->hl);
+    TEST_ASSERT_EQUAL_INT(PROTNUM_UDP, ipv6_hdr->nh);
+    TEST_ASSERT_EQUAL_INT(0xf0b1, byteorder_ntohs(udp_hdr->src_port));
+    TEST_ASSERT_EQUAL_INT(0xf0b2, byteorder_ntohs(udp_hdr->dst_port));
+    TEST_ASSERT_EQUAL_INT(0xabcd, byteorder_ntohs(udp_hdr->checksum));
+    TEST_ASSERT_EQUAL_INT(sizeof(udp_hdr_t) + sizeof(TEST_PAYLOAD) - 1,
+                          byteorder_ntohs(udp_hdr->length));
+    gnrc_pktbuf_release(dec_hdr);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
 Test *test_sixlowpan_tests(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
@@ -170,15 +440,24 @@ Test *test_sixlowpan_tests(void)
         new_TestFixture(test_sixlowpan_nalp_is_6lowpan_frame_10),
         new_TestFixture(test_sixlowpan_nalp_is_6lowpan_frame_11),
         new_TestFixture(test_sixlowpan_nalp_is_6lowpan_frame_12),
+        new_TestFixture(test_sixlowpan_iphc_encode__link_local_udp),
+        new_TestFixture(test_sixlowpan_iphc_encode__ctx_change),
+        new_TestFixture(test_sixlowpan_iphc_encode__l2addr_change),
+        new_TestFixture(test_sixlowpan_iphc_decode__link_local_udp),
     };
 
-    EMB_UNIT_TESTCALLER(test_sixlowpan_tests_caller, NULL, NULL, fixtures);
+    EMB_UNIT_TESTCALLER(test_sixlowpan_tests_caller, set_up, NULL, fixtures);
 
     return (Test *)&test_sixlowpan_tests_caller;
 }
 
 void tests_sixlowpan(void)
 {
+    if (_iface_pid == KERNEL_PID_UNDEF) {
+        _iface_pid = thread_create(_iface_stack, sizeof(_iface_stack),
+                                   THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST,
+                                   _iface_thread, NULL, "iface");
+    }
     TESTS_RUN(test_sixlowpan_tests());
 }
 /** @} */
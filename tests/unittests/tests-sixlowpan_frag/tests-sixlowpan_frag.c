@@ -0,0 +1,686 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "embUnit.h"
+
+#include "msg.h"
+#include "thread.h"
+#include "xtimer.h"
+#include "net/ipv6/hdr.h"
+#include "net/gnrc/ipv6/nc.h"
+#include "net/gnrc/ipv6/netif.h"
+#include "net/gnrc/netapi.h"
+#include "net/gnrc/netif/hdr.h"
+#include "net/gnrc/netreg.h"
+#include "net/gnrc/pktbuf.h"
+#include "net/gnrc/sixlowpan/frag.h"
+#include "net/gnrc/sixlowpan/iphc.h"
+#include "net/gnrc/sixlowpan/netif.h"
+#include "net/sixlowpan.h"
+
+#include "rbuf.h"
+#include "vrb.h"
+
+#include "unittests-constants.h"
+#include "tests-sixlowpan_frag.h"
+
+#define TEST_TAG            (0x1234U)
+#define TEST_SIZE           (64U)   /**< size of a datagram of two fragments */
+#define TEST_FRAG1_SIZE     (32U)   /**< payload of the FRAG1 of a datagram */
+#define TEST_FWD_FRAG1_SIZE (48U)   /**< payload of a FRAG1 that holds the
+                                     *   uncompressed IPv6 header */
+#define TEST_LARGE_SIZE     ((RBUF_BUDGET / 2) + RBUF_UNIT_SIZE)
+#define TEST_HL             (64U)
+#define TEST_MAX_FRAG_SIZE  (102U)
+#define TEST_MSG_QUEUE_SIZE (8U)
+
+static const uint8_t _src[] = { 0x02, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x01 };
+static const uint8_t _dst[] = { 0x02, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x02 };
+static const uint8_t _next_hop[] = { 0x02, 0x00, 0x00, 0xff, 0xfe, 0x00, 0x00, 0x03 };
+static uint8_t _datagram[SIXLOWPAN_FRAG_SIZE_MASK + 1];
+static msg_t _msg_queue[TEST_MSG_QUEUE_SIZE];
+static gnrc_sixlowpan_msg_frag_t _fragment_msg;
+static gnrc_netreg_entry_t _ipv6 = GNRC_NETREG_ENTRY_INIT_PID(GNRC_NETREG_DEMUX_CTX_ALL,
+                                                              KERNEL_PID_UNDEF);
+
+static void set_up(void)
+{
+    ipv6_hdr_t *hdr = (ipv6_hdr_t *)_datagram;
+
+    gnrc_pktbuf_init();
+    for (unsigned i = 0; i < sizeof(_datagram); i++) {
+        _datagram[i] = (uint8_t)i;
+    }
+    /* link-local addresses keep the datagram from being forwarded */
+    ipv6_hdr_set_version(hdr);
+    hdr->hl = TEST_HL;
+    ipv6_addr_set_link_local_prefix(&hdr->src);
+    ipv6_addr_set_link_local_prefix(&hdr->dst);
+    _ipv6.pid = thread_getpid();
+    gnrc_netreg_register(GNRC_NETTYPE_IPV6, &_ipv6);
+}
+
+static void tear_down(void)
+{
+    msg_t msg;
+
+    gnrc_netreg_unregister(GNRC_NETTYPE_IPV6, &_ipv6);
+    rbuf_reset();
+    vrb_reset();
+    gnrc_ipv6_nc_init();
+    gnrc_ipv6_netif_remove(thread_getpid());
+    if (gnrc_sixlowpan_netif_get(thread_getpid()) != NULL) {
+        gnrc_sixlowpan_netif_remove(thread_getpid());
+    }
+    while (msg_try_receive(&msg) == 1) {
+        if ((msg.type == GNRC_NETAPI_MSG_TYPE_RCV) ||
+            (msg.type == GNRC_NETAPI_MSG_TYPE_SND)) {
+            gnrc_pktbuf_release((gnrc_pktsnip_t *)msg.content.ptr);
+        }
+    }
+    gnrc_pktbuf_release(_fragment_msg.pkt);
+    _fragment_msg.pkt = NULL;
+}
+
+/* builds the fragment of _datagram at offset as received from _src */
+static gnrc_pktsnip_t *_frag(uint16_t size, uint16_t tag, uint16_t offset,
+                             size_t len)
+{
+    gnrc_pktsnip_t *netif, *frag;
+    sixlowpan_frag_n_t *hdr;
+    size_t hdr_size = (offset == 0) ? (sizeof(sixlowpan_frag_t) + 1) :
+                                      sizeof(sixlowpan_frag_n_t);
+
+    netif = gnrc_netif_hdr_build((uint8_t *)_src, sizeof(_src),
+                                 (uint8_t *)_dst, sizeof(_dst));
+    if (netif == NULL) {
+        return NULL;
+    }
+    frag = gnrc_pktbuf_add(netif, NULL, hdr_size + len, GNRC_NETTYPE_SIXLOWPAN);
+    if (frag == NULL) {
+        gnrc_pktbuf_release(netif);
+        return NULL;
+    }
+    hdr = frag->data;
+    hdr->disp_size = byteorder_htons(size);
+    hdr->tag = byteorder_htons(tag);
+    if (offset == 0) {
+        hdr->disp_size.u8[0] |= SIXLOWPAN_FRAG_1_DISP;
+        ((uint8_t *)frag->data)[sizeof(sixlowpan_frag_t)] = SIXLOWPAN_UNCOMP;
+    }
+    else {
+        hdr->disp_size.u8[0] |= SIXLOWPAN_FRAG_N_DISP;
+        hdr->offset = (uint8_t)(offset / 8);
+    }
+    memcpy((uint8_t *)frag->data + hdr_size, &_datagram[offset], len);
+    return frag;
+}
+
+/* hands a fragment to the reassembly like the 6LoWPAN thread does */
+static void _recv_frag(uint16_t size, uint16_t tag, uint16_t offset, size_t len)
+{
+    gnrc_pktsnip_t *frag = _frag(size, tag, offset, len);
+
+    TEST_ASSERT_NOT_NULL(frag);
+    gnrc_sixlowpan_frag_handle_pkt(frag);
+}
+
+/* returns the next packet dispatched to IPv6 or sent over the interface of
+ * this thread or NULL if there is none, sends paced fragments like the
+ * 6LoWPAN thread does */
+static gnrc_pktsnip_t *_next_pkt(void)
+{
+    msg_t msg;
+
+    while (msg_try_receive(&msg) == 1) {
+        if ((msg.type == GNRC_NETAPI_MSG_TYPE_RCV) ||
+            (msg.type == GNRC_NETAPI_MSG_TYPE_SND)) {
+            return (gnrc_pktsnip_t *)msg.content.ptr;
+        }
+        if (msg.type == GNRC_SIXLOWPAN_MSG_FRAG_SND) {
+            gnrc_sixlowpan_frag_send((gnrc_sixlowpan_msg_frag_t *)msg.content.ptr);
+        }
+    }
+    return NULL;
+}
+
+/* makes _datagram forwardable over the interface of this thread */
+static void _set_up_fwd(void)
+{
+    ipv6_hdr_t *hdr = (ipv6_hdr_t *)_datagram;
+
+    hdr->src.u8[0] = 0x20;
+    hdr->src.u8[1] = 0x01;
+    hdr->dst.u8[0] = 0x20;
+    hdr->dst.u8[1] = 0x01;
+    gnrc_sixlowpan_netif_add(thread_getpid(), TEST_MAX_FRAG_SIZE);
+#ifdef MODULE_GNRC_SIXLOWPAN_IPHC
+    gnrc_sixlowpan_netif_get(thread_getpid())->iphc_enabled = false;
+#endif
+}
+
+/* registers _next_hop as the next hop for dst */
+static void _add_next_hop(const ipv6_addr_t *dst)
+{
+    TEST_ASSERT_NOT_NULL(gnrc_ipv6_nc_add(thread_getpid(), dst, _next_hop,
+                                          sizeof(_next_hop),
+                                          GNRC_IPV6_NC_STATE_REACHABLE |
+                                          GNRC_IPV6_NC_TYPE_REGISTERED));
+}
+
+static void _check_datagram(gnrc_pktsnip_t *pkt, size_t size)
+{
+    gnrc_netif_hdr_t *netif;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_INT(GNRC_NETTYPE_IPV6, pkt->type);
+    TEST_ASSERT_EQUAL_INT(size, pkt->size);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_datagram, pkt->data, size));
+    TEST_ASSERT_NOT_NULL(pkt->next);
+    TEST_ASSERT_EQUAL_INT(GNRC_NETTYPE_NETIF, pkt->next->type);
+    netif = pkt->next->data;
+    TEST_ASSERT_EQUAL_INT(sizeof(_src), netif->src_l2addr_len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_src, gnrc_netif_hdr_get_src_addr(netif),
+                                    sizeof(_src)));
+    gnrc_pktbuf_release(pkt);
+}
+
+/* checks a fragment of _datagram forwarded to _next_hop */
+static void _check_fwd(gnrc_pktsnip_t *pkt, uint16_t tag, uint16_t offset,
+                       size_t len)
+{
+    gnrc_netif_hdr_t *netif;
+    sixlowpan_frag_n_t *hdr;
+    uint8_t *data;
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_INT(GNRC_NETTYPE_NETIF, pkt->type);
+    netif = pkt->data;
+    TEST_ASSERT_EQUAL_INT(thread_getpid(), netif->if_pid);
+    TEST_ASSERT_EQUAL_INT(sizeof(_next_hop), netif->dst_l2addr_len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_next_hop, gnrc_netif_hdr_get_dst_addr(netif),
+                                    sizeof(_next_hop)));
+    TEST_ASSERT_NOT_NULL(pkt->next);
+    TEST_ASSERT_NULL(pkt->next->next);
+    hdr = pkt->next->data;
+    TEST_ASSERT_EQUAL_INT(TEST_SIZE, byteorder_ntohs(hdr->disp_size) &
+                                     SIXLOWPAN_FRAG_SIZE_MASK);
+    TEST_ASSERT_EQUAL_INT(tag, byteorder_ntohs(hdr->tag));
+    if (offset == 0) {
+        ipv6_hdr_t *ipv6;
+
+        TEST_ASSERT_EQUAL_INT(SIXLOWPAN_FRAG_1_DISP,
+                              hdr->disp_size.u8[0] & SIXLOWPAN_FRAG_DISP_MASK);
+        TEST_ASSERT_EQUAL_INT(sizeof(sixlowpan_frag_t) + 1 + len, pkt->next->size);
+        data = (uint8_t *)pkt->next->data + sizeof(sixlowpan_frag_t);
+        TEST_ASSERT_EQUAL_INT(SIXLOWPAN_UNCOMP, data[0]);
+        data++;
+        /* the hop limit is the only field changed on the way */
+        ipv6 = (ipv6_hdr_t *)data;
+        TEST_ASSERT_EQUAL_INT(TEST_HL - 1, ipv6->hl);
+        ipv6->hl++;
+    }
+    else {
+        TEST_ASSERT_EQUAL_INT(SIXLOWPAN_FRAG_N_DISP,
+                              hdr->disp_size.u8[0] & SIXLOWPAN_FRAG_DISP_MASK);
+        TEST_ASSERT_EQUAL_INT(offset / 8, hdr->offset);
+        TEST_ASSERT_EQUAL_INT(sizeof(sixlowpan_frag_n_t) + len, pkt->next->size);
+        data = (uint8_t *)(hdr + 1);
+    }
+    TEST_ASSERT_EQUAL_INT(0, memcmp(&_datagram[offset], data, len));
+    gnrc_pktbuf_release(pkt);
+}
+
+/* lets the node receive _datagram in two fragments */
+static void _recv_datagram(void)
+{
+    _recv_frag(TEST_SIZE, TEST_TAG, 0, TEST_FWD_FRAG1_SIZE);
+    _recv_frag(TEST_SIZE, TEST_TAG, TEST_FWD_FRAG1_SIZE,
+               TEST_SIZE - TEST_FWD_FRAG1_SIZE);
+}
+
+/* sends _datagram uncompressed over the interface of this thread, its
+ * payload split into snips of the given sizes */
+static gnrc_pktsnip_t *_send_datagram(const size_t *sizes, unsigned numof,
+                                      bool shared)
+{
+    gnrc_pktsnip_t *netif, *payload = NULL;
+    uint8_t disp = SIXLOWPAN_UNCOMP;
+
+    _fragment_msg.pid = thread_getpid();
+    _fragment_msg.datagram_size = 0;
+    _fragment_msg.offset = 0;
+    for (unsigned i = numof; i > 0; i--) {
+        _fragment_msg.datagram_size += sizes[i - 1];
+    }
+    for (unsigned i = numof, offset = _fragment_msg.datagram_size; i > 0; i--) {
+        offset -= sizes[i - 1];
+        payload = gnrc_pktbuf_add(payload, &_datagram[offset], sizes[i - 1],
+                                  GNRC_NETTYPE_UNDEF);
+    }
+    payload = gnrc_pktbuf_add(payload, &disp, sizeof(disp), GNRC_NETTYPE_SIXLOWPAN);
+    netif = gnrc_netif_hdr_build(NULL, 0, (uint8_t *)_next_hop, sizeof(_next_hop));
+    if ((payload == NULL) || (netif == NULL)) {
+        gnrc_pktbuf_release(payload);
+        gnrc_pktbuf_release(netif);
+        return NULL;
+    }
+    ((gnrc_netif_hdr_t *)netif->data)->if_pid = thread_getpid();
+    netif->next = payload;
+    if (shared) {
+        /* e.g. a multicast datagram sent over several interfaces */
+        gnrc_pktbuf_hold(payload, 1);
+    }
+    gnrc_sixlowpan_netif_add(thread_getpid(), TEST_MAX_FRAG_SIZE);
+    _fragment_msg.pkt = netif;
+    gnrc_sixlowpan_frag_send(&_fragment_msg);
+    return payload;
+}
+
+/* checks the fragments sent for the first size bytes of _datagram */
+static void _check_frags(size_t size)
+{
+    gnrc_pktsnip_t *pkt;
+    uint8_t data[TEST_MAX_FRAG_SIZE];
+    size_t offset = 0;
+    uint16_t tag = 0;
+
+    while ((pkt = _next_pkt()) != NULL) {
+        sixlowpan_frag_n_t *hdr;
+        uint8_t *payload = data;
+        size_t len = 0;
+
+        TEST_ASSERT_EQUAL_INT(GNRC_NETTYPE_NETIF, pkt->type);
+        TEST_ASSERT_NOT_NULL(pkt->next);
+        hdr = pkt->next->data;
+        TEST_ASSERT_EQUAL_INT(size, byteorder_ntohs(hdr->disp_size) &
+                                    SIXLOWPAN_FRAG_SIZE_MASK);
+        for (gnrc_pktsnip_t *snip = pkt->next->next; snip; snip = snip->next) {
+            TEST_ASSERT(len + snip->size <= sizeof(data));
+            memcpy(&data[len], snip->data, snip->size);
+            len += snip->size;
+        }
+        TEST_ASSERT(pkt->next->size + len <= TEST_MAX_FRAG_SIZE);
+        if (offset == 0) {
+            TEST_ASSERT_EQUAL_INT(SIXLOWPAN_FRAG_1_DISP,
+                                  hdr->disp_size.u8[0] & SIXLOWPAN_FRAG_DISP_MASK);
+            TEST_ASSERT_EQUAL_INT(sizeof(sixlowpan_frag_t), pkt->next->size);
+            TEST_ASSERT_EQUAL_INT(SIXLOWPAN_UNCOMP, data[0]);
+            tag = byteorder_ntohs(hdr->tag);
+            payload++;
+            len--;
+        }
+        else {
+            TEST_ASSERT_EQUAL_INT(SIXLOWPAN_FRAG_N_DISP,
+                                  hdr->disp_size.u8[0] & SIXLOWPAN_FRAG_DISP_MASK);
+            TEST_ASSERT_EQUAL_INT(sizeof(sixlowpan_frag_n_t), pkt->next->size);
+            TEST_ASSERT_EQUAL_INT(tag, byteorder_ntohs(hdr->tag));
+            TEST_ASSERT_EQUAL_INT(offset, hdr->offset * 8);
+        }
+        TEST_ASSERT_EQUAL_INT(0, memcmp(&_datagram[offset], payload, len));
+        offset += len;
+        /* only the last fragment may end off the 8 byte grid */
+        TEST_ASSERT((offset == size) || ((len % 8) == 0));
+        gnrc_pktbuf_release(pkt);
+    }
+    TEST_ASSERT_EQUAL_INT(size, offset);
+}
+
+static void test_rbuf_add__complete(void)
+{
+    _recv_frag(TEST_SIZE, TEST_TAG, 0, TEST_FRAG1_SIZE);
+    TEST_ASSERT_NULL(_next_pkt());
+    _recv_frag(TEST_SIZE, TEST_TAG, TEST_FRAG1_SIZE, TEST_SIZE - TEST_FRAG1_SIZE);
+    _check_datagram(_next_pkt(), TEST_SIZE);
+    TEST_ASSERT_NULL(_next_pkt());
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_rbuf_add__duplicate(void)
+{
+    /* duplicates must be counted once or the datagram never completes */
+    _recv_frag(TEST_SIZE, TEST_TAG, 0, 24);
+    _recv_frag(TEST_SIZE, TEST_TAG, 0, 24);
+    _recv_frag(TEST_SIZE, TEST_TAG, 24, 16);
+    _recv_frag(TEST_SIZE, TEST_TAG, 24, 16);
+    TEST_ASSERT_NULL(_next_pkt());
+    _recv_frag(TEST_SIZE, TEST_TAG, 40, TEST_SIZE - 40);
+    _check_datagram(_next_pkt(), TEST_SIZE);
+    TEST_ASSERT_NULL(_next_pkt());
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_rbuf_add__overlap_restarts(void)
+{
+    _recv_frag(TEST_SIZE, TEST_TAG, 0, TEST_FRAG1_SIZE);
+    /* overlaps the last unit of the FRAG1 partially: reassembly starts over
+     * with only this fragment */
+    _recv_frag(TEST_SIZE, TEST_TAG, 24, 16);
+    _recv_frag(TEST_SIZE, TEST_TAG, 0, 24);
+    TEST_ASSERT_NULL(_next_pkt());
+    _recv_frag(TEST_SIZE, TEST_TAG, 40, TEST_SIZE - 40);
+    _check_datagram(_next_pkt(), TEST_SIZE);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_rbuf_add__evict_oldest_size(void)
+{
+    for (unsigned i = 0; i <= RBUF_SIZE; i++) {
+        _recv_frag(TEST_SIZE, TEST_TAG + i, 0, TEST_FRAG1_SIZE);
+    }
+    TEST_ASSERT_NULL(_next_pkt());
+    /* the newest datagram took the entry of the oldest one */
+    _recv_frag(TEST_SIZE, TEST_TAG + RBUF_SIZE, TEST_FRAG1_SIZE,
+               TEST_SIZE - TEST_FRAG1_SIZE);
+    _check_datagram(_next_pkt(), TEST_SIZE);
+    _recv_frag(TEST_SIZE, TEST_TAG, TEST_FRAG1_SIZE, TEST_SIZE - TEST_FRAG1_SIZE);
+    TEST_ASSERT_NULL(_next_pkt());
+}
+
+/* the slots of gnrc_pktbuf_slab are too small for datagrams of this size */
+#if (TEST_LARGE_SIZE <= SIXLOWPAN_FRAG_SIZE_MASK) && \
+    !defined(MODULE_GNRC_PKTBUF_SLAB)
+static void test_rbuf_add__evict_oldest_budget(void)
+{
+    _recv_frag(TEST_LARGE_SIZE, TEST_TAG, 0, TEST_FRAG1_SIZE);
+    /* both datagrams do not fit into RBUF_BUDGET */
+    _recv_frag(TEST_LARGE_SIZE, TEST_TAG + 1, 0, TEST_FRAG1_SIZE);
+    _recv_frag(TEST_LARGE_SIZE, TEST_TAG + 1, TEST_FRAG1_SIZE,
+               TEST_LARGE_SIZE - TEST_FRAG1_SIZE);
+    _check_datagram(_next_pkt(), TEST_LARGE_SIZE);
+    _recv_frag(TEST_LARGE_SIZE, TEST_TAG, TEST_FRAG1_SIZE,
+               TEST_LARGE_SIZE - TEST_FRAG1_SIZE);
+    TEST_ASSERT_NULL(_next_pkt());
+}
+#endif
+
+static void test_rbuf_gc__timeout(void)
+{
+    msg_t msg;
+    bool gc = false;
+
+    _recv_frag(TEST_SIZE, TEST_TAG, 0, TEST_FRAG1_SIZE);
+    /* too young to be collected */
+    gnrc_sixlowpan_frag_gc_rbuf();
+    TEST_ASSERT(!gnrc_pktbuf_is_empty());
+    xtimer_usleep(RBUF_TIMEOUT + (2 * RBUF_GC_SLACK));
+    while (msg_try_receive(&msg) == 1) {
+        if (msg.type == GNRC_SIXLOWPAN_MSG_FRAG_GC_RBUF) {
+            gc = true;
+        }
+    }
+    TEST_ASSERT(gc);
+    gnrc_sixlowpan_frag_gc_rbuf();
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+    /* the fragment now starts a new datagram */
+    _recv_frag(TEST_SIZE, TEST_TAG, TEST_FRAG1_SIZE, TEST_SIZE - TEST_FRAG1_SIZE);
+    TEST_ASSERT_NULL(_next_pkt());
+}
+
+static void test_vrb_fwd__switch(void)
+{
+    ipv6_hdr_t *hdr = (ipv6_hdr_t *)_datagram;
+    uint16_t out_tag = gnrc_sixlowpan_frag_next_tag() + 1;
+
+    _set_up_fwd();
+    _add_next_hop(&hdr->dst);
+    _recv_frag(TEST_SIZE, TEST_TAG, 0, TEST_FWD_FRAG1_SIZE);
+    _check_fwd(_next_pkt(), out_tag, 0, TEST_FWD_FRAG1_SIZE);
+    _recv_frag(TEST_SIZE, TEST_TAG, TEST_FWD_FRAG1_SIZE,
+               TEST_SIZE - TEST_FWD_FRAG1_SIZE);
+    _check_fwd(_next_pkt(), out_tag, TEST_FWD_FRAG1_SIZE,
+               TEST_SIZE - TEST_FWD_FRAG1_SIZE);
+    TEST_ASSERT_NULL(_next_pkt());
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_vrb_fwd__link_local(void)
+{
+    ipv6_hdr_t *hdr = (ipv6_hdr_t *)_datagram;
+
+    _set_up_fwd();
+    ipv6_addr_set_link_local_prefix(&hdr->dst);
+    _add_next_hop(&hdr->dst);
+    _recv_datagram();
+    _check_datagram(_next_pkt(), TEST_SIZE);
+    TEST_ASSERT_NULL(_next_pkt());
+}
+
+static void test_vrb_fwd__local_dst(void)
+{
+    ipv6_hdr_t *hdr = (ipv6_hdr_t *)_datagram;
+
+    _set_up_fwd();
+    _add_next_hop(&hdr->dst);
+    gnrc_ipv6_netif_add(thread_getpid());
+    TEST_ASSERT_NOT_NULL(gnrc_ipv6_netif_add_addr(thread_getpid(), &hdr->dst,
+                                                  64, 0));
+    _recv_datagram();
+    _check_datagram(_next_pkt(), TEST_SIZE);
+    TEST_ASSERT_NULL(_next_pkt());
+}
+
+static void test_vrb_fwd__hop_limit(void)
+{
+    ipv6_hdr_t *hdr = (ipv6_hdr_t *)_datagram;
+
+    _set_up_fwd();
+    _add_next_hop(&hdr->dst);
+    /* the IPv6 layer replies with a Time Exceeded message */
+    hdr->hl = 1;
+    _recv_datagram();
+    _check_datagram(_next_pkt(), TEST_SIZE);
+    TEST_ASSERT_NULL(_next_pkt());
+}
+
+static void test_vrb_fwd__timeout(void)
+{
+    ipv6_hdr_t *hdr = (ipv6_hdr_t *)_datagram;
+    uint16_t out_tag = gnrc_sixlowpan_frag_next_tag() + 1;
+
+    _set_up_fwd();
+    _add_next_hop(&hdr->dst);
+    _recv_frag(TEST_SIZE, TEST_TAG, 0, TEST_FWD_FRAG1_SIZE);
+    _check_fwd(_next_pkt(), out_tag, 0, TEST_FWD_FRAG1_SIZE);
+    xtimer_usleep(VRB_TIMEOUT + RBUF_GC_SLACK);
+    /* the entry timed out, so the fragment is handed to the reassembly
+     * buffer */
+    _recv_frag(TEST_SIZE, TEST_TAG, TEST_FWD_FRAG1_SIZE,
+               TEST_SIZE - TEST_FWD_FRAG1_SIZE);
+    TEST_ASSERT_NULL(_next_pkt());
+    TEST_ASSERT(!gnrc_pktbuf_is_empty());
+}
+
+static void test_vrb_fwd__fragn_before_frag1(void)
+{
+    ipv6_hdr_t *hdr = (ipv6_hdr_t *)_datagram;
+    uint16_t out_tag = gnrc_sixlowpan_frag_next_tag() + 1;
+
+    _set_up_fwd();
+    _add_next_hop(&hdr->dst);
+    /* the next hop is not known yet: the fragment is never forwarded */
+    _recv_frag(TEST_SIZE, TEST_TAG, TEST_FWD_FRAG1_SIZE,
+               TEST_SIZE - TEST_FWD_FRAG1_SIZE);
+    TEST_ASSERT_NULL(_next_pkt());
+    _recv_frag(TEST_SIZE, TEST_TAG, 0, TEST_FWD_FRAG1_SIZE);
+    _check_fwd(_next_pkt(), out_tag, 0, TEST_FWD_FRAG1_SIZE);
+    TEST_ASSERT_NULL(_next_pkt());
+}
+
+static void test_vrb_fwd__duplicate(void)
+{
+    ipv6_hdr_t *hdr = (ipv6_hdr_t *)_datagram;
+    uint16_t out_tag = gnrc_sixlowpan_frag_next_tag() + 1;
+
+    _set_up_fwd();
+    _add_next_hop(&hdr->dst);
+    _recv_frag(TEST_SIZE, TEST_TAG, 0, TEST_FWD_FRAG1_SIZE);
+    _check_fwd(_next_pkt(), out_tag, 0, TEST_FWD_FRAG1_SIZE);
+    _recv_frag(TEST_SIZE, TEST_TAG, 0, TEST_FWD_FRAG1_SIZE);
+    TEST_ASSERT_NULL(_next_pkt());
+    _recv_frag(TEST_SIZE, TEST_TAG, TEST_FWD_FRAG1_SIZE, 8);
+    _check_fwd(_next_pkt(), out_tag, TEST_FWD_FRAG1_SIZE, 8);
+    _recv_frag(TEST_SIZE, TEST_TAG, TEST_FWD_FRAG1_SIZE, 8);
+    TEST_ASSERT_NULL(_next_pkt());
+    /* the duplicates did not count as the rest of the datagram */
+    _recv_frag(TEST_SIZE, TEST_TAG, TEST_FWD_FRAG1_SIZE + 8,
+               TEST_SIZE - TEST_FWD_FRAG1_SIZE - 8);
+    _check_fwd(_next_pkt(), out_tag, TEST_FWD_FRAG1_SIZE + 8,
+               TEST_SIZE - TEST_FWD_FRAG1_SIZE - 8);
+    TEST_ASSERT_NULL(_next_pkt());
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+#ifdef MODULE_GNRC_SIXLOWPAN_IPHC
+static void test_vrb_fwd__iphc(void)
+{
+    ipv6_hdr_t *hdr = (ipv6_hdr_t *)_datagram;
+    uint16_t out_tag = gnrc_sixlowpan_frag_next_tag() + 1;
+    gnrc_pktsnip_t *pkt, *frag, *dec_hdr;
+    size_t iphc_len, nh_len = 0;
+    sixlowpan_frag_t *frag_hdr;
+
+    _set_up_fwd();
+    gnrc_sixlowpan_netif_get(thread_getpid())->iphc_enabled = true;
+    hdr->len = byteorder_htons(TEST_SIZE - sizeof(ipv6_hdr_t));
+    _add_next_hop(&hdr->dst);
+    _recv_frag(TEST_SIZE, TEST_TAG, 0, TEST_FWD_FRAG1_SIZE);
+    pkt = _next_pkt();
+    TEST_ASSERT_NOT_NULL(pkt);
+    TEST_ASSERT_EQUAL_INT(GNRC_NETTYPE_NETIF, pkt->type);
+    TEST_ASSERT_NOT_NULL(pkt->next);
+    frag_hdr = pkt->next->data;
+    TEST_ASSERT_EQUAL_INT(SIXLOWPAN_FRAG_1_DISP,
+                          frag_hdr->disp_size.u8[0] & SIXLOWPAN_FRAG_DISP_MASK);
+    /* the datagram size refers to the uncompressed datagram, so it stays */
+    TEST_ASSERT_EQUAL_INT(TEST_SIZE, byteorder_ntohs(frag_hdr->disp_size) &
+                                     SIXLOWPAN_FRAG_SIZE_MASK);
+    TEST_ASSERT_EQUAL_INT(out_tag, byteorder_ntohs(frag_hdr->tag));
+    TEST_ASSERT(sixlowpan_iphc_is((uint8_t *)(frag_hdr + 1)));
+    /* decode as the next hop would */
+    frag = gnrc_pktbuf_add(pkt, pkt->next->data, pkt->next->size, GNRC_NETTYPE_SIXLOWPAN);
+    dec_hdr = gnrc_pktbuf_add(NULL, NULL, sizeof(ipv6_hdr_t), GNRC_NETTYPE_IPV6);
+    TEST_ASSERT_NOT_NULL(frag);
+    TEST_ASSERT_NOT_NULL(dec_hdr);
+    iphc_len = gnrc_sixlowpan_iphc_decode(&dec_hdr, frag, TEST_SIZE,
+                                          sizeof(sixlowpan_frag_t), &nh_len);
+    TEST_ASSERT(iphc_len > 0);
+    TEST_ASSERT_EQUAL_INT(TEST_HL - 1, ((ipv6_hdr_t *)dec_hdr->data)->hl);
+    ((ipv6_hdr_t *)dec_hdr->data)->hl++;
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_datagram, dec_hdr->data, sizeof(ipv6_hdr_t)));
+    /* the rest of the first fragment is the same, so the offsets of the
+     * subsequent fragments still fit */
+    TEST_ASSERT_EQUAL_INT(sizeof(sixlowpan_frag_t) + iphc_len + TEST_FWD_FRAG1_SIZE -
+                          sizeof(ipv6_hdr_t), frag->size);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(&_datagram[sizeof(ipv6_hdr_t)],
+                                    (uint8_t *)frag->data + sizeof(sixlowpan_frag_t) +
+                                    iphc_len,
+                                    TEST_FWD_FRAG1_SIZE - sizeof(ipv6_hdr_t)));
+    gnrc_pktbuf_release(dec_hdr);
+    gnrc_pktbuf_release(frag);
+    _recv_frag(TEST_SIZE, TEST_TAG, TEST_FWD_FRAG1_SIZE,
+               TEST_SIZE - TEST_FWD_FRAG1_SIZE);
+    _check_fwd(_next_pkt(), out_tag, TEST_FWD_FRAG1_SIZE,
+               TEST_SIZE - TEST_FWD_FRAG1_SIZE);
+    TEST_ASSERT_NULL(_next_pkt());
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+#endif
+
+static void test_frag_send__multi_snip(void)
+{
+    /* snip boundaries lie within the fragments */
+    static const size_t sizes[] = { sizeof(ipv6_hdr_t), 30, 90, 50 };
+
+    TEST_ASSERT_NOT_NULL(_send_datagram(sizes, 4, false));
+    _check_frags(sizeof(ipv6_hdr_t) + 30 + 90 + 50);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_frag_send__shared(void)
+{
+    static const size_t sizes[] = { sizeof(ipv6_hdr_t), 170 };
+    gnrc_pktsnip_t *payload = _send_datagram(sizes, 2, true);
+
+    TEST_ASSERT_NOT_NULL(payload);
+    _check_frags(sizeof(ipv6_hdr_t) + 170);
+    /* the other user's copy is left untouched */
+    TEST_ASSERT_EQUAL_INT(1 + sizeof(ipv6_hdr_t) + 170, gnrc_pkt_len(payload));
+    TEST_ASSERT_NOT_NULL(payload->next);
+    TEST_ASSERT_NOT_NULL(payload->next->next);
+    TEST_ASSERT_NULL(payload->next->next->next);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_datagram, payload->next->data,
+                                    sizeof(ipv6_hdr_t)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(&_datagram[sizeof(ipv6_hdr_t)],
+                                    payload->next->next->data, 170));
+    gnrc_pktbuf_release(payload);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_frag_send__paced(void)
+{
+    /* more fragments than fit into the message queue of the interface */
+    static const size_t sizes[] = { sizeof(ipv6_hdr_t),
+                                    TEST_MSG_QUEUE_SIZE * TEST_MAX_FRAG_SIZE };
+
+    TEST_ASSERT_NOT_NULL(_send_datagram(sizes, 2, false));
+    _check_frags(sizeof(ipv6_hdr_t) + (TEST_MSG_QUEUE_SIZE * TEST_MAX_FRAG_SIZE));
+    TEST_ASSERT_NULL(_fragment_msg.pkt);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+Test *tests_sixlowpan_frag_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_rbuf_add__complete),
+        new_TestFixture(test_rbuf_add__duplicate),
+        new_TestFixture(test_rbuf_add__overlap_restarts),
+        new_TestFixture(test_rbuf_add__evict_oldest_size),
+#if (TEST_LARGE_SIZE <= SIXLOWPAN_FRAG_SIZE_MASK) && \
+    !defined(MODULE_GNRC_PKTBUF_SLAB)
+        new_TestFixture(test_rbuf_add__evict_oldest_budget),
+#endif
+        new_TestFixture(test_rbuf_gc__timeout),
+        new_TestFixture(test_vrb_fwd__switch),
+        new_TestFixture(test_vrb_fwd__link_local),
+        new_TestFixture(test_vrb_fwd__local_dst),
+        new_TestFixture(test_vrb_fwd__hop_limit),
+        new_TestFixture(test_vrb_fwd__timeout),
+        new_TestFixture(test_vrb_fwd__fragn_before_frag1),
+        new_TestFixture(test_vrb_fwd__duplicate),
+#ifdef MODULE_GNRC_SIXLOWPAN_IPHC
+        new_TestFixture(test_vrb_fwd__iphc),
+#endif
+        new_TestFixture(test_frag_send__multi_snip),
+        new_TestFixture(test_frag_send__shared),
+        new_TestFixture(test_frag_send__paced),
+    };
+
+    EMB_UNIT_TESTCALLER(sixlowpan_frag_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&sixlowpan_frag_tests;
+}
+
+void tests_sixlowpan_frag(void)
+{
+    /* rbuf dispatches complete datagrams to and sets its GC timer for this
+     * thread, vrb and the fragmentation send over the interface of this
+     * thread */
+    msg_init_queue(_msg_queue, TEST_MSG_QUEUE_SIZE);
+    TESTS_RUN(tests_sixlowpan_frag_tests());
+}
+/** @} */
@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ *
+ * The timer wheel is compiled into this file and runs on a simulated
+ * low-level timer, so the tests can skip ahead to the 32 bit wraparound of
+ * xtimer_now() and beyond the horizon of the wheel. Its public functions are
+ * renamed, so they do not clash with the xtimer backend of the application.
+ */
+#ifndef MODULE_XTIMER_WHEEL
+#define MODULE_XTIMER_WHEEL
+#endif
+
+#define timer_init(dev, freq, cb, arg)      _fake_timer_init(dev, freq, cb, arg)
+#define timer_read(dev)                     _fake_timer_read(dev)
+#define timer_set_absolute(dev, chan, val)  _fake_timer_set_absolute(dev, chan, val)
+
+#define xtimer_init             _wheel_init
+#define xtimer_now64            _wheel_now64
+#define _xtimer_set64           _wheel_set64
+#define xtimer_set              _wheel_set
+#define _xtimer_set_absolute    _wheel_set_absolute
+#define xtimer_remove           _wheel_remove
+#define _high_cnt               _wheel_high_cnt
+
+#include "xtimer_wheel.c"
+
+#include "embUnit.h"
+
+#include "tests-xtimer_wheel.h"
+
+#define TEST_TIMERS     (6U)
+#define TEST_SLACK      (100U)  /**< latest acceptable firing in us */
+#define TEST_TICK       (((uint64_t)1) << XTIMER_WHEEL_TICK_SHIFT)
+#define TEST_HORIZON    (TEST_TICK << _HORIZON_BITS)
+
+static uint64_t _now;           /* time of the simulated low-level timer */
+static uint64_t _alarm;         /* time the simulated low-level timer fires */
+static timer_cb_t _isr;
+
+static xtimer_t _timers[TEST_TIMERS];
+static uint64_t _targets[TEST_TIMERS];
+static uint64_t _fired[TEST_TIMERS];
+/* one more, so the timer after the last one never fired */
+static unsigned _fire_count[TEST_TIMERS + 1];
+static xtimer_t *_to_remove;
+
+int _fake_timer_init(tim_t dev, unsigned long freq, timer_cb_t cb, void *arg)
+{
+    (void)dev;
+    (void)freq;
+    (void)arg;
+    _isr = cb;
+    return 0;
+}
+
+unsigned int _fake_timer_read(tim_t dev)
+{
+    (void)dev;
+    /* every read takes a microsecond, so busy waits terminate */
+    return _lltimer_mask((uint32_t)(_now++));
+}
+
+int _fake_timer_set_absolute(tim_t dev, int channel, unsigned int value)
+{
+    (void)dev;
+    (void)channel;
+    /* like a hardware timer, fires when the counter next reaches value */
+    _alarm = _now + _lltimer_mask(value - (uint32_t)_now);
+    return 0;
+}
+
+/* runs the simulated low-level timer up to time */
+static void _run_until(uint64_t time)
+{
+    while (_alarm <= time) {
+        if (_now < _alarm) {
+            _now = _alarm;
+        }
+        _alarm = _NEVER;
+        _isr(NULL, 0);
+    }
+    if (_now < time) {
+        _now = time;
+    }
+}
+
+static void _cb(void *arg)
+{
+    unsigned i = (xtimer_t *)arg - _timers;
+
+    _fired[i] = _now;
+    _fire_count[i]++;
+    if (_to_remove) {
+        xtimer_remove(_to_remove);
+        _to_remove = NULL;
+    }
+}
+
+static void _set(unsigned i, uint64_t offset)
+{
+    _timers[i].callback = _cb;
+    _timers[i].arg = &_timers[i];
+    _targets[i] = _now + offset;
+    _xtimer_set64(&_timers[i], (uint32_t)offset, offset >> 32);
+}
+
+static void _assert_fired(unsigned i)
+{
+    TEST_ASSERT_EQUAL_INT(1, _fire_count[i]);
+    TEST_ASSERT(_fired[i] >= _targets[i]);
+    TEST_ASSERT(_fired[i] - _targets[i] < TEST_SLACK);
+}
+
+static void _assert_empty(void)
+{
+    for (unsigned level = 0; level < XTIMER_WHEEL_LEVELS; level++) {
+        TEST_ASSERT_EQUAL_INT(0, _bitmap[level]);
+        for (unsigned slot = 0; slot < _SLOTS; slot++) {
+            TEST_ASSERT_NULL(_wheel[level][slot]);
+        }
+    }
+    TEST_ASSERT_NULL(_due);
+    TEST_ASSERT_NULL(_far);
+}
+
+static void set_up(void)
+{
+    memset(_wheel, 0, sizeof(_wheel));
+    memset(_bitmap, 0, sizeof(_bitmap));
+    _due = NULL;
+    _far = NULL;
+    _wheel_time = 0;
+    _armed = _NEVER;
+    _in_handler = 0;
+    _long_cnt = 0;
+#if XTIMER_MASK
+    _high_cnt = 0;
+#endif
+    _now = 0;
+    _alarm = _NEVER;
+    memset(_timers, 0, sizeof(_timers));
+    memset(_fired, 0, sizeof(_fired));
+    memset(_fire_count, 0, sizeof(_fire_count));
+    _to_remove = NULL;
+    xtimer_init();
+}
+
+static void test_xtimer_wheel__cascade(void)
+{
+    /* due list, level 0, 1, 2, 3 and 4 with the default configuration,
+     * set in reverse order */
+    static const uint64_t offsets[] = { 500, 5000, 100000, 2000000,
+                                        60000000, 3600000000 };
+
+    for (unsigned i = TEST_TIMERS; i > 0; i--) {
+        _set(i - 1, offsets[i - 1]);
+    }
+    for (unsigned i = 0; i < TEST_TIMERS; i++) {
+        _run_until(_targets[i] + TEST_SLACK);
+        _assert_fired(i);
+        TEST_ASSERT_EQUAL_INT(0, _fire_count[i + 1]);
+    }
+    _assert_empty();
+}
+
+static void test_xtimer_wheel__remove_cascaded(void)
+{
+    /* all in the same level 1 slot, which is cascaded down at once */
+    uint64_t slot = TEST_TICK << _SLOT_BITS;
+
+    _set(0, (3 * slot) + (TEST_TICK / 2));
+    _set(1, (3 * slot) + (4 * TEST_TICK));
+    _set(2, (3 * slot) + (5 * TEST_TICK));
+    _set(3, (3 * slot) + (6 * TEST_TICK));
+    TEST_ASSERT(_bitmap[1] != 0);
+
+    /* timer 0 removes timer 1 after the slot was cascaded */
+    _to_remove = &_timers[1];
+    _run_until(_targets[0] + TEST_SLACK);
+    _assert_fired(0);
+    TEST_ASSERT_EQUAL_INT(0, _bitmap[1]);
+    TEST_ASSERT(!_is_set(&_timers[1]));
+    xtimer_remove(&_timers[2]);
+    TEST_ASSERT(!_is_set(&_timers[2]));
+    /* only the slot of timer 3 is left */
+    TEST_ASSERT_EQUAL_INT(((uint32_t)1) << 6, _bitmap[0]);
+
+    _run_until(_targets[3] + TEST_SLACK);
+    TEST_ASSERT_EQUAL_INT(0, _fire_count[1]);
+    TEST_ASSERT_EQUAL_INT(0, _fire_count[2]);
+    _assert_fired(3);
+    _assert_empty();
+}
+
+static void test_xtimer_wheel__horizon(void)
+{
+    /* the wheel starts at tick 0, so a timer of exactly the horizon is the
+     * first one that does not fit on the wheel */
+    _set(0, TEST_HORIZON - TEST_TICK);
+    _set(1, TEST_HORIZON);
+    _set(2, TEST_HORIZON + (TEST_TICK / 2));
+    _set(3, TEST_HORIZON + TEST_TICK);
+    TEST_ASSERT_EQUAL_INT(((uint32_t)1) << (_SLOTS - 1),
+                          _bitmap[XTIMER_WHEEL_LEVELS - 1]);
+    TEST_ASSERT(_far == &_timers[3]);
+    TEST_ASSERT(_far->next == &_timers[2]);
+    TEST_ASSERT(_far->next->next == &_timers[1]);
+
+    for (unsigned i = 0; i < 4; i++) {
+        _run_until(_targets[i] + TEST_SLACK);
+        _assert_fired(i);
+        TEST_ASSERT_EQUAL_INT(0, _fire_count[i + 1]);
+    }
+    _assert_empty();
+}
+
+static void test_xtimer_wheel__wraparound(void)
+{
+    uint64_t wrap = ((uint64_t)1) << 32;
+
+    _now = wrap - 10000;
+    /* before, right at, after the wraparound and on another level */
+    _set(0, 5000);
+    _set(1, 10000);
+    _set(2, 10000 + TEST_TICK);
+    _set(3, 200000);
+    _set(4, 200000 + wrap);
+
+    for (unsigned i = 0; i < 5; i++) {
+        _run_until(_targets[i] + TEST_SLACK);
+        _assert_fired(i);
+        TEST_ASSERT_EQUAL_INT(0, _fire_count[i + 1]);
+        TEST_ASSERT_EQUAL_INT(_fired[i] >> 32, _long_cnt);
+    }
+    _assert_empty();
+    TEST_ASSERT(xtimer_now64() >= _targets[4]);
+}
+
+Test *tests_xtimer_wheel_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_xtimer_wheel__cascade),
+        new_TestFixture(test_xtimer_wheel__remove_cascaded),
+        new_TestFixture(test_xtimer_wheel__horizon),
+        new_TestFixture(test_xtimer_wheel__wraparound),
+    };
+
+    EMB_UNIT_TESTCALLER(xtimer_wheel_tests, set_up, NULL, fixtures);
+
+    return (Test *)&xtimer_wheel_tests;
+}
+
+void tests_xtimer_wheel(void)
+{
+    TESTS_RUN(tests_xtimer_wheel_tests());
+}
+/** @} */
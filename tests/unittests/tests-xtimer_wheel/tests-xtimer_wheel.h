@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file
+ * @brief       Unittests for the ``xtimer_wheel`` module
+ */
+#ifndef TESTS_XTIMER_WHEEL_H_
+#define TESTS_XTIMER_WHEEL_H_
+
+#include "embUnit.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_xtimer_wheel(void);
+
+/**
+ * @brief   Generates tests for the timer wheel
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_xtimer_wheel_tests(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TESTS_XTIMER_WHEEL_H_ */
+/** @} */
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2016 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measures xtimer insert and remove latency against the number
+ *              of active timers
+ *
+ * @}
+ */
+
+#include <stdio.h>
+
+#include "xtimer.h"
+
+#define MAX_TIMERS  (256U)
+#define PROBES      (16U)
+#define REPEAT      (8U)
+/* far enough in the future to never fire during the test */
+#define BASE_OFFSET (10U * SEC_IN_USEC)
+
+static xtimer_t timers[MAX_TIMERS];
+static xtimer_t probes[PROBES];
+static const unsigned counts[] = { 0, 1, 8, 32, 64, 128, 256 };
+
+static void _cb(void *arg)
+{
+    (void)arg;
+    puts("error: timer fired");
+}
+
+/* spreads the timers over about a minute, in no particular order */
+static uint32_t _offset(unsigned i)
+{
+    return BASE_OFFSET + ((i * 7919U) % MAX_TIMERS) * 200000U;
+}
+
+int main(void)
+{
+    unsigned active = 0;
+
+    puts("xtimer benchmark");
+#ifdef MODULE_XTIMER_WHEEL
+    puts("backend: timer wheel");
+#else
+    puts("backend: sorted lists");
+#endif
+    puts("timers | insert [ns] | remove [ns]");
+
+    for (unsigned i = 0; i < MAX_TIMERS; i++) {
+        timers[i].callback = _cb;
+    }
+    for (unsigned i = 0; i < PROBES; i++) {
+        probes[i].callback = _cb;
+    }
+    for (unsigned c = 0; c < (sizeof(counts) / sizeof(counts[0])); c++) {
+        uint32_t insert = 0, remove = 0;
+
+        while (active < counts[c]) {
+            xtimer_set(&timers[active], _offset(active));
+            active++;
+        }
+        for (unsigned r = 0; r < REPEAT; r++) {
+            uint32_t start = xtimer_now();
+
+            for (unsigned i = 0; i < PROBES; i++) {
+                xtimer_set(&probes[i], _offset(i * (r + 3)) + i);
+            }
+            insert += xtimer_now() - start;
+            start = xtimer_now();
+            for (unsigned i = 0; i < PROBES; i++) {
+                xtimer_remove(&probes[i]);
+            }
+            remove += xtimer_now() - start;
+        }
+        printf("%6u | %11lu | %11lu\n", active,
+               (unsigned long)((insert * 1000UL) / (REPEAT * PROBES)),
+               (unsigned long)((remove * 1000UL) / (REPEAT * PROBES)));
+    }
+    for (unsigned i = 0; i < active; i++) {
+        xtimer_remove(&timers[i]);
+    }
+    puts("done");
+
+    return 0;
+}